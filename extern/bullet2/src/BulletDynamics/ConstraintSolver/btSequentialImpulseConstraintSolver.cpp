@@ -305,7 +305,9 @@ void	btSequentialImpulseConstraintSolver::resolveSplitPenetrationImpulseCacheFri
 {
 		if (c.m_rhsPenetration)
         {
+#ifndef BT_NO_PROFILE
 			gNumSplitImpulseRecoveries++;
+#endif
 			btScalar deltaImpulse = c.m_rhsPenetration-btScalar(c.m_appliedPushImpulse)*c.m_cfm;
 			const btScalar deltaVel1Dotn	=	c.m_contactNormal1.dot(body1.internalGetPushVelocity()) 	+ c.m_relpos1CrossNormal.dot(body1.internalGetTurnVelocity());
 			const btScalar deltaVel2Dotn	=	c.m_contactNormal2.dot(body2.internalGetPushVelocity())		+ c.m_relpos2CrossNormal.dot(body2.internalGetTurnVelocity());
@@ -333,7 +335,9 @@ void	btSequentialImpulseConstraintSolver::resolveSplitPenetrationImpulseCacheFri
 	if (!c.m_rhsPenetration)
 		return;
 
+#ifndef BT_NO_PROFILE
 	gNumSplitImpulseRecoveries++;
+#endif
 
 	__m128 cpAppliedImp = _mm_set1_ps(c.m_appliedPushImpulse);
 	__m128	lowerLimit1 = _mm_set1_ps(c.m_lowerLimit);
@@ -719,6 +723,20 @@ int	btSequentialImpulseConstraintSolver::getOrInitSolverBody(btCollisionObject&
 
 	int solverBodyIdA = -1;
 
+	if (body.isKinematicObject() && btRigidBody::upcast(&body))
+	{
+		//kinematic bodies can be shared by islands solved concurrently, don't use their companion id
+		const int* kinematicBodyId = m_kinematicBodySolverIds.find(btHashPtr(&body));
+		if (kinematicBodyId)
+			return *kinematicBodyId;
+
+		solverBodyIdA = m_tmpSolverBodyPool.size();
+		btSolverBody& solverBody = m_tmpSolverBodyPool.expand();
+		initSolverBody(&solverBody,&body,timeStep);
+		m_kinematicBodySolverIds.insert(btHashPtr(&body),solverBodyIdA);
+		return solverBodyIdA;
+	}
+
 	if (body.getCompanionId() >= 0)
 	{
 		//body has already been converted
@@ -1170,6 +1188,7 @@ void btSequentialImpulseConstraintSolver::convertContacts(btPersistentManifold**
 btScalar btSequentialImpulseConstraintSolver::solveGroupCacheFriendlySetup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifoldPtr, int numManifolds,btTypedConstraint** constraints,int numConstraints,const btContactSolverInfo& infoGlobal,btIDebugDraw* debugDrawer)
 {
 	m_fixedBodyId = -1;
+	m_kinematicBodySolverIds.clear();
 	BT_PROFILE("solveGroupCacheFriendlySetup");
 	(void)debugDrawer;
 
@@ -1874,7 +1893,8 @@ btScalar btSequentialImpulseConstraintSolver::solveGroupCacheFriendlyFinish(btCo
 	for ( i=0;i<m_tmpSolverBodyPool.size();i++)
 	{
 		btRigidBody* body = m_tmpSolverBodyPool[i].m_originalBody;
-		if (body)
+		//kinematic bodies aren't moved by the solver, and are only read for thread safety
+		if (body && !body->isKinematicObject())
 		{
 			if (infoGlobal.m_splitImpulse)
 				m_tmpSolverBodyPool[i].writebackVelocityAndTransform(infoGlobal.m_timeStep, infoGlobal.m_splitImpulseTurnErp);
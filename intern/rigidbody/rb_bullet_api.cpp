@@ -50,8 +50,14 @@
  * -- Joshua Leung, June 2010
  */
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <errno.h>
+#include <mutex>
 #include <stdio.h>
+#include <thread>
+#include <vector>
 
 #include "RBI_api.h"
 
@@ -63,12 +69,309 @@
 #include "LinearMath/btTransform.h"
 #include "LinearMath/btVector3.h"
 
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
 #include "BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h"
 #include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
 #include "BulletCollision/Gimpact/btGImpactShape.h"
 
+/* Contacts, constraints and bodies of simulation islands solved together. */
+struct rbIslandBatch {
+  btAlignedObjectArray<btCollisionObject *> bodies;
+  btAlignedObjectArray<btPersistentManifold *> manifolds;
+  btAlignedObjectArray<btTypedConstraint *> constraints;
+
+  int size() const
+  {
+    return manifolds.size() + constraints.size();
+  }
+
+  void clear()
+  {
+    bodies.resize(0);
+    manifolds.resize(0);
+    constraints.resize(0);
+  }
+};
+
+static int rb_constraint_island_id(const btTypedConstraint *con)
+{
+  const btCollisionObject &ob0 = con->getRigidBodyA();
+  const btCollisionObject &ob1 = con->getRigidBodyB();
+  return ob0.getIslandTag() >= 0 ? ob0.getIslandTag() : ob1.getIslandTag();
+}
+
+struct rbConstraintIslandSort {
+  bool operator()(const btTypedConstraint *lhs, const btTypedConstraint *rhs) const
+  {
+    return rb_constraint_island_id(lhs) < rb_constraint_island_id(rhs);
+  }
+};
+
+/* Dynamics world solving the simulation islands on multiple threads.
+ *
+ * Islands are batched the same way btDiscreteDynamicsWorld does, and every batch is solved
+ * separately by the solver of a thread, so the result doesn't depend on the number of threads.
+ * Kinematic bodies can be used by several batches, the bundled Bullet solver only reads them
+ * like static bodies (see patches/blender.patch).
+ *
+ * The threads are started once and wait for the batches of every step. */
+class rbIslandDynamicsWorld : public btDiscreteDynamicsWorld {
+ public:
+  rbIslandDynamicsWorld(btDispatcher *dispatcher,
+                        btBroadphaseInterface *pairCache,
+                        btConstraintSolver *constraintSolver,
+                        btCollisionConfiguration *collisionConfiguration)
+      : btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+        num_threads(1),
+        num_batches(0),
+        solver_info(NULL),
+        next_batch(0),
+        threads_stop(false),
+        threads_step(0),
+        threads_used(0),
+        threads_running(0)
+  {
+  }
+
+  virtual ~rbIslandDynamicsWorld()
+  {
+    {
+      std::lock_guard<std::mutex> lock(threads_mutex);
+      threads_stop = true;
+    }
+    threads_start.notify_all();
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    for (int i = 0; i < (int)thread_solvers.size(); i++) {
+      delete thread_solvers[i];
+    }
+  }
+
+  void set_num_threads(int value)
+  {
+#ifdef BT_NO_PROFILE
+    num_threads = std::max(value, 1);
+#else
+    /* Bullet's profiler is not thread safe. */
+    (void)value;
+#endif
+  }
+
+ protected:
+  virtual void solveConstraints(btContactSolverInfo &solverInfo);
+
+ private:
+  /* Collects the islands into batches instead of solving them. */
+  struct IslandCollector : public btSimulationIslandManager::IslandCallback {
+    rbIslandDynamicsWorld *world;
+    const btContactSolverInfo *solver_info;
+
+    virtual void processIsland(btCollisionObject **bodies,
+                               int numBodies,
+                               btPersistentManifold **manifolds,
+                               int numManifolds,
+                               int islandId);
+  };
+
+  rbIslandBatch &batch_current();
+  void batch_close();
+  void batches_solve(btConstraintSolver *solver);
+  void threads_ensure(int num);
+  void thread_run(int thread);
+
+  int num_threads;
+  /* Batches of the current step, kept between steps to reuse the allocations. */
+  std::vector<rbIslandBatch> batches;
+  int num_batches;
+  /* Batches in solving order, and the next one to solve by any thread. */
+  std::vector<rbIslandBatch *> batches_order;
+  const btContactSolverInfo *solver_info;
+  std::atomic<int> next_batch;
+
+  /* Threads other than the calling one and their solvers, the calling one uses the world's. */
+  std::vector<std::thread> threads;
+  std::vector<btConstraintSolver *> thread_solvers;
+  std::mutex threads_mutex;
+  std::condition_variable threads_start;
+  std::condition_variable threads_done;
+  bool threads_stop;
+  /* Incremented for every step solved on multiple threads. */
+  int threads_step;
+  /* Number of threads solving batches in the current step, and still solving them. */
+  int threads_used;
+  int threads_running;
+};
+
+void rbIslandDynamicsWorld::IslandCollector::processIsland(btCollisionObject **bodies,
+                                                           int numBodies,
+                                                           btPersistentManifold **manifolds,
+                                                           int numManifolds,
+                                                           int islandId)
+{
+  rbIslandBatch &batch = world->batch_current();
+  const btAlignedObjectArray<btTypedConstraint *> &constraints = world->m_sortedConstraints;
+  int i;
+
+  for (i = 0; i < numBodies; i++) {
+    batch.bodies.push_back(bodies[i]);
+  }
+  for (i = 0; i < numManifolds; i++) {
+    batch.manifolds.push_back(manifolds[i]);
+  }
+
+  if (islandId < 0) {
+    /* Islands aren't split, everything is solved at once. */
+    for (i = 0; i < constraints.size(); i++) {
+      batch.constraints.push_back(constraints[i]);
+    }
+    world->batch_close();
+    return;
+  }
+
+  /* Constraints are sorted by island. */
+  for (i = 0; i < constraints.size(); i++) {
+    if (rb_constraint_island_id(constraints[i]) == islandId) {
+      break;
+    }
+  }
+  for (; i < constraints.size() && rb_constraint_island_id(constraints[i]) == islandId; i++) {
+    batch.constraints.push_back(constraints[i]);
+  }
+
+  if (solver_info->m_minimumSolverBatchSize <= 1 ||
+      batch.size() > solver_info->m_minimumSolverBatchSize) {
+    world->batch_close();
+  }
+}
+
+rbIslandBatch &rbIslandDynamicsWorld::batch_current()
+{
+  if (num_batches == (int)batches.size()) {
+    batches.push_back(rbIslandBatch());
+    batches.back().clear();
+  }
+  return batches[num_batches];
+}
+
+void rbIslandDynamicsWorld::batch_close()
+{
+  rbIslandBatch &batch = batch_current();
+  if (batch.bodies.size() == 0 && batch.size() == 0) {
+    return;
+  }
+
+  num_batches++;
+  batch_current().clear();
+}
+
+void rbIslandDynamicsWorld::batches_solve(btConstraintSolver *solver)
+{
+  for (int i = next_batch++; i < (int)batches_order.size(); i = next_batch++) {
+    rbIslandBatch &batch = *batches_order[i];
+    solver->solveGroup(batch.bodies.size() ? &batch.bodies[0] : NULL,
+                       batch.bodies.size(),
+                       batch.manifolds.size() ? &batch.manifolds[0] : NULL,
+                       batch.manifolds.size(),
+                       batch.constraints.size() ? &batch.constraints[0] : NULL,
+                       batch.constraints.size(),
+                       *solver_info,
+                       getDebugDrawer(),
+                       getDispatcher());
+  }
+}
+
+void rbIslandDynamicsWorld::threads_ensure(int num)
+{
+  while ((int)threads.size() < num) {
+    thread_solvers.push_back(new btSequentialImpulseConstraintSolver());
+    threads.push_back(std::thread(&rbIslandDynamicsWorld::thread_run, this, (int)threads.size()));
+  }
+}
+
+void rbIslandDynamicsWorld::thread_run(int thread)
+{
+  int step = 0;
+  std::unique_lock<std::mutex> lock(threads_mutex);
+
+  while (true) {
+    threads_start.wait(lock, [&] { return threads_stop || threads_step != step; });
+    if (threads_stop) {
+      return;
+    }
+    step = threads_step;
+    if (thread >= threads_used) {
+      continue;
+    }
+
+    lock.unlock();
+    batches_solve(thread_solvers[thread]);
+    lock.lock();
+
+    if (--threads_running == 0) {
+      threads_done.notify_one();
+    }
+  }
+}
+
+void rbIslandDynamicsWorld::solveConstraints(btContactSolverInfo &solverInfo)
+{
+  if (num_threads == 1) {
+    btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+    return;
+  }
+
+  m_sortedConstraints.resize(m_constraints.size());
+  for (int i = 0; i < m_constraints.size(); i++) {
+    m_sortedConstraints[i] = m_constraints[i];
+  }
+  m_sortedConstraints.quickSort(rbConstraintIslandSort());
+
+  num_batches = 0;
+  batch_current().clear();
+
+  IslandCollector collector;
+  collector.world = this;
+  collector.solver_info = &solverInfo;
+
+  m_constraintSolver->prepareSolve(getNumCollisionObjects(), getDispatcher()->getNumManifolds());
+  getSimulationIslandManager()->buildAndProcessIslands(getDispatcher(), this, &collector);
+  batch_close();
+
+  /* Solve the largest batches first for the threads to finish at about the same time. */
+  batches_order.resize(num_batches);
+  for (int i = 0; i < num_batches; i++) {
+    batches_order[i] = &batches[i];
+  }
+  std::sort(batches_order.begin(),
+            batches_order.end(),
+            [](const rbIslandBatch *a, const rbIslandBatch *b) { return a->size() > b->size(); });
+  solver_info = &solverInfo;
+  next_batch = 0;
+
+  const int num_used = std::min(num_threads, num_batches) - 1;
+  if (num_used > 0) {
+    threads_ensure(num_used);
+    {
+      std::lock_guard<std::mutex> lock(threads_mutex);
+      threads_used = threads_running = num_used;
+      threads_step++;
+    }
+    threads_start.notify_all();
+  }
+
+  batches_solve(m_constraintSolver);
+
+  if (num_used > 0) {
+    std::unique_lock<std::mutex> lock(threads_mutex);
+    threads_done.wait(lock, [&] { return threads_running == 0; });
+  }
+
+  m_constraintSolver->allSolved(solverInfo, getDebugDrawer());
+}
+
 struct rbDynamicsWorld {
-  btDiscreteDynamicsWorld *dynamicsWorld;
+  rbIslandDynamicsWorld *dynamicsWorld;
   btDefaultCollisionConfiguration *collisionConfiguration;
   btDispatcher *dispatcher;
   btBroadphaseInterface *pairCache;
@@ -153,7 +456,7 @@ rbDynamicsWorld *RB_dworld_new(const float gravity[3])
   world->constraintSolver = new btSequentialImpulseConstraintSolver();
 
   /* world */
-  world->dynamicsWorld = new btDiscreteDynamicsWorld(
+  world->dynamicsWorld = new rbIslandDynamicsWorld(
       world->dispatcher, world->pairCache, world->constraintSolver, world->collisionConfiguration);
 
   RB_dworld_set_gravity(world, gravity);
@@ -202,6 +505,12 @@ void RB_dworld_set_split_impulse(rbDynamicsWorld *world, int split_impulse)
   info.m_splitImpulse = split_impulse;
 }
 
+/* Threads */
+void RB_dworld_set_num_threads(rbDynamicsWorld *world, int num_threads)
+{
+  world->dynamicsWorld->set_num_threads(num_threads);
+}
+
 /* Simulation ----------------------- */
 
 void RB_dworld_step_simulation(rbDynamicsWorld *world,
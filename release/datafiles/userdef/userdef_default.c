@@ -129,6 +129,7 @@ const UserDef U_default = {
 
     /** Clamped by half the systems memory. */
     .memcachelimit = 4096,
+    .modifier_cache_limit = 512,
 
     .prefetchframes = 0,
     .pad_rot_angle = 15,
@@ -193,8 +193,13 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
         col.prop(md, "operation", text="")
 
         col = split.column()
-        col.label(text="Object:")
-        col.prop(md, "object", text="")
+        col.label(text="Operand Type:")
+        col.prop(md, "operand_type", text="")
+
+        if md.operand_type == 'OBJECT':
+            layout.prop(md, "object")
+        else:
+            layout.prop(md, "collection")
 
         layout.prop(md, "double_threshold")
 
@@ -1143,6 +1148,11 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
             sub.prop(md, "render_levels", text="Render")
             sub.prop(md, "levels", text="Viewport")
 
+            col.prop(md, "use_adaptive")
+            sub = col.column()
+            sub.active = md.use_adaptive
+            sub.prop(md, "adaptive_pixel_size", text="Pixel Size")
+
             col.prop(md, "quality")
 
         col = split.column()
@@ -173,6 +173,12 @@ class RENDER_PT_post_processing(RenderOutputButtonsPanel, Panel):
         col.prop(rd, "use_compositing")
         col.prop(rd, "use_sequencer")
 
+        ed = context.scene.sequence_editor
+        if ed:
+            sub = layout.column()
+            sub.active = rd.use_sequencer
+            sub.prop(ed, "scale_filter", text="Strip Scaling")
+
         layout.prop(rd, "dither_intensity", text="Dither", slider=True)
 
 
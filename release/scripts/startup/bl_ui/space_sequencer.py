@@ -1815,6 +1815,7 @@ class SEQUENCER_PT_proxy_settings(SequencerButtonsPanel, Panel):
 
         if ed.proxy_storage == 'PROJECT':
             flow.prop(ed, "proxy_dir", text="Directory")
+        flow.prop(ed, "scale_filter")
 
         col = layout.column()
         col.operator("sequencer.enable_proxies")
@@ -1960,6 +1961,9 @@ class SEQUENCER_PT_view(SequencerButtonsPanel_Output, Panel):
 
         if ed:
             col.prop(ed, "use_prefetch")
+            sub = col.column()
+            sub.active = ed.use_prefetch
+            sub.prop(ed, "prefetch_threads")
 
 
 class SEQUENCER_PT_frame_overlay(SequencerButtonsPanel_Output, Panel):
@@ -251,6 +251,8 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph,
                              struct FCurve *fcu_orig);
 
 void BKE_animsys_update_driver_array(struct ID *id);
+void BKE_animsys_eval_plan_free(struct AnimData *adt);
+void BKE_animsys_nla_eval_data_free(struct AnimData *adt);
 
 /* ************************************* */
 
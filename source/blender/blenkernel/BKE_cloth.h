@@ -67,6 +67,10 @@ typedef struct ClothSolverResult {
   int max_iterations, min_iterations;
   float avg_iterations;
   float max_error, min_error, avg_error;
+
+  /* Time spent in the stages of collision handling during the frame, in seconds. */
+  float time_collision_bvh, time_collision_overlap;
+  float time_collision_narrow, time_collision_response;
 } ClothSolverResult;
 
 /**
@@ -228,6 +232,12 @@ typedef enum {
   CLOTH_BENDING_ANGULAR = 1,
 } CLOTH_BENDING_MODEL;
 
+/* ClothSimSettings.solver_type. */
+typedef enum {
+  CLOTH_SOLVER_CONJUGATE_GRADIENT = 0,
+  CLOTH_SOLVER_BLOCK_JACOBI = 1,
+} CLOTH_SOLVER_TYPE;
+
 /* COLLISION FLAGS */
 typedef enum {
   CLOTH_COLLSETTINGS_FLAG_ENABLED = (1 << 1), /* enables cloth - object collisions */
@@ -109,6 +109,9 @@ void dynamicPaint_outputSurfaceImage(struct DynamicPaintSurface *surface,
                                      char *filename,
                                      short output_layer);
 
+/* Process all points of paint surfaces instead of only the painted tiles, for testing. */
+void dynamicPaint_setUseTiles(const bool use_tiles);
+
 /* PaintPoint state */
 #define DPAINT_PAINT_NONE -1
 #define DPAINT_PAINT_DRY 0
@@ -38,6 +38,7 @@ struct Object;
 struct ParticleData;
 struct ParticleKey;
 struct ParticleSimulationData;
+struct ParticleSystem;
 struct Scene;
 struct ViewLayer;
 
@@ -132,6 +133,8 @@ void BKE_effectors_apply(struct ListBase *effectors,
                          float *force,
                          float *impulse);
 void BKE_effectors_free(struct ListBase *lb);
+bool BKE_effectors_support_threading(struct ListBase *effectors,
+                                     struct ParticleSystem *psys_updated);
 
 void pd_point_from_particle(struct ParticleSimulationData *sim,
                             struct ParticleData *pa,
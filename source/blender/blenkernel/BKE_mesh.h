@@ -257,6 +257,7 @@ void BKE_mesh_vert_coords_apply_with_mat4(struct Mesh *mesh,
                                           const float (*vert_coords)[3],
                                           const float mat[4][4]);
 void BKE_mesh_vert_coords_apply(struct Mesh *mesh, const float (*vert_coords)[3]);
+void BKE_mesh_vert_coords_apply_with_normals(struct Mesh *mesh, const float (*vert_coords)[3]);
 void BKE_mesh_vert_normals_apply(struct Mesh *mesh, const short (*vertNormals)[3]);
 
 /* *** mesh_evaluate.c *** */
@@ -294,6 +295,14 @@ void BKE_mesh_calc_normals_poly(struct MVert *mverts,
                                 int numPolys,
                                 float (*r_polyNors)[3],
                                 const bool only_face_normals);
+void BKE_mesh_calc_normals_poly_coords(const float (*vert_coords)[3],
+                                       int numVerts,
+                                       const struct MLoop *mloop,
+                                       const struct MPoly *mpolys,
+                                       int numLoops,
+                                       int numPolys,
+                                       float (*r_polynors)[3],
+                                       float (*r_vertnors)[3]);
 void BKE_mesh_calc_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals_for_display(struct Mesh *mesh);
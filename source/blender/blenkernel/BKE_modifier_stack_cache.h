@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#ifndef __BKE_MODIFIER_STACK_CACHE_H__
+#define __BKE_MODIFIER_STACK_CACHE_H__
+
+/** \file
+ * \ingroup bke
+ *
+ * Cache of intermediate modifier stack results.
+ *
+ * Results are keyed by the input mesh and the settings of every modifier evaluated so far,
+ * so changing a modifier only re-evaluates the stack from that modifier on.
+ * Only modifiers which depend on nothing but their input mesh and their own settings
+ * can be part of a cached stack, see #BKE_modifier_stack_cache_supports_modifier.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CustomData_MeshMasks;
+struct Mesh;
+struct ModifierData;
+struct ModifierStackCacheKeyData;
+struct Object;
+struct Scene;
+
+/**
+ * The hashes only select candidates, the data they were computed from is compared as well,
+ * so a hash collision can't return the result of another input.
+ */
+typedef struct ModifierStackCacheKey {
+  /** Input mesh and settings, shared by all keys of a #ModifierStackCacheKeyState. */
+  struct ModifierStackCacheKeyData *data;
+  /** Length of the settings data up to this point. */
+  size_t stack_len;
+  /** Session UUID of the original object. */
+  uint32_t object_uuid;
+  /** Hash of the input mesh data. */
+  uint32_t input_hash;
+  /** Hash of the evaluation settings and all modifiers up to this point. */
+  uint32_t stack_hash;
+  char _pad[4];
+} ModifierStackCacheKey;
+
+/**
+ * Accumulates the key while walking over the modifier stack. Keys are only valid until the state
+ * is freed, and all of them have to be created before they are used.
+ */
+typedef struct ModifierStackCacheKeyState {
+  ModifierStackCacheKey key;
+} ModifierStackCacheKeyState;
+
+typedef struct ModifierStackCacheStats {
+  /** Stack evaluations which could start from a cached result. */
+  uint64_t hits;
+  /** Stack evaluations which had to run all modifiers. */
+  uint64_t misses;
+  /** Time spent evaluating the modifiers of the found results (in seconds). */
+  double time_saved;
+  /** Time spent creating keys, storing results and copying found ones (in seconds). */
+  double time_overhead;
+  size_t mem_in_use;
+  int entries_len;
+} ModifierStackCacheStats;
+
+bool BKE_modifier_stack_cache_key_init(ModifierStackCacheKeyState *state,
+                                       const struct Scene *scene,
+                                       const struct Object *ob,
+                                       const struct Mesh *mesh_input,
+                                       const struct CustomData_MeshMasks *final_datamask,
+                                       const int required_mode,
+                                       const int apply_flag);
+void BKE_modifier_stack_cache_key_add_modifier(ModifierStackCacheKeyState *state,
+                                               const struct ModifierData *md,
+                                               const struct CustomData_MeshMasks *datamask);
+void BKE_modifier_stack_cache_key_get(const ModifierStackCacheKeyState *state,
+                                      ModifierStackCacheKey *r_key);
+void BKE_modifier_stack_cache_key_state_free(ModifierStackCacheKeyState *state);
+
+bool BKE_modifier_stack_cache_supports_modifier(struct Object *ob, struct ModifierData *md);
+
+int BKE_modifier_stack_cache_find(const ModifierStackCacheKey *keys,
+                                  const int keys_len,
+                                  const ModifierStackCacheKey *deform_key,
+                                  struct Mesh **r_mesh,
+                                  struct Mesh **r_mesh_deform,
+                                  double *r_eval_time);
+void BKE_modifier_stack_cache_store(const ModifierStackCacheKey *key,
+                                    struct Mesh *mesh,
+                                    const double eval_time);
+
+void BKE_modifier_stack_cache_enforce_limit(void);
+void BKE_modifier_stack_cache_free_all(void);
+void BKE_modifier_stack_cache_stats_get(ModifierStackCacheStats *r_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BKE_MODIFIER_STACK_CACHE_H__ */
@@ -49,6 +49,8 @@ extern "C" {
 
 /* Add the blendfile name after blendcache_ */
 #define PTCACHE_EXT ".bphys"
+/* All the frames in one file, see #PTCACHE_DISK_SINGLE_FILE. */
+#define PTCACHE_ARCHIVE_EXT ".bpcache"
 #define PTCACHE_PATH "blendcache_"
 
 /* File open options, for BKE_ptcache_file_open */
@@ -68,6 +70,8 @@ extern "C" {
 /* high bits reserved for flags that need to be stored in file */
 #define PTCACHE_TYPEFLAG_COMPRESS (1 << 16)
 #define PTCACHE_TYPEFLAG_EXTRADATA (1 << 17)
+/* Data arrays are stored byte by byte as differences to the previous point (compressed only). */
+#define PTCACHE_TYPEFLAG_SHUFFLE (1 << 18)
 
 #define PTCACHE_TYPEFLAG_TYPEMASK 0x0000FFFF
 #define PTCACHE_TYPEFLAG_FLAGMASK 0xFFFF0000
@@ -109,6 +113,12 @@ typedef struct PTCacheData {
 typedef struct PTCacheFile {
   FILE *fp;
 
+  /* Read from memory instead of the file when set, for frames of single file caches. */
+  const unsigned char *mem;
+  size_t mem_len, mem_pos;
+  /* Owned copy of the frame when the file couldn't be mapped in memory. */
+  void *mem_buffer;
+
   int frame, old_format;
   unsigned int totpoint, type;
   unsigned int data_types, flag;
@@ -367,6 +377,7 @@ void BKE_ptcache_mem_to_disk(struct PTCacheID *pid);
 
 /* Convert disk cache to memory cache and vice versa. Clears the cache that was converted. */
 void BKE_ptcache_toggle_disk_cache(struct PTCacheID *pid);
+void BKE_ptcache_toggle_disk_single_file(struct PTCacheID *pid);
 
 /* Rename all disk cache files with a new name. Doesn't touch the actual content of the files. */
 void BKE_ptcache_disk_cache_rename(struct PTCacheID *pid,
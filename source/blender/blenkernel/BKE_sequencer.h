@@ -87,9 +87,14 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
   } \
   ((void)0)
 
+/* Maximum number of prefetch workers rendering frames in parallel. */
+#define SEQ_PREFETCH_THREADS_MAX 8
+
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Each prefetch worker uses its own ID, starting with this one. */
   SEQ_TASK_PREFETCH_RENDER,
+  SEQ_TASK_MAX = SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_THREADS_MAX,
 } eSeqTaskId;
 
 typedef struct SeqRenderData {
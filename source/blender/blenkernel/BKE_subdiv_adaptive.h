@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#ifndef __BKE_SUBDIV_ADAPTIVE_H__
+#define __BKE_SUBDIV_ADAPTIVE_H__
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Mesh;
+struct Object;
+struct RenderData;
+
+/* Render camera as seen by the adaptive subdivision: what it sees and how large things are on
+ * the rendered image. */
+typedef struct SubdivAdaptiveView {
+  /* World space to camera space. */
+  float viewmat[4][4];
+  /* Normalized world space planes of the camera frustum, pointing inwards. */
+  float frustum_planes[6][4];
+  /* Pixels covered by a world space unit at unit distance from a perspective camera, or at any
+   * distance from an orthographic camera. */
+  float pixels_per_unit;
+  float clip_start;
+  bool is_ortho;
+} SubdivAdaptiveView;
+
+void BKE_subdiv_adaptive_view_init(SubdivAdaptiveView *view,
+                                   const struct Object *camera,
+                                   const struct RenderData *rd);
+
+/* Subdivision level of every face of the mesh: the lowest level at which the subdivided edges
+ * of the face are no longer than pixel_size on the rendered image, clamped to max_level. Faces
+ * outside of the camera frustum get level 0.
+ *
+ * r_face_levels is optional, it receives the level of every polygon.
+ * Returns the highest level of all faces. */
+int BKE_subdiv_adaptive_face_levels(const SubdivAdaptiveView *view,
+                                    const struct Mesh *mesh,
+                                    const float obmat[4][4],
+                                    const float pixel_size,
+                                    const int max_level,
+                                    int *r_face_levels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BKE_SUBDIV_ADAPTIVE_H__ */
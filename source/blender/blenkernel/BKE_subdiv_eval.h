@@ -31,6 +31,7 @@ extern "C" {
 #endif
 
 struct Mesh;
+struct OpenSubdiv_PatchCoord;
 struct Subdiv;
 
 /* Returns true if evaluator is ready for use. */
@@ -77,6 +78,20 @@ void BKE_subdiv_eval_limit_point_and_short_normal(struct Subdiv *subdiv,
                                                   float r_P[3],
                                                   short r_N[3]);
 
+/* Batched queries. */
+
+/* Evaluate given number of points at a limit surface, with optional derivatives.
+ *
+ * Avoids the per-point overhead of the single point queries, so is preferred when many points
+ * are known ahead of a time. Is safe to be called from multiple threads. */
+void BKE_subdiv_eval_limit_points_and_derivatives(
+    struct Subdiv *subdiv,
+    const struct OpenSubdiv_PatchCoord *patch_coords,
+    const int num_patch_coords,
+    float (*r_P)[3],
+    float (*r_dPdu)[3],
+    float (*r_dPdv)[3]);
+
 /* Evaluate face-varying layer (such as UV). */
 void BKE_subdiv_eval_face_varying(struct Subdiv *subdiv,
                                   const int face_varying_channel,
@@ -58,6 +58,7 @@
 #include "BKE_mesh_runtime.h"
 #include "BKE_mesh_tangent.h"
 #include "BKE_modifier.h"
+#include "BKE_modifier_stack_cache.h"
 #include "BKE_multires.h"
 #include "BKE_object.h"
 #include "BKE_object_deform.h"
@@ -65,6 +66,8 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#include "PIL_time.h"
+
 #include "BKE_shrinkwrap.h"
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
@@ -783,14 +786,21 @@ static void add_orco_mesh(Object *ob, BMEditMesh *em, Mesh *mesh, Mesh *mesh_orc
   }
 }
 
+static bool mesh_calc_modifier_final_needs_loop_normals(
+    const Mesh *mesh_input, const CustomData_MeshMasks *final_datamask)
+{
+  return ((mesh_input->flag & ME_AUTOSMOOTH) != 0 ||
+          (final_datamask->lmask & CD_MASK_NORMAL) != 0);
+}
+
 static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
                                              const CustomData_MeshMasks *final_datamask,
                                              const bool sculpt_dyntopo,
                                              Mesh *mesh_final)
 {
   /* Compute normals. */
-  const bool do_loop_normals = ((mesh_input->flag & ME_AUTOSMOOTH) != 0 ||
-                                (final_datamask->lmask & CD_MASK_NORMAL) != 0);
+  const bool do_loop_normals = mesh_calc_modifier_final_needs_loop_normals(mesh_input,
+                                                                           final_datamask);
   /* Some modifiers may need this info from their target (other) object,
    * simpler to generate it here as well.
    * Note that they will always be generated when no loop normals are computed,
@@ -873,6 +883,88 @@ void BKE_mesh_wrapper_deferred_finalize(Mesh *me_eval,
   BLI_assert(me_eval->runtime.wrapper_type_finalize == 0);
 }
 
+/**
+ * Compute modifier stack cache keys for the constructive modifiers at the start of the stack,
+ * up to the first modifier which can't be cached.
+ *
+ * \param r_state: The keys are valid until this is freed, only needed when there are any.
+ * \param r_deform_key: Key of the result of the leading deform modifiers, only set when there
+ * are any, since #mesh_calc_modifiers needs that result as well.
+ * \return The number of keys, zero when the stack can't be cached.
+ */
+static int mesh_calc_modifiers_cache_keys(Scene *scene,
+                                          Object *ob,
+                                          Mesh *mesh_input,
+                                          ModifierData *firstmd,
+                                          CDMaskLink *datamasks,
+                                          const CustomData_MeshMasks *final_datamask,
+                                          const int required_mode,
+                                          const int apply_flag,
+                                          ModifierStackCacheKeyState *r_state,
+                                          ModifierStackCacheKey *r_keys,
+                                          ModifierData **r_key_modifiers,
+                                          ModifierStackCacheKey *r_deform_key,
+                                          bool *r_has_deform_key)
+{
+  *r_has_deform_key = false;
+
+  /* Undeformed coordinates are carried along in a separate mesh, which isn't cached. */
+  const CustomDataMask orco_mask = CD_MASK_ORCO | CD_MASK_CLOTH_ORCO;
+  if (final_datamask->vmask & orco_mask) {
+    return 0;
+  }
+  for (CDMaskLink *md_datamask = datamasks; md_datamask; md_datamask = md_datamask->next) {
+    if (md_datamask->mask.vmask & orco_mask) {
+      return 0;
+    }
+  }
+
+  if (!BKE_modifier_stack_cache_key_init(
+          r_state, scene, ob, mesh_input, final_datamask, required_mode, apply_flag)) {
+    return 0;
+  }
+
+  int keys_len = 0;
+  bool has_leading_deform = false;
+  CDMaskLink *md_datamask = datamasks;
+  for (ModifierData *md = firstmd; md; md = md->next, md_datamask = md_datamask->next) {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+    if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
+      continue;
+    }
+    if (!BKE_modifier_stack_cache_supports_modifier(ob, md)) {
+      break;
+    }
+
+    if (mti->type == eModifierTypeType_OnlyDeform) {
+      has_leading_deform |= (keys_len == 0);
+    }
+    else {
+      if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) && keys_len != 0) {
+        break;
+      }
+      if (has_leading_deform && keys_len == 0) {
+        BKE_modifier_stack_cache_key_get(r_state, r_deform_key);
+        *r_has_deform_key = true;
+      }
+    }
+
+    BKE_modifier_stack_cache_key_add_modifier(r_state, md, &md_datamask->mask);
+
+    if (mti->type != eModifierTypeType_OnlyDeform) {
+      BKE_modifier_stack_cache_key_get(r_state, &r_keys[keys_len]);
+      r_key_modifiers[keys_len] = md;
+      keys_len++;
+    }
+  }
+
+  if (keys_len == 0) {
+    BKE_modifier_stack_cache_key_state_free(r_state);
+  }
+  return keys_len;
+}
+
 static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
                                 Scene *scene,
                                 Object *ob,
@@ -959,8 +1051,73 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* Clear errors before evaluation. */
   BKE_modifiers_clear_errors(ob);
 
+  /* Continue from the result of previous evaluations when possible. Only done for full
+   * evaluations of the stack, without mapping or sculpt mode specific handling. */
+  ModifierStackCacheKeyState cache_key_state;
+  ModifierStackCacheKey *cache_keys = NULL;
+  ModifierData **cache_key_modifiers = NULL;
+  ModifierStackCacheKey cache_deform_key;
+  bool cache_has_deform_key = false;
+  int cache_keys_len = 0;
+  int cache_key_next = 0;
+  bool cache_hit = false;
+  bool cache_store_deform = false;
+  /* Time spent evaluating the stack, stored with results to measure what the cache saves. */
+  double cache_eval_time = 0.0;
+  if (useDeform == 1 && index == -1 && !need_mapping && !sculpt_mode && previewmd == NULL) {
+    int modifiers_len = 0;
+    for (ModifierData *md_iter = firstmd; md_iter; md_iter = md_iter->next) {
+      modifiers_len++;
+    }
+    cache_keys = MEM_malloc_arrayN(modifiers_len, sizeof(*cache_keys), __func__);
+    cache_key_modifiers = MEM_malloc_arrayN(modifiers_len, sizeof(*cache_key_modifiers), __func__);
+    cache_keys_len = mesh_calc_modifiers_cache_keys(scene,
+                                                    ob,
+                                                    mesh_input,
+                                                    firstmd,
+                                                    datamasks,
+                                                    &final_datamask,
+                                                    required_mode,
+                                                    mectx.flag,
+                                                    &cache_key_state,
+                                                    cache_keys,
+                                                    cache_key_modifiers,
+                                                    &cache_deform_key,
+                                                    &cache_has_deform_key);
+  }
+  if (cache_keys_len != 0) {
+    Mesh *mesh_deform_cached = NULL;
+    const int cache_index = BKE_modifier_stack_cache_find(
+        cache_keys,
+        cache_keys_len,
+        (r_deform && cache_has_deform_key) ? &cache_deform_key : NULL,
+        &mesh_final,
+        &mesh_deform_cached,
+        &cache_eval_time);
+
+    if (cache_index != -1) {
+      cache_hit = true;
+      cache_key_next = cache_index + 1;
+      mesh_final->runtime.deformed_only = false;
+
+      if (r_deform) {
+        mesh_deform = mesh_deform_cached ? mesh_deform_cached :
+                                           BKE_mesh_copy_for_eval(mesh_input, true);
+      }
+
+      /* Skip the modifiers evaluated for the cached result. */
+      while (md != cache_key_modifiers[cache_index]) {
+        md = md->next;
+        md_datamask = md_datamask->next;
+      }
+      md = md->next;
+      md_datamask = md_datamask->next;
+    }
+  }
+  const double cache_time_start = PIL_check_seconds_timer();
+
   /* Apply all leading deform modifiers. */
-  if (useDeform) {
+  if (useDeform && !cache_hit) {
     for (; md; md = md->next, md_datamask = md_datamask->next) {
       const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
 
@@ -1008,11 +1165,14 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       if (deformed_verts) {
         BKE_mesh_vert_coords_apply(mesh_deform, deformed_verts);
       }
+
+      /* Stored together with the first constructive result, which can't be used without it. */
+      cache_store_deform = cache_has_deform_key;
     }
   }
 
   /* Apply all remaining constructive and deforming modifiers. */
-  bool have_non_onlydeform_modifiers_appled = false;
+  bool have_non_onlydeform_modifiers_appled = cache_hit;
   for (; md; md = md->next, md_datamask = md_datamask->next) {
     const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
 
@@ -1271,6 +1431,23 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       }
 
       mesh_final->runtime.deformed_only = false;
+
+      if (cache_key_next < cache_keys_len && md == cache_key_modifiers[cache_key_next]) {
+        if (md->error == NULL) {
+          const double eval_time = cache_eval_time + PIL_check_seconds_timer() -
+                                   cache_time_start;
+          if (cache_store_deform) {
+            BKE_modifier_stack_cache_store(&cache_deform_key, mesh_deform, eval_time);
+            cache_store_deform = false;
+          }
+          BKE_modifier_stack_cache_store(&cache_keys[cache_key_next], mesh_final, eval_time);
+          cache_key_next++;
+        }
+        else {
+          /* Errors would be lost when continuing from cached results. */
+          cache_key_next = cache_keys_len;
+        }
+      }
     }
 
     isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
@@ -1286,6 +1463,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   }
 
   BLI_linklist_free((LinkNode *)datamasks, NULL);
+  if (cache_keys_len != 0) {
+    BKE_modifier_stack_cache_key_state_free(&cache_key_state);
+  }
+  MEM_SAFE_FREE(cache_keys);
+  MEM_SAFE_FREE(cache_key_modifiers);
 
   for (md = firstmd; md; md = md->next) {
     BKE_modifier_free_temporary_data(md);
@@ -1308,7 +1490,15 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
     }
   }
   if (deformed_verts) {
-    BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
+    /* When only vertex and poly normals are needed for display, calculate them from the
+     * deformed coordinates while applying them, see #mesh_calc_modifier_final_normals. */
+    if (!sculpt_dyntopo &&
+        !mesh_calc_modifier_final_needs_loop_normals(mesh_input, &final_datamask)) {
+      BKE_mesh_vert_coords_apply_with_normals(mesh_final, deformed_verts);
+    }
+    else {
+      BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
+    }
     MEM_freeN(deformed_verts);
     deformed_verts = NULL;
   }
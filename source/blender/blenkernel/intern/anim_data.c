@@ -261,6 +261,10 @@ void BKE_animdata_free(ID *id, const bool do_id_user)
       /* free driver array cache */
       MEM_SAFE_FREE(adt->driver_array);
 
+      /* free action evaluation cache */
+      BKE_animsys_eval_plan_free(adt);
+      BKE_animsys_nla_eval_data_free(adt);
+
       /* free overrides */
       /* TODO... */
 
@@ -347,6 +351,8 @@ AnimData *BKE_animdata_copy(Main *bmain, AnimData *adt, const int flag)
   /* duplicate drivers (F-Curves) */
   copy_fcurves(&dadt->drivers, &adt->drivers);
   dadt->driver_array = NULL;
+  dadt->action_eval_plan = NULL;
+  dadt->nla_eval_data = NULL;
 
   /* don't copy overrides */
   BLI_listbase_clear(&dadt->overrides);
@@ -35,6 +35,7 @@
 #include "BLI_listbase.h"
 #include "BLI_math_rotation.h"
 #include "BLI_math_vector.h"
+#include "BLI_memarena.h"
 #include "BLI_string_utils.h"
 #include "BLI_utildefines.h"
 
@@ -702,6 +703,188 @@ void animsys_evaluate_action(PointerRNA *ptr,
   animsys_evaluate_action_ex(ptr, act, ctime, flush_to_original);
 }
 
+/* ***************************************** */
+/* Action Evaluation Plan */
+
+/* The active action of evaluated IDs is prepared for evaluation once, instead of resolving the
+ * RNA paths and searching the keyframes of every F-Curve every frame. The plan is stored in the
+ * evaluated AnimData, so it is freed when the ID is copied again, and it is checked against the
+ * curves of the action every evaluation, since the action is updated separately. */
+
+typedef enum eAnimEvalPathState {
+  /* Not resolved yet. */
+  ANIM_EVAL_PATH_NONE = 0,
+  /* Resolved to a property of the animated ID, valid until the ID is copied again. */
+  ANIM_EVAL_PATH_CACHED,
+  /* Resolved every evaluation: the path leads to another ID or to an ID-property,
+   * which can be freed at any time, or it doesn't resolve. */
+  ANIM_EVAL_PATH_DYNAMIC,
+} eAnimEvalPathState;
+
+typedef struct AnimEvalPath {
+  PathResolvedRNA anim_rna;
+  char state;
+} AnimEvalPath;
+
+typedef struct AnimEvalChannel {
+  /* Checked against the action, the path is a copy since the curve can be reallocated at the same
+   * address with another path. */
+  FCurve *fcu;
+  const char *rna_path;
+  int array_index;
+
+  AnimEvalPath path;
+  /* Path on the original ID, when flushing values to original. */
+  AnimEvalPath path_orig;
+} AnimEvalChannel;
+
+typedef struct AnimEvalPlan {
+  AnimEvalChannel *channels;
+  int channels_num;
+  char *rna_paths;
+
+  /* Arguments of evaluate_fcurves(), curves that are skipped are NULL. */
+  FCurve **fcurves;
+  int *segment_cache;
+  float *values;
+} AnimEvalPlan;
+
+static AnimEvalPlan *animsys_eval_plan_create(ListBase *curves)
+{
+  int channels_num = 0;
+  size_t rna_paths_len = 0;
+  LISTBASE_FOREACH (FCurve *, fcu, curves) {
+    channels_num++;
+    rna_paths_len += (fcu->rna_path ? strlen(fcu->rna_path) : 0) + 1;
+  }
+
+  AnimEvalPlan *plan = MEM_callocN(sizeof(*plan), __func__);
+  plan->channels = MEM_calloc_arrayN(channels_num, sizeof(*plan->channels), __func__);
+  plan->channels_num = channels_num;
+  plan->rna_paths = MEM_mallocN(rna_paths_len, __func__);
+  plan->fcurves = MEM_calloc_arrayN(channels_num, sizeof(*plan->fcurves), __func__);
+  plan->segment_cache = MEM_calloc_arrayN(channels_num, sizeof(*plan->segment_cache), __func__);
+  plan->values = MEM_calloc_arrayN(channels_num, sizeof(*plan->values), __func__);
+
+  AnimEvalChannel *chan = plan->channels;
+  char *rna_path = plan->rna_paths;
+  LISTBASE_FOREACH (FCurve *, fcu, curves) {
+    const size_t rna_path_len = (fcu->rna_path ? strlen(fcu->rna_path) : 0) + 1;
+    memcpy(rna_path, fcu->rna_path ? fcu->rna_path : "", rna_path_len);
+    chan->fcu = fcu;
+    chan->rna_path = rna_path;
+    chan->array_index = fcu->array_index;
+    rna_path += rna_path_len;
+    chan++;
+  }
+
+  return plan;
+}
+
+static void animsys_eval_plan_free_ex(AnimEvalPlan *plan)
+{
+  MEM_freeN(plan->channels);
+  MEM_freeN(plan->rna_paths);
+  MEM_freeN(plan->fcurves);
+  MEM_freeN(plan->segment_cache);
+  MEM_freeN(plan->values);
+  MEM_freeN(plan);
+}
+
+void BKE_animsys_eval_plan_free(AnimData *adt)
+{
+  if (adt->action_eval_plan != NULL) {
+    animsys_eval_plan_free_ex(adt->action_eval_plan);
+    adt->action_eval_plan = NULL;
+  }
+}
+
+/* Check the plan was created from these curves, which can change when the action is edited. */
+static bool animsys_eval_plan_matches(const AnimEvalPlan *plan, ListBase *curves)
+{
+  const AnimEvalChannel *chan = plan->channels;
+  const AnimEvalChannel *chan_end = chan + plan->channels_num;
+  LISTBASE_FOREACH (FCurve *, fcu, curves) {
+    if ((chan == chan_end) || (chan->fcu != fcu) || (chan->array_index != fcu->array_index) ||
+        !STREQ(chan->rna_path, fcu->rna_path ? fcu->rna_path : "")) {
+      return false;
+    }
+    chan++;
+  }
+  return (chan == chan_end);
+}
+
+static bool animsys_eval_path_resolve(PointerRNA *ptr, const FCurve *fcu, AnimEvalPath *path)
+{
+  if (path->state == ANIM_EVAL_PATH_CACHED) {
+    return true;
+  }
+  if (!BKE_animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, &path->anim_rna)) {
+    path->state = ANIM_EVAL_PATH_DYNAMIC;
+    return false;
+  }
+  if (path->state == ANIM_EVAL_PATH_NONE) {
+    const bool is_cached = (path->anim_rna.ptr.owner_id == ptr->owner_id) &&
+                           !RNA_property_is_idprop(path->anim_rna.prop);
+    path->state = is_cached ? ANIM_EVAL_PATH_CACHED : ANIM_EVAL_PATH_DYNAMIC;
+  }
+  return true;
+}
+
+/* Evaluate the active action of a copied-on-write ID, the same as animsys_evaluate_action(). */
+static void animsys_evaluate_action_plan(PointerRNA *ptr,
+                                         AnimData *adt,
+                                         float ctime,
+                                         const bool flush_to_original)
+{
+  bAction *act = adt->action;
+  BLI_assert(ptr->owner_id->tag & LIB_TAG_COPIED_ON_WRITE);
+
+  action_idcode_patch_check(ptr->owner_id, act);
+
+  if (adt->action_eval_plan && !animsys_eval_plan_matches(adt->action_eval_plan, &act->curves)) {
+    BKE_animsys_eval_plan_free(adt);
+  }
+  if (adt->action_eval_plan == NULL) {
+    adt->action_eval_plan = animsys_eval_plan_create(&act->curves);
+  }
+  AnimEvalPlan *plan = adt->action_eval_plan;
+
+  /* Same checks as animsys_evaluate_fcurves(). */
+  for (int i = 0; i < plan->channels_num; i++) {
+    AnimEvalChannel *chan = &plan->channels[i];
+    FCurve *fcu = chan->fcu;
+    plan->fcurves[i] = NULL;
+    if ((fcu->grp != NULL) && (fcu->grp->flag & AGRP_MUTED)) {
+      continue;
+    }
+    if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED))) {
+      continue;
+    }
+    if (BKE_fcurve_is_empty(fcu)) {
+      continue;
+    }
+    if (animsys_eval_path_resolve(ptr, fcu, &chan->path)) {
+      plan->fcurves[i] = fcu;
+    }
+  }
+
+  evaluate_fcurves(plan->fcurves, plan->segment_cache, plan->values, plan->channels_num, ctime);
+
+  PointerRNA ptr_orig;
+  const bool use_orig = flush_to_original && animsys_construct_orig_pointer_rna(ptr, &ptr_orig);
+  for (int i = 0; i < plan->channels_num; i++) {
+    AnimEvalChannel *chan = &plan->channels[i];
+    if (plan->fcurves[i] == NULL) {
+      continue;
+    }
+    BKE_animsys_write_rna_setting(&chan->path.anim_rna, plan->values[i]);
+    if (use_orig && animsys_eval_path_resolve(&ptr_orig, chan->fcu, &chan->path_orig)) {
+      BKE_animsys_write_rna_setting(&chan->path_orig.anim_rna, plan->values[i]);
+    }
+  }
+}
+
 /* ***************************************** */
 /* NLA System - Evaluation */
 
@@ -937,13 +1120,22 @@ static bool nlaevalchan_keycmp(const void *a, const void *b)
 
 /* ---------------------- */
 
-/* Allocate a new blending value snapshot for the channel. */
+/* Get a blending value snapshot for the channel, reusing a released one if possible.
+ * The values are not initialized. */
 static NlaEvalChannelSnapshot *nlaevalchan_snapshot_new(NlaEvalChannel *nec)
 {
+  NlaEvalChannelSnapshot *nec_snapshot = nec->free_snapshots;
+
+  if (nec_snapshot != NULL) {
+    nec->free_snapshots = nec_snapshot->next_free;
+    nec_snapshot->next_free = NULL;
+    return nec_snapshot;
+  }
+
   int length = nec->base_snapshot.length;
 
   size_t byte_size = sizeof(NlaEvalChannelSnapshot) + sizeof(float) * length;
-  NlaEvalChannelSnapshot *nec_snapshot = MEM_callocN(byte_size, "NlaEvalChannelSnapshot");
+  nec_snapshot = MEM_callocN(byte_size, "NlaEvalChannelSnapshot");
 
   nec_snapshot->channel = nec;
   nec_snapshot->length = length;
@@ -951,12 +1143,14 @@ static NlaEvalChannelSnapshot *nlaevalchan_snapshot_new(NlaEvalChannel *nec)
   return nec_snapshot;
 }
 
-/* Free a channel's blending value snapshot. */
+/* Release a channel's blending value snapshot, it's freed with the channel. */
 static void nlaevalchan_snapshot_free(NlaEvalChannelSnapshot *nec_snapshot)
 {
   BLI_assert(!nec_snapshot->is_base);
 
-  MEM_freeN(nec_snapshot);
+  NlaEvalChannel *nec = nec_snapshot->channel;
+  nec_snapshot->next_free = nec->free_snapshots;
+  nec->free_snapshots = nec_snapshot;
 }
 
 /* Copy all data in the snapshot. */
@@ -1072,10 +1266,25 @@ static void nlaevalchan_free_data(NlaEvalChannel *nec)
   nlavalidmask_free(&nec->valid);
 
   if (nec->blend_snapshot != NULL) {
-    nlaevalchan_snapshot_free(nec->blend_snapshot);
+    MEM_freeN(nec->blend_snapshot);
+  }
+
+  while (nec->free_snapshots != NULL) {
+    NlaEvalChannelSnapshot *nec_snapshot = nec->free_snapshots;
+    nec->free_snapshots = nec_snapshot->next_free;
+    MEM_freeN(nec_snapshot);
   }
 }
 
+static void nlaeval_action_free(void *nea_v)
+{
+  NlaEvalAction *nea = nea_v;
+
+  animsys_eval_plan_free_ex(nea->plan);
+  MEM_freeN(nea->channels);
+  MEM_freeN(nea);
+}
+
 /* Initialize a full NLA evaluation state structure. */
 static void nlaeval_init(NlaEvalData *nlaeval)
 {
@@ -1084,6 +1293,8 @@ static void nlaeval_init(NlaEvalData *nlaeval)
   nlaeval->path_hash = BLI_ghash_str_new("NlaEvalData::path_hash");
   nlaeval->key_hash = BLI_ghash_new(
       nlaevalchan_keyhash, nlaevalchan_keycmp, "NlaEvalData::key_hash");
+  nlaeval->path_arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "NlaEvalData::path_arena");
+  nlaeval->action_hash = BLI_ghash_ptr_new("NlaEvalData::action_hash");
 }
 
 static void nlaeval_free(NlaEvalData *nlaeval)
@@ -1102,6 +1313,31 @@ static void nlaeval_free(NlaEvalData *nlaeval)
   BLI_freelistN(&nlaeval->channels);
   BLI_ghash_free(nlaeval->path_hash, NULL, NULL);
   BLI_ghash_free(nlaeval->key_hash, NULL, NULL);
+  BLI_ghash_free(nlaeval->action_hash, NULL, nlaeval_action_free);
+  BLI_memarena_free(nlaeval->path_arena);
+}
+
+/* Prepare the data of a previous evaluation to evaluate the same ID again: the channels and the
+ * prepared actions are kept, only the result snapshot and the masks are cleared. */
+static void nlaeval_reset(NlaEvalData *nlaeval)
+{
+  NlaEvalSnapshot *snapshot = &nlaeval->eval_snapshot;
+
+  for (int i = 0; i < snapshot->size; i++) {
+    if (snapshot->channels[i] != NULL) {
+      nlaevalchan_snapshot_free(snapshot->channels[i]);
+      snapshot->channels[i] = NULL;
+    }
+  }
+
+  LISTBASE_FOREACH (NlaEvalChannel *, nec, &nlaeval->channels) {
+    BLI_bitmap_set_all(nec->valid.ptr, false, nec->base_snapshot.length);
+  }
+
+  GHASH_FOREACH_BEGIN (NlaEvalAction *, nea, nlaeval->action_hash) {
+    nea->is_checked = false;
+  }
+  GHASH_FOREACH_END();
 }
 
 /* ---------------------- */
@@ -1279,17 +1515,14 @@ static NlaEvalChannel *nlaevalchan_verify(PointerRNA *ptr, NlaEvalData *nlaeval,
   }
 
   /* Lookup the path in the path based hash. */
-  NlaEvalChannel **p_path_nec;
-  bool found_path = BLI_ghash_ensure_p(nlaeval->path_hash, (void *)path, (void ***)&p_path_nec);
+  NlaEvalChannel **p_path_nec = (NlaEvalChannel **)BLI_ghash_lookup_p(nlaeval->path_hash, path);
 
-  if (found_path) {
+  if (p_path_nec != NULL) {
     return *p_path_nec;
   }
 
-  /* Cache NULL result for now. */
-  *p_path_nec = NULL;
-
-  /* Resolve the property and look it up in the key hash. */
+  /* Resolve the property and look it up in the key hash.
+   * Failures aren't cached, the path may resolve in the next evaluation. */
   NlaEvalChannelKey key;
 
   if (!RNA_path_resolve_property(ptr, path, &key.ptr, &key.prop)) {
@@ -1309,13 +1542,94 @@ static NlaEvalChannel *nlaevalchan_verify(PointerRNA *ptr, NlaEvalData *nlaeval,
     return NULL;
   }
 
+  /* Other IDs and ID-properties can be freed without the animated ID being copied again. */
+  if ((key.ptr.owner_id != ptr->owner_id) || RNA_property_is_idprop(key.prop)) {
+    nlaeval->is_volatile = true;
+  }
+
+  /* The path is owned by the F-Curve, which can be freed before the channels. */
+  const size_t path_len = strlen(path) + 1;
+  char *path_copy = BLI_memarena_alloc(nlaeval->path_arena, path_len);
+  memcpy(path_copy, path, path_len);
+  path = path_copy;
+
   NlaEvalChannel *nec = nlaevalchan_verify_key(nlaeval, path, &key);
 
   if (nec->rna_path == NULL) {
     nec->rna_path = path;
   }
 
-  return *p_path_nec = nec;
+  BLI_ghash_insert(nlaeval->path_hash, (void *)path, nec);
+
+  return nec;
+}
+
+/* Get the action prepared for evaluation, with the channels of its F-Curves. */
+static NlaEvalAction *nlaeval_action_ensure(PointerRNA *ptr, NlaEvalData *nlaeval, bAction *act)
+{
+  NlaEvalAction **p_nea;
+
+  if (BLI_ghash_ensure_p(nlaeval->action_hash, act, (void ***)&p_nea)) {
+    NlaEvalAction *nea = *p_nea;
+
+    if (nea->is_checked) {
+      return nea;
+    }
+    if (animsys_eval_plan_matches(nea->plan, &act->curves)) {
+      nea->is_checked = true;
+
+      /* Paths that didn't resolve are tried again, like when evaluating from scratch. */
+      for (int i = 0; i < nea->plan->channels_num; i++) {
+        if (nea->channels[i] == NULL) {
+          const char *rna_path = nea->plan->channels[i].fcu->rna_path;
+          nea->channels[i] = nlaevalchan_verify(ptr, nlaeval, rna_path);
+        }
+      }
+      return nea;
+    }
+
+    /* The action was edited, channels of the old curves stay unused until the data is freed. */
+    nlaeval_action_free(nea);
+  }
+
+  NlaEvalAction *nea = MEM_callocN(sizeof(*nea), __func__);
+  nea->plan = animsys_eval_plan_create(&act->curves);
+  nea->is_checked = true;
+  nea->channels = MEM_calloc_arrayN(
+      nea->plan->channels_num, sizeof(*nea->channels), "NlaEvalAction::channels");
+
+  for (int i = 0; i < nea->plan->channels_num; i++) {
+    nea->channels[i] = nlaevalchan_verify(ptr, nlaeval, nea->plan->channels[i].fcu->rna_path);
+  }
+
+  return *p_nea = nea;
+}
+
+/* Fill the F-Curves of the plan to evaluate, skipping the ones that don't affect any channel. */
+static void nlaeval_action_filter_fcurves(NlaEvalAction *nea)
+{
+  AnimEvalPlan *plan = nea->plan;
+
+  for (int i = 0; i < plan->channels_num; i++) {
+    FCurve *fcu = plan->channels[i].fcu;
+    plan->fcurves[i] = NULL;
+
+    /* check if this curve should be skipped */
+    if (nea->channels[i] == NULL) {
+      continue;
+    }
+    if (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) {
+      continue;
+    }
+    if ((fcu->grp) && (fcu->grp->flag & AGRP_MUTED)) {
+      continue;
+    }
+    if (BKE_fcurve_is_empty(fcu)) {
+      continue;
+    }
+
+    plan->fcurves[i] = fcu;
+  }
 }
 
 /* ---------------------- */
@@ -1722,7 +2036,6 @@ static void nlastrip_evaluate_actionclip(PointerRNA *ptr,
 {
   ListBase tmp_modifiers = {NULL, NULL};
   NlaStrip *strip = nes->strip;
-  FCurve *fcu;
   float evaltime;
 
   /* sanity checks for action */
@@ -1754,40 +2067,35 @@ static void nlastrip_evaluate_actionclip(PointerRNA *ptr,
       .influence = strip->influence,
   };
 
-  /* Evaluate all the F-Curves in the action,
-   * saving the relevant pointers to data that will need to be used. */
-  for (fcu = strip->act->curves.first; fcu; fcu = fcu->next) {
-    float value = 0.0f;
+  /* Get the NLA evaluation channels the F-Curves of the action affect,
+   * prepared the first time the action is evaluated. */
+  NlaEvalAction *nea = nlaeval_action_ensure(ptr, channels, strip->act);
+  AnimEvalPlan *plan = nea->plan;
 
-    /* check if this curve should be skipped */
-    if (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) {
-      continue;
-    }
-    if ((fcu->grp) && (fcu->grp->flag & AGRP_MUTED)) {
-      continue;
-    }
-    if (BKE_fcurve_is_empty(fcu)) {
+  /* evaluate the F-Curves' values for the time given in the strip
+   * NOTE: we use the modified time here, since strip's F-Curve Modifiers
+   * are applied on top of this.
+   */
+  nlaeval_action_filter_fcurves(nea);
+  evaluate_fcurves(plan->fcurves, plan->segment_cache, plan->values, plan->channels_num, evaltime);
+
+  for (int i = 0; i < plan->channels_num; i++) {
+    FCurve *fcu = plan->fcurves[i];
+    float value = plan->values[i];
+
+    if (fcu == NULL) {
       continue;
     }
 
-    /* evaluate the F-Curve's value for the time given in the strip
-     * NOTE: we use the modified time here, since strip's F-Curve Modifiers
-     * are applied on top of this.
-     */
-    value = evaluate_fcurve(fcu, evaltime);
-
     /* apply strip's F-Curve Modifiers on this value
      * NOTE: we apply the strip's original evaluation time not the modified one
      * (as per standard F-Curve eval)
      */
     evaluate_value_fmodifiers(&storage, &tmp_modifiers, fcu, &value, strip->strip_time);
 
-    /* Get an NLA evaluation channel to work with,
-     * and accumulate the evaluated value with the value(s)
+    /* accumulate the evaluated value with the value(s)
      * stored in this channel if it has been used already. */
-    NlaEvalChannel *nec = nlaevalchan_verify(ptr, channels, fcu->rna_path);
-
-    nlaeval_blend_value(&blend, nec, fcu->array_index, value);
+    nlaeval_blend_value(&blend, nea->channels[i], fcu->array_index, value);
   }
 
   nlaeval_blend_flush(&blend);
@@ -1985,32 +2293,29 @@ static void nla_eval_domain_action(PointerRNA *ptr,
     return;
   }
 
-  LISTBASE_FOREACH (FCurve *, fcu, &act->curves) {
-    /* check if this curve should be skipped */
-    if (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) {
-      continue;
-    }
-    if ((fcu->grp) && (fcu->grp->flag & AGRP_MUTED)) {
+  NlaEvalAction *nea = nlaeval_action_ensure(ptr, channels, act);
+  AnimEvalPlan *plan = nea->plan;
+
+  nlaeval_action_filter_fcurves(nea);
+
+  for (int i = 0; i < plan->channels_num; i++) {
+    FCurve *fcu = plan->fcurves[i];
+    NlaEvalChannel *nec = nea->channels[i];
+
+    if (fcu == NULL) {
       continue;
     }
-    if (BKE_fcurve_is_empty(fcu)) {
+
+    /* For quaternion properties, enable all sub-channels. */
+    if (nec->mix_mode == NEC_MIX_QUATERNION) {
+      BLI_bitmap_set_all(nec->valid.ptr, true, 4);
       continue;
     }
 
-    NlaEvalChannel *nec = nlaevalchan_verify(ptr, channels, fcu->rna_path);
-
-    if (nec != NULL) {
-      /* For quaternion properties, enable all sub-channels. */
-      if (nec->mix_mode == NEC_MIX_QUATERNION) {
-        BLI_bitmap_set_all(nec->valid.ptr, true, 4);
-        continue;
-      }
+    int idx = nlaevalchan_validate_index(nec, fcu->array_index);
 
-      int idx = nlaevalchan_validate_index(nec, fcu->array_index);
-
-      if (idx >= 0) {
-        BLI_BITMAP_ENABLE(nec->valid.ptr, idx);
-      }
+    if (idx >= 0) {
+      BLI_BITMAP_ENABLE(nec->valid.ptr, idx);
     }
   }
 }
@@ -2245,17 +2550,31 @@ static void animsys_calculate_nla(PointerRNA *ptr,
                                   float ctime,
                                   const bool flush_to_original)
 {
-  NlaEvalData echannels;
+  NlaEvalData echannels_buf;
+  NlaEvalData *echannels = &echannels_buf;
+  const bool is_evaluated_copy = (ptr->owner_id->tag & LIB_TAG_COPIED_ON_WRITE) != 0;
 
-  nlaeval_init(&echannels);
+  /* Evaluated IDs keep the channels, snapshots and prepared actions for the next frame,
+   * they're freed when the ID is copied again. */
+  if (is_evaluated_copy && adt->nla_eval_data != NULL) {
+    echannels = adt->nla_eval_data;
+    nlaeval_reset(echannels);
+  }
+  else if (is_evaluated_copy) {
+    echannels = adt->nla_eval_data = MEM_mallocN(sizeof(*echannels), "NlaEvalData");
+    nlaeval_init(echannels);
+  }
+  else {
+    nlaeval_init(echannels);
+  }
 
   /* evaluate the NLA stack, obtaining a set of values to flush */
-  if (animsys_evaluate_nla(&echannels, ptr, adt, ctime, flush_to_original, NULL)) {
+  if (animsys_evaluate_nla(echannels, ptr, adt, ctime, flush_to_original, NULL)) {
     /* reset any channels touched by currently inactive actions to default value */
-    animsys_evaluate_nla_domain(ptr, &echannels, adt);
+    animsys_evaluate_nla_domain(ptr, echannels, adt);
 
     /* flush effects of accumulating channels in NLA to the actual data they affect */
-    nladata_flush_channels(ptr, &echannels, &echannels.eval_snapshot, flush_to_original);
+    nladata_flush_channels(ptr, echannels, &echannels->eval_snapshot, flush_to_original);
   }
   else {
     /* special case - evaluate as if there isn't any NLA data */
@@ -2267,8 +2586,22 @@ static void animsys_calculate_nla(PointerRNA *ptr,
     animsys_evaluate_action(ptr, adt->action, ctime, flush_to_original);
   }
 
-  /* free temp data */
-  nlaeval_free(&echannels);
+  /* free temp data, unless it can be used for the next frame */
+  if (!is_evaluated_copy) {
+    nlaeval_free(echannels);
+  }
+  else if (echannels->is_volatile) {
+    BKE_animsys_nla_eval_data_free(adt);
+  }
+}
+
+void BKE_animsys_nla_eval_data_free(AnimData *adt)
+{
+  if (adt->nla_eval_data != NULL) {
+    nlaeval_free(adt->nla_eval_data);
+    MEM_freeN(adt->nla_eval_data);
+    adt->nla_eval_data = NULL;
+  }
 }
 
 /* ---------------------- */
@@ -2527,7 +2860,12 @@ void BKE_animsys_evaluate_animdata(
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action_ex(&id_ptr, adt->action, ctime, flush_to_original);
+      if ((id->tag & LIB_TAG_COPIED_ON_WRITE) && adt->action->curves.first) {
+        animsys_evaluate_action_plan(&id_ptr, adt, ctime, flush_to_original);
+      }
+      else {
+        animsys_evaluate_action_ex(&id_ptr, adt->action, ctime, flush_to_original);
+      }
     }
   }
 
@@ -1331,46 +1331,46 @@ void BKE_pchan_bbone_deform_segment_index(const bPoseChannel *pchan,
   *r_blend_next = blend;
 }
 
-/* Add the effect of one bone or B-Bone segment to the accumulated result. */
+/**
+ * Add the effect of one bone or B-Bone segment to the accumulated result.
+ *
+ * Linear blending accumulates the weighted deform matrices, which are applied to the
+ * coordinate once all influences of a vertex are added. This is equivalent to summing the
+ * weighted offsets of each bone, but only costs a multiply-add of the matrix per influence.
+ */
 static void pchan_deform_accumulate(const DualQuat *deform_dq,
                                     const float deform_mat[4][4],
-                                    const float co_in[3],
                                     float weight,
-                                    float co_accum[3],
                                     DualQuat *dq_accum,
-                                    float mat_accum[3][3])
+                                    float mat_accum[4][4])
 {
   if (weight == 0.0f) {
     return;
   }
 
   if (dq_accum) {
-    BLI_assert(!co_accum);
+    BLI_assert(!mat_accum);
 
     add_weighted_dq_dq(dq_accum, deform_dq, weight);
   }
   else {
-    float tmp[3];
-    mul_v3_m4v3(tmp, deform_mat, co_in);
-
-    sub_v3_v3(tmp, co_in);
-    madd_v3_v3fl(co_accum, tmp, weight);
-
-    if (mat_accum) {
-      float tmpmat[3][3];
-      copy_m3_m4(tmpmat, deform_mat);
-
-      madd_m3_m3m3fl(mat_accum, mat_accum, tmpmat, weight);
+#ifdef __SSE2__
+    const __m128 w = _mm_set1_ps(weight);
+    for (int i = 0; i < 4; i++) {
+      const __m128 m = _mm_mul_ps(_mm_loadu_ps(deform_mat[i]), w);
+      _mm_storeu_ps(mat_accum[i], _mm_add_ps(_mm_loadu_ps(mat_accum[i]), m));
     }
+#else
+    madd_m4_m4m4fl(mat_accum, mat_accum, deform_mat, weight);
+#endif
   }
 }
 
 static void b_bone_deform(const bPoseChannel *pchan,
                           const float co[3],
                           float weight,
-                          float vec[3],
                           DualQuat *dq,
-                          float defmat[3][3])
+                          float defmat[4][4])
 {
   const DualQuat *quats = pchan->runtime.bbone_dual_quats;
   const Mat4 *mats = pchan->runtime.bbone_deform_mats;
@@ -1384,10 +1384,8 @@ static void b_bone_deform(const bPoseChannel *pchan,
   /* Calculate the indices of the 2 affecting b_bone segments. */
   BKE_pchan_bbone_deform_segment_index(pchan, y / pchan->bone->length, &index, &blend);
 
-  pchan_deform_accumulate(
-      &quats[index], mats[index + 1].mat, co, weight * (1.0f - blend), vec, dq, defmat);
-  pchan_deform_accumulate(
-      &quats[index + 1], mats[index + 2].mat, co, weight * blend, vec, dq, defmat);
+  pchan_deform_accumulate(&quats[index], mats[index + 1].mat, weight * (1.0f - blend), dq, defmat);
+  pchan_deform_accumulate(&quats[index + 1], mats[index + 2].mat, weight * blend, dq, defmat);
 }
 
 /* using vec with dist to bone b1 - b2 */
@@ -1446,8 +1444,10 @@ float distfactor_to_bone(
   }
 }
 
-static float dist_bone_deform(
-    bPoseChannel *pchan, float vec[3], DualQuat *dq, float mat[3][3], const float co[3])
+static float dist_bone_deform(bPoseChannel *pchan,
+                              DualQuat *dq,
+                              float mat[4][4],
+                              const float co[3])
 {
   Bone *bone = pchan->bone;
   float fac, contrib = 0.0;
@@ -1464,11 +1464,10 @@ static float dist_bone_deform(
     contrib = fac;
     if (contrib > 0.0f) {
       if (bone->segments > 1 && pchan->runtime.bbone_segments == bone->segments) {
-        b_bone_deform(pchan, co, fac, vec, dq, mat);
+        b_bone_deform(pchan, co, fac, dq, mat);
       }
       else {
-        pchan_deform_accumulate(
-            &pchan->runtime.deform_dual_quat, pchan->chan_mat, co, fac, vec, dq, mat);
+        pchan_deform_accumulate(&pchan->runtime.deform_dual_quat, pchan->chan_mat, fac, dq, mat);
       }
     }
   }
@@ -1476,30 +1475,17 @@ static float dist_bone_deform(
   return contrib;
 }
 
-static void pchan_bone_deform(bPoseChannel *pchan,
-                              float weight,
-                              float vec[3],
-                              DualQuat *dq,
-                              float mat[3][3],
-                              const float co[3],
-                              float *contrib)
-{
-  Bone *bone = pchan->bone;
-
-  if (!weight) {
-    return;
-  }
-
-  if (bone->segments > 1 && pchan->runtime.bbone_segments == bone->segments) {
-    b_bone_deform(pchan, co, weight, vec, dq, mat);
-  }
-  else {
-    pchan_deform_accumulate(
-        &pchan->runtime.deform_dual_quat, pchan->chan_mat, co, weight, vec, dq, mat);
-  }
-
-  (*contrib) += weight;
-}
+/* Bone of a vertex group, looked up once per evaluation so the vertex loop reads a compact
+ * array instead of the pose channels and their bones. */
+typedef struct ArmatureDeformGroup {
+  /* NULL for groups which are not deforming bones. */
+  const bPoseChannel *pchan;
+  const float (*deform_mat)[4];
+  const DualQuat *deform_dq;
+  /* The deformation depends on the vertex position. */
+  bool use_bbone;
+  bool use_envelope_multiply;
+} ArmatureDeformGroup;
 
 typedef struct ArmatureUserdata {
   Object *armOb;
@@ -1520,7 +1506,7 @@ typedef struct ArmatureUserdata {
   MDeformVert *dverts;
 
   int defbase_tot;
-  bPoseChannel **defnrToPC;
+  const ArmatureDeformGroup *groups;
 
   float premat[4][4];
   float postmat[4][4];
@@ -1543,8 +1529,8 @@ static void armature_vert_task(void *__restrict userdata,
   DualQuat sumdq, *dq = NULL;
   bPoseChannel *pchan;
   float *co, dco[3];
-  float sumvec[3], summat[3][3];
-  float *vec = NULL, (*smat)[3] = NULL;
+  float summat[3][3], sumdefmat[4][4];
+  float(*smat)[3] = NULL, (*defmat)[4] = NULL;
   float contrib = 0.0f;
   float armature_weight = 1.0f; /* default to 1 if no overall def group */
   float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
@@ -1554,13 +1540,8 @@ static void armature_vert_task(void *__restrict userdata,
     dq = &sumdq;
   }
   else {
-    sumvec[0] = sumvec[1] = sumvec[2] = 0.0f;
-    vec = sumvec;
-
-    if (defMats) {
-      zero_m3(summat);
-      smat = summat;
-    }
+    zero_m4(sumdefmat);
+    defmat = sumdefmat;
   }
 
   if (use_dverts || armature_def_nr != -1) {
@@ -1615,18 +1596,29 @@ static void armature_vert_task(void *__restrict userdata,
     unsigned int j;
     for (j = dvert->totweight; j != 0; j--, dw++) {
       const uint index = dw->def_nr;
-      if (index < data->defbase_tot && (pchan = data->defnrToPC[index])) {
+      const ArmatureDeformGroup *group;
+      if (index < data->defbase_tot && (group = &data->groups[index])->pchan) {
         float weight = dw->weight;
-        Bone *bone = pchan->bone;
 
         deformed = 1;
 
-        if (bone && bone->flag & BONE_MULT_VG_ENV) {
+        if (group->use_envelope_multiply) {
+          const Bone *bone = group->pchan->bone;
           weight *= distfactor_to_bone(
               co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
         }
 
-        pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
+        if (weight == 0.0f) {
+          continue;
+        }
+
+        if (group->use_bbone) {
+          b_bone_deform(group->pchan, co, weight, dq, defmat);
+        }
+        else {
+          pchan_deform_accumulate(group->deform_dq, group->deform_mat, weight, dq, defmat);
+        }
+        contrib += weight;
       }
     }
     /* if there are vertexgroups but not groups with bones
@@ -1634,7 +1626,7 @@ static void armature_vert_task(void *__restrict userdata,
     if (deformed == 0 && use_envelope) {
       for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next) {
         if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-          contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+          contrib += dist_bone_deform(pchan, dq, defmat, co);
         }
       }
     }
@@ -1642,7 +1634,7 @@ static void armature_vert_task(void *__restrict userdata,
   else if (use_envelope) {
     for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next) {
       if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-        contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+        contrib += dist_bone_deform(pchan, dq, defmat, co);
       }
     }
   }
@@ -1666,8 +1658,15 @@ static void armature_vert_task(void *__restrict userdata,
       smat = summat;
     }
     else {
-      mul_v3_fl(vec, armature_weight / contrib);
-      add_v3_v3v3(co, vec, co);
+      /* The offset from the blended matrix, relative to the total weight. */
+      mul_v3_m4v3(dco, defmat, co);
+      madd_v3_v3fl(dco, co, -contrib);
+      madd_v3_v3fl(co, dco, armature_weight / contrib);
+
+      if (defMats) {
+        copy_m3_m4(summat, defmat);
+        smat = summat;
+      }
     }
 
     if (defMats) {
@@ -1709,7 +1708,7 @@ void armature_deform_verts(Object *armOb,
                            bGPDstroke *gps)
 {
   bArmature *arm = armOb->data;
-  bPoseChannel **defnrToPC = NULL;
+  ArmatureDeformGroup *groups = NULL;
   MDeformVert *dverts = NULL;
   bDeformGroup *dg;
   const bool use_envelope = (deformflag & ARM_DEF_ENVELOPE) != 0;
@@ -1772,19 +1771,20 @@ void armature_deform_verts(Object *armOb,
       }
 
       if (use_dverts) {
-        defnrToPC = MEM_callocN(sizeof(*defnrToPC) * defbase_tot, "defnrToBone");
-        /* TODO(sergey): Some considerations here:
-         *
-         * - Check whether keeping this consistent across frames gives speedup.
-         */
+        groups = MEM_callocN(sizeof(*groups) * defbase_tot, "ArmatureDeformGroup");
         for (i = 0, dg = target->defbase.first; dg; i++, dg = dg->next) {
-          defnrToPC[i] = BKE_pose_channel_find_name(armOb->pose, dg->name);
+          const bPoseChannel *pchan = BKE_pose_channel_find_name(armOb->pose, dg->name);
           /* exclude non-deforming bones */
-          if (defnrToPC[i]) {
-            if (defnrToPC[i]->bone->flag & BONE_NO_DEFORM) {
-              defnrToPC[i] = NULL;
-            }
+          if (pchan == NULL || (pchan->bone->flag & BONE_NO_DEFORM)) {
+            continue;
           }
+          const Bone *bone = pchan->bone;
+          groups[i].pchan = pchan;
+          groups[i].deform_mat = pchan->chan_mat;
+          groups[i].deform_dq = &pchan->runtime.deform_dual_quat;
+          groups[i].use_bbone = (bone->segments > 1 &&
+                                 pchan->runtime.bbone_segments == bone->segments);
+          groups[i].use_envelope_multiply = (bone->flag & BONE_MULT_VG_ENV) != 0;
         }
       }
     }
@@ -1804,7 +1804,7 @@ void armature_deform_verts(Object *armOb,
                            .target_totvert = target_totvert,
                            .dverts = dverts,
                            .defbase_tot = defbase_tot,
-                           .defnrToPC = defnrToPC};
+                           .groups = groups};
 
   float obinv[4][4];
   invert_m4_m4(obinv, target->obmat);
@@ -1817,8 +1817,8 @@ void armature_deform_verts(Object *armOb,
   settings.min_iter_per_thread = 32;
   BLI_task_parallel_range(0, numVerts, &data, armature_vert_task, &settings);
 
-  if (defnrToPC) {
-    MEM_freeN(defnrToPC);
+  if (groups) {
+    MEM_freeN(groups);
   }
 }
 
@@ -49,6 +49,7 @@
 #include "BKE_image.h"
 #include "BKE_layer.h"
 #include "BKE_main.h"
+#include "BKE_modifier_stack_cache.h"
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
@@ -98,6 +99,7 @@ void BKE_blender_free(void)
   BKE_callback_global_finalize();
 
   IMB_moviecache_destruct();
+  BKE_modifier_stack_cache_free_all();
 
   free_nodesystem();
 }
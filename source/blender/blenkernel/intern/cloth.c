@@ -34,6 +34,7 @@
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DEG_depsgraph.h"
@@ -229,6 +230,49 @@ static BVHTree *bvhtree_build_from_cloth(ClothModifierData *clmd, float epsilon)
   return bvhtree;
 }
 
+typedef struct BVHUpdateFromClothData {
+  BVHTree *bvhtree;
+  const ClothVertex *verts;
+  const MVertTri *tri;
+  bool moving;
+} BVHUpdateFromClothData;
+
+static void bvhtree_update_from_cloth_tri_cb(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHUpdateFromClothData *data = userdata;
+  const ClothVertex *verts = data->verts;
+  const MVertTri *vt = &data->tri[i];
+  float co[3][3], co_moving[3][3];
+  bool ret;
+
+  /* copy new locations into array */
+  if (data->moving) {
+    copy_v3_v3(co[0], verts[vt->tri[0]].txold);
+    copy_v3_v3(co[1], verts[vt->tri[1]].txold);
+    copy_v3_v3(co[2], verts[vt->tri[2]].txold);
+
+    /* update moving positions */
+    copy_v3_v3(co_moving[0], verts[vt->tri[0]].tx);
+    copy_v3_v3(co_moving[1], verts[vt->tri[1]].tx);
+    copy_v3_v3(co_moving[2], verts[vt->tri[2]].tx);
+
+    ret = BLI_bvhtree_update_node(data->bvhtree, i, co[0], co_moving[0], 3);
+  }
+  else {
+    copy_v3_v3(co[0], verts[vt->tri[0]].tx);
+    copy_v3_v3(co[1], verts[vt->tri[1]].tx);
+    copy_v3_v3(co[2], verts[vt->tri[2]].tx);
+
+    ret = BLI_bvhtree_update_node(data->bvhtree, i, co[0], NULL, 3);
+  }
+
+  /* The tree is created with a leaf for every triangle. */
+  BLI_assert(ret);
+  UNUSED_VARS_NDEBUG(ret);
+}
+
 void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
 {
   unsigned int i = 0;
@@ -255,36 +299,18 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
   /* update vertex position in bvh tree */
   if (clmd->hairdata == NULL) {
     if (verts && vt) {
-      for (i = 0; i < cloth->primitive_num; i++, vt++) {
-        float co[3][3], co_moving[3][3];
-        bool ret;
-
-        /* copy new locations into array */
-        if (moving) {
-          copy_v3_v3(co[0], verts[vt->tri[0]].txold);
-          copy_v3_v3(co[1], verts[vt->tri[1]].txold);
-          copy_v3_v3(co[2], verts[vt->tri[2]].txold);
-
-          /* update moving positions */
-          copy_v3_v3(co_moving[0], verts[vt->tri[0]].tx);
-          copy_v3_v3(co_moving[1], verts[vt->tri[1]].tx);
-          copy_v3_v3(co_moving[2], verts[vt->tri[2]].tx);
-
-          ret = BLI_bvhtree_update_node(bvhtree, i, co[0], co_moving[0], 3);
-        }
-        else {
-          copy_v3_v3(co[0], verts[vt->tri[0]].tx);
-          copy_v3_v3(co[1], verts[vt->tri[1]].tx);
-          copy_v3_v3(co[2], verts[vt->tri[2]].tx);
-
-          ret = BLI_bvhtree_update_node(bvhtree, i, co[0], NULL, 3);
-        }
-
-        /* check if tree is already full */
-        if (ret == false) {
-          break;
-        }
-      }
+      /* Every triangle only writes its own leaf. */
+      BVHUpdateFromClothData data = {
+          .bvhtree = bvhtree,
+          .verts = verts,
+          .tri = vt,
+          .moving = moving,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(
+          0, (int)cloth->primitive_num, &data, bvhtree_update_from_cloth_tri_cb, &settings);
 
       BLI_bvhtree_update_tree(bvhtree);
     }
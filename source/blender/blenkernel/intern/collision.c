@@ -53,6 +53,8 @@
 #include "DEG_depsgraph_physics.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
 #ifdef WITH_ELTOPO
 #  include "eltopo-capi.h"
 #endif
@@ -903,12 +905,28 @@ static void cloth_selfcollision_impulse_vert(const float clamp_sq,
   vert->impulse_count++;
 }
 
-static int cloth_selfcollision_response_static(ClothModifierData *clmd,
-                                               CollPair *collpair,
-                                               uint collision_count,
-                                               const float dt)
+/* Impulses of a self collision pair, computed in parallel before they are merged. */
+typedef struct SelfColImpulse {
+  float ia[3][3], ib[3][3];
+  bool has_impulse;
+} SelfColImpulse;
+
+typedef struct SelfColResponseData {
+  ClothModifierData *clmd;
+  CollPair *collisions;
+  SelfColImpulse *impulses;
+} SelfColResponseData;
+
+static void cloth_selfcollision_response_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  int result = 0;
+  SelfColResponseData *data = (SelfColResponseData *)userdata;
+  ClothModifierData *clmd = data->clmd;
+  CollPair *collpair = &data->collisions[i];
+  SelfColImpulse *col_impulse = &data->impulses[i];
+  float(*ia)[3] = col_impulse->ia;
+  float(*ib)[3] = col_impulse->ib;
   Cloth *cloth1;
   float w1, w2, w3, u1, u2, u3;
   float v1[3], v2[3], relativeVelocity[3];
@@ -916,93 +934,114 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd,
 
   cloth1 = clmd->clothObject;
 
-  for (int i = 0; i < collision_count; i++, collpair++) {
-    float ia[3][3] = {{0.0f}};
-    float ib[3][3] = {{0.0f}};
+  memset(col_impulse, 0, sizeof(*col_impulse));
 
-    /* Only handle static collisions here. */
-    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
-      continue;
-    }
+  /* Only handle static collisions here. */
+  if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
+    return;
+  }
 
-    /* Compute barycentric coordinates for both collision points. */
-    collision_compute_barycentric(collpair->pa,
-                                  cloth1->verts[collpair->ap1].tx,
-                                  cloth1->verts[collpair->ap2].tx,
-                                  cloth1->verts[collpair->ap3].tx,
-                                  &w1,
-                                  &w2,
-                                  &w3);
+  /* Compute barycentric coordinates for both collision points. */
+  collision_compute_barycentric(collpair->pa,
+                                cloth1->verts[collpair->ap1].tx,
+                                cloth1->verts[collpair->ap2].tx,
+                                cloth1->verts[collpair->ap3].tx,
+                                &w1,
+                                &w2,
+                                &w3);
 
-    collision_compute_barycentric(collpair->pb,
-                                  cloth1->verts[collpair->bp1].tx,
-                                  cloth1->verts[collpair->bp2].tx,
-                                  cloth1->verts[collpair->bp3].tx,
-                                  &u1,
-                                  &u2,
-                                  &u3);
+  collision_compute_barycentric(collpair->pb,
+                                cloth1->verts[collpair->bp1].tx,
+                                cloth1->verts[collpair->bp2].tx,
+                                cloth1->verts[collpair->bp3].tx,
+                                &u1,
+                                &u2,
+                                &u3);
+
+  /* Calculate relative "velocity". */
+  collision_interpolateOnTriangle(v1,
+                                  cloth1->verts[collpair->ap1].tv,
+                                  cloth1->verts[collpair->ap2].tv,
+                                  cloth1->verts[collpair->ap3].tv,
+                                  w1,
+                                  w2,
+                                  w3);
+
+  collision_interpolateOnTriangle(v2,
+                                  cloth1->verts[collpair->bp1].tv,
+                                  cloth1->verts[collpair->bp2].tv,
+                                  cloth1->verts[collpair->bp3].tv,
+                                  u1,
+                                  u2,
+                                  u3);
 
-    /* Calculate relative "velocity". */
-    collision_interpolateOnTriangle(v1,
-                                    cloth1->verts[collpair->ap1].tv,
-                                    cloth1->verts[collpair->ap2].tv,
-                                    cloth1->verts[collpair->ap3].tv,
-                                    w1,
-                                    w2,
-                                    w3);
+  sub_v3_v3v3(relativeVelocity, v2, v1);
 
-    collision_interpolateOnTriangle(v2,
-                                    cloth1->verts[collpair->bp1].tv,
-                                    cloth1->verts[collpair->bp2].tv,
-                                    cloth1->verts[collpair->bp3].tv,
-                                    u1,
-                                    u2,
-                                    u3);
+  /* Calculate the normal component of the relative velocity
+   * (actually only the magnitude - the direction is stored in 'normal'). */
+  magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
 
-    sub_v3_v3v3(relativeVelocity, v2, v1);
+  /* TODO: Impulses should be weighed by mass as this is self col,
+   * this has to be done after mass distribution is implemented. */
 
-    /* Calculate the normal component of the relative velocity
-     * (actually only the magnitude - the direction is stored in 'normal'). */
-    magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+  /* If magrelVel < 0 the edges are approaching each other. */
+  if (magrelVel > 0.0f) {
+    /* Calculate Impulse magnitude to stop all motion in normal direction. */
+    float magtangent = 0, repulse = 0, d = 0;
+    double impulse = 0.0;
+    float vrel_t_pre[3];
+    float temp[3], time_multiplier;
 
-    /* TODO: Impulses should be weighed by mass as this is self col,
-     * this has to be done after mass distribution is implemented. */
+    /* Calculate tangential velocity. */
+    copy_v3_v3(temp, collpair->normal);
+    mul_v3_fl(temp, magrelVel);
+    sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
 
-    /* If magrelVel < 0 the edges are approaching each other. */
-    if (magrelVel > 0.0f) {
-      /* Calculate Impulse magnitude to stop all motion in normal direction. */
-      float magtangent = 0, repulse = 0, d = 0;
-      double impulse = 0.0;
-      float vrel_t_pre[3];
-      float temp[3], time_multiplier;
+    /* Decrease in magnitude of relative tangential velocity due to coulomb friction
+     * in original formula "magrelVel" should be the
+     * "change of relative velocity in normal direction". */
+    magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
 
-      /* Calculate tangential velocity. */
-      copy_v3_v3(temp, collpair->normal);
-      mul_v3_fl(temp, magrelVel);
-      sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
+    /* Apply friction impulse. */
+    if (magtangent > ALMOST_ZERO) {
+      normalize_v3(vrel_t_pre);
 
-      /* Decrease in magnitude of relative tangential velocity due to coulomb friction
-       * in original formula "magrelVel" should be the
-       * "change of relative velocity in normal direction". */
-      magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
+      impulse = magtangent / 1.5;
 
-      /* Apply friction impulse. */
-      if (magtangent > ALMOST_ZERO) {
-        normalize_v3(vrel_t_pre);
+      VECADDMUL(ia[0], vrel_t_pre, w1 * impulse);
+      VECADDMUL(ia[1], vrel_t_pre, w2 * impulse);
+      VECADDMUL(ia[2], vrel_t_pre, w3 * impulse);
 
-        impulse = magtangent / 1.5;
+      VECADDMUL(ib[0], vrel_t_pre, -u1 * impulse);
+      VECADDMUL(ib[1], vrel_t_pre, -u2 * impulse);
+      VECADDMUL(ib[2], vrel_t_pre, -u3 * impulse);
+    }
+
+    /* Apply velocity stopping impulse. */
+    impulse = magrelVel / 3.0f;
+
+    VECADDMUL(ia[0], collpair->normal, w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, w3 * impulse);
 
-        VECADDMUL(ia[0], vrel_t_pre, w1 * impulse);
-        VECADDMUL(ia[1], vrel_t_pre, w2 * impulse);
-        VECADDMUL(ia[2], vrel_t_pre, w3 * impulse);
+    VECADDMUL(ib[0], collpair->normal, -u1 * impulse);
+    VECADDMUL(ib[1], collpair->normal, -u2 * impulse);
+    VECADDMUL(ib[2], collpair->normal, -u3 * impulse);
 
-        VECADDMUL(ib[0], vrel_t_pre, -u1 * impulse);
-        VECADDMUL(ib[1], vrel_t_pre, -u2 * impulse);
-        VECADDMUL(ib[2], vrel_t_pre, -u3 * impulse);
+    time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
+
+    d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
+
+    if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
+      repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+
+      if (impulse > ALMOST_ZERO) {
+        repulse = min_ff(repulse, 5.0 * impulse);
       }
 
-      /* Apply velocity stopping impulse. */
-      impulse = magrelVel / 3.0f;
+      repulse = max_ff(impulse, repulse);
+
+      impulse = repulse / 1.5f;
 
       VECADDMUL(ia[0], collpair->normal, w1 * impulse);
       VECADDMUL(ia[1], collpair->normal, w2 * impulse);
@@ -1011,59 +1050,73 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd,
       VECADDMUL(ib[0], collpair->normal, -u1 * impulse);
       VECADDMUL(ib[1], collpair->normal, -u2 * impulse);
       VECADDMUL(ib[2], collpair->normal, -u3 * impulse);
+    }
 
-      time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
-
-      d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
-
-      if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
-        repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
-
-        if (impulse > ALMOST_ZERO) {
-          repulse = min_ff(repulse, 5.0 * impulse);
-        }
+    col_impulse->has_impulse = true;
+  }
+  else {
+    float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
+    float d;
 
-        repulse = max_ff(impulse, repulse);
+    d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
 
-        impulse = repulse / 1.5f;
+    if (d > ALMOST_ZERO) {
+      /* Stay on the safe side and clamp repulse. */
+      float repulse = d * 1.0f / time_multiplier;
+      float impulse = repulse / 9.0f;
 
-        VECADDMUL(ia[0], collpair->normal, w1 * impulse);
-        VECADDMUL(ia[1], collpair->normal, w2 * impulse);
-        VECADDMUL(ia[2], collpair->normal, w3 * impulse);
+      VECADDMUL(ia[0], collpair->normal, w1 * impulse);
+      VECADDMUL(ia[1], collpair->normal, w2 * impulse);
+      VECADDMUL(ia[2], collpair->normal, w3 * impulse);
 
-        VECADDMUL(ib[0], collpair->normal, -u1 * impulse);
-        VECADDMUL(ib[1], collpair->normal, -u2 * impulse);
-        VECADDMUL(ib[2], collpair->normal, -u3 * impulse);
-      }
+      VECADDMUL(ib[0], collpair->normal, -u1 * impulse);
+      VECADDMUL(ib[1], collpair->normal, -u2 * impulse);
+      VECADDMUL(ib[2], collpair->normal, -u3 * impulse);
 
-      result = 1;
+      col_impulse->has_impulse = true;
     }
-    else {
-      float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
-      float d;
+  }
+}
+
+static int cloth_selfcollision_response_static(ClothModifierData *clmd,
+                                               CollPair *collpair,
+                                               uint collision_count,
+                                               const float dt)
+{
+  int result = 0;
+  Cloth *cloth1 = clmd->clothObject;
+  float clamp_sq = clmd->coll_parms->self_clamp * dt;
+  clamp_sq *= clamp_sq;
 
-      d = clmd->coll_parms->selfepsilon * 8.0f / 9.0f * 2.0f - collpair->distance;
+  /* The impulses only depend on the pair, the merge in the vertices is done afterwards
+   * in the order of the pairs so the result doesn't depend on threading. */
+  SelfColResponseData data = {
+      .clmd = clmd,
+      .collisions = collpair,
+      .impulses = MEM_malloc_arrayN(collision_count, sizeof(SelfColImpulse), __func__),
+  };
 
-      if (d > ALMOST_ZERO) {
-        /* Stay on the safe side and clamp repulse. */
-        float repulse = d * 1.0f / time_multiplier;
-        float impulse = repulse / 9.0f;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = true;
+  BLI_task_parallel_range(
+      0, (int)collision_count, &data, cloth_selfcollision_response_cb, &settings);
 
-        VECADDMUL(ia[0], collpair->normal, w1 * impulse);
-        VECADDMUL(ia[1], collpair->normal, w2 * impulse);
-        VECADDMUL(ia[2], collpair->normal, w3 * impulse);
+  for (int i = 0; i < collision_count; i++, collpair++) {
+    const SelfColImpulse *col_impulse = &data.impulses[i];
 
-        VECADDMUL(ib[0], collpair->normal, -u1 * impulse);
-        VECADDMUL(ib[1], collpair->normal, -u2 * impulse);
-        VECADDMUL(ib[2], collpair->normal, -u3 * impulse);
+    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
+      continue;
+    }
 
-        result = 1;
-      }
+    if (col_impulse->has_impulse) {
+      result = 1;
     }
 
+    /* Once a pair had an impulse, the following pairs are counted even without impulse. */
     if (result) {
-      float clamp_sq = clmd->coll_parms->self_clamp * dt;
-      clamp_sq *= clamp_sq;
+      const float(*ia)[3] = col_impulse->ia;
+      const float(*ib)[3] = col_impulse->ib;
 
       cloth_selfcollision_impulse_vert(clamp_sq, ia[0], &cloth1->verts[collpair->ap1]);
       cloth_selfcollision_impulse_vert(clamp_sq, ia[1], &cloth1->verts[collpair->ap2]);
@@ -1075,6 +1128,8 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd,
     }
   }
 
+  MEM_freeN(data.impulses);
+
   return result;
 }
 
@@ -1600,7 +1655,8 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
 
 static bool cloth_bvh_self_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
 {
-  /* No need for equal combinations (eg. (0,1) & (1,0)). */
+  /* No need for equal combinations (eg. (0,1) & (1,0)),
+   * #BLI_bvhtree_overlap_self already only passes `index_a < index_b`. */
   if (index_a < index_b) {
     ClothModifierData *clmd = (ClothModifierData *)userdata;
     struct Cloth *clothObject = clmd->clothObject;
@@ -1632,6 +1688,8 @@ int cloth_bvh_collision(
   BVHTreeOverlap **overlap_obj = NULL;
   uint coll_count_self = 0;
   BVHTreeOverlap *overlap_self = NULL;
+  double time_bvh = 0.0, time_overlap = 0.0, time_narrow = 0.0, time_response = 0.0;
+  double time_start;
 
   if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_COLLOBJ) || cloth_bvh == NULL) {
     return 0;
@@ -1641,7 +1699,9 @@ int cloth_bvh_collision(
   mvert_num = cloth->mvert_num;
 
   if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) {
+    time_start = PIL_check_seconds_timer();
     bvhtree_update_from_cloth(clmd, false, false);
+    time_bvh += PIL_check_seconds_timer() - time_start;
 
     /* Enable self collision if this is a hair sim */
     const bool is_hair = (clmd->hairdata != NULL);
@@ -1666,19 +1726,27 @@ int cloth_bvh_collision(
         }
 
         /* Move object to position (step) in time. */
+        time_start = PIL_check_seconds_timer();
         collision_move_object(collmd, step + dt, step, false);
+        time_bvh += PIL_check_seconds_timer() - time_start;
 
+        time_start = PIL_check_seconds_timer();
         overlap_obj[i] = BLI_bvhtree_overlap(
             cloth_bvh, collmd->bvhtree, &coll_counts_obj[i], NULL, NULL);
+        time_overlap += PIL_check_seconds_timer() - time_start;
       }
     }
   }
 
   if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) {
+    time_start = PIL_check_seconds_timer();
     bvhtree_update_from_cloth(clmd, false, true);
+    time_bvh += PIL_check_seconds_timer() - time_start;
 
-    overlap_self = BLI_bvhtree_overlap(
-        cloth->bvhselftree, cloth->bvhselftree, &coll_count_self, cloth_bvh_self_overlap_cb, clmd);
+    time_start = PIL_check_seconds_timer();
+    overlap_self = BLI_bvhtree_overlap_self(
+        cloth->bvhselftree, &coll_count_self, cloth_bvh_self_overlap_cb, clmd);
+    time_overlap += PIL_check_seconds_timer() - time_start;
   }
 
   do {
@@ -1691,6 +1759,7 @@ int cloth_bvh_collision(
 
       collisions = MEM_callocN(sizeof(CollPair *) * numcollobj, "CollPair");
 
+      time_start = PIL_check_seconds_timer();
       for (i = 0; i < numcollobj; i++) {
         Object *collob = collobjs[i];
         CollisionModifierData *collmd = (CollisionModifierData *)BKE_modifiers_findby_type(
@@ -1712,11 +1781,14 @@ int cloth_bvh_collision(
                      collided;
         }
       }
+      time_narrow += PIL_check_seconds_timer() - time_start;
 
       if (collided) {
+        time_start = PIL_check_seconds_timer();
         ret += cloth_bvh_objcollisions_resolve(
             clmd, collobjs, collisions, coll_counts_obj, numcollobj, dt);
         ret2 += ret;
+        time_response += PIL_check_seconds_timer() - time_start;
       }
 
       for (i = 0; i < numcollobj; i++) {
@@ -1738,10 +1810,16 @@ int cloth_bvh_collision(
           collisions = (CollPair *)MEM_mallocN(sizeof(CollPair) * coll_count_self,
                                                "collision array");
 
-          if (cloth_bvh_selfcollisions_nearcheck(
-                  clmd, collisions, coll_count_self, overlap_self)) {
+          time_start = PIL_check_seconds_timer();
+          const bool collided = cloth_bvh_selfcollisions_nearcheck(
+              clmd, collisions, coll_count_self, overlap_self);
+          time_narrow += PIL_check_seconds_timer() - time_start;
+
+          if (collided) {
+            time_start = PIL_check_seconds_timer();
             ret += cloth_bvh_selfcollisions_resolve(clmd, collisions, coll_count_self, dt);
             ret2 += ret;
+            time_response += PIL_check_seconds_timer() - time_start;
           }
         }
       }
@@ -1779,6 +1857,14 @@ int cloth_bvh_collision(
 
   BKE_collision_objects_free(collobjs);
 
+  if (clmd->solver_result) {
+    ClothSolverResult *sres = clmd->solver_result;
+    sres->time_collision_bvh += (float)time_bvh;
+    sres->time_collision_overlap += (float)time_overlap;
+    sres->time_collision_narrow += (float)time_narrow;
+    sres->time_collision_response += (float)time_response;
+  }
+
   return MIN2(ret, 1);
 }
 
@@ -128,6 +128,18 @@ static int neighStraightY[8] = {0, 1, 0, -1, 1, 1, -1, -1};
 /* drying limits */
 #define MIN_WETNESS 0.001f
 #define MAX_WETNESS 5.0f
+/* sparse tiles of paint surfaces, size in pixels for image sequences and in points otherwise */
+#define TILE_PIXELS 32
+#define TILE_POINTS 1024
+/* tile flags, set if the tile may have points with wet paint or any paint */
+#define TILE_WET (1 << 0)
+#define TILE_PAINTED (1 << 1)
+/* dynamicPaint_doTiles options */
+#define TILES_READ_NEIGHBORS (1 << 0)
+#define TILES_UPDATE_FLAGS (1 << 1)
+
+/* Only process the painted tiles of paint surfaces, see #dynamicPaint_setUseTiles. */
+static bool dpaint_use_tiles = true;
 
 /* dissolve inline function */
 BLI_INLINE void value_dissolve(float *r_value,
@@ -186,6 +198,24 @@ typedef struct PaintBakeNormal {
   float normal_scale;
 } PaintBakeNormal;
 
+/** Tiles of consecutive surface points, so effects only process the painted parts */
+typedef struct PaintTileData {
+  /** index of the first point of each tile, followed by the total number of points */
+  int *start;
+  int total_tiles;
+  /** tile of each point */
+  int *point_tile;
+  /** neighboring tiles, access: (n_index + n_num) */
+  int *n_index;
+  int *n_num;
+  int *n_target;
+  /** TILE_WET and TILE_PAINTED flags of each tile */
+  uint8_t *flags;
+  /** temporary list of tiles to process and marks used while collecting it */
+  int *list;
+  uint8_t *mark;
+} PaintTileData;
+
 /** Temp surface data used to process a frame */
 typedef struct PaintBakeData {
   /* point space data */
@@ -206,6 +236,8 @@ typedef struct PaintBakeData {
   /* space partitioning */
   /** space partitioning grid to optimize brush checks */
   VolumeGrid *grid;
+  /** sparse tiles of paint surfaces with adjacency data */
+  PaintTileData *tiles;
 
   /* velocity and movement */
   /** speed vector in global space movement per frame, if required */
@@ -899,6 +931,23 @@ static void dynamicPaint_freeAdjData(PaintSurfaceData *data)
   }
 }
 
+static void dynamicPaint_freeTileData(PaintBakeData *bData)
+{
+  PaintTileData *tiles = bData->tiles;
+  if (tiles) {
+    MEM_SAFE_FREE(tiles->start);
+    MEM_SAFE_FREE(tiles->point_tile);
+    MEM_SAFE_FREE(tiles->n_index);
+    MEM_SAFE_FREE(tiles->n_num);
+    MEM_SAFE_FREE(tiles->n_target);
+    MEM_SAFE_FREE(tiles->flags);
+    MEM_SAFE_FREE(tiles->list);
+    MEM_SAFE_FREE(tiles->mark);
+    MEM_freeN(tiles);
+    bData->tiles = NULL;
+  }
+}
+
 static void free_bakeData(PaintSurfaceData *data)
 {
   PaintBakeData *bData = data->bData;
@@ -921,6 +970,7 @@ static void free_bakeData(PaintSurfaceData *data)
     if (bData->grid) {
       freeGrid(data);
     }
+    dynamicPaint_freeTileData(bData);
     if (bData->prev_verts) {
       MEM_freeN(bData->prev_verts);
     }
@@ -2984,11 +3034,19 @@ int dynamicPaint_createUVSurface(Scene *scene,
       int cursor = 0;
 
       /* Create a temporary array of final indexes (before unassigned
-       * pixels have been dropped) */
-      for (int i = 0; i < w * h; i++) {
-        if (tempPoints[i].tri_index != -1) {
-          final_index[i] = cursor;
-          cursor++;
+       * pixels have been dropped). Pixels are ordered in tiles so the
+       * points of a tile are consecutive, see #dynamicPaint_initTileData. */
+      for (int tile_y = 0; tile_y < h; tile_y += TILE_PIXELS) {
+        for (int tile_x = 0; tile_x < w; tile_x += TILE_PIXELS) {
+          for (int ty = tile_y; ty < min_ii(tile_y + TILE_PIXELS, h); ty++) {
+            for (int tx = tile_x; tx < min_ii(tile_x + TILE_PIXELS, w); tx++) {
+              const int i = tx + w * ty;
+              if (tempPoints[i].tri_index != -1) {
+                final_index[i] = cursor;
+                cursor++;
+              }
+            }
+          }
         }
       }
       /* allocate memory */
@@ -3148,13 +3206,13 @@ int dynamicPaint_createUVSurface(Scene *scene,
       sData->total_points = (int)active_points;
       sData->format_data = f_data;
 
-      for (int index = 0, cursor = 0; index < (w * h); index++) {
+      for (int index = 0; index < (w * h); index++) {
         if (tempPoints[index].tri_index != -1) {
+          const int cursor = final_index[index];
           memcpy(&f_data->uv_p[cursor], &tempPoints[index], sizeof(PaintUVPoint));
           memcpy(&f_data->barycentricWeights[cursor * aa_samples],
                  &tempWeights[index * aa_samples],
                  sizeof(*tempWeights) * aa_samples);
-          cursor++;
         }
       }
     }
@@ -3442,6 +3500,338 @@ void dynamicPaint_outputSurfaceImage(DynamicPaintSurface *surface,
 
 /** \} */
 
+/***************************** Sparse Tiles ******************************/
+
+static bool surface_usesTiles(const DynamicPaintSurface *surface)
+{
+  return (dpaint_use_tiles && surface->type == MOD_DPAINT_SURFACE_T_PAINT &&
+          surface->data->adj_data);
+}
+
+void dynamicPaint_setUseTiles(const bool use_tiles)
+{
+  dpaint_use_tiles = use_tiles;
+}
+
+BLI_INLINE uint8_t dynamicPaint_getPointFlags(const PaintPoint *pPoint)
+{
+  if (pPoint->wetness != 0.0f || pPoint->state > DPAINT_PAINT_DRY) {
+    return TILE_WET | TILE_PAINTED;
+  }
+  if (pPoint->color[3] != 0.0f || pPoint->e_color[3] != 0.0f) {
+    return TILE_PAINTED;
+  }
+  return 0;
+}
+
+/* Get the flags of a tile from the paint of its points. */
+static uint8_t dynamicPaint_getTileFlags(const PaintSurfaceData *sData, const int tile)
+{
+  const PaintTileData *tiles = sData->bData->tiles;
+  const PaintPoint *pPoint = (const PaintPoint *)sData->type_data;
+  uint8_t flags = 0;
+
+  for (int index = tiles->start[tile]; index < tiles->start[tile + 1]; index++) {
+    flags |= dynamicPaint_getPointFlags(&pPoint[index]);
+    if (flags & TILE_WET) {
+      break;
+    }
+  }
+
+  return flags;
+}
+
+/* Flag the tile of a point that may have received paint. */
+BLI_INLINE void dynamicPaint_markTile(const PaintSurfaceData *sData,
+                                      const int index,
+                                      const uint8_t flags)
+{
+  const PaintTileData *tiles = sData->bData->tiles;
+
+  if (tiles) {
+    uint8_t *tile_flags = &tiles->flags[tiles->point_tile[index]];
+    if ((*tile_flags & flags) != flags) {
+      atomic_fetch_and_or_uint8(tile_flags, flags);
+    }
+  }
+}
+
+/* Split the surface points into tiles of consecutive points, and find the neighboring tiles
+ * from the adjacency data. Image sequence points are ordered by tiles of pixels. */
+static void dynamicPaint_initTileData(DynamicPaintSurface *surface)
+{
+  PaintSurfaceData *sData = surface->data;
+  PaintAdjData *adj_data = sData->adj_data;
+  const int w = surface->image_resolution;
+  const int tiles_x = (w + TILE_PIXELS - 1) / TILE_PIXELS;
+  int total_tiles = 0, prev_key = -1;
+
+  PaintTileData *tiles = MEM_callocN(sizeof(*tiles), "PaintTileData");
+  sData->bData->tiles = tiles;
+  tiles->point_tile = MEM_mallocN(sizeof(int) * sData->total_points, "Paint Tile Points");
+  if (!tiles->point_tile) {
+    dynamicPaint_freeTileData(sData->bData);
+    return;
+  }
+
+  for (int index = 0; index < sData->total_points; index++) {
+    int key;
+
+    if (surface->format == MOD_DPAINT_SURFACE_F_IMAGESEQ) {
+      const ImgSeqFormatData *f_data = (ImgSeqFormatData *)sData->format_data;
+      const int pixel_index = (int)f_data->uv_p[index].pixel_index;
+      key = (pixel_index / w / TILE_PIXELS) * tiles_x + (pixel_index % w) / TILE_PIXELS;
+    }
+    else {
+      key = index / TILE_POINTS;
+    }
+
+    if (key != prev_key) {
+      prev_key = key;
+      total_tiles++;
+    }
+    tiles->point_tile[index] = total_tiles - 1;
+  }
+
+  tiles->total_tiles = total_tiles;
+  tiles->start = MEM_mallocN(sizeof(int) * (total_tiles + 1), "Paint Tile Start");
+  tiles->n_index = MEM_mallocN(sizeof(int) * total_tiles, "Paint Tile Adj Index");
+  tiles->n_num = MEM_callocN(sizeof(int) * total_tiles, "Paint Tile Adj Counts");
+  tiles->flags = MEM_callocN(sizeof(uint8_t) * total_tiles, "Paint Tile Flags");
+  tiles->list = MEM_mallocN(sizeof(int) * total_tiles, "Paint Tile List");
+  tiles->mark = MEM_mallocN(sizeof(uint8_t) * total_tiles, "Paint Tile Marks");
+  /* last tile a tile was added as neighbor to, plus one */
+  int *added = MEM_callocN(sizeof(int) * total_tiles, "Temp Paint Tile Added");
+
+  if (!tiles->start || !tiles->n_index || !tiles->n_num || !tiles->flags || !tiles->list ||
+      !tiles->mark || !added) {
+    dynamicPaint_freeTileData(sData->bData);
+    if (added) {
+      MEM_freeN(added);
+    }
+    return;
+  }
+
+  for (int index = 0; index < sData->total_points; index++) {
+    if (index == 0 || tiles->point_tile[index] != tiles->point_tile[index - 1]) {
+      tiles->start[tiles->point_tile[index]] = index;
+    }
+  }
+  tiles->start[total_tiles] = sData->total_points;
+
+  /* count neighboring tiles, then add them */
+  for (int pass = 0; pass < 2; pass++) {
+    int n_pos = 0;
+
+    for (int tile = 0; tile < total_tiles; tile++) {
+      if (pass == 1) {
+        tiles->n_index[tile] = n_pos;
+      }
+
+      for (int index = tiles->start[tile]; index < tiles->start[tile + 1]; index++) {
+        for (int i = 0; i < adj_data->n_num[index]; i++) {
+          const int n_tile = tiles->point_tile[adj_data->n_target[adj_data->n_index[index] + i]];
+
+          if (n_tile != tile && added[n_tile] != tile + 1) {
+            added[n_tile] = tile + 1;
+            if (pass == 1) {
+              tiles->n_target[n_pos] = n_tile;
+            }
+            n_pos++;
+          }
+        }
+      }
+
+      if (pass == 1) {
+        tiles->n_num[tile] = n_pos - tiles->n_index[tile];
+      }
+    }
+
+    if (pass == 0) {
+      tiles->n_target = MEM_mallocN(sizeof(int) * max_ii(n_pos, 1), "Paint Tile Adj Targets");
+      memset(added, 0, sizeof(int) * total_tiles);
+      if (!tiles->n_target) {
+        dynamicPaint_freeTileData(sData->bData);
+        break;
+      }
+    }
+  }
+
+  MEM_freeN(added);
+}
+
+typedef struct DynamicPaintTilesData {
+  const DynamicPaintSurface *surface;
+  const int *tile_list;
+  PaintPoint *prevPoint;
+  TaskParallelRangeFunc func;
+  void *userdata;
+  const int options;
+} DynamicPaintTilesData;
+
+static void dynamic_paint_tile_flags_cb(void *__restrict userdata,
+                                        const int tile,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DynamicPaintTilesData *data = userdata;
+  const PaintSurfaceData *sData = data->surface->data;
+
+  sData->bData->tiles->flags[tile] = dynamicPaint_getTileFlags(sData, tile);
+}
+
+static void dynamic_paint_tile_copy_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DynamicPaintTilesData *data = userdata;
+  const PaintSurfaceData *sData = data->surface->data;
+  const PaintTileData *tiles = sData->bData->tiles;
+  const int tile = data->tile_list[i];
+  const int start = tiles->start[tile];
+
+  memcpy(&data->prevPoint[start],
+         &((PaintPoint *)sData->type_data)[start],
+         sizeof(PaintPoint) * (tiles->start[tile + 1] - start));
+}
+
+static void dynamic_paint_tile_points_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  const DynamicPaintTilesData *data = userdata;
+  const PaintSurfaceData *sData = data->surface->data;
+  const PaintTileData *tiles = sData->bData->tiles;
+  const int tile = data->tile_list[i];
+
+  for (int index = tiles->start[tile]; index < tiles->start[tile + 1]; index++) {
+    data->func(data->userdata, index, tls);
+  }
+
+  if (data->options & TILES_UPDATE_FLAGS) {
+    tiles->flags[tile] = dynamicPaint_getTileFlags(sData, tile);
+  }
+}
+
+/* Create the tiles if needed and get their flags from the paint, since the surface data
+ * can change between frames (cache, initial color or reset). */
+static void dynamicPaint_updateTileData(DynamicPaintSurface *surface)
+{
+  PaintSurfaceData *sData = surface->data;
+
+  if (!surface_usesTiles(surface)) {
+    dynamicPaint_freeTileData(sData->bData);
+    return;
+  }
+  if (!sData->bData->tiles) {
+    dynamicPaint_initTileData(surface);
+    if (!sData->bData->tiles) {
+      return;
+    }
+  }
+
+  DynamicPaintTilesData data = {
+      .surface = surface,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (sData->total_points > 1000);
+  BLI_task_parallel_range(
+      0, sData->bData->tiles->total_tiles, &data, dynamic_paint_tile_flags_cb, &settings);
+}
+
+/* Collect the tiles with any of the flags, followed by rings of neighboring tiles.
+ * r_ring_end gets the length of the list without rings and with each ring. */
+static void dynamicPaint_collectTiles(PaintTileData *tiles,
+                                      const uint8_t flags,
+                                      const int rings,
+                                      int *r_ring_end)
+{
+  int *list = tiles->list;
+  uint8_t *mark = tiles->mark;
+  int num = 0;
+
+  memset(mark, 0, sizeof(*mark) * tiles->total_tiles);
+
+  for (int tile = 0; tile < tiles->total_tiles; tile++) {
+    if (tiles->flags[tile] & flags) {
+      mark[tile] = 1;
+      list[num++] = tile;
+    }
+  }
+  r_ring_end[0] = num;
+
+  for (int ring = 0, ring_start = 0; ring < rings; ring++) {
+    const int ring_end = num;
+
+    for (int i = ring_start; i < ring_end; i++) {
+      const int tile = list[i];
+
+      for (int j = 0; j < tiles->n_num[tile]; j++) {
+        const int n_tile = tiles->n_target[tiles->n_index[tile] + j];
+
+        if (!mark[n_tile]) {
+          mark[n_tile] = 1;
+          list[num++] = n_tile;
+        }
+      }
+    }
+
+    ring_start = ring_end;
+    r_ring_end[ring + 1] = num;
+  }
+}
+
+/**
+ * Run a point callback on the tiles with any of the flags and the given number of rings of
+ * neighboring tiles, or on all points of surfaces without tiles.
+ *
+ * \param options: #TILES_READ_NEIGHBORS when the callback reads prevPoint of neighboring
+ * points too, #TILES_UPDATE_FLAGS to get the flags of the processed tiles again, only for
+ * callbacks that don't change other points.
+ */
+static void dynamicPaint_doTiles(DynamicPaintSurface *surface,
+                                 const uint8_t flags,
+                                 const int rings,
+                                 const int options,
+                                 PaintPoint *prevPoint,
+                                 TaskParallelRangeFunc func,
+                                 void *userdata)
+{
+  PaintSurfaceData *sData = surface->data;
+  PaintTileData *tiles = sData->bData->tiles;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  if (!tiles || surface->type != MOD_DPAINT_SURFACE_T_PAINT) {
+    if (prevPoint) {
+      memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
+    }
+    settings.use_threading = (sData->total_points > 1000);
+    BLI_task_parallel_range(0, sData->total_points, userdata, func, &settings);
+    return;
+  }
+
+  int ring_end[3];
+  const int copy_rings = rings + ((options & TILES_READ_NEIGHBORS) ? 1 : 0);
+  BLI_assert(copy_rings < ARRAY_SIZE(ring_end));
+  dynamicPaint_collectTiles(tiles, flags, copy_rings, ring_end);
+
+  DynamicPaintTilesData data = {
+      .surface = surface,
+      .tile_list = tiles->list,
+      .prevPoint = prevPoint,
+      .func = func,
+      .userdata = userdata,
+      .options = options,
+  };
+  settings.use_threading = (ring_end[copy_rings] > 1);
+
+  if (prevPoint) {
+    BLI_task_parallel_range(0, ring_end[copy_rings], &data, dynamic_paint_tile_copy_cb, &settings);
+  }
+  BLI_task_parallel_range(0, ring_end[rings], &data, dynamic_paint_tile_points_cb, &settings);
+}
+
 /***************************** Ray / Nearest Point Utils ******************************/
 
 /* A modified callback to bvh tree raycast.
@@ -3685,6 +4075,7 @@ static void dynamicPaint_updatePointData(const DynamicPaintSurface *surface,
 
     dynamicPaint_mixPaintColors(
         surface, index, brush->flags, paint, paintAlpha, paintWetness, timescale);
+    dynamicPaint_markTile(sData, index, TILE_WET | TILE_PAINTED);
   }
   /* displace surface */
   else if (surface->type == MOD_DPAINT_SURFACE_T_DISPLACE) {
@@ -5057,6 +5448,7 @@ static void dynamicPaint_doSmudge(DynamicPaintSurface *surface,
           ePoint->e_color[3] = ePoint->e_color[3] * (1.0f - dir_factor) +
                                pPoint->e_color[3] * dir_factor;
           pPoint->wetness *= (1.0f - dir_factor);
+          dynamicPaint_markTile(sData, sData->adj_data->n_target[n_index], TILE_PAINTED);
         }
       }
     }
@@ -5403,6 +5795,7 @@ static void dynamic_paint_effect_drip_cb(void *__restrict userdata,
       /* mix new wetness */
       ePoint->wetness += dir_factor;
       CLAMP(ePoint->wetness, 0.0f, MAX_WETNESS);
+      dynamicPaint_markTile(sData, n_trgt, TILE_WET | TILE_PAINTED);
 
       /* mix new color */
       a_factor = dir_factor / pPoint_prev->wetness;
@@ -5478,19 +5871,19 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
     const float eff_scale = distance_scale * EFF_MOVEMENT_PER_FRAME * surface->spread_speed *
                             timescale;
 
-    /* Copy current surface to the previous points array to read unmodified values */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
-
     DynamicPaintEffectData data = {
         .surface = surface,
         .prevPoint = prevPoint,
         .eff_scale = eff_scale,
     };
-    TaskParallelSettings settings;
-    BLI_parallel_range_settings_defaults(&settings);
-    settings.use_threading = (sData->total_points > 1000);
-    BLI_task_parallel_range(
-        0, sData->total_points, &data, dynamic_paint_effect_spread_cb, &settings);
+    /* Wet points spread to their neighbors, so also process the tiles around wet tiles. */
+    dynamicPaint_doTiles(surface,
+                         TILE_WET,
+                         1,
+                         TILES_READ_NEIGHBORS | TILES_UPDATE_FLAGS,
+                         prevPoint,
+                         dynamic_paint_effect_spread_cb,
+                         &data);
   }
 
   /*
@@ -5500,19 +5893,18 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
     const float eff_scale = distance_scale * EFF_MOVEMENT_PER_FRAME * surface->shrink_speed *
                             timescale;
 
-    /* Copy current surface to the previous points array to read unmodified values */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
-
     DynamicPaintEffectData data = {
         .surface = surface,
         .prevPoint = prevPoint,
         .eff_scale = eff_scale,
     };
-    TaskParallelSettings settings;
-    BLI_parallel_range_settings_defaults(&settings);
-    settings.use_threading = (sData->total_points > 1000);
-    BLI_task_parallel_range(
-        0, sData->total_points, &data, dynamic_paint_effect_shrink_cb, &settings);
+    dynamicPaint_doTiles(surface,
+                         TILE_PAINTED,
+                         0,
+                         TILES_READ_NEIGHBORS | TILES_UPDATE_FLAGS,
+                         prevPoint,
+                         dynamic_paint_effect_shrink_cb,
+                         &data);
   }
 
   /*
@@ -5525,9 +5917,6 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
     const size_t point_locks_size = (sData->total_points / 8) + 1;
     uint8_t *point_locks = MEM_callocN(sizeof(*point_locks) * point_locks_size, __func__);
 
-    /* Copy current surface to the previous points array to read unmodified values */
-    memcpy(prevPoint, sData->type_data, sData->total_points * sizeof(struct PaintPoint));
-
     DynamicPaintEffectData data = {
         .surface = surface,
         .prevPoint = prevPoint,
@@ -5535,11 +5924,9 @@ static void dynamicPaint_doEffectStep(DynamicPaintSurface *surface,
         .force = force,
         .point_locks = point_locks,
     };
-    TaskParallelSettings settings;
-    BLI_parallel_range_settings_defaults(&settings);
-    settings.use_threading = (sData->total_points > 1000);
-    BLI_task_parallel_range(
-        0, sData->total_points, &data, dynamic_paint_effect_drip_cb, &settings);
+    /* Only wet points drip, the tiles they drip to are flagged by the callback. */
+    dynamicPaint_doTiles(
+        surface, TILE_WET, 0, 0, prevPoint, dynamic_paint_effect_drip_cb, &data);
 
     MEM_freeN(point_locks);
   }
@@ -5603,6 +5990,11 @@ static void dynamic_paint_border_cb(void *__restrict userdata,
   }
 
   pPoint->wetness = mix_wetness / numOfNeighs;
+
+  const uint8_t flags = dynamicPaint_getPointFlags(pPoint);
+  if (flags) {
+    dynamicPaint_markTile(sData, index, flags);
+  }
 }
 
 static void dynamicPaint_doBorderStep(DynamicPaintSurface *surface)
@@ -6222,11 +6614,10 @@ static int dynamicPaint_doStep(Depsgraph *depsgraph,
         .surface = surface,
         .timescale = timescale,
     };
-    TaskParallelSettings settings;
-    BLI_parallel_range_settings_defaults(&settings);
-    settings.use_threading = (sData->total_points > 1000);
-    BLI_task_parallel_range(
-        0, sData->total_points, &data, dynamic_paint_surface_pre_step_cb, &settings);
+    /* Drying only changes wet paint, dissolving any paint. */
+    const uint8_t flags = (surface->flags & MOD_DPAINT_DISSOLVE) ? TILE_PAINTED : TILE_WET;
+    dynamicPaint_doTiles(
+        surface, flags, 0, TILES_UPDATE_FLAGS, NULL, dynamic_paint_surface_pre_step_cb, &data);
   }
 
   /*
@@ -6396,6 +6787,7 @@ int dynamicPaint_calculateFrame(DynamicPaintSurface *surface,
 
   /* update bake data */
   dynamicPaint_generateBakeData(surface, depsgraph, cObject);
+  dynamicPaint_updateTileData(surface);
 
   /* don't do substeps for first frame */
   if (surface->substeps && (frame != surface->start_frame)) {
@@ -272,6 +272,23 @@ void BKE_effector_relations_free(ListBase *lb)
   }
 }
 
+/* Effectors with noise share the random number generator of their field, and particles
+ * affecting their own system read particles while they are updated. */
+bool BKE_effectors_support_threading(ListBase *effectors, ParticleSystem *psys_updated)
+{
+  if (effectors) {
+    LISTBASE_FOREACH (EffectorCache *, eff, effectors) {
+      if (eff->pd->f_noise > 0.0f) {
+        return false;
+      }
+      if (psys_updated && eff->psys == psys_updated) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 /* Create effective list of effectors from relations built beforehand. */
 ListBase *BKE_effectors_create(Depsgraph *depsgraph,
                                Object *ob_src,
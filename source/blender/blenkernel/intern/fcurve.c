@@ -1448,6 +1448,182 @@ static void berekeny(float f1, float f2, float f3, float f4, float *o, int b)
   }
 }
 
+/* Value of the Bezier segment (after correct_bezpart()) at the given frame. */
+static float fcurve_eval_bezier(
+    float evaltime, float x1, float x2, float x3, float x4, float y1, float y2, float y3, float y4)
+{
+  float opl[32];
+
+  /* try to get a value for this position - if failure, try another set of points */
+  if (!findzero(evaltime, x1, x2, x3, x4, opl)) {
+    if (G.debug & G_DEBUG) {
+      printf("    ERROR: findzero() failed at %f with %f %f %f %f\n", evaltime, x1, x2, x3, x4);
+    }
+    return 0.0;
+  }
+
+  berekeny(y1, y2, y3, y4, opl, 1);
+  return opl[0];
+}
+
+/* -------------------------- */
+
+/* Bezier segments of many F-Curves, gathered to be solved together, see evaluate_fcurves(). */
+#define FCURVE_BEZIER_BATCH_SIZE 64
+
+typedef struct FCurveBezierBatch {
+  int len;
+  /* Control points of the segments, one array per point. */
+  float x[4][FCURVE_BEZIER_BATCH_SIZE];
+  float y[4][FCURVE_BEZIER_BATCH_SIZE];
+  float evaltime[FCURVE_BEZIER_BATCH_SIZE];
+  /* Index of the F-Curve the segment belongs to, in the arrays given to evaluate_fcurves(). */
+  int index[FCURVE_BEZIER_BATCH_SIZE];
+} FCurveBezierBatch;
+
+static void fcurve_bezier_batch_add(FCurveBezierBatch *batch,
+                                    const float evaltime,
+                                    const float v1[2],
+                                    const float v2[2],
+                                    const float v3[2],
+                                    const float v4[2])
+{
+  BLI_assert(batch->len < FCURVE_BEZIER_BATCH_SIZE);
+  const int i = batch->len++;
+  batch->x[0][i] = v1[0];
+  batch->x[1][i] = v2[0];
+  batch->x[2][i] = v3[0];
+  batch->x[3][i] = v4[0];
+  batch->y[0][i] = v1[1];
+  batch->y[1][i] = v2[1];
+  batch->y[2][i] = v3[1];
+  batch->y[3][i] = v4[1];
+  batch->evaltime[i] = evaltime;
+}
+
+#ifdef __SSE2__
+BLI_INLINE __m128 fcurve_bezier_select_ps(const __m128 mask, const __m128 a, const __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/**
+ * Solve four segments at once. Instead of the closed form cubic root of findzero(), the frame
+ * polynomial is solved with Newton iterations, falling back to bisection when a step leaves the
+ * interval known to contain the root. Within a segment the frame only increases, so the root is
+ * unique. Returns a bit per segment that converged, the other ones are solved by findzero().
+ */
+static int fcurve_bezier_batch_solve_sse2(const FCurveBezierBatch *batch,
+                                          const int i,
+                                          float r_values[4])
+{
+  /* Same coefficients as findzero() and berekeny(). */
+  const __m128 three = _mm_set1_ps(3.0f);
+  const __m128 q0 = _mm_loadu_ps(&batch->x[0][i]);
+  const __m128 q1 = _mm_loadu_ps(&batch->x[1][i]);
+  const __m128 q2 = _mm_loadu_ps(&batch->x[2][i]);
+  const __m128 q3 = _mm_loadu_ps(&batch->x[3][i]);
+  const __m128 c0 = _mm_sub_ps(q0, _mm_loadu_ps(&batch->evaltime[i]));
+  const __m128 c1 = _mm_mul_ps(three, _mm_sub_ps(q1, q0));
+  const __m128 c2 = _mm_mul_ps(three, _mm_add_ps(_mm_sub_ps(q0, _mm_add_ps(q1, q1)), q2));
+  const __m128 c3 = _mm_add_ps(_mm_sub_ps(q3, q0), _mm_mul_ps(three, _mm_sub_ps(q1, q2)));
+  /* Derivative coefficients. */
+  const __m128 dc2 = _mm_add_ps(c2, c2);
+  const __m128 dc3 = _mm_mul_ps(three, c3);
+
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 half = _mm_set1_ps(0.5f);
+  __m128 lo = zero;
+  __m128 hi = _mm_set1_ps(1.0f);
+
+  /* Start from linear interpolation between the keyframes. */
+  __m128 t = _mm_div_ps(c0, _mm_sub_ps(q0, q3));
+  t = fcurve_bezier_select_ps(_mm_and_ps(_mm_cmpgt_ps(t, lo), _mm_cmplt_ps(t, hi)), t, half);
+
+  for (int iter = 0; iter < 8; iter++) {
+    const __m128 f = _mm_add_ps(
+        _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, t), c2), t), c1), t), c0);
+    const __m128 df = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(dc3, t), dc2), t), c1);
+
+    /* Shrink the interval around the root. */
+    const __m128 below = _mm_cmplt_ps(f, zero);
+    lo = fcurve_bezier_select_ps(below, t, lo);
+    hi = fcurve_bezier_select_ps(below, hi, t);
+
+    /* A step out of the interval (or a division by zero) bisects instead. The interval includes
+     * its bounds, as one of them is the root once converged. */
+    const __m128 t_newton = _mm_sub_ps(t, _mm_div_ps(f, df));
+    const __m128 inside = _mm_and_ps(_mm_cmpge_ps(t_newton, lo), _mm_cmple_ps(t_newton, hi));
+    t = fcurve_bezier_select_ps(inside, t_newton, _mm_mul_ps(_mm_add_ps(lo, hi), half));
+  }
+
+  /* Converged when the last Newton step is small, which is then applied too. */
+  const __m128 f = _mm_add_ps(
+      _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, t), c2), t), c1), t), c0);
+  const __m128 df = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(dc3, t), dc2), t), c1);
+  const __m128 step = _mm_div_ps(f, df);
+  const __m128 step_abs = _mm_andnot_ps(_mm_set1_ps(-0.0f), step);
+  const int converged = _mm_movemask_ps(_mm_cmple_ps(step_abs, _mm_set1_ps(1e-5f)));
+  t = _mm_sub_ps(t, step);
+
+  const __m128 f1 = _mm_loadu_ps(&batch->y[0][i]);
+  const __m128 f2 = _mm_loadu_ps(&batch->y[1][i]);
+  const __m128 f3 = _mm_loadu_ps(&batch->y[2][i]);
+  const __m128 f4 = _mm_loadu_ps(&batch->y[3][i]);
+  const __m128 d1 = _mm_mul_ps(three, _mm_sub_ps(f2, f1));
+  const __m128 d2 = _mm_mul_ps(three, _mm_add_ps(_mm_sub_ps(f1, _mm_add_ps(f2, f2)), f3));
+  const __m128 d3 = _mm_add_ps(_mm_sub_ps(f4, f1), _mm_mul_ps(three, _mm_sub_ps(f2, f3)));
+  const __m128 value = _mm_add_ps(
+      _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(d3, t), d2), t), d1), t), f1);
+  _mm_storeu_ps(r_values, value);
+
+  return converged;
+}
+#endif /* __SSE2__ */
+
+static float fcurve_bezier_batch_eval(const FCurveBezierBatch *batch, const int i)
+{
+  return fcurve_eval_bezier(batch->evaltime[i],
+                            batch->x[0][i],
+                            batch->x[1][i],
+                            batch->x[2][i],
+                            batch->x[3][i],
+                            batch->y[0][i],
+                            batch->y[1][i],
+                            batch->y[2][i],
+                            batch->y[3][i]);
+}
+
+/* Solve the gathered segments, storing the values of their F-Curves. */
+static void fcurve_bezier_batch_solve(FCurveBezierBatch *batch, FCurve **fcurves, float *r_values)
+{
+  int i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= batch->len; i += 4) {
+    float values[4];
+    const int converged = fcurve_bezier_batch_solve_sse2(batch, i, values);
+    for (int j = 0; j < 4; j++) {
+      r_values[batch->index[i + j]] = (converged & (1 << j)) ?
+                                          values[j] :
+                                          fcurve_bezier_batch_eval(batch, i + j);
+    }
+  }
+#endif
+  for (; i < batch->len; i++) {
+    r_values[batch->index[i]] = fcurve_bezier_batch_eval(batch, i);
+  }
+
+  for (i = 0; i < batch->len; i++) {
+    const int index = batch->index[i];
+    FCurve *fcu = fcurves[index];
+    if (fcu->flag & FCURVE_INT_VALUES) {
+      r_values[index] = floorf(r_values[index] + 0.5f);
+    }
+    fcu->curval = r_values[index]; /* debug display only, not thread safe! */
+  }
+  batch->len = 0;
+}
+
 /* -------------------------- */
 
 static float fcurve_eval_keyframes_extrapolate(
@@ -1497,18 +1673,16 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
+/**
+ * Find the keyframe that \a evaltime occurs before, like #binarysearch_bezt_index_ex().
+ *
+ * When given, \a segment_cache stores the keyframe found last. It is checked first together with
+ * the next one, so the keyframes don't need to be searched every frame during playback.
+ */
+static int fcurve_eval_keyframes_find(
+    FCurve *fcu, BezTriple *bezts, float evaltime, int *segment_cache, bool *r_exact)
 {
-  const float eps = 1.e-8f;
-  BezTriple *bezt, *prevbezt;
-  unsigned int a;
-
-  /* evaltime occurs somewhere in the middle of the curve */
-  bool exact = false;
-
-  /* Use binary search to find appropriate keyframes...
-   *
-   * The threshold here has the following constraints:
+  /* The threshold here has the following constraints:
    * - 0.001 is too coarse:
    *   We get artifacts with 2cm driver movements at 1BU = 1m (see T40332)
    *
@@ -1516,7 +1690,43 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
    *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
    *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
    */
-  a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+  const float threshold = 0.0001f;
+
+  if (segment_cache != NULL) {
+    const int a_end = min_ii(*segment_cache + 2, fcu->totvert);
+    for (int a = max_ii(*segment_cache, 1); a < a_end; a++) {
+      /* Strictly between the keyframes, as the binary search would find it. */
+      if ((evaltime - bezts[a - 1].vec[1][0]) > threshold &&
+          (bezts[a].vec[1][0] - evaltime) > threshold) {
+        *segment_cache = a;
+        *r_exact = false;
+        return a;
+      }
+    }
+  }
+
+  const int a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, threshold, r_exact);
+  if (segment_cache != NULL) {
+    *segment_cache = a;
+  }
+  return a;
+}
+
+static float fcurve_eval_keyframes_interpolate(FCurve *fcu,
+                                               BezTriple *bezts,
+                                               float evaltime,
+                                               int *segment_cache,
+                                               FCurveBezierBatch *batch)
+{
+  const float eps = 1.e-8f;
+  BezTriple *bezt, *prevbezt;
+  unsigned int a;
+
+  /* evaltime occurs somewhere in the middle of the curve */
+  bool exact = false;
+
+  /* Use binary search to find appropriate keyframes... */
+  a = fcurve_eval_keyframes_find(fcu, bezts, evaltime, segment_cache, &exact);
   bezt = bezts + a;
 
   if (exact) {
@@ -1566,7 +1776,7 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
   switch (prevbezt->ipo) {
     /* interpolation ...................................... */
     case BEZT_IPO_BEZ: {
-      float v1[2], v2[2], v3[2], v4[2], opl[32];
+      float v1[2], v2[2], v3[2], v4[2];
 
       /* bezier interpolation */
       /* (v1, v2) are the first keyframe and its 2nd handle */
@@ -1590,21 +1800,12 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
       /* adjust handles so that they don't overlap (forming a loop) */
       correct_bezpart(v1, v2, v3, v4);
 
-      /* try to get a value for this position - if failure, try another set of points */
-      if (!findzero(evaltime, v1[0], v2[0], v3[0], v4[0], opl)) {
-        if (G.debug & G_DEBUG) {
-          printf("    ERROR: findzero() failed at %f with %f %f %f %f\n",
-                 evaltime,
-                 v1[0],
-                 v2[0],
-                 v3[0],
-                 v4[0]);
-        }
-        return 0.0;
+      if (batch != NULL) {
+        /* Solved together with the segments of other curves, the value is set later. */
+        fcurve_bezier_batch_add(batch, evaltime, v1, v2, v3, v4);
+        return 0.0f;
       }
-
-      berekeny(v1[1], v2[1], v3[1], v4[1], opl, 1);
-      return opl[0];
+      return fcurve_eval_bezier(evaltime, v1[0], v2[0], v3[0], v4[0], v1[1], v2[1], v3[1], v4[1]);
     }
     case BEZT_IPO_LIN:
       /* linear - simply linearly interpolate between values of the two keyframes */
@@ -1759,7 +1960,11 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
 }
 
 /* Calculate F-Curve value for 'evaltime' using BezTriple keyframes */
-static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
+static float fcurve_eval_keyframes(FCurve *fcu,
+                                   BezTriple *bezts,
+                                   float evaltime,
+                                   int *segment_cache,
+                                   FCurveBezierBatch *batch)
 {
   if (evaltime <= bezts->vec[1][0]) {
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, 0, +1);
@@ -1770,7 +1975,7 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, fcu->totvert - 1, -1);
   }
 
-  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime);
+  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime, segment_cache, batch);
 }
 
 /* Calculate F-Curve value for 'evaltime' using FPoint samples */
@@ -1816,7 +2021,7 @@ static float fcurve_eval_samples(FCurve *fcu, FPoint *fpts, float evaltime)
 /* Evaluate and return the value of the given F-Curve at the specified frame ("evaltime")
  * Note: this is also used for drivers
  */
-static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue)
+static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue, int *segment_cache)
 {
   float devaltime;
 
@@ -1833,7 +2038,7 @@ static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue)
    *   F-Curve modifier on the stack requested the curve to be evaluated at
    */
   if (fcu->bezt) {
-    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime);
+    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime, segment_cache, NULL);
   }
   else if (fcu->fpt) {
     cvalue = fcurve_eval_samples(fcu, fcu->fpt, devaltime);
@@ -1857,7 +2062,59 @@ float evaluate_fcurve(FCurve *fcu, float evaltime)
 {
   BLI_assert(fcu->driver == NULL);
 
-  return evaluate_fcurve_ex(fcu, evaltime, 0.0);
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, NULL);
+}
+
+/**
+ * Evaluate many F-Curves at the same frame, storing their values in \a r_values.
+ * NULL items of \a fcurves are skipped. Curves with drivers are not supported.
+ *
+ * \param segment_cache: The keyframe each F-Curve was evaluated at last, zero initialized.
+ * Keeping it between frames avoids searching the keyframes during playback.
+ *
+ * Bezier segments of curves without modifiers are gathered and solved together.
+ */
+void evaluate_fcurves(FCurve **fcurves,
+                      int *segment_cache,
+                      float *r_values,
+                      const int fcurves_num,
+                      const float evaltime)
+{
+  FCurveBezierBatch batch;
+  batch.len = 0;
+
+  for (int i = 0; i < fcurves_num; i++) {
+    FCurve *fcu = fcurves[i];
+    if (fcu == NULL) {
+      continue;
+    }
+    BLI_assert(fcu->driver == NULL);
+
+    if (fcu->bezt == NULL || !BLI_listbase_is_empty(&fcu->modifiers)) {
+      r_values[i] = evaluate_fcurve_ex(fcu, evaltime, 0.0f, &segment_cache[i]);
+      fcu->curval = r_values[i]; /* debug display only, not thread safe! */
+      continue;
+    }
+
+    const int batch_len = batch.len;
+    float cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, evaltime, &segment_cache[i], &batch);
+    if (batch.len != batch_len) {
+      /* The value is set once the batch is solved. */
+      batch.index[batch_len] = i;
+      if (batch.len == FCURVE_BEZIER_BATCH_SIZE) {
+        fcurve_bezier_batch_solve(&batch, fcurves, r_values);
+      }
+      continue;
+    }
+
+    if (fcu->flag & FCURVE_INT_VALUES) {
+      cvalue = floorf(cvalue + 0.5f);
+    }
+    r_values[i] = cvalue;
+    fcu->curval = cvalue; /* debug display only, not thread safe! */
+  }
+
+  fcurve_bezier_batch_solve(&batch, fcurves, r_values);
 }
 
 float evaluate_fcurve_only_curve(FCurve *fcu, float evaltime)
@@ -1865,7 +2122,7 @@ float evaluate_fcurve_only_curve(FCurve *fcu, float evaltime)
   /* Can be used to evaluate the (keyframed) fcurve only.
    * Also works for driver-fcurves when the driver itself is not relevant.
    * E.g. when inserting a keyframe in a driver fcurve. */
-  return evaluate_fcurve_ex(fcu, evaltime, 0.0);
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, NULL);
 }
 
 float evaluate_fcurve_driver(PathResolvedRNA *anim_rna,
@@ -1912,7 +2169,7 @@ float evaluate_fcurve_driver(PathResolvedRNA *anim_rna,
     }
   }
 
-  return evaluate_fcurve_ex(fcu, evaltime, cvalue);
+  return evaluate_fcurve_ex(fcu, evaltime, cvalue, NULL);
 }
 
 /* Checks if the curve has valid keys, drivers or modifiers that produce an actual curve. */
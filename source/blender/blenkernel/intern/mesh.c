@@ -1597,6 +1597,42 @@ void BKE_mesh_vert_coords_apply(Mesh *mesh, const float (*vert_coords)[3])
   mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
 }
 
+/**
+ * Same as #BKE_mesh_vert_coords_apply, also calculating the vertex and poly normals from the
+ * coordinates array, so the positions aren't read back from the #MVert array. Poly normals
+ * are stored in the #CD_NORMAL layer, which is added when needed.
+ */
+void BKE_mesh_vert_coords_apply_with_normals(Mesh *mesh, const float (*vert_coords)[3])
+{
+  float(*poly_nors)[3] = CustomData_duplicate_referenced_layer(
+      &mesh->pdata, CD_NORMAL, mesh->totpoly);
+  if (poly_nors == NULL) {
+    poly_nors = CustomData_add_layer(&mesh->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh->totpoly);
+  }
+  float(*vert_nors)[3] = MEM_malloc_arrayN((size_t)mesh->totvert, sizeof(*vert_nors), __func__);
+
+  BKE_mesh_calc_normals_poly_coords(vert_coords,
+                                    mesh->totvert,
+                                    mesh->mloop,
+                                    mesh->mpoly,
+                                    mesh->totloop,
+                                    mesh->totpoly,
+                                    poly_nors,
+                                    vert_nors);
+
+  /* This will just return the pointer if it wasn't a referenced layer. */
+  MVert *mv = CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
+  mesh->mvert = mv;
+  for (int i = 0; i < mesh->totvert; i++, mv++) {
+    copy_v3_v3(mv->co, vert_coords[i]);
+    normal_float_to_short_v3(mv->no, vert_nors[i]);
+  }
+  MEM_freeN(vert_nors);
+
+  mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+  mesh->runtime.cd_dirty_poly &= ~CD_MASK_NORMAL;
+}
+
 void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
                                           const float (*vert_coords)[3],
                                           const float mat[4][4])
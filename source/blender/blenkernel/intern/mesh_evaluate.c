@@ -213,12 +213,21 @@ void BKE_mesh_calc_normals_mapping_ex(MVert *mverts,
 typedef struct MeshCalcNormalsData {
   const MPoly *mpolys;
   const MLoop *mloop;
+  /* Either the vertices (which get the resulting normals too), or a contiguous array of
+   * coordinates, avoiding to stride over the other #MVert members. */
   MVert *mverts;
+  const float (*vert_coords)[3];
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
 } MeshCalcNormalsData;
 
+BLI_INLINE const float *mesh_calc_normals_vert_co(const MeshCalcNormalsData *data,
+                                                  const uint vidx)
+{
+  return data->vert_coords ? data->vert_coords[vidx] : data->mverts[vidx].co;
+}
+
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
                                       const int pidx,
                                       const TaskParallelTLS *__restrict UNUSED(tls))
@@ -226,7 +235,13 @@ static void mesh_calc_normals_poly_cb(void *__restrict userdata,
   MeshCalcNormalsData *data = userdata;
   const MPoly *mp = &data->mpolys[pidx];
 
-  BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
+  if (data->vert_coords) {
+    BKE_mesh_calc_poly_normal_coords(
+        mp, data->mloop + mp->loopstart, data->vert_coords, data->pnors[pidx]);
+  }
+  else {
+    BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
+  }
 }
 
 static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
@@ -236,7 +251,6 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   MeshCalcNormalsData *data = userdata;
   const MPoly *mp = &data->mpolys[pidx];
   const MLoop *ml = &data->mloop[mp->loopstart];
-  const MVert *mverts = data->mverts;
 
   float pnor_temp[3];
   float *pnor = data->pnors ? data->pnors[pidx] : pnor_temp;
@@ -250,13 +264,13 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   /* inline version of #BKE_mesh_calc_poly_normal, also does edge-vectors */
   {
     int i_prev = nverts - 1;
-    const float *v_prev = mverts[ml[i_prev].v].co;
+    const float *v_prev = mesh_calc_normals_vert_co(data, ml[i_prev].v);
     const float *v_curr;
 
     zero_v3(pnor);
     /* Newell's Method */
     for (i = 0; i < nverts; i++) {
-      v_curr = mverts[ml[i].v].co;
+      v_curr = mesh_calc_normals_vert_co(data, ml[i].v);
       add_newell_cross_v3_v3v3(pnor, v_prev, v_curr);
 
       /* Unrelated to normalize, calculate edge-vector */
@@ -299,15 +313,63 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
 {
   MeshCalcNormalsData *data = userdata;
 
-  MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
-    normalize_v3_v3(no, mv->co);
+    normalize_v3_v3(no, mesh_calc_normals_vert_co(data, (uint)vidx));
+  }
+
+  if (data->mverts) {
+    normal_float_to_short_v3(data->mverts[vidx].no, no);
+  }
+}
+
+static void mesh_calc_normals_poly_vnors(MeshCalcNormalsData *data,
+                                         const TaskParallelSettings *settings,
+                                         int numVerts,
+                                         int numLoops,
+                                         int numPolys,
+                                         float (*r_vertnors)[3])
+{
+  const MLoop *mloop = data->mloop;
+  float(*vnors)[3] = r_vertnors;
+  float(*lnors_weighted)[3] = MEM_malloc_arrayN(
+      (size_t)numLoops, sizeof(*lnors_weighted), __func__);
+  bool free_vnors = false;
+
+  /* first go through and calculate normals for all the polys */
+  if (vnors == NULL) {
+    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
+    free_vnors = true;
+  }
+  else {
+    memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
+  }
+
+  data->lnors_weighted = lnors_weighted;
+  data->vnors = vnors;
+
+  /* Compute poly normals, and prepare weighted loop normals. */
+  BLI_task_parallel_range(0, numPolys, data, mesh_calc_normals_poly_prepare_cb, settings);
+
+  /* Actually accumulate weighted loop normals into vertex ones. */
+  /* Unfortunately, not possible to thread that
+   * (not in a reasonable, totally lock- and barrier-free fashion),
+   * since several loops will point to the same vertex... */
+  for (int lidx = 0; lidx < numLoops; lidx++) {
+    add_v3_v3(vnors[mloop[lidx].v], lnors_weighted[lidx]);
   }
 
-  normal_float_to_short_v3(mv->no, no);
+  /* Normalize and validate computed vertex normals. */
+  BLI_task_parallel_range(0, numVerts, data, mesh_calc_normals_poly_finalize_cb, settings);
+
+  if (free_vnors) {
+    MEM_freeN(vnors);
+  }
+  MEM_freeN(lnors_weighted);
+  data->lnors_weighted = NULL;
+  data->vnors = NULL;
 }
 
 void BKE_mesh_calc_normals_poly(MVert *mverts,
@@ -326,62 +388,60 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
   BLI_parallel_range_settings_defaults(&settings);
   settings.min_iter_per_thread = 1024;
 
+  MeshCalcNormalsData data = {
+      .mpolys = mpolys,
+      .mloop = mloop,
+      .mverts = mverts,
+      .pnors = pnors,
+  };
+
   if (only_face_normals) {
     BLI_assert((pnors != NULL) || (numPolys == 0));
     BLI_assert(r_vertnors == NULL);
 
-    MeshCalcNormalsData data = {
-        .mpolys = mpolys,
-        .mloop = mloop,
-        .mverts = mverts,
-        .pnors = pnors,
-    };
-
     BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_cb, &settings);
     return;
   }
 
-  float(*vnors)[3] = r_vertnors;
-  float(*lnors_weighted)[3] = MEM_malloc_arrayN(
-      (size_t)numLoops, sizeof(*lnors_weighted), __func__);
-  bool free_vnors = false;
+  mesh_calc_normals_poly_vnors(&data, &settings, numVerts, numLoops, numPolys, r_vertnors);
+}
 
-  /* first go through and calculate normals for all the polys */
-  if (vnors == NULL) {
-    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
-    free_vnors = true;
-  }
-  else {
-    memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
-  }
+/**
+ * Same as #BKE_mesh_calc_normals_poly, but reading the positions from a contiguous array of
+ * coordinates (as passed to deform modifiers) and only writing float normals, leaving the
+ * #MVert array untouched.
+ *
+ * \param r_polynors: Optional.
+ * \param r_vertnors: Optional, allowing to only calculate poly normals when NULL.
+ */
+void BKE_mesh_calc_normals_poly_coords(const float (*vert_coords)[3],
+                                       int numVerts,
+                                       const MLoop *mloop,
+                                       const MPoly *mpolys,
+                                       int numLoops,
+                                       int numPolys,
+                                       float (*r_polynors)[3],
+                                       float (*r_vertnors)[3])
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
 
   MeshCalcNormalsData data = {
       .mpolys = mpolys,
       .mloop = mloop,
-      .mverts = mverts,
-      .pnors = pnors,
-      .lnors_weighted = lnors_weighted,
-      .vnors = vnors,
+      .vert_coords = vert_coords,
+      .pnors = r_polynors,
   };
 
-  /* Compute poly normals, and prepare weighted loop normals. */
-  BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
-
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+  if (r_vertnors == NULL) {
+    if (r_polynors != NULL) {
+      BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_cb, &settings);
+    }
+    return;
   }
 
-  /* Normalize and validate computed vertex normals. */
-  BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
-
-  if (free_vnors) {
-    MEM_freeN(vnors);
-  }
-  MEM_freeN(lnors_weighted);
+  mesh_calc_normals_poly_vnors(&data, &settings, numVerts, numLoops, numPolys, r_vertnors);
 }
 
 void BKE_mesh_ensure_normals(Mesh *mesh)
@@ -774,12 +834,10 @@ void BKE_lnor_space_custom_normal_to_data(MLoopNorSpace *lnor_space,
   }
 }
 
-#define LOOP_SPLIT_TASK_BLOCK_SIZE 1024
-
 typedef struct LoopSplitTaskData {
-  /* Specific to each instance (each task). */
+  /* Specific to each instance (each fan). */
 
-  /** We have to create those outside of tasks, since afaik memarena is not threadsafe. */
+  /** We have to create those outside of threads, since afaik memarena is not threadsafe. */
   MLoopNorSpace *lnor_space;
   float (*lnor)[3];
   const MLoop *ml_curr;
@@ -790,11 +848,9 @@ typedef struct LoopSplitTaskData {
   const int *e2l_prev;
   int mp_index;
 
-  /** This one is special, it's owned and managed by worker tasks,
+  /** This one is special, it's owned and managed by each thread,
    * avoid to have to create it for each fan! */
   BLI_Stack *edge_vectors;
-
-  char pad_c;
 } LoopSplitTaskData;
 
 typedef struct LoopSplitTaskDataCommon {
@@ -817,118 +873,141 @@ typedef struct LoopSplitTaskDataCommon {
   int numEdges;
   int numLoops;
   int numPolys;
+
+  /** Atomic operations are only needed when actually using threads, avoid their cost otherwise. */
+  bool use_threading;
 } LoopSplitTaskDataCommon;
 
+/* Not enough loops to be worth the whole threading overhead below that amount. */
+#define LOOP_SPLIT_THREADING_MIN_LOOPS 8192
+
+static bool loop_split_use_threading(const int numLoops)
+{
+  return (numLoops >= LOOP_SPLIT_THREADING_MIN_LOOPS) && (BLI_task_scheduler_num_threads() > 1);
+}
+
 #define INDEX_UNSET INT_MIN
 #define INDEX_INVALID -1
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
-static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
-                                 const bool check_angle,
-                                 const float split_angle,
-                                 const bool do_sharp_edges_tag)
+typedef struct EdgesSharpTagData {
+  LoopSplitTaskDataCommon *common_data;
+  /** Number of loops using each edge. */
+  int *edge_users;
+  bool check_angle;
+  float split_angle_cos;
+  bool do_sharp_edges_tag;
+} EdgesSharpTagData;
+
+static void mesh_edges_sharp_tag_loops_cb(void *__restrict userdata,
+                                          const int mp_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
 {
+  EdgesSharpTagData *tag_data = userdata;
+  LoopSplitTaskDataCommon *data = tag_data->common_data;
   const MVert *mverts = data->mverts;
-  const MEdge *medges = data->medges;
   const MLoop *mloops = data->mloops;
-
-  const MPoly *mpolys = data->mpolys;
-
-  const int numEdges = data->numEdges;
-  const int numPolys = data->numPolys;
+  const MPoly *mp = &data->mpolys[mp_index];
 
   float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
-  const float(*polynors)[3] = data->polynors;
-
   int(*edge_to_loops)[2] = data->edge_to_loops;
   int *loop_to_poly = data->loop_to_poly;
+  int *edge_users = tag_data->edge_users;
 
-  BLI_bitmap *sharp_edges = do_sharp_edges_tag ? BLI_BITMAP_NEW(numEdges, __func__) : NULL;
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
 
-  const MPoly *mp;
-  int mp_index;
+    loop_to_poly[ml_curr_index] = mp_index;
 
-  const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    if (loopnors) {
+      normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
+    }
 
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    const MLoop *ml_curr;
-    int *e2l;
-    int ml_curr_index = mp->loopstart;
-    const int ml_last_index = (ml_curr_index + mp->totloop) - 1;
+    /* Only the first two loops using an edge are stored, any other one just makes it sharp.
+     * Their order does not matter, fans are walked the same way whichever loop comes first. */
+    int *users_p = &edge_users[ml_curr->e];
+    const int users = data->use_threading ? atomic_fetch_and_add_int32(users_p, 1) : (*users_p)++;
+    if (users < 2) {
+      edge_to_loops[ml_curr->e][users] = ml_curr_index;
+    }
+  }
+}
 
-    ml_curr = &mloops[ml_curr_index];
+static void mesh_edges_sharp_tag_edges_cb(void *__restrict userdata,
+                                          const int me_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EdgesSharpTagData *tag_data = userdata;
+  LoopSplitTaskDataCommon *data = tag_data->common_data;
+  const MLoop *mloops = data->mloops;
+  const MPoly *mpolys = data->mpolys;
+  const float(*polynors)[3] = data->polynors;
+  const int *loop_to_poly = data->loop_to_poly;
+  MEdge *me = (MEdge *)&data->medges[me_index];
+  int *e2l = data->edge_to_loops[me_index];
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
-      e2l = edge_to_loops[ml_curr->e];
+  switch (tag_data->edge_users[me_index]) {
+    case 0:
+      /* Loose edge, both values stay set to 0. */
+      return;
+    case 2:
+      break;
+    default:
+      /* Boundary edge, or more than two loops using this edge, always sharp. */
+      e2l[1] = INDEX_INVALID;
+      return;
+  }
 
-      loop_to_poly[ml_curr_index] = mp_index;
+  const int mp_index_a = loop_to_poly[e2l[0]];
+  const int mp_index_b = loop_to_poly[e2l[1]];
+  const bool is_angle_sharp = (tag_data->check_angle &&
+                               dot_v3v3(polynors[mp_index_a], polynors[mp_index_b]) <
+                                   tag_data->split_angle_cos);
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
+  /* An edge is sharp if it is tagged as such, or one of its faces is not smooth,
+   * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
+   * same vertex, or angle between both its polys' normals is above split_angle value.
+   */
+  if (!(mpolys[mp_index_a].flag & ME_SMOOTH) || !(mpolys[mp_index_b].flag & ME_SMOOTH) ||
+      (me->flag & ME_SHARP) || mloops[e2l[0]].v == mloops[e2l[1]].v || is_angle_sharp) {
+    e2l[1] = INDEX_INVALID;
 
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = ml_curr_index;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = (mp->flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
-      }
-      else if (e2l[1] == INDEX_UNSET) {
-        const bool is_angle_sharp = (check_angle &&
-                                     dot_v3v3(polynors[loop_to_poly[e2l[0]]], polynors[mp_index]) <
-                                         split_angle_cos);
-
-        /* Second loop using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
-         * same vertex, or angle between both its polys' normals is above split_angle value.
-         */
-        if (!(mp->flag & ME_SMOOTH) || (medges[ml_curr->e].flag & ME_SHARP) ||
-            ml_curr->v == mloops[e2l[0]].v || is_angle_sharp) {
-          /* Note: we are sure that loop != 0 here ;) */
-          e2l[1] = INDEX_INVALID;
-
-          /* We want to avoid tagging edges as sharp when it is already defined as such by
-           * other causes than angle threshold... */
-          if (do_sharp_edges_tag && is_angle_sharp) {
-            BLI_BITMAP_SET(sharp_edges, ml_curr->e, true);
-          }
-        }
-        else {
-          e2l[1] = ml_curr_index;
-        }
-      }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two loops using this edge, tag as sharp if not yet done. */
-        e2l[1] = INDEX_INVALID;
-
-        /* We want to avoid tagging edges as sharp when it is already defined as such by
-         * other causes than angle threshold... */
-        if (do_sharp_edges_tag) {
-          BLI_BITMAP_SET(sharp_edges, ml_curr->e, false);
-        }
-      }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
+    if (tag_data->do_sharp_edges_tag && is_angle_sharp) {
+      me->flag |= ME_SHARP;
     }
   }
+}
 
-  /* If requested, do actual tagging of edges as sharp in another loop. */
-  if (do_sharp_edges_tag) {
-    MEdge *me;
-    int me_index;
-    for (me = (MEdge *)medges, me_index = 0; me_index < numEdges; me++, me_index++) {
-      if (BLI_BITMAP_TEST(sharp_edges, me_index)) {
-        me->flag |= ME_SHARP;
-      }
-    }
+static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
+                                 const bool check_angle,
+                                 const float split_angle,
+                                 const bool do_sharp_edges_tag)
+{
+  EdgesSharpTagData tag_data = {
+      .common_data = data,
+      .edge_users = MEM_calloc_arrayN((size_t)data->numEdges, sizeof(int), __func__),
+      .check_angle = check_angle,
+      .split_angle_cos = check_angle ? cosf(split_angle) : -1.0f,
+      .do_sharp_edges_tag = do_sharp_edges_tag,
+  };
 
-    MEM_freeN(sharp_edges);
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = data->use_threading;
+  settings.min_iter_per_thread = 1024;
+
+  /* Map edges to the loops using them. */
+  BLI_task_parallel_range(0, data->numPolys, &tag_data, mesh_edges_sharp_tag_loops_cb, &settings);
+
+  /* Check which edges are actually smooth. */
+  BLI_task_parallel_range(0, data->numEdges, &tag_data, mesh_edges_sharp_tag_edges_cb, &settings);
+
+  MEM_freeN(tag_data.edge_users);
 }
 
 /**
@@ -969,6 +1048,7 @@ void BKE_edges_sharp_from_angle_set(const struct MVert *mverts,
       .polynors = polynors,
       .numEdges = numEdges,
       .numPolys = numPolys,
+      .use_threading = loop_split_use_threading(numLoops),
   };
 
   mesh_edges_sharp_tag(&common_data, true, split_angle, true);
@@ -1300,81 +1380,64 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
   }
 }
 
-static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
-                                 LoopSplitTaskData *data,
-                                 BLI_Stack *edge_vectors)
+/**
+ * Tag a loop as walked from given poly, unless it was already walked.
+ * \return The poly from which the loop was first walked.
+ */
+BLI_INLINE int loop_split_fan_walker_tag(const LoopSplitTaskDataCommon *common_data,
+                                         int *fan_walkers,
+                                         const int ml_index,
+                                         const int mp_index)
 {
-  BLI_assert(data->ml_curr);
-  if (data->e2l_prev) {
-    BLI_assert((edge_vectors == NULL) || BLI_stack_is_empty(edge_vectors));
-    data->edge_vectors = edge_vectors;
-    split_loop_nor_fan_do(common_data, data);
+  if (common_data->use_threading) {
+    const int mp_walker_index = atomic_cas_int32(&fan_walkers[ml_index], -1, mp_index);
+    return (mp_walker_index == -1) ? mp_index : mp_walker_index;
   }
-  else {
-    /* No need for edge_vectors for 'single' case! */
-    split_loop_nor_single_do(common_data, data);
+  if (fan_walkers[ml_index] == -1) {
+    fan_walkers[ml_index] = mp_index;
   }
-}
-
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
-{
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
-
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
-    }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
+  return fan_walkers[ml_index];
 }
 
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
- * Needed because cyclic smooth fans have no obvious 'entry point',
- * and yet we need to walk them once, and only once.
+ * Walk the smooth fan around the vertex of given loop (which has a smooth edge), to find whether
+ * it is a cyclic smooth fan (i.e. a fan which has no sharp edge, and so no obvious 'entry point'),
+ * which we need to walk once, and only once.
+ *
+ * Walked loops are tagged with the poly of the walk in \a fan_walkers, a walk stops at loops
+ * walked from a previous poly: that walk goes through the same loops. So fans are only walked
+ * once (or a few times when threads walk the same fan concurrently), and the walk from the
+ * smallest poly always completes. The entry point of a cyclic fan is the loop with the smallest
+ * index, so it does not depend on the order in which loops are checked.
+ *
+ * \return The entry loop of the cyclic smooth fan, or -1 if the fan has a sharp edge or is
+ * walked from a previous poly.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static int loop_split_cyclic_smooth_fan_entry_find(const LoopSplitTaskDataCommon *common_data,
+                                                   int *fan_walkers,
+                                                   const int *e2l_prev,
+                                                   const MLoop *ml_curr,
+                                                   const MLoop *ml_prev,
+                                                   const int ml_curr_index,
+                                                   const int ml_prev_index,
+                                                   const int mp_curr_index)
 {
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
   const MLoop *mlfan_curr;
   /* mlfan_vert_index: the loop of our current edge might not be the loop of our current vertex! */
   int mlfan_curr_index, mlfan_vert_index, mpfan_curr_index;
+  int ml_entry_index = ml_curr_index;
 
   e2lfan_curr = e2l_prev;
   if (IS_EDGE_SHARP(e2lfan_curr)) {
     /* Sharp loop, so not a cyclic smooth fan... */
-    return false;
+    return -1;
   }
 
   mlfan_curr = ml_prev;
@@ -1386,8 +1449,11 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+  if (loop_split_fan_walker_tag(common_data, fan_walkers, ml_curr_index, mp_curr_index) !=
+      mp_curr_index) {
+    /* Already walked from another poly. */
+    return -1;
+  }
 
   while (true) {
     /* Find next loop of the smooth fan. */
@@ -1405,200 +1471,258 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
 
     if (IS_EDGE_SHARP(e2lfan_curr)) {
       /* Sharp loop/edge, so not a cyclic smooth fan... */
-      return false;
+      return -1;
     }
     /* Smooth loop/edge... */
-    else if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
-      return false;
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan. */
+      return ml_entry_index;
     }
-    else {
-      /* ... we can skip it in future, and keep checking the smooth fan. */
-      BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+    if (loop_split_fan_walker_tag(common_data, fan_walkers, mlfan_vert_index, mp_curr_index) <
+        mp_curr_index) {
+      /* ... already walked from a previous poly, we can abort. */
+      return -1;
     }
+    /* ... keep checking the smooth fan. */
+    ml_entry_index = min_ii(ml_entry_index, mlfan_vert_index);
   }
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+typedef struct LoopSplitTLSData {
+  /** Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+  /** Number of fans found when their processing is deferred. */
+  int num_fans;
+} LoopSplitTLSData;
+
+typedef struct LoopSplitFansData {
+  LoopSplitTaskDataCommon *common_data;
+  /** Loops from which a smooth fan (or single loop) is walked. */
+  BLI_bitmap *fan_loops;
+  /** Poly from which each loop was walked looking for cyclic fans (-1 when not walked yet). */
+  int *fan_walkers;
+  /** Entry loops of the cyclic smooth fans, so each is only processed once. */
+  BLI_bitmap *cyclic_fan_entries;
+  /** Pre-allocated lnor spaces, when processing the fans in a second pass. */
+  MLoopNorSpace *lnor_spaces;
+  int lnor_spaces_used;
+} LoopSplitFansData;
+
+static void loop_split_fan_do(LoopSplitFansData *fans_data,
+                              LoopSplitTLSData *tls_data,
+                              const int ml_curr_index,
+                              const int mp_index)
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
-
+  LoopSplitTaskDataCommon *common_data = fans_data->common_data;
   const MLoop *mloops = common_data->mloops;
-  const MPoly *mpolys = common_data->mpolys;
-  const int *loop_to_poly = common_data->loop_to_poly;
-  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_prev_index = (ml_curr_index == mp->loopstart) ?
+                                (mp->loopstart + mp->totloop - 1) :
+                                (ml_curr_index - 1);
+  const MLoop *ml_curr = &mloops[ml_curr_index];
+  const MLoop *ml_prev = &mloops[ml_prev_index];
+  const int *e2l_curr = common_data->edge_to_loops[ml_curr->e];
+  const int *e2l_prev = common_data->edge_to_loops[ml_prev->e];
+
+  LoopSplitTaskData data = {
+      .ml_curr = ml_curr,
+      .ml_prev = ml_prev,
+      .ml_curr_index = ml_curr_index,
+      .mp_index = mp_index,
+  };
 
-  const MPoly *mp;
-  int mp_index;
+  if (common_data->lnors_spacearr) {
+    const int index = common_data->use_threading ?
+                          atomic_fetch_and_add_int32(&fans_data->lnor_spaces_used, 1) :
+                          fans_data->lnor_spaces_used++;
+    data.lnor_space = &fans_data->lnor_spaces[index];
+  }
+
+  if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
+    data.lnor = &common_data->loopnors[ml_curr_index];
+    split_loop_nor_single_do(common_data, &data);
+  }
+  /* We *do not need* to check/tag loops as already computed!
+   * Due to the fact a loop only links to one of its two edges,
+   * a same fan *will never be walked more than once!*
+   * Since we consider edges having neighbor polys with inverted
+   * (flipped) normals as sharp, we are sure that no fan will be skipped,
+   * even only considering the case (sharp curr_edge, smooth prev_edge),
+   * and not the alternative (smooth curr_edge, sharp prev_edge).
+   * All this due/thanks to link between normals and loop ordering (i.e. winding).
+   */
+  else {
+    data.ml_prev_index = ml_prev_index;
+    data.e2l_prev = e2l_prev;
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+    if (common_data->lnors_spacearr) {
+      if (tls_data->edge_vectors == NULL) {
+        tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+      }
+      BLI_assert(BLI_stack_is_empty(tls_data->edge_vectors));
+      data.edge_vectors = tls_data->edge_vectors;
+    }
+    split_loop_nor_fan_do(common_data, &data);
+  }
+}
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+static void loop_split_fan_found(LoopSplitFansData *fans_data,
+                                 LoopSplitTLSData *tls_data,
+                                 const int ml_index,
+                                 const int mp_index)
+{
+  if (fans_data->common_data->lnors_spacearr) {
+    /* Spaces have to be allocated first, process all fans in a second pass. */
+    if (fans_data->common_data->use_threading) {
+      BLI_BITMAP_TEST_AND_SET_ATOMIC(fans_data->fan_loops, ml_index);
+    }
+    else {
+      BLI_BITMAP_ENABLE(fans_data->fan_loops, ml_index);
+    }
+    tls_data->num_fans++;
+  }
+  else {
+    loop_split_fan_do(fans_data, tls_data, ml_index, mp_index);
+  }
+}
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+/**
+ * Find the loops from which smooth fans (or single loops) are walked, and process them directly
+ * when no lnor space is needed.
+ */
+static void loop_split_fans_find_cb(void *__restrict userdata,
+                                    const int mp_index,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitFansData *fans_data = userdata;
+  LoopSplitTLSData *tls_data = tls->userdata_chunk;
+  const LoopSplitTaskDataCommon *common_data = fans_data->common_data;
+  const MLoop *mloops = common_data->mloops;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const MPoly *mp = &common_data->mpolys[mp_index];
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_prev_index = ml_last_index;
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
+  for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+    if (IS_EDGE_SHARP(e2l_curr)) {
+      loop_split_fan_found(fans_data, tls_data, ml_curr_index, mp_index);
+    }
+    /* A smooth edge, we have to check for cyclic smooth fan case.
+     * The entry point of a cyclic smooth fan is only claimed once. */
+    else {
+      const int ml_entry_index = loop_split_cyclic_smooth_fan_entry_find(
+          common_data,
+          fans_data->fan_walkers,
+          edge_to_loops[ml_prev->e],
+          ml_curr,
+          ml_prev,
+          ml_curr_index,
+          ml_prev_index,
+          mp_index);
+      if (ml_entry_index != -1 &&
+          !BLI_BITMAP_TEST_AND_SET_ATOMIC(fans_data->cyclic_fan_entries, ml_entry_index)) {
+        loop_split_fan_found(fans_data, tls_data, ml_entry_index, loop_to_poly[ml_entry_index]);
+      }
     }
-  }
-
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+    ml_prev_index = ml_curr_index;
+  }
+}
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+static void loop_split_fans_process_cb(void *__restrict userdata,
+                                       const int mp_index,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitFansData *fans_data = userdata;
+  const MPoly *mp = &fans_data->common_data->mpolys[mp_index];
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  for (int ml_index = mp->loopstart; ml_index <= ml_last_index; ml_index++) {
+    if (BLI_BITMAP_TEST(fans_data->fan_loops, ml_index)) {
+      loop_split_fan_do(fans_data, tls->userdata_chunk, ml_index, mp_index);
+    }
+  }
+}
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+static void loop_split_fans_find_reduce(const void *__restrict UNUSED(userdata),
+                                        void *__restrict chunk_join,
+                                        void *__restrict chunk)
+{
+  LoopSplitTLSData *join = chunk_join;
+  LoopSplitTLSData *tls_data = chunk;
+  join->num_fans += tls_data->num_fans;
+}
 
-        //              printf("PROCESSING!\n");
+static void loop_split_fans_free(const void *__restrict UNUSED(userdata),
+                                 void *__restrict chunk)
+{
+  LoopSplitTLSData *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+    tls_data->edge_vectors = NULL;
+  }
+}
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+/**
+ * Compute the loop normals (and lnor spaces) of all smooth fans.
+ *
+ * Every fan is walked from a single loop: the one using its first sharp edge, or the one with the
+ * smallest index for cyclic fans. Both can be found from each poly (with atomic tagging of the
+ * loops walked looking for cyclic fans), so this runs as a parallel range over polys, without
+ * generating tasks for each fan. Lnor spaces are allocated
+ * from a non thread-safe memarena, when they are needed all fans are found first, so their spaces
+ * can be allocated at once.
+ */
+static void loop_split_fans_compute(LoopSplitTaskDataCommon *common_data)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+  LoopSplitFansData fans_data = {
+      .common_data = common_data,
+      .fan_loops = lnors_spacearr ? BLI_BITMAP_NEW(common_data->numLoops, __func__) : NULL,
+      .fan_walkers = MEM_malloc_arrayN((size_t)common_data->numLoops, sizeof(int), __func__),
+      .cyclic_fan_entries = BLI_BITMAP_NEW(common_data->numLoops, __func__),
+  };
+  LoopSplitTLSData tls_data = {NULL};
+  copy_vn_i(fans_data.fan_walkers, common_data->numLoops, -1);
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = common_data->use_threading;
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
-    }
+  if (lnors_spacearr) {
+    settings.func_reduce = loop_split_fans_find_reduce;
   }
-
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+  else {
+    settings.func_free = loop_split_fans_free;
   }
+  BLI_task_parallel_range(
+      0, common_data->numPolys, &fans_data, loop_split_fans_find_cb, &settings);
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+  if (lnors_spacearr) {
+    fans_data.lnor_spaces = BLI_memarena_calloc(lnors_spacearr->mem,
+                                                sizeof(MLoopNorSpace) * (size_t)tls_data.num_fans);
+    lnors_spacearr->num_spaces += tls_data.num_fans;
+
+    settings.func_reduce = NULL;
+    settings.func_free = loop_split_fans_free;
+    BLI_task_parallel_range(
+        0, common_data->numPolys, &fans_data, loop_split_fans_process_cb, &settings);
+    BLI_assert(fans_data.lnor_spaces_used == tls_data.num_fans);
   }
-  MEM_freeN(skip_loops);
 
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
-#endif
+  MEM_SAFE_FREE(fans_data.fan_loops);
+  MEM_freeN(fans_data.fan_walkers);
+  MEM_freeN(fans_data.cyclic_fan_entries);
 }
 
 /**
@@ -1710,24 +1834,13 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
+      .use_threading = loop_split_use_threading(numLoops),
   };
 
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
+  loop_split_fans_compute(&common_data);
 
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
@@ -0,0 +1,637 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * Global cache of intermediate modifier stack results, limited by
+ * #UserDef.modifier_cache_limit and freed in least recently used order.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sdna_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_modifier_stack_cache.h" /* own include */
+
+/* Results which are this fast to evaluate (in seconds) aren't worth copying into the cache. */
+#define MODIFIER_STACK_CACHE_MIN_EVAL_TIME 1e-3
+
+typedef struct KeyBuffer {
+  unsigned char *data;
+  size_t len, alloc;
+} KeyBuffer;
+
+typedef struct ModifierStackCacheKeyData {
+  /** Input mesh data. */
+  KeyBuffer input;
+  /** Evaluation settings followed by the settings of every modifier. */
+  KeyBuffer stack;
+  /** Key state and cache entries using the data, changed with the cache lock held. */
+  int users;
+  /** Cache entries using the data, its memory is counted while there are any. */
+  int cache_users;
+} ModifierStackCacheKeyData;
+
+typedef struct ModifierStackCacheEntry {
+  struct ModifierStackCacheEntry *next, *prev;
+  ModifierStackCacheKey key;
+  Mesh *mesh;
+  size_t mem_size;
+  /** Time it took to evaluate the stack up to this result. */
+  double eval_time;
+  /** Entries being copied from can't be freed. */
+  int users;
+} ModifierStackCacheEntry;
+
+static struct {
+  /** #ModifierStackCacheKey -> #ModifierStackCacheEntry. */
+  GHash *entries;
+  /** Least recently used entries first. */
+  ListBase lru;
+  size_t mem_in_use;
+  uint64_t hits;
+  uint64_t misses;
+  double time_saved;
+  double time_overhead;
+} stack_cache = {NULL};
+
+static ThreadMutex stack_cache_lock = BLI_MUTEX_INITIALIZER;
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ * \{ */
+
+static void key_buffer_add(KeyBuffer *buf, const void *data, const size_t size)
+{
+  if (buf->len + size > buf->alloc) {
+    buf->alloc = MAX2(buf->alloc * 2, buf->len + size);
+    buf->data = MEM_reallocN_id(buf->data, buf->alloc, __func__);
+  }
+  memcpy(buf->data + buf->len, data, size);
+  buf->len += size;
+}
+
+static void key_buffer_add_int(KeyBuffer *buf, const int value)
+{
+  key_buffer_add(buf, &value, sizeof(value));
+}
+
+static void key_buffer_add_string(KeyBuffer *buf, const char *str)
+{
+  key_buffer_add(buf, str, strlen(str) + 1);
+}
+
+static void key_add_struct(KeyBuffer *buf, const SDNA *sdna, const int struct_nr, const char *data)
+{
+  const short *sp = sdna->structs[struct_nr];
+  const int members_len = sp[1];
+
+  sp += 2;
+  for (int a = 0; a < members_len; a++, sp += 2) {
+    const short type = sp[0];
+    const short name = sp[1];
+    const int size = DNA_elem_size_nr(sdna, type, name);
+
+    /* Pointers differ between copies of the same settings,
+     * modifiers using pointed to data are not cached anyway. */
+    if (!ELEM(sdna->names[name][0], '*', '(') && !STREQ(sdna->types[type], "ModifierData")) {
+      const int member_struct_nr = DNA_struct_find_nr(sdna, sdna->types[type]);
+      if (member_struct_nr != -1) {
+        for (int i = 0; i < sdna->names_array_len[name]; i++) {
+          key_add_struct(buf, sdna, member_struct_nr, data + i * sdna->types_size[type]);
+        }
+      }
+      else {
+        key_buffer_add(buf, data, (size_t)size);
+      }
+    }
+
+    data += size;
+  }
+}
+
+static bool key_add_customdata(KeyBuffer *buf, const CustomData *data, const int totelem)
+{
+  key_buffer_add_int(buf, totelem);
+  key_buffer_add_int(buf, data->totlayer);
+
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+
+    key_buffer_add_int(buf, layer->type);
+    key_buffer_add_string(buf, layer->name);
+
+    switch (layer->type) {
+      case CD_MDEFORMVERT: {
+        const MDeformVert *dvert = layer->data;
+        for (int j = 0; j < totelem; j++) {
+          key_buffer_add_int(buf, dvert[j].totweight);
+          key_buffer_add(buf, dvert[j].dw, sizeof(*dvert[j].dw) * (size_t)dvert[j].totweight);
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+      case CD_BM_ELEM_PYPTR:
+        /* Layers with pointers to their data, not worth comparing. */
+        return false;
+      default:
+        key_buffer_add(
+            buf, layer->data, (size_t)CustomData_sizeof(layer->type) * (size_t)totelem);
+        break;
+    }
+  }
+  return true;
+}
+
+static void key_data_free(ModifierStackCacheKeyData *data)
+{
+  MEM_SAFE_FREE(data->input.data);
+  MEM_SAFE_FREE(data->stack.data);
+  MEM_freeN(data);
+}
+
+/* Must be called with the lock held. */
+static void key_data_release(ModifierStackCacheKeyData *data)
+{
+  BLI_assert(data->users > 0);
+  data->users--;
+  if (data->users == 0) {
+    key_data_free(data);
+  }
+}
+
+static size_t key_data_mem_size(const ModifierStackCacheKeyData *data)
+{
+  return sizeof(*data) + data->input.alloc + data->stack.alloc;
+}
+
+static size_t customdata_mem_size(const CustomData *data, const int totelem)
+{
+  size_t size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    size += (size_t)CustomData_sizeof(data->layers[i].type) * (size_t)totelem;
+  }
+  return size;
+}
+
+static size_t mesh_mem_size(const Mesh *mesh)
+{
+  return sizeof(Mesh) + customdata_mem_size(&mesh->vdata, mesh->totvert) +
+         customdata_mem_size(&mesh->edata, mesh->totedge) +
+         customdata_mem_size(&mesh->ldata, mesh->totloop) +
+         customdata_mem_size(&mesh->pdata, mesh->totpoly);
+}
+
+/**
+ * Start the key of a modifier stack evaluation. The input mesh data is copied into the key,
+ * so that cached results are only used for exactly the same input.
+ *
+ * \return false when the input can not be cached, there is nothing to free then.
+ */
+bool BKE_modifier_stack_cache_key_init(ModifierStackCacheKeyState *state,
+                                       const Scene *scene,
+                                       const Object *ob,
+                                       const Mesh *mesh_input,
+                                       const CustomData_MeshMasks *final_datamask,
+                                       const int required_mode,
+                                       const int apply_flag)
+{
+  const ID *id_orig = ob->id.orig_id ? ob->id.orig_id : &ob->id;
+  ModifierStackCacheKey *key = &state->key;
+
+  if (U.modifier_cache_limit <= 0 || id_orig->session_uuid == MAIN_ID_SESSION_UUID_UNSET) {
+    return false;
+  }
+
+  const double time_start = PIL_check_seconds_timer();
+
+  ModifierStackCacheKeyData *data = MEM_callocN(sizeof(*data), __func__);
+  data->users = 1;
+
+  KeyBuffer *input = &data->input;
+  input->alloc = mesh_mem_size(mesh_input);
+  input->data = MEM_mallocN(input->alloc, __func__);
+  if (!key_add_customdata(input, &mesh_input->vdata, mesh_input->totvert) ||
+      !key_add_customdata(input, &mesh_input->edata, mesh_input->totedge) ||
+      !key_add_customdata(input, &mesh_input->ldata, mesh_input->totloop) ||
+      !key_add_customdata(input, &mesh_input->pdata, mesh_input->totpoly)) {
+    key_data_free(data);
+    return false;
+  }
+
+  /* Everything besides the modifiers that may change the result of the stack. */
+  KeyBuffer *stack = &data->stack;
+  key_buffer_add(stack, final_datamask, sizeof(*final_datamask));
+  key_buffer_add_int(stack, required_mode);
+  key_buffer_add_int(stack, apply_flag);
+  key_buffer_add_int(stack, mesh_input->flag);
+  key_buffer_add_int(stack, mesh_input->cd_flag);
+  key_buffer_add(stack, &mesh_input->smoothresh, sizeof(float));
+  key_buffer_add_int(stack, ob->totcol);
+  LISTBASE_FOREACH (const bDeformGroup *, dg, &ob->defbase) {
+    key_buffer_add_string(stack, dg->name);
+  }
+  key_buffer_add_int(stack, scene->r.mode & R_SIMPLIFY);
+  key_buffer_add_int(stack, scene->r.simplify_subsurf);
+  key_buffer_add_int(stack, scene->r.simplify_subsurf_render);
+
+  memset(key, 0, sizeof(*key));
+  key->data = data;
+  key->object_uuid = id_orig->session_uuid;
+  key->input_hash = BLI_hash_mm2(input->data, input->len, 0);
+
+  const double time_overhead = PIL_check_seconds_timer() - time_start;
+  BLI_mutex_lock(&stack_cache_lock);
+  stack_cache.time_overhead += time_overhead;
+  BLI_mutex_unlock(&stack_cache_lock);
+
+  return true;
+}
+
+void BKE_modifier_stack_cache_key_add_modifier(ModifierStackCacheKeyState *state,
+                                               const ModifierData *md,
+                                               const CustomData_MeshMasks *datamask)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+  const SDNA *sdna = DNA_sdna_current_get();
+  KeyBuffer *stack = &state->key.data->stack;
+
+  key_buffer_add_int(stack, md->type);
+  key_buffer_add(stack, datamask, sizeof(*datamask));
+  key_add_struct(stack, sdna, DNA_struct_find_nr(sdna, mti->structName), (const char *)md);
+}
+
+void BKE_modifier_stack_cache_key_get(const ModifierStackCacheKeyState *state,
+                                      ModifierStackCacheKey *r_key)
+{
+  const KeyBuffer *stack = &state->key.data->stack;
+  *r_key = state->key;
+  r_key->stack_len = stack->len;
+  r_key->stack_hash = BLI_hash_mm2(stack->data, stack->len, state->key.input_hash);
+}
+
+/** Free the state, cached results keep the data they were stored with. */
+void BKE_modifier_stack_cache_key_state_free(ModifierStackCacheKeyState *state)
+{
+  BLI_mutex_lock(&stack_cache_lock);
+  key_data_release(state->key.data);
+  BLI_mutex_unlock(&stack_cache_lock);
+  state->key.data = NULL;
+}
+
+static void modifier_stack_cache_id_walk(void *userData,
+                                         Object *UNUSED(ob),
+                                         ID **idpoin,
+                                         int UNUSED(cb_flag))
+{
+  if (*idpoin != NULL) {
+    *((bool *)userData) = true;
+  }
+}
+
+/**
+ * Modifiers with results depending on anything else than their input mesh and their settings
+ * (other ID's, time, simulation state, bound data) can't be cached, neither can modifiers
+ * with side effects on the object, since they wouldn't run for cached results.
+ */
+bool BKE_modifier_stack_cache_supports_modifier(Object *ob, ModifierData *md)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+  /* Simulations and modifiers storing data for other users. */
+  if (ELEM(md->type,
+           eModifierType_ParticleSystem,
+           eModifierType_Collision,
+           eModifierType_Surface,
+           eModifierType_Cloth,
+           eModifierType_Softbody,
+           eModifierType_DynamicPaint,
+           eModifierType_Fluid,
+           eModifierType_Explode,
+           eModifierType_Ocean)) {
+    return false;
+  }
+  /* Modifiers using external or bound data. */
+  if (ELEM(md->type,
+           eModifierType_ShapeKey,
+           eModifierType_Multires,
+           eModifierType_MeshCache,
+           eModifierType_MeshSequenceCache,
+           eModifierType_MeshDeform,
+           eModifierType_SurfaceDeform,
+           eModifierType_LaplacianDeform,
+           eModifierType_CorrectiveSmooth)) {
+    return false;
+  }
+
+  /* Subdivision level chosen from the scene camera. */
+  if (md->type == eModifierType_Subsurf &&
+      (((SubsurfModifierData *)md)->flags & eSubsurfModifierFlag_UseAdaptive)) {
+    return false;
+  }
+
+  if ((mti->flags & eModifierTypeFlag_UsesPreview) ||
+      (mti->dependsOnTime && mti->dependsOnTime(md))) {
+    return false;
+  }
+
+  bool has_id = false;
+  if (mti->foreachIDLink) {
+    mti->foreachIDLink(md, ob, modifier_stack_cache_id_walk, &has_id);
+  }
+  else if (mti->foreachObjectLink) {
+    mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_stack_cache_id_walk, &has_id);
+  }
+  return !has_id;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Storage
+ * \{ */
+
+static uint modifier_stack_cache_key_hash(const void *ptr)
+{
+  const ModifierStackCacheKey *key = ptr;
+  return key->stack_hash ^ (key->object_uuid * 2654435761u);
+}
+
+/* Equal hashes are not enough, the data they were computed from has to match as well. */
+static bool modifier_stack_cache_key_cmp(const void *a, const void *b)
+{
+  const ModifierStackCacheKey *key_a = a;
+  const ModifierStackCacheKey *key_b = b;
+
+  if (key_a->object_uuid != key_b->object_uuid || key_a->input_hash != key_b->input_hash ||
+      key_a->stack_hash != key_b->stack_hash || key_a->stack_len != key_b->stack_len) {
+    return true;
+  }
+  if (key_a->data == key_b->data) {
+    return false;
+  }
+
+  const ModifierStackCacheKeyData *data_a = key_a->data;
+  const ModifierStackCacheKeyData *data_b = key_b->data;
+  return (data_a->input.len != data_b->input.len ||
+          memcmp(data_a->input.data, data_b->input.data, data_a->input.len) != 0 ||
+          memcmp(data_a->stack.data, data_b->stack.data, key_a->stack_len) != 0);
+}
+
+static size_t modifier_stack_cache_limit(void)
+{
+  return (size_t)MAX2(U.modifier_cache_limit, 0) * 1024 * 1024;
+}
+
+/* Must be called with the lock held. */
+static void modifier_stack_cache_entry_free(ModifierStackCacheEntry *entry)
+{
+  ModifierStackCacheKeyData *data = entry->key.data;
+  data->cache_users--;
+  if (data->cache_users == 0) {
+    stack_cache.mem_in_use -= key_data_mem_size(data);
+  }
+  key_data_release(data);
+
+  stack_cache.mem_in_use -= entry->mem_size;
+  BKE_id_free(NULL, entry->mesh);
+  MEM_freeN(entry);
+}
+
+static void modifier_stack_cache_entry_remove(ModifierStackCacheEntry *entry)
+{
+  BLI_ghash_remove(stack_cache.entries, &entry->key, NULL, NULL);
+  BLI_remlink(&stack_cache.lru, entry);
+  modifier_stack_cache_entry_free(entry);
+}
+
+/* Must be called with the lock held. */
+static void modifier_stack_cache_limit_ensure(const size_t limit)
+{
+  ModifierStackCacheEntry *entry = stack_cache.lru.first;
+  while (entry != NULL && stack_cache.mem_in_use > limit) {
+    ModifierStackCacheEntry *entry_next = entry->next;
+    if (entry->users == 0) {
+      modifier_stack_cache_entry_remove(entry);
+    }
+    entry = entry_next;
+  }
+}
+
+static ModifierStackCacheEntry *modifier_stack_cache_lookup(const ModifierStackCacheKey *key)
+{
+  if (stack_cache.entries == NULL) {
+    return NULL;
+  }
+  ModifierStackCacheEntry *entry = BLI_ghash_lookup(stack_cache.entries, key);
+  if (entry != NULL) {
+    /* Move to the most recently used end. */
+    BLI_remlink(&stack_cache.lru, entry);
+    BLI_addtail(&stack_cache.lru, entry);
+  }
+  return entry;
+}
+
+/**
+ * Find the cached result for the key furthest along the stack.
+ *
+ * \param deform_key: When not NULL, the result of the leading deform modifiers is needed as well.
+ * \param r_eval_time: Time it took to evaluate the found result.
+ * \return The index of the found key or -1, in which case the stack has to be fully evaluated.
+ * Found meshes are copies owned by the caller.
+ */
+int BKE_modifier_stack_cache_find(const ModifierStackCacheKey *keys,
+                                  const int keys_len,
+                                  const ModifierStackCacheKey *deform_key,
+                                  Mesh **r_mesh,
+                                  Mesh **r_mesh_deform,
+                                  double *r_eval_time)
+{
+  ModifierStackCacheEntry *entry = NULL, *entry_deform = NULL;
+  int index = -1;
+  const double time_start = PIL_check_seconds_timer();
+
+  BLI_mutex_lock(&stack_cache_lock);
+  if (deform_key != NULL) {
+    entry_deform = modifier_stack_cache_lookup(deform_key);
+  }
+  if (deform_key == NULL || entry_deform != NULL) {
+    for (int i = keys_len - 1; i >= 0; i--) {
+      entry = modifier_stack_cache_lookup(&keys[i]);
+      if (entry != NULL) {
+        index = i;
+        break;
+      }
+    }
+  }
+  if (index != -1) {
+    entry->users++;
+    if (entry_deform != NULL) {
+      entry_deform->users++;
+    }
+    stack_cache.hits++;
+    stack_cache.time_saved += entry->eval_time;
+    *r_eval_time = entry->eval_time;
+  }
+  else {
+    stack_cache.misses++;
+    stack_cache.time_overhead += PIL_check_seconds_timer() - time_start;
+  }
+  BLI_mutex_unlock(&stack_cache_lock);
+
+  if (index == -1) {
+    return -1;
+  }
+
+  /* Copy outside of the lock, the users count keeps the entries alive. */
+  *r_mesh = BKE_mesh_copy_for_eval(entry->mesh, false);
+  if (entry_deform != NULL) {
+    *r_mesh_deform = BKE_mesh_copy_for_eval(entry_deform->mesh, false);
+  }
+
+  BLI_mutex_lock(&stack_cache_lock);
+  entry->users--;
+  if (entry_deform != NULL) {
+    entry_deform->users--;
+  }
+  stack_cache.time_overhead += PIL_check_seconds_timer() - time_start;
+  BLI_mutex_unlock(&stack_cache_lock);
+
+  return index;
+}
+
+/**
+ * Store a copy of \a mesh as the result for \a key.
+ *
+ * \param eval_time: Time it took to evaluate the stack up to this result.
+ */
+void BKE_modifier_stack_cache_store(const ModifierStackCacheKey *key,
+                                    Mesh *mesh,
+                                    const double eval_time)
+{
+  const size_t limit = modifier_stack_cache_limit();
+  const size_t mem_size = mesh_mem_size(mesh);
+
+  /* Don't let a single result flush everything else. */
+  if (mem_size > limit / 2 || eval_time < MODIFIER_STACK_CACHE_MIN_EVAL_TIME) {
+    return;
+  }
+
+  const double time_start = PIL_check_seconds_timer();
+
+  BLI_mutex_lock(&stack_cache_lock);
+  const bool exists = stack_cache.entries != NULL &&
+                      BLI_ghash_haskey(stack_cache.entries, key);
+  BLI_mutex_unlock(&stack_cache_lock);
+  if (exists) {
+    return;
+  }
+
+  ModifierStackCacheEntry *entry = MEM_callocN(sizeof(*entry), __func__);
+  entry->key = *key;
+  entry->mesh = BKE_mesh_copy_for_eval(mesh, false);
+  entry->mem_size = mem_size;
+  entry->eval_time = eval_time;
+
+  BLI_mutex_lock(&stack_cache_lock);
+  if (stack_cache.entries == NULL) {
+    stack_cache.entries = BLI_ghash_new(
+        modifier_stack_cache_key_hash, modifier_stack_cache_key_cmp, __func__);
+  }
+  void **val_p;
+  if (BLI_ghash_ensure_p(stack_cache.entries, &entry->key, &val_p)) {
+    /* Stored by another thread in the meantime. */
+    BKE_id_free(NULL, entry->mesh);
+    MEM_freeN(entry);
+  }
+  else {
+    ModifierStackCacheKeyData *data = entry->key.data;
+    data->users++;
+    if (data->cache_users == 0) {
+      stack_cache.mem_in_use += key_data_mem_size(data);
+    }
+    data->cache_users++;
+
+    *val_p = entry;
+    BLI_addtail(&stack_cache.lru, entry);
+    stack_cache.mem_in_use += mem_size;
+    modifier_stack_cache_limit_ensure(limit);
+  }
+  stack_cache.time_overhead += PIL_check_seconds_timer() - time_start;
+  BLI_mutex_unlock(&stack_cache_lock);
+}
+
+/** Free entries until the cache fits #UserDef.modifier_cache_limit. */
+void BKE_modifier_stack_cache_enforce_limit(void)
+{
+  BLI_mutex_lock(&stack_cache_lock);
+  modifier_stack_cache_limit_ensure(modifier_stack_cache_limit());
+  BLI_mutex_unlock(&stack_cache_lock);
+}
+
+void BKE_modifier_stack_cache_free_all(void)
+{
+  BLI_mutex_lock(&stack_cache_lock);
+  LISTBASE_FOREACH_MUTABLE (ModifierStackCacheEntry *, entry, &stack_cache.lru) {
+    BLI_assert(entry->users == 0);
+    modifier_stack_cache_entry_free(entry);
+  }
+  BLI_listbase_clear(&stack_cache.lru);
+  if (stack_cache.entries != NULL) {
+    BLI_ghash_free(stack_cache.entries, NULL, NULL);
+    stack_cache.entries = NULL;
+  }
+  stack_cache.mem_in_use = 0;
+  BLI_mutex_unlock(&stack_cache_lock);
+}
+
+void BKE_modifier_stack_cache_stats_get(ModifierStackCacheStats *r_stats)
+{
+  BLI_mutex_lock(&stack_cache_lock);
+  r_stats->hits = stack_cache.hits;
+  r_stats->misses = stack_cache.misses;
+  r_stats->time_saved = stack_cache.time_saved;
+  r_stats->time_overhead = stack_cache.time_overhead;
+  r_stats->mem_in_use = stack_cache.mem_in_use;
+  r_stats->entries_len = stack_cache.entries ? (int)BLI_ghash_len(stack_cache.entries) : 0;
+  BLI_mutex_unlock(&stack_cache_lock);
+}
+
+/** \} */
@@ -967,7 +967,7 @@ static void get_pointcache_keys_for_time(Object *UNUSED(ob),
                                          ParticleKey *key1,
                                          ParticleKey *key2)
 {
-  static PTCacheMem *pm = NULL;
+  PTCacheMem *pm;
   int index1, index2;
 
   if (index < 0) { /* initialize */
@@ -2966,37 +2966,210 @@ static void cache_key_incremental_rotation(ParticleCacheKey *key0,
  * - Useful for making use of opengl vertex arrays for super fast strand drawing.
  * - Makes child strands possible and creates them too into the cache.
  * - Cached path data is also used to determine cut position for the editmode tool. */
+typedef struct CachePathsIterData {
+  ParticleSimulationData *sim;
+  ParticleCacheKey **cache;
+  Mesh *hair_mesh;
+  const float *col;
+  float *vg_effector;
+  float *vg_length;
+  float cfra;
+  int segments;
+  int keyed;
+  int baked;
+} CachePathsIterData;
+
+static void psys_cache_paths_iter(void *__restrict iter_data_v,
+                                  const int p,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CachePathsIterData *iter_data = (CachePathsIterData *)iter_data_v;
+  ParticleSimulationData *sim = iter_data->sim;
+  ParticleSystemModifierData *psmd = sim->psmd;
+  ParticleSystem *psys = sim->psys;
+  ParticleSettings *part = psys->part;
+  ParticleData *pa = psys->particles + p;
+  ParticleCacheKey *ca, **cache = iter_data->cache;
+  Mesh *hair_mesh = iter_data->hair_mesh;
+  const float *col = iter_data->col;
+  float *vg_effector = iter_data->vg_effector;
+  float *vg_length = iter_data->vg_length;
+  const float cfra = iter_data->cfra;
+  const int segments = iter_data->segments;
+  const int keyed = iter_data->keyed;
+  const int baked = iter_data->baked;
+
+  ParticleKey result;
+  ParticleInterpolationData pind;
+  ParticleTexture ptex;
+
+  float birthtime = 0.0, dietime = 0.0;
+  float t, time = 0.0, dfra = 1.0;
+  float prev_tangent[3] = {0.0f, 0.0f, 0.0f}, hairmat[4][4];
+  float rotmat[3][3];
+  int k;
+  float length, vec[3];
+  float pa_length = 1.0f;
+
+  if (!psys->totchild) {
+    psys_get_texture(sim, pa, &ptex, PAMAP_LENGTH, 0.f);
+    pa_length = ptex.length * (1.0f - part->randlength * psys_frand(psys, psys->seed + p));
+    if (vg_length) {
+      pa_length *= psys_particle_value_from_verts(psmd->mesh_final, part->from, pa, vg_length);
+    }
+  }
+
+  pind.keyed = keyed;
+  pind.cache = baked ? psys->pointcache : NULL;
+  pind.epoint = NULL;
+  pind.bspline = (psys->part->flag & PART_HAIR_BSPLINE);
+  pind.mesh = hair_mesh;
+
+  memset(cache[p], 0, sizeof(*cache[p]) * (segments + 1));
+
+  cache[p]->segments = segments;
+
+  /*--get the first data points--*/
+  init_particle_interpolation(sim->ob, sim->psys, pa, &pind);
+
+  /* 'hairmat' is needed for non-hair particle too so we get proper rotations. */
+  psys_mat_hair_to_global(sim->ob, psmd->mesh_final, psys->part->from, pa, hairmat);
+  copy_v3_v3(rotmat[0], hairmat[2]);
+  copy_v3_v3(rotmat[1], hairmat[1]);
+  copy_v3_v3(rotmat[2], hairmat[0]);
+
+  if (part->draw & PART_ABS_PATH_TIME) {
+    birthtime = MAX2(pind.birthtime, part->path_start);
+    dietime = MIN2(pind.dietime, part->path_end);
+  }
+  else {
+    float tb = pind.birthtime;
+    birthtime = tb + part->path_start * (pind.dietime - tb);
+    dietime = tb + part->path_end * (pind.dietime - tb);
+  }
+
+  if (birthtime >= dietime) {
+    cache[p]->segments = -1;
+    return;
+  }
+
+  dietime = birthtime + pa_length * (dietime - birthtime);
+
+  /*--interpolate actual path from data points--*/
+  for (k = 0, ca = cache[p]; k <= segments; k++, ca++) {
+    time = (float)k / (float)segments;
+    t = birthtime + time * (dietime - birthtime);
+    result.time = -t;
+    do_particle_interpolation(psys, p, pa, t, &pind, &result);
+    copy_v3_v3(ca->co, result.co);
+
+    /* dynamic hair is in object space */
+    /* keyed and baked are already in global space */
+    if (hair_mesh) {
+      mul_m4_v3(sim->ob->obmat, ca->co);
+    }
+    else if (!keyed && !baked && !(psys->flag & PSYS_GLOBAL_HAIR)) {
+      mul_m4_v3(hairmat, ca->co);
+    }
+
+    copy_v3_v3(ca->col, col);
+  }
+
+  if (part->type == PART_HAIR) {
+    HairKey *hkey;
+
+    for (k = 0, hkey = pa->hair; k < pa->totkey; k++, hkey++) {
+      mul_v3_m4v3(hkey->world_co, hairmat, hkey->co);
+    }
+  }
+
+  /*--modify paths and calculate rotation & velocity--*/
+
+  if (!(psys->flag & PSYS_GLOBAL_HAIR)) {
+    /* apply effectors */
+    if ((psys->part->flag & PART_CHILD_EFFECT) == 0) {
+      float effector = 1.0f;
+      if (vg_effector) {
+        effector *= psys_particle_value_from_verts(
+            psmd->mesh_final, psys->part->from, pa, vg_effector);
+      }
+
+      sub_v3_v3v3(vec, (cache[p] + 1)->co, cache[p]->co);
+      length = len_v3(vec);
+
+      for (k = 1, ca = cache[p] + 1; k <= segments; k++, ca++) {
+        do_path_effectors(
+            sim, p, ca, k, segments, cache[p]->co, effector, dfra, cfra, &length, vec);
+      }
+    }
+
+    /* apply guide curves to path data */
+    if (sim->psys->effectors && (psys->part->flag & PART_CHILD_EFFECT) == 0) {
+      for (k = 0, ca = cache[p]; k <= segments; k++, ca++) {
+        /* ca is safe to cast, since only co and vel are used */
+        do_guides(sim->depsgraph,
+                  sim->psys->part,
+                  sim->psys->effectors,
+                  (ParticleKey *)ca,
+                  p,
+                  (float)k / (float)segments);
+      }
+    }
+
+    /* lattices have to be calculated separately to avoid mixups between effector calculations */
+    if (psys->lattice_deform_data) {
+      for (k = 0, ca = cache[p]; k <= segments; k++, ca++) {
+        calc_latt_deform(psys->lattice_deform_data, ca->co, psys->lattice_strength);
+      }
+    }
+  }
+
+  /* finally do rotation & velocity */
+  for (k = 1, ca = cache[p] + 1; k <= segments; k++, ca++) {
+    cache_key_incremental_rotation(ca, ca - 1, ca - 2, prev_tangent, k);
+
+    if (k == segments) {
+      copy_qt_qt(ca->rot, (ca - 1)->rot);
+    }
+
+    /* set velocity */
+    sub_v3_v3v3(ca->vel, ca->co, (ca - 1)->co);
+
+    if (k == 1) {
+      copy_v3_v3((ca - 1)->vel, ca->vel);
+    }
+
+    ca->time = (float)k / (float)segments;
+  }
+  /* First rotation is based on emitting face orientation.
+   * This is way better than having flipping rotations resulting
+   * from using a global axis as a rotation pole (vec_to_quat()).
+   * It's not an ideal solution though since it disregards the
+   * initial tangent, but taking that in to account will allow
+   * the possibility of flipping again. -jahka
+   */
+  mat3_to_quat_is_ok(cache[p]->rot, rotmat);
+}
+
 void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_render_params)
 {
   PARTICLE_PSMD;
   ParticleEditSettings *pset = &sim->scene->toolsettings->particle;
   ParticleSystem *psys = sim->psys;
   ParticleSettings *part = psys->part;
-  ParticleCacheKey *ca, **cache;
+  ParticleCacheKey **cache;
 
   Mesh *hair_mesh = (psys->part->type == PART_HAIR && psys->flag & PSYS_HAIR_DYNAMICS) ?
                         psys->hair_out_mesh :
                         NULL;
 
-  ParticleKey result;
-
   Material *ma;
-  ParticleInterpolationData pind;
-  ParticleTexture ptex;
-
-  PARTICLE_P;
 
-  float birthtime = 0.0, dietime = 0.0;
-  float t, time = 0.0, dfra = 1.0 /* , frs_sec = sim->scene->r.frs_sec*/ /*UNUSED*/;
   float col[4] = {0.5f, 0.5f, 0.5f, 1.0f};
-  float prev_tangent[3] = {0.0f, 0.0f, 0.0f}, hairmat[4][4];
-  float rotmat[3][3];
-  int k;
   int segments = (int)pow(2.0, (double)((use_render_params) ? part->ren_step : part->draw_step));
   int totpart = psys->totpart;
-  float length, vec[3];
   float *vg_effector = NULL;
-  float *vg_length = NULL, pa_length = 1.0f;
+  float *vg_length = NULL;
   int keyed, baked;
 
   /* we don't have anything valid to create paths from so let's quit here */
@@ -3039,148 +3212,24 @@ void psys_cache_paths(ParticleSimulationData *sim, float cfra, const bool use_re
     BKE_mesh_tessface_ensure(psmd->mesh_final);
   }
 
-  /*---first main loop: create all actual particles' paths---*/
-  LOOP_PARTICLES
-  {
-    if (!psys->totchild) {
-      psys_get_texture(sim, pa, &ptex, PAMAP_LENGTH, 0.f);
-      pa_length = ptex.length * (1.0f - part->randlength * psys_frand(psys, psys->seed + p));
-      if (vg_length) {
-        pa_length *= psys_particle_value_from_verts(psmd->mesh_final, part->from, pa, vg_length);
-      }
-    }
-
-    pind.keyed = keyed;
-    pind.cache = baked ? psys->pointcache : NULL;
-    pind.epoint = NULL;
-    pind.bspline = (psys->part->flag & PART_HAIR_BSPLINE);
-    pind.mesh = hair_mesh;
-
-    memset(cache[p], 0, sizeof(*cache[p]) * (segments + 1));
-
-    cache[p]->segments = segments;
-
-    /*--get the first data points--*/
-    init_particle_interpolation(sim->ob, sim->psys, pa, &pind);
-
-    /* 'hairmat' is needed for non-hair particle too so we get proper rotations. */
-    psys_mat_hair_to_global(sim->ob, psmd->mesh_final, psys->part->from, pa, hairmat);
-    copy_v3_v3(rotmat[0], hairmat[2]);
-    copy_v3_v3(rotmat[1], hairmat[1]);
-    copy_v3_v3(rotmat[2], hairmat[0]);
-
-    if (part->draw & PART_ABS_PATH_TIME) {
-      birthtime = MAX2(pind.birthtime, part->path_start);
-      dietime = MIN2(pind.dietime, part->path_end);
-    }
-    else {
-      float tb = pind.birthtime;
-      birthtime = tb + part->path_start * (pind.dietime - tb);
-      dietime = tb + part->path_end * (pind.dietime - tb);
-    }
-
-    if (birthtime >= dietime) {
-      cache[p]->segments = -1;
-      continue;
-    }
-
-    dietime = birthtime + pa_length * (dietime - birthtime);
-
-    /*--interpolate actual path from data points--*/
-    for (k = 0, ca = cache[p]; k <= segments; k++, ca++) {
-      time = (float)k / (float)segments;
-      t = birthtime + time * (dietime - birthtime);
-      result.time = -t;
-      do_particle_interpolation(psys, p, pa, t, &pind, &result);
-      copy_v3_v3(ca->co, result.co);
-
-      /* dynamic hair is in object space */
-      /* keyed and baked are already in global space */
-      if (hair_mesh) {
-        mul_m4_v3(sim->ob->obmat, ca->co);
-      }
-      else if (!keyed && !baked && !(psys->flag & PSYS_GLOBAL_HAIR)) {
-        mul_m4_v3(hairmat, ca->co);
-      }
-
-      copy_v3_v3(ca->col, col);
-    }
-
-    if (part->type == PART_HAIR) {
-      HairKey *hkey;
-
-      for (k = 0, hkey = pa->hair; k < pa->totkey; k++, hkey++) {
-        mul_v3_m4v3(hkey->world_co, hairmat, hkey->co);
-      }
-    }
-
-    /*--modify paths and calculate rotation & velocity--*/
-
-    if (!(psys->flag & PSYS_GLOBAL_HAIR)) {
-      /* apply effectors */
-      if ((psys->part->flag & PART_CHILD_EFFECT) == 0) {
-        float effector = 1.0f;
-        if (vg_effector) {
-          effector *= psys_particle_value_from_verts(
-              psmd->mesh_final, psys->part->from, pa, vg_effector);
-        }
-
-        sub_v3_v3v3(vec, (cache[p] + 1)->co, cache[p]->co);
-        length = len_v3(vec);
+  /*---main loop: create all actual particles' paths, each particle independently---*/
+  CachePathsIterData iter_data = {
+      .sim = sim,
+      .cache = cache,
+      .hair_mesh = hair_mesh,
+      .col = col,
+      .vg_effector = vg_effector,
+      .vg_length = vg_length,
+      .cfra = cfra,
+      .segments = segments,
+      .keyed = keyed,
+      .baked = baked,
+  };
 
-        for (k = 1, ca = cache[p] + 1; k <= segments; k++, ca++) {
-          do_path_effectors(
-              sim, p, ca, k, segments, cache[p]->co, effector, dfra, cfra, &length, vec);
-        }
-      }
-
-      /* apply guide curves to path data */
-      if (sim->psys->effectors && (psys->part->flag & PART_CHILD_EFFECT) == 0) {
-        for (k = 0, ca = cache[p]; k <= segments; k++, ca++) {
-          /* ca is safe to cast, since only co and vel are used */
-          do_guides(sim->depsgraph,
-                    sim->psys->part,
-                    sim->psys->effectors,
-                    (ParticleKey *)ca,
-                    p,
-                    (float)k / (float)segments);
-        }
-      }
-
-      /* lattices have to be calculated separately to avoid mixups between effector calculations */
-      if (psys->lattice_deform_data) {
-        for (k = 0, ca = cache[p]; k <= segments; k++, ca++) {
-          calc_latt_deform(psys->lattice_deform_data, ca->co, psys->lattice_strength);
-        }
-      }
-    }
-
-    /* finally do rotation & velocity */
-    for (k = 1, ca = cache[p] + 1; k <= segments; k++, ca++) {
-      cache_key_incremental_rotation(ca, ca - 1, ca - 2, prev_tangent, k);
-
-      if (k == segments) {
-        copy_qt_qt(ca->rot, (ca - 1)->rot);
-      }
-
-      /* set velocity */
-      sub_v3_v3v3(ca->vel, ca->co, (ca - 1)->co);
-
-      if (k == 1) {
-        copy_v3_v3((ca - 1)->vel, ca->vel);
-      }
-
-      ca->time = (float)k / (float)segments;
-    }
-    /* First rotation is based on emitting face orientation.
-     * This is way better than having flipping rotations resulting
-     * from using a global axis as a rotation pole (vec_to_quat()).
-     * It's not an ideal solution though since it disregards the
-     * initial tangent, but taking that in to account will allow
-     * the possibility of flipping again. -jahka
-     */
-    mat3_to_quat_is_ok(cache[p]->rot, rotmat);
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = BKE_effectors_support_threading(psys->effectors, NULL);
+  BLI_task_parallel_range(0, totpart, &iter_data, psys_cache_paths_iter, &settings);
 
   psys->totcached = totpart;
 
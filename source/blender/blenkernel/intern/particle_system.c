@@ -3805,6 +3805,55 @@ static void dynamics_step_sph_classical_integrate_task_cb_ex(void *__restrict us
   }
 }
 
+typedef struct DynamicStepNewtonTLS {
+  /* Copy of the simulation data with a random number generator for the thread. */
+  ParticleSimulationData sim;
+} DynamicStepNewtonTLS;
+
+static void dynamics_step_newton_task_cb_ex(void *__restrict userdata,
+                                            const int p,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  DynamicStepSolverTaskData *data = userdata;
+  DynamicStepNewtonTLS *newton_tls = tls->userdata_chunk;
+  ParticleSimulationData *sim = &newton_tls->sim;
+  ParticleSystem *psys = sim->psys;
+  ParticleSettings *part = psys->part;
+  ParticleData *pa = psys->particles + p;
+
+  if (pa->state.time <= 0.0f) {
+    return;
+  }
+
+  /* Random values only depend on the particle and frame, not on the threads. */
+  if (sim->rng == NULL) {
+    sim->rng = BLI_rng_new(0);
+  }
+  BLI_rng_srandom(sim->rng, 31415926 + (int)data->cfra + psys->seed + p * 7919);
+
+  /* do global forces & effectors */
+  basic_integrate(sim, p, pa->state.time, data->cfra);
+
+  /* deflection */
+  if (sim->colliders) {
+    collision_check(sim, p, pa->state.time, data->cfra);
+  }
+
+  /* rotations */
+  basic_rotate(part, pa, pa->state.time, data->timestep);
+}
+
+static void dynamics_step_newton_free(const void *__restrict UNUSED(userdata),
+                                      void *__restrict chunk_v)
+{
+  DynamicStepNewtonTLS *newton_tls = chunk_v;
+
+  if (newton_tls->sim.rng) {
+    BLI_rng_free(newton_tls->sim.rng);
+    newton_tls->sim.rng = NULL;
+  }
+}
+
 /* unbaked particles are calculated dynamically */
 static void dynamics_step(ParticleSimulationData *sim, float cfra)
 {
@@ -3933,19 +3982,24 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 
   switch (part->phystype) {
     case PART_PHYS_NEWTON: {
-      LOOP_DYNAMIC_PARTICLES
-      {
-        /* do global forces & effectors */
-        basic_integrate(sim, p, pa->state.time, cfra);
-
-        /* deflection */
-        if (sim->colliders) {
-          collision_check(sim, p, pa->state.time, cfra);
-        }
-
-        /* rotations */
-        basic_rotate(part, pa, pa->state.time, timestep);
-      }
+      DynamicStepSolverTaskData task_data = {
+          .sim = sim,
+          .cfra = cfra,
+          .timestep = timestep,
+          .dtime = dtime,
+      };
+      DynamicStepNewtonTLS newton_tls = {.sim = *sim};
+      newton_tls.sim.rng = NULL;
+
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.use_threading = (psys->totpart > 100) &&
+                               BKE_effectors_support_threading(psys->effectors, psys);
+      settings.userdata_chunk = &newton_tls;
+      settings.userdata_chunk_size = sizeof(newton_tls);
+      settings.func_free = dynamics_step_newton_free;
+      BLI_task_parallel_range(
+          0, psys->totpart, &task_data, dynamics_step_newton_task_cb_ex, &settings);
       break;
     }
     case PART_PHYS_BOIDS: {
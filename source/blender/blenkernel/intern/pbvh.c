@@ -51,6 +51,11 @@
 
 #define LEAF_LIMIT 10000
 
+/* Number of buckets the primitive centroids are sorted into when searching for a split. */
+#define SAH_BINS 16
+/* Maximum number of primitives binned to find the split of a node. */
+#define SAH_SAMPLES_MAX 16384
+
 //#define PERFCNTRS
 
 #define STACK_FIXED_DEPTH 100
@@ -255,16 +260,19 @@ void pbvh_grow_nodes(PBVH *bvh, int totnode)
 
 /* Add a vertex to the map, with a positive value for unique vertices and
  * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *bvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+static int map_insert_vert(PBVH *bvh,
+                           GHash *map,
+                           unsigned int *face_verts,
+                           unsigned int *uniq_verts,
+                           int node_index,
+                           int vertex)
 {
   void *key, **value_p;
 
   key = POINTER_FROM_INT(vertex);
   if (!BLI_ghash_ensure_p(map, key, &value_p)) {
     int value_i;
-    if (BLI_BITMAP_TEST(bvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(bvh->vert_bitmap, vertex);
+    if (bvh->vert_owner[vertex] == node_index) {
       value_i = *uniq_verts;
       (*uniq_verts)++;
     }
@@ -283,6 +291,7 @@ static int map_insert_vert(
 /* Find vertices used by the faces in this node and update the draw buffers */
 static void build_mesh_leaf_node(PBVH *bvh, PBVHNode *node)
 {
+  const int node_index = (int)(node - bvh->nodes);
   bool has_visible = false;
 
   node->uniq_verts = node->face_verts = 0;
@@ -302,8 +311,12 @@ static void build_mesh_leaf_node(PBVH *bvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &bvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          bvh, map, &node->face_verts, &node->uniq_verts, bvh->mloop[lt->tri[j]].v);
+      face_vert_indices[i][j] = map_insert_vert(bvh,
+                                                map,
+                                                &node->face_verts,
+                                                &node->uniq_verts,
+                                                node_index,
+                                                bvh->mloop[lt->tri[j]].v);
     }
 
     if (has_visible == false) {
@@ -416,6 +429,8 @@ static void build_grid_leaf_node(PBVH *bvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
+/* Vertex and visibility data of the leaves is filled in afterwards,
+ * see #pbvh_build_leaf_nodes. */
 static void build_leaf(PBVH *bvh, int node_index, BBC *prim_bbc, int offset, int count)
 {
   bvh->nodes[node_index].flag |= PBVH_Leaf;
@@ -425,13 +440,6 @@ static void build_leaf(PBVH *bvh, int node_index, BBC *prim_bbc, int offset, int
 
   /* Still need vb for searches */
   update_vb(bvh, &bvh->nodes[node_index], prim_bbc, offset, count);
-
-  if (bvh->looptri) {
-    build_mesh_leaf_node(bvh, bvh->nodes + node_index);
-  }
-  else {
-    build_grid_leaf_node(bvh, bvh->nodes + node_index);
-  }
 }
 
 /* Return zero if all primitives in the node can be drawn with the
@@ -468,6 +476,147 @@ static bool leaf_needs_material_split(PBVH *bvh, int offset, int count)
   return false;
 }
 
+static void pbvh_build_parallel_range_settings(TaskParallelSettings *settings,
+                                               const PBVH *bvh,
+                                               const int totprim)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = totprim > 4 * bvh->leaf_limit;
+  settings->min_iter_per_thread = bvh->leaf_limit;
+}
+
+static void pbvh_build_bb_reduce(const void *__restrict UNUSED(userdata),
+                                 void *__restrict chunk_join,
+                                 void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+/* Surface area heuristic binning: primitives are sorted into buckets along one axis by their
+ * centroid, the split between buckets which minimizes the summed surface area of both
+ * children, weighted by their primitive count, is then used to partition the primitives.
+ *
+ * Large nodes only bin an evenly spread subset of their primitives, that is plenty to find
+ * a good split and keeps the cost of the split search from growing with the mesh size. */
+
+typedef struct SAHBin {
+  BB bb;
+  int count;
+} SAHBin;
+
+typedef struct SAHSplit {
+  int axis;
+  float bmin, scale;
+  /* First bin on the right side. */
+  int bin;
+} SAHSplit;
+
+BLI_INLINE int sah_bin_index(const SAHSplit *split, const BBC *bbc)
+{
+  const int bin = (int)((bbc->bcentroid[split->axis] - split->bmin) * split->scale);
+  return CLAMPIS(bin, 0, SAH_BINS - 1);
+}
+
+static float bb_half_area(const BB *bb)
+{
+  float dim[3];
+  sub_v3_v3v3(dim, bb->bmax, bb->bmin);
+  return dim[0] * dim[1] + dim[1] * dim[2] + dim[2] * dim[0];
+}
+
+/* Returns false when no split leaves primitives on both sides. */
+static bool sah_split_find(
+    PBVH *bvh, const BBC *prim_bbc, const BB *cb, int offset, int count, SAHSplit *r_split)
+{
+  const int axis = BB_widest_axis(cb);
+  const float extent = cb->bmax[axis] - cb->bmin[axis];
+  if (!(extent > 0.0f)) {
+    return false;
+  }
+
+  r_split->axis = axis;
+  r_split->bmin = cb->bmin[axis];
+  r_split->scale = (float)SAH_BINS / extent;
+
+  SAHBin bins[SAH_BINS];
+  for (int i = 0; i < SAH_BINS; i++) {
+    BB_reset(&bins[i].bb);
+    bins[i].count = 0;
+  }
+
+  const int step = max_ii(count / SAH_SAMPLES_MAX, 1);
+  int totsample = 0;
+  for (int i = offset; i < offset + count; i += step, totsample++) {
+    const BBC *bbc = &prim_bbc[bvh->prim_indices[i]];
+    SAHBin *bin = &bins[sah_bin_index(r_split, bbc)];
+    BB_expand_with_bb(&bin->bb, (BB *)bbc);
+    bin->count++;
+  }
+
+  /* Sweep from the right to get the cost of the right side of every split. */
+  float cost_right[SAH_BINS];
+  BB bb;
+  BB_reset(&bb);
+  int count_right = 0;
+  for (int i = SAH_BINS - 1; i > 0; i--) {
+    BB_expand_with_bb(&bb, &bins[i].bb);
+    count_right += bins[i].count;
+    cost_right[i] = count_right ? bb_half_area(&bb) * (float)count_right : 0.0f;
+  }
+
+  /* Sweep from the left, only splits which leave primitives on both sides are valid. */
+  float cost_best = FLT_MAX;
+  r_split->bin = 0;
+  BB_reset(&bb);
+  int count_left = 0;
+  for (int i = 1; i < SAH_BINS; i++) {
+    BB_expand_with_bb(&bb, &bins[i - 1].bb);
+    count_left += bins[i - 1].count;
+    if (count_left == 0 || count_left == totsample) {
+      continue;
+    }
+    const float cost = bb_half_area(&bb) * (float)count_left + cost_right[i];
+    if (cost < cost_best) {
+      cost_best = cost;
+      r_split->bin = i;
+    }
+  }
+
+  return r_split->bin != 0;
+}
+
+/* Returns the index of the first element on the right of the partition,
+ * the bounds of the centroids on both sides are returned too. */
+static int partition_indices_sah(
+    int *prim_indices, int lo, int hi, const SAHSplit *split, const BBC *prim_bbc, BB r_cb[2])
+{
+  int i = lo, j = hi;
+
+  BB_reset(&r_cb[0]);
+  BB_reset(&r_cb[1]);
+
+  /* Both sides are known to be non-empty, so the scans can't run out of the range.
+   * Every primitive is passed over by exactly one of the scans, or swapped. */
+  for (;;) {
+    for (; sah_bin_index(split, &prim_bbc[prim_indices[i]]) < split->bin; i++) {
+      BB_expand(&r_cb[0], prim_bbc[prim_indices[i]].bcentroid);
+    }
+    for (; sah_bin_index(split, &prim_bbc[prim_indices[j]]) >= split->bin; j--) {
+      BB_expand(&r_cb[1], prim_bbc[prim_indices[j]].bcentroid);
+    }
+
+    if (!(i < j)) {
+      return i;
+    }
+
+    SWAP(int, prim_indices[i], prim_indices[j]);
+    BB_expand(&r_cb[0], prim_bbc[prim_indices[i]].bcentroid);
+    BB_expand(&r_cb[1], prim_bbc[prim_indices[j]].bcentroid);
+    i++;
+    j--;
+  }
+}
+
 /* Recursively build a node in the tree
  *
  * vb is the voxel box around all of the primitives contained in
@@ -483,6 +632,8 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc, int offs
 {
   int end;
   BB cb_backing;
+  BB cb_children[2];
+  bool has_cb_children = false;
 
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = count <= bvh->leaf_limit;
@@ -501,7 +652,6 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc, int offs
   update_vb(bvh, &bvh->nodes[node_index], prim_bbc, offset, count);
 
   if (!below_leaf_limit) {
-    /* Find axis with widest range of primitive centroids */
     if (!cb) {
       cb = &cb_backing;
       BB_reset(cb);
@@ -509,15 +659,24 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc, int offs
         BB_expand(cb, prim_bbc[bvh->prim_indices[i]].bcentroid);
       }
     }
-    const int axis = BB_widest_axis(cb);
 
-    /* Partition primitives along that axis */
-    end = partition_indices(bvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+    SAHSplit split;
+    if (sah_split_find(bvh, prim_bbc, cb, offset, count, &split)) {
+      end = partition_indices_sah(
+          bvh->prim_indices, offset, offset + count - 1, &split, prim_bbc, cb_children);
+      has_cb_children = true;
+    }
+    else {
+      /* All centroids are (nearly) at the same position, split at the middle of the widest
+       * axis of their bounds, which divides the primitives evenly in that case. */
+      const int axis = BB_widest_axis(cb);
+      end = partition_indices(bvh->prim_indices,
+                              offset,
+                              offset + count - 1,
+                              axis,
+                              (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
+                              prim_bbc);
+    }
   }
   else {
     /* Partition primitives by material */
@@ -525,9 +684,93 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc, int offs
   }
 
   /* Build children */
-  build_sub(bvh, bvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(
-      bvh, bvh->nodes[node_index].children_offset + 1, NULL, prim_bbc, end, offset + count - end);
+  build_sub(bvh,
+            bvh->nodes[node_index].children_offset,
+            has_cb_children ? &cb_children[0] : NULL,
+            prim_bbc,
+            offset,
+            end - offset);
+  build_sub(bvh,
+            bvh->nodes[node_index].children_offset + 1,
+            has_cb_children ? &cb_children[1] : NULL,
+            prim_bbc,
+            end,
+            offset + count - end);
+}
+
+typedef struct PBVHBuildLeafData {
+  PBVH *bvh;
+  const int *leaf_indices;
+} PBVHBuildLeafData;
+
+/* Give every vertex to the first leaf using it, so the result doesn't depend on threading. */
+static void pbvh_build_vert_owner_task_cb(void *__restrict userdata,
+                                          const int n,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeafData *data = userdata;
+  PBVH *bvh = data->bvh;
+  const int node_index = data->leaf_indices[n];
+  const PBVHNode *node = &bvh->nodes[node_index];
+  const int totface = node->totprim;
+
+  for (int i = 0; i < totface; i++) {
+    const MLoopTri *lt = &bvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      int *owner = &bvh->vert_owner[bvh->mloop[lt->tri[j]].v];
+      int owner_prev = *owner;
+      while (node_index < owner_prev) {
+        const int owner_found = atomic_cas_int32(owner, owner_prev, node_index);
+        if (owner_found == owner_prev) {
+          break;
+        }
+        owner_prev = owner_found;
+      }
+    }
+  }
+}
+
+static void pbvh_build_leaf_task_cb(void *__restrict userdata,
+                                    const int n,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeafData *data = userdata;
+  PBVH *bvh = data->bvh;
+  PBVHNode *node = &bvh->nodes[data->leaf_indices[n]];
+
+  if (bvh->looptri) {
+    build_mesh_leaf_node(bvh, node);
+  }
+  else {
+    build_grid_leaf_node(bvh, node);
+  }
+}
+
+static void pbvh_build_leaf_nodes(PBVH *bvh)
+{
+  int *leaf_indices = MEM_mallocN(sizeof(int) * bvh->totnode, __func__);
+  int totleaf = 0;
+  for (int i = 0; i < bvh->totnode; i++) {
+    if (bvh->nodes[i].flag & PBVH_Leaf) {
+      leaf_indices[totleaf++] = i;
+    }
+  }
+
+  PBVHBuildLeafData data = {
+      .bvh = bvh,
+      .leaf_indices = leaf_indices,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totleaf);
+
+  if (bvh->looptri) {
+    copy_vn_i(bvh->vert_owner, bvh->totvert, INT_MAX);
+    BLI_task_parallel_range(0, totleaf, &data, pbvh_build_vert_owner_task_cb, &settings);
+  }
+  BLI_task_parallel_range(0, totleaf, &data, pbvh_build_leaf_task_cb, &settings);
+
+  MEM_freeN(leaf_indices);
 }
 
 static void pbvh_build(PBVH *bvh, BB *cb, BBC *prim_bbc, int totprim)
@@ -553,6 +796,54 @@ static void pbvh_build(PBVH *bvh, BB *cb, BBC *prim_bbc, int totprim)
 
   bvh->totnode = 1;
   build_sub(bvh, 0, cb, prim_bbc, 0, totprim);
+  pbvh_build_leaf_nodes(bvh);
+}
+
+typedef struct PBVHBuildPrimBBData {
+  PBVH *bvh;
+  BBC *prim_bbc;
+} PBVHBuildPrimBBData;
+
+static void pbvh_build_mesh_prim_bb_task_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildPrimBBData *data = userdata;
+  PBVH *bvh = data->bvh;
+  const MLoopTri *lt = &bvh->looptri[i];
+  const int sides = 3;
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < sides; j++) {
+    BB_expand((BB *)bbc, bvh->verts[bvh->mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void pbvh_build_grids_prim_bb_task_cb(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildPrimBBData *data = userdata;
+  PBVH *bvh = data->bvh;
+  const CCGKey *key = &bvh->gridkey;
+  CCGElem *grid = bvh->grids[i];
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
 }
 
 /**
@@ -582,7 +873,8 @@ void BKE_pbvh_build_mesh(PBVH *bvh,
   bvh->mloop = mloop;
   bvh->looptri = looptri;
   bvh->verts = verts;
-  bvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
+  bvh->vert_owner = MEM_mallocN(sizeof(int) * totvert, "bvh->vert_owner");
+  MEM_SAFE_FREE(bvh->vert_normals_accum);
   bvh->totvert = totvert;
   bvh->leaf_limit = LEAF_LIMIT;
   bvh->vdata = vdata;
@@ -597,28 +889,24 @@ void BKE_pbvh_build_mesh(PBVH *bvh,
   /* For each face, store the AABB and the AABB centroid */
   prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[bvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
+  PBVHBuildPrimBBData data = {
+      .bvh = bvh,
+      .prim_bbc = prim_bbc,
+  };
 
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  TaskParallelSettings settings;
+  pbvh_build_parallel_range_settings(&settings, bvh, looptri_num);
+  settings.userdata_chunk = &cb;
+  settings.userdata_chunk_size = sizeof(cb);
+  settings.func_reduce = pbvh_build_bb_reduce;
+  BLI_task_parallel_range(0, looptri_num, &data, pbvh_build_mesh_prim_bb_task_cb, &settings);
 
   if (looptri_num) {
     pbvh_build(bvh, &cb, prim_bbc, looptri_num);
   }
 
   MEM_freeN(prim_bbc);
-  MEM_freeN(bvh->vert_bitmap);
+  MEM_SAFE_FREE(bvh->vert_owner);
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -647,20 +935,17 @@ void BKE_pbvh_build_grids(PBVH *bvh,
   /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
 
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
+  PBVHBuildPrimBBData data = {
+      .bvh = bvh,
+      .prim_bbc = prim_bbc,
+  };
 
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  TaskParallelSettings settings;
+  pbvh_build_parallel_range_settings(&settings, bvh, totgrid);
+  settings.userdata_chunk = &cb;
+  settings.userdata_chunk_size = sizeof(cb);
+  settings.func_reduce = pbvh_build_bb_reduce;
+  BLI_task_parallel_range(0, totgrid, &data, pbvh_build_grids_prim_bb_task_cb, &settings);
 
   if (totgrid) {
     pbvh_build(bvh, &cb, prim_bbc, totgrid);
@@ -723,6 +1008,8 @@ void BKE_pbvh_free(PBVH *bvh)
     MEM_freeN(bvh->prim_indices);
   }
 
+  MEM_SAFE_FREE(bvh->vert_normals_accum);
+
   MEM_freeN(bvh);
 }
 
@@ -1018,6 +1305,28 @@ typedef struct PBVHUpdateData {
   bool show_sculpt_face_sets;
 } PBVHUpdateData;
 
+static void pbvh_update_normals_clear_task_cb(void *__restrict userdata,
+                                              const int n,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHUpdateData *data = userdata;
+  PBVH *bvh = data->bvh;
+  PBVHNode *node = data->nodes[n];
+  float(*vnors)[3] = data->vnors;
+
+  if (node->flag & PBVH_UpdateNormals) {
+    const int *verts = node->vert_indices;
+    const int totvert = node->uniq_verts;
+
+    for (int i = 0; i < totvert; i++) {
+      const int v = verts[i];
+      if (bvh->verts[v].flag & ME_VERT_PBVH_UPDATE) {
+        zero_v3(vnors[v]);
+      }
+    }
+  }
+}
+
 static void pbvh_update_normals_accum_task_cb(void *__restrict userdata,
                                               const int n,
                                               const TaskParallelTLS *__restrict UNUSED(tls))
@@ -1101,8 +1410,14 @@ static void pbvh_update_normals_store_task_cb(void *__restrict userdata,
 static void pbvh_faces_update_normals(PBVH *bvh, PBVHNode **nodes, int totnode)
 {
   /* could be per node to save some memory, but also means
-   * we have to store for each vertex which node it is in */
-  float(*vnors)[3] = MEM_callocN(sizeof(*vnors) * bvh->totvert, __func__);
+   * we have to store for each vertex which node it is in.
+   * Kept between updates and only cleared for the updated vertices,
+   * so the cost of an update depends on the modified nodes only. */
+  if (bvh->vert_normals_accum == NULL) {
+    bvh->vert_normals_accum = MEM_mallocN(sizeof(*bvh->vert_normals_accum) * bvh->totvert,
+                                          __func__);
+  }
+  float(*vnors)[3] = bvh->vert_normals_accum;
 
   /* subtle assumptions:
    * - We know that for all edited vertices, the nodes with faces
@@ -1112,6 +1427,9 @@ static void pbvh_faces_update_normals(PBVH *bvh, PBVHNode **nodes, int totnode)
    * - However this is only true for the vertices that have actually been
    *   edited, not for all vertices in the nodes marked for update, so we
    *   can only update vertices marked with ME_VERT_PBVH_UPDATE.
+   * - Every vertex is unique to exactly one node, which has faces adjacent
+   *   to it, so clearing the unique vertices of the marked nodes clears all
+   *   accumulated normals which are stored afterwards.
    */
 
   PBVHUpdateData data = {
@@ -1123,10 +1441,9 @@ static void pbvh_faces_update_normals(PBVH *bvh, PBVHNode **nodes, int totnode)
   TaskParallelSettings settings;
   BKE_pbvh_parallel_range_settings(&settings, true, totnode);
 
+  BLI_task_parallel_range(0, totnode, &data, pbvh_update_normals_clear_task_cb, &settings);
   BLI_task_parallel_range(0, totnode, &data, pbvh_update_normals_accum_task_cb, &settings);
   BLI_task_parallel_range(0, totnode, &data, pbvh_update_normals_store_task_cb, &settings);
-
-  MEM_freeN(vnors);
 }
 
 static void pbvh_update_mask_redraw_task_cb(void *__restrict userdata,
@@ -1707,36 +2024,46 @@ BMesh *BKE_pbvh_get_bmesh(PBVH *bvh)
 
 /***************************** Node Access ***********************************/
 
+/* Nodes may be tagged from multiple threads at once, e.g. by brushes affecting neighboring
+ * vertices, so the tags are set atomically instead of under a lock. */
+BLI_INLINE void pbvh_node_flag_enable(PBVHNode *node, const PBVHNodeFlags flag)
+{
+  atomic_fetch_and_or_uint32((uint32_t *)&node->flag, (uint32_t)flag);
+}
+
 void BKE_pbvh_node_mark_update(PBVHNode *node)
 {
-  node->flag |= PBVH_UpdateNormals | PBVH_UpdateBB | PBVH_UpdateOriginalBB |
-                PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw;
+  pbvh_node_flag_enable(node,
+                        PBVH_UpdateNormals | PBVH_UpdateBB | PBVH_UpdateOriginalBB |
+                            PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw);
 }
 
 void BKE_pbvh_node_mark_update_mask(PBVHNode *node)
 {
-  node->flag |= PBVH_UpdateMask | PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw;
+  pbvh_node_flag_enable(node, PBVH_UpdateMask | PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw);
 }
 
 void BKE_pbvh_node_mark_update_visibility(PBVHNode *node)
 {
-  node->flag |= PBVH_UpdateVisibility | PBVH_RebuildDrawBuffers | PBVH_UpdateDrawBuffers |
-                PBVH_UpdateRedraw;
+  pbvh_node_flag_enable(node,
+                        PBVH_UpdateVisibility | PBVH_RebuildDrawBuffers |
+                            PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw);
 }
 
 void BKE_pbvh_node_mark_rebuild_draw(PBVHNode *node)
 {
-  node->flag |= PBVH_RebuildDrawBuffers | PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw;
+  pbvh_node_flag_enable(node,
+                        PBVH_RebuildDrawBuffers | PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw);
 }
 
 void BKE_pbvh_node_mark_redraw(PBVHNode *node)
 {
-  node->flag |= PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw;
+  pbvh_node_flag_enable(node, PBVH_UpdateDrawBuffers | PBVH_UpdateRedraw);
 }
 
 void BKE_pbvh_node_mark_normals_update(PBVHNode *node)
 {
-  node->flag |= PBVH_UpdateNormals;
+  pbvh_node_flag_enable(node, PBVH_UpdateNormals);
 }
 
 void BKE_pbvh_node_fully_hidden_set(PBVHNode *node, int fully_hidden)
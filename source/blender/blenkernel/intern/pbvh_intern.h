@@ -86,8 +86,9 @@ struct PBVHNode {
   const int (*face_vert_indices)[3];
 
   /* Indicates whether this node is a leaf or not; also used for
-   * marking various updates that need to be applied. */
-  PBVHNodeFlags flag : 16;
+   * marking various updates that need to be applied.
+   * Not a bit-field, so update tags can be set atomically from multiple threads. */
+  PBVHNodeFlags flag;
 
   /* Used for raycasting: how close bb is to the ray point. */
   float tmin;
@@ -149,8 +150,13 @@ struct PBVH {
   BLI_bitmap **grid_hidden;
 
   /* Only used during BVH build and update,
-   * don't need to remain valid after */
-  BLI_bitmap *vert_bitmap;
+   * don't need to remain valid after.
+   * Index of the leaf node which has the vertex in its unique vertices. */
+  int *vert_owner;
+
+  /* Vertex normals accumulated from the faces of nodes tagged for a normals update,
+   * only the entries of updated vertices are valid. */
+  float (*vert_normals_accum)[3];
 
 #ifdef PERFCNTRS
   int perf_modified;
@@ -100,6 +100,7 @@
 /* needed for directory lookup */
 #ifndef WIN32
 #  include <dirent.h>
+#  include <sys/mman.h>
 #else
 #  include "BLI_winstuff.h"
 #endif
@@ -152,11 +153,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
   int error = 0;
 
   /* Custom functions should read these basic elements too! */
-  if (!error && !fread(&pf->totpoint, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->totpoint, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
-  if (!error && !fread(&pf->data_types, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->data_types, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -2190,7 +2191,7 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
     return NULL;
   }
 
-  pf = MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
+  pf = MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
   pf->fp = fp;
   pf->old_format = 0;
   pf->frame = cfra;
@@ -2200,7 +2201,12 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 static void ptcache_file_close(PTCacheFile *pf)
 {
   if (pf) {
-    fclose(pf->fp);
+    if (pf->fp) {
+      fclose(pf->fp);
+    }
+    if (pf->mem_buffer) {
+      MEM_freeN(pf->mem_buffer);
+    }
     MEM_freeN(pf);
   }
 }
@@ -2327,6 +2333,16 @@ static int ptcache_file_compressed_write(
 }
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
+  if (pf->mem) {
+    const size_t len = (size_t)tot * size;
+
+    if (len > pf->mem_len - pf->mem_pos) {
+      return 0;
+    }
+    memcpy(f, pf->mem + pf->mem_pos, len);
+    pf->mem_pos += len;
+    return 1;
+  }
   return (fread(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
@@ -2367,7 +2383,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   pf->data_types = 0;
 
-  if (fread(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_read(pf, bphysics, 8, sizeof(char))) {
     error = 1;
   }
 
@@ -2375,7 +2391,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
     error = 1;
   }
 
-  if (!error && !fread(&typeflag, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &typeflag, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -2384,7 +2400,12 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   /* if there was an error set file as it was */
   if (error) {
-    BLI_fseek(pf->fp, 0, SEEK_SET);
+    if (pf->mem) {
+      pf->mem_pos = 0;
+    }
+    else {
+      BLI_fseek(pf->fp, 0, SEEK_SET);
+    }
   }
 
   return !error;
@@ -2405,6 +2426,471 @@ static int ptcache_file_header_begin_write(PTCacheFile *pf)
   return 1;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Single File Disk Cache
+ *
+ * With #PTCACHE_DISK_SINGLE_FILE all the frames of a cache are stored in one file,
+ * instead of one `.bphys` file per frame.
+ * Each frame is stored like a `.bphys` file, one after the other, followed by the index
+ * of the frames. Writing a frame overwrites the index and writes it again after the frame,
+ * the header at the start of the file points to the current index.
+ *
+ * Frames are read from the file mapped in memory, so jumping to any frame only needs
+ * a lookup in the index. The space of removed or re-written frames is only reused when
+ * the frames at the end of the file are removed.
+ * \{ */
+
+#define PTCACHE_ARCHIVE_VERSION 1
+
+typedef struct PTCacheArchiveHeader {
+  char id[8];
+  unsigned int version;
+  unsigned int type;
+  /** Changed on every write, starting from a different value for every new file. */
+  unsigned int generation;
+  unsigned int frames_len;
+  uint64_t index_offset;
+} PTCacheArchiveHeader;
+
+typedef struct PTCacheArchiveFrame {
+  int frame;
+  unsigned int size;
+  uint64_t offset;
+} PTCacheArchiveFrame;
+
+/** Runtime data of #PointCache.archive, the index is reloaded when the header changed. */
+typedef struct PTCacheArchive {
+  PTCacheArchiveHeader header;
+  /** Sorted by frame. */
+  PTCacheArchiveFrame *frames;
+  /** The start of the file, up to the index when it was mapped. */
+  unsigned char *map;
+  size_t map_len;
+} PTCacheArchive;
+
+static bool ptcache_archive_supported(const PTCacheID *pid)
+{
+  return pid->file_type == PTCACHE_FILE_PTCACHE && pid->write_stream == NULL &&
+         (pid->cache->flag & PTCACHE_EXTERNAL) == 0;
+}
+
+/* Doesn't check #PTCACHE_DISK_CACHE, which is toggled before the cache is converted. */
+static bool ptcache_use_archive(const PTCacheID *pid)
+{
+  return (pid->cache->flag & PTCACHE_DISK_SINGLE_FILE) && ptcache_archive_supported(pid);
+}
+
+static int ptcache_archive_filename(PTCacheID *pid, char *filename)
+{
+  int len = ptcache_filename(pid, filename, 0, 1, 0);
+
+  if (len == 0) {
+    return 0;
+  }
+
+  if (pid->cache->index < 0) {
+    pid->cache->index = pid->stack_index = BKE_object_insert_ptcache(pid->ob);
+  }
+
+  return len + BLI_snprintf(filename + len,
+                            MAX_PTCACHE_FILE - len,
+                            "_%02u" PTCACHE_ARCHIVE_EXT,
+                            pid->stack_index);
+}
+
+static void ptcache_archive_unmap(PTCacheArchive *archive)
+{
+#ifndef WIN32
+  if (archive->map) {
+    munmap(archive->map, archive->map_len);
+  }
+#endif
+  archive->map = NULL;
+  archive->map_len = 0;
+}
+
+static void ptcache_archive_free(PointCache *cache)
+{
+  PTCacheArchive *archive = cache->archive;
+
+  if (archive) {
+    ptcache_archive_unmap(archive);
+    MEM_SAFE_FREE(archive->frames);
+    MEM_freeN(archive);
+    cache->archive = NULL;
+  }
+}
+
+static bool ptcache_archive_header_read(FILE *fp,
+                                        const PTCacheID *pid,
+                                        PTCacheArchiveHeader *r_header)
+{
+  return fread(r_header, sizeof(*r_header), 1, fp) == 1 &&
+         STREQLEN(r_header->id, "BPHYSARC", 8) &&
+         r_header->version == PTCACHE_ARCHIVE_VERSION && r_header->type == pid->type;
+}
+
+/**
+ * Get the index of the frames in the file, loading it again if the file changed.
+ * \return NULL when there is no valid file.
+ */
+static PTCacheArchive *ptcache_archive_get(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  PTCacheArchive *archive = cache->archive;
+  PTCacheArchiveHeader header;
+  char filename[MAX_PTCACHE_FILE];
+  FILE *fp = NULL;
+
+  if (ptcache_archive_filename(pid, filename)) {
+    fp = BLI_fopen(filename, "rb");
+  }
+
+  if (fp == NULL || !ptcache_archive_header_read(fp, pid, &header)) {
+    if (fp) {
+      fclose(fp);
+    }
+    ptcache_archive_free(cache);
+    return NULL;
+  }
+
+  if (archive && memcmp(&archive->header, &header, sizeof(header)) == 0) {
+    fclose(fp);
+    return archive;
+  }
+
+  if (archive == NULL) {
+    archive = cache->archive = MEM_callocN(sizeof(PTCacheArchive), "PTCacheArchive");
+  }
+  ptcache_archive_unmap(archive);
+  MEM_SAFE_FREE(archive->frames);
+
+  archive->header = header;
+  archive->frames = MEM_malloc_arrayN(
+      MAX2(header.frames_len, 1), sizeof(PTCacheArchiveFrame), "PTCacheArchiveFrame");
+
+  if (BLI_fseek(fp, (int64_t)header.index_offset, SEEK_SET) != 0 ||
+      fread(archive->frames, sizeof(PTCacheArchiveFrame), header.frames_len, fp) !=
+          header.frames_len) {
+    fclose(fp);
+    ptcache_archive_free(cache);
+    return NULL;
+  }
+
+  fclose(fp);
+  return archive;
+}
+
+static const PTCacheArchiveFrame *ptcache_archive_frame_find(const PTCacheArchive *archive,
+                                                             int cfra)
+{
+  int low = 0, high = (int)archive->header.frames_len - 1;
+
+  while (low <= high) {
+    const int mid = (low + high) / 2;
+
+    if (archive->frames[mid].frame < cfra) {
+      low = mid + 1;
+    }
+    else if (archive->frames[mid].frame > cfra) {
+      high = mid - 1;
+    }
+    else {
+      return &archive->frames[mid];
+    }
+  }
+  return NULL;
+}
+
+static bool ptcache_archive_frame_exists(PTCacheID *pid, int cfra)
+{
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+
+  return archive && ptcache_archive_frame_find(archive, cfra);
+}
+
+/* Open a frame for reading, from the mapped file when possible. */
+static PTCacheFile *ptcache_archive_frame_open(PTCacheID *pid, int cfra)
+{
+  PTCacheArchive *archive = ptcache_archive_get(pid);
+  const PTCacheArchiveFrame *frame = archive ? ptcache_archive_frame_find(archive, cfra) : NULL;
+  char filename[MAX_PTCACHE_FILE];
+  PTCacheFile *pf;
+  FILE *fp;
+
+  if (frame == NULL) {
+    return NULL;
+  }
+
+  pf = MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
+  pf->frame = cfra;
+  pf->mem_len = frame->size;
+
+  if (archive->map && frame->offset + frame->size <= archive->map_len) {
+    pf->mem = archive->map + frame->offset;
+    return pf;
+  }
+
+  ptcache_archive_filename(pid, filename);
+  fp = BLI_fopen(filename, "rb");
+  if (fp == NULL) {
+    MEM_freeN(pf);
+    return NULL;
+  }
+
+#ifndef WIN32
+  /* Map everything written before the index, the frames written later are mapped again. */
+  ptcache_archive_unmap(archive);
+  void *map = mmap(NULL, archive->header.index_offset, PROT_READ, MAP_SHARED, fileno(fp), 0);
+  if (map != MAP_FAILED) {
+    archive->map = map;
+    archive->map_len = archive->header.index_offset;
+    pf->mem = archive->map + frame->offset;
+    fclose(fp);
+    return pf;
+  }
+#endif
+
+  /* Read the frame in memory. */
+  pf->mem_buffer = MEM_mallocN(MAX2(frame->size, 1), "PTCacheFile mem_buffer");
+  if (BLI_fseek(fp, (int64_t)frame->offset, SEEK_SET) != 0 ||
+      fread(pf->mem_buffer, 1, frame->size, fp) != frame->size) {
+    fclose(fp);
+    ptcache_file_close(pf);
+    return NULL;
+  }
+  pf->mem = pf->mem_buffer;
+  fclose(fp);
+  return pf;
+}
+
+/* Write the index after the frames, and then the header pointing to it. */
+static bool ptcache_archive_index_write(FILE *fp, PTCacheArchive *archive)
+{
+  archive->header.generation++;
+
+  return BLI_fseek(fp, (int64_t)archive->header.index_offset, SEEK_SET) == 0 &&
+         fwrite(archive->frames,
+                sizeof(PTCacheArchiveFrame),
+                archive->header.frames_len,
+                fp) == archive->header.frames_len &&
+         BLI_fseek(fp, 0, SEEK_SET) == 0 &&
+         fwrite(&archive->header, sizeof(archive->header), 1, fp) == 1;
+}
+
+/**
+ * Open the file to write a frame, creating it if needed.
+ * The frame is written where the index is, #ptcache_archive_frame_write_end writes it again.
+ */
+static PTCacheFile *ptcache_archive_frame_write_begin(PTCacheID *pid, int cfra)
+{
+  PTCacheArchive *archive;
+  char filename[MAX_PTCACHE_FILE];
+  PTCacheFile *pf;
+  FILE *fp;
+
+#ifndef DURIAN_POINTCACHE_LIB_OK
+  /* don't allow writing for linked objects */
+  if (pid->ob->id.lib) {
+    return NULL;
+  }
+#endif
+
+  if (!ptcache_archive_filename(pid, filename)) {
+    return NULL;
+  }
+
+  archive = ptcache_archive_get(pid);
+
+  if (archive) {
+    fp = BLI_fopen(filename, "rb+");
+  }
+  else {
+    /* Will create the dir if needs be, same as "//textures" is created. */
+    BLI_make_existing_file(filename);
+    fp = BLI_fopen(filename, "wb+");
+
+    if (fp) {
+      archive = pid->cache->archive = MEM_callocN(sizeof(PTCacheArchive), "PTCacheArchive");
+      memcpy(archive->header.id, "BPHYSARC", 8);
+      archive->header.version = PTCACHE_ARCHIVE_VERSION;
+      archive->header.type = pid->type;
+      archive->header.generation = (unsigned int)(PIL_check_seconds_timer() * 1000.0);
+      archive->header.index_offset = sizeof(PTCacheArchiveHeader);
+      archive->frames = MEM_mallocN(sizeof(PTCacheArchiveFrame), "PTCacheArchiveFrame");
+
+      if (!ptcache_archive_index_write(fp, archive)) {
+        fclose(fp);
+        fp = NULL;
+      }
+    }
+  }
+
+  if (fp == NULL || BLI_fseek(fp, (int64_t)archive->header.index_offset, SEEK_SET) != 0) {
+    if (fp) {
+      fclose(fp);
+    }
+    return NULL;
+  }
+
+  pf = MEM_callocN(sizeof(PTCacheFile), "PTCacheFile");
+  pf->fp = fp;
+  pf->frame = cfra;
+
+  return pf;
+}
+
+/* Add the frame written in \a pf to the index (unless there was an error) and close the file. */
+static bool ptcache_archive_frame_write_end(PTCacheID *pid, PTCacheFile *pf, bool error)
+{
+  PTCacheArchive *archive = pid->cache->archive;
+  const uint64_t offset = archive->header.index_offset;
+  const int64_t end = BLI_ftell(pf->fp);
+
+  if (!error && end > (int64_t)offset) {
+    PTCacheArchiveFrame *frames = archive->frames;
+    unsigned int frames_len = archive->header.frames_len;
+    PTCacheArchiveFrame *frame = (PTCacheArchiveFrame *)ptcache_archive_frame_find(archive,
+                                                                                  pf->frame);
+
+    if (frame == NULL) {
+      /* Insert the frame sorted, usually at the end. */
+      unsigned int i = frames_len;
+
+      frames = MEM_reallocN(frames, sizeof(PTCacheArchiveFrame) * (frames_len + 1));
+      while (i > 0 && frames[i - 1].frame > pf->frame) {
+        frames[i] = frames[i - 1];
+        i--;
+      }
+      frame = &frames[i];
+      frame->frame = pf->frame;
+
+      archive->frames = frames;
+      archive->header.frames_len = frames_len + 1;
+    }
+
+    /* A re-written frame leaves its previous data unused in the file. */
+    frame->offset = offset;
+    frame->size = (unsigned int)(end - (int64_t)offset);
+    archive->header.index_offset = (uint64_t)end;
+  }
+  else {
+    error = true;
+  }
+
+  /* The index was overwritten by the frame, write it in any case. */
+  if (!ptcache_archive_index_write(pf->fp, archive)) {
+    error = true;
+  }
+
+  ptcache_file_close(pf);
+
+  if (error) {
+    /* Read the index from the file again when it's needed. */
+    ptcache_archive_free(pid->cache);
+  }
+
+  return !error;
+}
+
+/* Remove frames from the index, or the file with #PTCACHE_CLEAR_ALL. */
+static void ptcache_archive_clear(PTCacheID *pid, int mode, int cfra)
+{
+  PTCacheArchive *archive;
+  char filename[MAX_PTCACHE_FILE];
+  unsigned int i, frames_len = 0;
+  uint64_t index_offset = sizeof(PTCacheArchiveHeader);
+  FILE *fp;
+
+  if (!ptcache_archive_filename(pid, filename)) {
+    return;
+  }
+
+  if (mode == PTCACHE_CLEAR_ALL) {
+    ptcache_archive_free(pid->cache);
+    if (BLI_exists(filename)) {
+      BLI_delete(filename, false, false);
+    }
+    return;
+  }
+
+  archive = ptcache_archive_get(pid);
+  if (archive == NULL) {
+    return;
+  }
+
+  for (i = 0; i < archive->header.frames_len; i++) {
+    const PTCacheArchiveFrame *frame = &archive->frames[i];
+
+    if ((mode == PTCACHE_CLEAR_BEFORE && frame->frame < cfra) ||
+        (mode == PTCACHE_CLEAR_AFTER && frame->frame > cfra) ||
+        (mode == PTCACHE_CLEAR_FRAME && frame->frame == cfra)) {
+      continue;
+    }
+    index_offset = MAX2(index_offset, frame->offset + frame->size);
+    archive->frames[frames_len++] = *frame;
+  }
+
+  if (frames_len == archive->header.frames_len) {
+    return;
+  }
+
+  /* Reuse the space after the remaining frames, it may already be mapped. */
+  if (index_offset < archive->header.index_offset) {
+    ptcache_archive_unmap(archive);
+  }
+  archive->header.frames_len = frames_len;
+  archive->header.index_offset = index_offset;
+
+  fp = BLI_fopen(filename, "rb+");
+  if (fp == NULL || !ptcache_archive_index_write(fp, archive)) {
+    ptcache_archive_free(pid->cache);
+  }
+  if (fp) {
+    fclose(fp);
+  }
+}
+
+/**
+ * Store the bytes of the elements by significance, each as difference to the same byte of the
+ * previous element. The high bytes of floats of nearby points are often equal,
+ * which makes the data compress much better.
+ */
+static void ptcache_data_shuffle_encode(const unsigned char *in,
+                                        unsigned char *out,
+                                        unsigned int tot,
+                                        unsigned int size)
+{
+  for (unsigned int b = 0; b < size; b++) {
+    unsigned char *plane = out + (size_t)b * tot;
+    unsigned char prev = 0;
+
+    for (unsigned int i = 0; i < tot; i++) {
+      const unsigned char value = in[(size_t)i * size + b];
+      plane[i] = (unsigned char)(value - prev);
+      prev = value;
+    }
+  }
+}
+
+static void ptcache_data_shuffle_decode(const unsigned char *in,
+                                        unsigned char *out,
+                                        unsigned int tot,
+                                        unsigned int size)
+{
+  for (unsigned int b = 0; b < size; b++) {
+    const unsigned char *plane = in + (size_t)b * tot;
+    unsigned char value = 0;
+
+    for (unsigned int i = 0; i < tot; i++) {
+      value = (unsigned char)(value + plane[i]);
+      out[(size_t)i * size + b] = value;
+    }
+  }
+}
+
+/** \} */
+
 /* Data pointer handling */
 int BKE_ptcache_data_size(int data_type)
 {
@@ -2627,7 +3113,8 @@ static void ptcache_find_frames_around(PTCacheID *pid, unsigned int frame, int *
 
 static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 {
-  PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
+  PTCacheFile *pf = ptcache_use_archive(pid) ? ptcache_archive_frame_open(pid, cfra) :
+                                               ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
   PTCacheMem *pm = NULL;
   unsigned int i, error = 0;
 
@@ -2656,7 +3143,16 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
       for (i = 0; i < BPHYS_TOT_DATA; i++) {
         unsigned int out_len = pm->totpoint * ptcache_data_size[i];
         if (pf->data_types & (1 << i)) {
-          ptcache_file_compressed_read(pf, (unsigned char *)(pm->data[i]), out_len);
+          if (pf->flag & PTCACHE_TYPEFLAG_SHUFFLE) {
+            unsigned char *in = MEM_mallocN(MAX2(out_len, 1), "pointcache_shuffle_buffer");
+            ptcache_file_compressed_read(pf, in, out_len);
+            ptcache_data_shuffle_decode(
+                in, (unsigned char *)(pm->data[i]), pm->totpoint, ptcache_data_size[i]);
+            MEM_freeN(in);
+          }
+          else {
+            ptcache_file_compressed_read(pf, (unsigned char *)(pm->data[i]), out_len);
+          }
         }
       }
     }
@@ -2719,11 +3215,18 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 {
   PTCacheFile *pf = NULL;
+  const bool use_archive = ptcache_use_archive(pid);
   unsigned int i, error = 0;
 
-  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
+  if (use_archive) {
+    /* Replaces the frame in the index when it's written. */
+    pf = ptcache_archive_frame_write_begin(pid, pm->frame);
+  }
+  else {
+    BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_FRAME, pm->frame);
 
-  pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, pm->frame);
+    pf = ptcache_file_open(pid, PTCACHE_FILE_WRITE, pm->frame);
+  }
 
   if (pf == NULL) {
     if (G.debug & G_DEBUG) {
@@ -2743,6 +3246,10 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 
   if (pid->cache->compression) {
     pf->flag |= PTCACHE_TYPEFLAG_COMPRESS;
+
+    if (use_archive) {
+      pf->flag |= PTCACHE_TYPEFLAG_SHUFFLE;
+    }
   }
 
   if (!ptcache_file_header_begin_write(pf) || !pid->write_header(pf)) {
@@ -2756,8 +3263,17 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
           unsigned int in_len = pm->totpoint * ptcache_data_size[i];
           unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
                                                             "pointcache_lzo_buffer");
-          ptcache_file_compressed_write(
-              pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
+          if (pf->flag & PTCACHE_TYPEFLAG_SHUFFLE) {
+            unsigned char *in = MEM_mallocN(MAX2(in_len, 1), "pointcache_shuffle_buffer");
+            ptcache_data_shuffle_encode(
+                (unsigned char *)(pm->data[i]), in, pm->totpoint, ptcache_data_size[i]);
+            ptcache_file_compressed_write(pf, in, in_len, out, pid->cache->compression);
+            MEM_freeN(in);
+          }
+          else {
+            ptcache_file_compressed_write(
+                pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
+          }
           MEM_freeN(out);
         }
       }
@@ -2802,7 +3318,14 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
     }
   }
 
-  ptcache_file_close(pf);
+  if (use_archive) {
+    if (!ptcache_archive_frame_write_end(pid, pf, error != 0)) {
+      error = 1;
+    }
+  }
+  else {
+    ptcache_file_close(pf);
+  }
 
   if (error && G.debug & G_DEBUG) {
     printf("Error writing to disk cache\n");
@@ -3385,7 +3908,25 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
     case PTCACHE_CLEAR_ALL:
     case PTCACHE_CLEAR_BEFORE:
     case PTCACHE_CLEAR_AFTER:
-      if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+      if ((pid->cache->flag & PTCACHE_DISK_CACHE) && ptcache_use_archive(pid)) {
+        ptcache_archive_clear(pid, mode, cfra);
+
+        if (mode == PTCACHE_CLEAR_ALL) {
+          pid->cache->last_exact = MIN2(pid->cache->startframe, 0);
+          if (pid->cache->cached_frames) {
+            memset(pid->cache->cached_frames, 0, MEM_allocN_len(pid->cache->cached_frames));
+          }
+        }
+        else if (pid->cache->cached_frames) {
+          for (unsigned int frame = sta; frame <= end; frame++) {
+            if ((mode == PTCACHE_CLEAR_BEFORE && frame < cfra) ||
+                (mode == PTCACHE_CLEAR_AFTER && frame > cfra)) {
+              pid->cache->cached_frames[frame - sta] = 0;
+            }
+          }
+        }
+      }
+      else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
         ptcache_path(pid, path);
 
         dir = opendir(path);
@@ -3476,7 +4017,10 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 
     case PTCACHE_CLEAR_FRAME:
       if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-        if (BKE_ptcache_id_exist(pid, cfra)) {
+        if (ptcache_use_archive(pid)) {
+          ptcache_archive_clear(pid, mode, cfra);
+        }
+        else if (BKE_ptcache_id_exist(pid, cfra)) {
           ptcache_filename(pid, filename, cfra, 1, 1); /* no path */
           BLI_delete(filename, false, false);
         }
@@ -3519,6 +4063,10 @@ int BKE_ptcache_id_exist(PTCacheID *pid, int cfra)
   if (pid->cache->flag & PTCACHE_DISK_CACHE) {
     char filename[MAX_PTCACHE_FILE];
 
+    if (ptcache_use_archive(pid)) {
+      return ptcache_archive_frame_exists(pid, cfra);
+    }
+
     ptcache_filename(pid, filename, cfra, 1, 1);
 
     return BLI_exists(filename);
@@ -3586,7 +4134,18 @@ void BKE_ptcache_id_time(
     cache->cached_frames = MEM_callocN(sizeof(char) * cache->cached_frames_len,
                                        "cached frames array");
 
-    if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+    if ((pid->cache->flag & PTCACHE_DISK_CACHE) && ptcache_use_archive(pid)) {
+      PTCacheArchive *archive = ptcache_archive_get(pid);
+
+      for (unsigned int i = 0; archive && i < archive->header.frames_len; i++) {
+        const int frame = archive->frames[i].frame;
+
+        if (frame >= sta && frame <= end) {
+          cache->cached_frames[frame - sta] = 1;
+        }
+      }
+    }
+    else if (pid->cache->flag & PTCACHE_DISK_CACHE) {
       /* mode is same as fopen's modes */
       DIR *dir;
       struct dirent *de;
@@ -3798,7 +4357,8 @@ void BKE_ptcache_remove(void)
       if (FILENAME_IS_CURRPAR(de->d_name)) {
         /* do nothing */
       }
-      else if (strstr(de->d_name, PTCACHE_EXT)) { /* do we have the right extension?*/
+      else if (strstr(de->d_name, PTCACHE_EXT) || /* do we have the right extension?*/
+               strstr(de->d_name, PTCACHE_ARCHIVE_EXT)) {
         BLI_join_dirfile(path_full, sizeof(path_full), path, de->d_name);
         BLI_delete(path_full, false, false);
       }
@@ -3857,6 +4417,7 @@ void BKE_ptcache_free(PointCache *cache)
   if (cache->cached_frames) {
     MEM_freeN(cache->cached_frames);
   }
+  ptcache_archive_free(cache);
   MEM_freeN(cache);
 }
 void BKE_ptcache_free_list(ListBase *ptcaches)
@@ -3881,7 +4442,8 @@ static PointCache *ptcache_copy(PointCache *cache, const bool copy_data)
     ncache->cached_frames_len = 0;
 
     /* flag is a mix of user settings and simulator/baking state */
-    ncache->flag = ncache->flag & (PTCACHE_DISK_CACHE | PTCACHE_EXTERNAL | PTCACHE_IGNORE_LIBPATH);
+    ncache->flag = ncache->flag & (PTCACHE_DISK_CACHE | PTCACHE_DISK_SINGLE_FILE |
+                                   PTCACHE_EXTERNAL | PTCACHE_IGNORE_LIBPATH);
     ncache->simframe = 0;
   }
   else {
@@ -3909,6 +4471,7 @@ static PointCache *ptcache_copy(PointCache *cache, const bool copy_data)
 
   /* hmm, should these be copied over instead? */
   ncache->edit = NULL;
+  ncache->archive = NULL;
 
   return ncache;
 }
@@ -4297,6 +4860,61 @@ void BKE_ptcache_toggle_disk_cache(PTCacheID *pid)
     }
   }
 }
+/* Convert the disk cache files after #PTCACHE_DISK_SINGLE_FILE was toggled. */
+void BKE_ptcache_toggle_disk_single_file(PTCacheID *pid)
+{
+  PointCache *cache = pid->cache;
+  ListBase frames = {NULL, NULL};
+  PTCacheMem *pm;
+  int baked = cache->flag & PTCACHE_BAKED;
+  int last_exact = cache->last_exact;
+  int cfra;
+
+  if ((cache->flag & PTCACHE_DISK_CACHE) == 0 || !ptcache_archive_supported(pid)) {
+    return;
+  }
+
+  /* Read the frames stored the previous way. */
+  cache->flag ^= PTCACHE_DISK_SINGLE_FILE;
+
+  for (cfra = cache->startframe; cfra <= cache->endframe; cfra++) {
+    pm = ptcache_disk_frame_to_mem(pid, cfra);
+
+    if (pm) {
+      BLI_addtail(&frames, pm);
+    }
+  }
+
+  /* Remove possible bake flag to allow clear */
+  cache->flag &= ~PTCACHE_BAKED;
+  BKE_ptcache_id_clear(pid, PTCACHE_CLEAR_ALL, 0);
+
+  cache->flag ^= PTCACHE_DISK_SINGLE_FILE;
+
+  for (pm = frames.first; pm; pm = pm->next) {
+    ptcache_mem_frame_to_disk(pid, pm);
+  }
+  BKE_ptcache_free_mem(&frames);
+
+  /* restore possible bake flag */
+  cache->flag |= baked;
+
+  /* write info file */
+  if (cache->flag & PTCACHE_BAKED) {
+    BKE_ptcache_write(pid, 0);
+  }
+
+  cache->last_exact = last_exact;
+
+  if (cache->cached_frames) {
+    MEM_freeN(cache->cached_frames);
+    cache->cached_frames = NULL;
+    cache->cached_frames_len = 0;
+  }
+  BKE_ptcache_id_time(pid, NULL, 0.0f, NULL, NULL, NULL);
+
+  cache->flag |= PTCACHE_FLAG_INFO_DIRTY;
+}
 
 void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const char *name_dst)
 {
@@ -4317,6 +4935,20 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
   /* get "from" filename */
   BLI_strncpy(pid->cache->name, name_src, sizeof(pid->cache->name));
 
+  if (ptcache_use_archive(pid)) {
+    ptcache_archive_free(pid->cache);
+
+    if (ptcache_archive_filename(pid, old_path_full) && BLI_exists(old_path_full)) {
+      BLI_strncpy(pid->cache->name, name_dst, sizeof(pid->cache->name));
+      if (ptcache_archive_filename(pid, new_path_full)) {
+        BLI_rename(old_path_full, new_path_full);
+      }
+    }
+
+    BLI_strncpy(pid->cache->name, old_name, sizeof(pid->cache->name));
+    return;
+  }
+
   len = ptcache_filename(pid, old_filename, 0, 0, 0); /* no path */
 
   ptcache_path(pid, path);
@@ -4517,7 +5149,22 @@ void BKE_ptcache_update_info(PTCacheID *pid)
         }
       }
 
-      BLI_snprintf(mem_info, sizeof(mem_info), TIP_("%i frames on disk"), totframes);
+      if (ptcache_use_archive(pid)) {
+        char filename[MAX_PTCACHE_FILE];
+        char formatted_size[15];
+
+        ptcache_archive_filename(pid, filename);
+        BLI_str_format_byte_unit(formatted_size, (long long int)BLI_file_size(filename), false);
+
+        BLI_snprintf(mem_info,
+                     sizeof(mem_info),
+                     TIP_("%i frames on disk (%s)"),
+                     totframes,
+                     formatted_size);
+      }
+      else {
+        BLI_snprintf(mem_info, sizeof(mem_info), TIP_("%i frames on disk"), totframes);
+      }
     }
   }
   else {
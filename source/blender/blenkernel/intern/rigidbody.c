@@ -35,6 +35,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 
 #ifdef WITH_BULLET
 #  include "RBI_api.h"
@@ -1563,6 +1564,10 @@ static void rigidbody_update_sim_world(Scene *scene, RigidBodyWorld *rbw)
   /* update gravity, since this RNA setting is not part of RigidBody settings */
   RB_dworld_set_gravity(rbw->shared->physics_world, adj_gravity);
 
+  /* update threads, the system thread count can change between steps */
+  RB_dworld_set_num_threads(rbw->shared->physics_world,
+                            rbw->num_threads ? rbw->num_threads : BLI_system_thread_count());
+
   /* update object array in case there are changes */
   rigidbody_update_ob_array(rbw);
 }
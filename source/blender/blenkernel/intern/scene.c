@@ -316,6 +316,7 @@ static void scene_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int
   if (scene_src->ed) {
     scene_dst->ed = MEM_callocN(sizeof(*scene_dst->ed), __func__);
     scene_dst->ed->seqbasep = &scene_dst->ed->seqbase;
+    scene_dst->ed->scale_filter = scene_src->ed->scale_filter;
     BKE_sequence_base_dupli_recursive(scene_src,
                                       scene_dst,
                                       &scene_dst->ed->seqbase,
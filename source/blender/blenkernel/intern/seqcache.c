@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "CLG_log.h"
+
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_space_types.h" /* for FILE_MAX. */
@@ -44,11 +46,26 @@
 #include "BLI_path_util.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 #include "BKE_sequencer.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_HEAP_ALLOC(var, size) \
+    lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
+static CLG_LogRef LOG = {"bke.sequencer"};
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -81,24 +98,38 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data can be stored uncompressed, compressed with LZO (fast) or with Zlib using user
+ * definable level. Codec used is stored per image in its header entry.
  * Images are written in order in which they are rendered.
+ * Writing is done by background thread, so rendering is not stalled by compression and I/O.
+ * Images waiting in write queue are referenced by queue items and can be read back from there.
+ * If the queue is full, rendering threads wait until some images are written.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
  * To distinguish 2 blend files with same name, scene->ed->disk_cache_timestamp
  * is used as UID. Blend file can still be copied manually which may cause conflict.
  *
+ * Read and write latency of each image is reported by "bke.sequencer" log.
  */
 
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
+#define DCACHE_WRITE_QUEUE_MAX 16
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* DiskCacheHeaderEntry.codec */
+enum {
+  DCACHE_CODEC_NONE = 0,
+  DCACHE_CODEC_ZLIB = 1,
+  DCACHE_CODEC_LZO = 2,
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -116,8 +147,32 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /* Images waiting to be written by write thread. */
+  ListBase write_queue;
+  int write_queue_len;
+  ThreadMutex write_queue_mutex;
+  ThreadCondition write_queue_cond;
+  ListBase write_thread;
+  bool write_thread_stop;
+
+  /* Latency statistics, protected by read_write_mutex. */
+  double read_time_total;
+  double write_time_total;
+  int read_count;
+  int write_count;
 } SeqDiskCache;
 
+typedef struct DiskCacheWriteItem {
+  struct DiskCacheWriteItem *next, *prev;
+  char path[FILE_MAX];
+  /* Only used to identify items on invalidation, don't access from write thread. */
+  struct Sequence *seq;
+  int cache_type;
+  float nfra;
+  struct ImBuf *ibuf;
+} DiskCacheWriteItem;
+
 typedef struct DiskCacheFile {
   struct DiskCacheFile *next, *prev;
   char path[FILE_MAX];
@@ -138,7 +193,8 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last key put into cache by each task, so frames rendered in parallel are linked separately. */
+  struct SeqCacheKey *last_key[SEQ_TASK_MAX];
   size_t memory_used;
   SeqDiskCache *disk_cache;
 } SeqCache;
@@ -177,6 +233,7 @@ static int seq_disk_cache_compression_level(void)
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -186,6 +243,23 @@ static int seq_disk_cache_compression_level(void)
   return U.sequencer_disk_cache_compression;
 }
 
+static int seq_disk_cache_codec(void)
+{
+  switch (U.sequencer_disk_cache_compression) {
+    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+      return DCACHE_CODEC_NONE;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+#ifdef WITH_LZO
+      return DCACHE_CODEC_LZO;
+#else
+      /* Fall back to fastest Zlib level. */
+      return DCACHE_CODEC_ZLIB;
+#endif
+  }
+
+  return DCACHE_CODEC_ZLIB;
+}
+
 static size_t seq_disk_cache_size_limit(void)
 {
   return (size_t)U.sequencer_disk_cache_size_limit * (1024 * 1024 * 1024);
@@ -455,6 +529,27 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
   }
 }
 
+/* Remove images of invalidated strip from write queue, so they won't be written anymore. */
+static void seq_disk_cache_write_queue_remove_invalid(SeqDiskCache *disk_cache,
+                                                     Sequence *seq,
+                                                     int invalidate_types)
+{
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  DiskCacheWriteItem *next_item, *item = disk_cache->write_queue.first;
+  while (item) {
+    next_item = item->next;
+    if (item->seq == seq && (item->cache_type & invalidate_types)) {
+      BLI_remlink(&disk_cache->write_queue, item);
+      disk_cache->write_queue_len--;
+      IMB_freeImBuf(item->ibuf);
+      MEM_freeN(item);
+    }
+    item = next_item;
+  }
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+}
+
 static void seq_disk_cache_invalidate(Scene *scene,
                                       Sequence *seq,
                                       Sequence *seq_changed,
@@ -464,6 +559,8 @@ static void seq_disk_cache_invalidate(Scene *scene,
   int end;
   SeqDiskCache *disk_cache = scene->ed->cache->disk_cache;
 
+  seq_disk_cache_write_queue_remove_invalid(disk_cache, seq, invalidate_types);
+
   BLI_mutex_lock(&disk_cache->read_write_mutex);
 
   start = seq_changed->startdisp - DCACHE_IMAGES_PER_FILE;
@@ -474,31 +571,101 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
+static size_t seq_disk_cache_write_raw(const void *mem, size_t size, FILE *file, size_t offset)
+{
+  if (fseek(file, offset, SEEK_SET) != 0) {
+    return 0;
+  }
+  return fwrite(mem, 1, size, file) == size ? size : 0;
+}
+
+static size_t seq_disk_cache_read_raw(void *mem, size_t size, FILE *file, size_t offset)
+{
+  if (fseek(file, offset, SEEK_SET) != 0) {
+    return 0;
+  }
+  return fread(mem, 1, size, file);
+}
+
+#ifdef WITH_LZO
+static size_t seq_disk_cache_lzo_compress_to_file(const void *mem,
+                                                  size_t size,
+                                                  FILE *file,
+                                                  size_t offset)
+{
+  lzo_uint out_len = LZO_OUT_LEN(size);
+  unsigned char *out = MEM_mallocN(out_len, "seq_disk_cache_lzo_buffer");
+  LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
+  size_t bytes_written = 0;
+
+  if (lzo1x_1_compress(mem, (lzo_uint)size, out, &out_len, wrkmem) == LZO_E_OK) {
+    bytes_written = seq_disk_cache_write_raw(out, out_len, file, offset);
+  }
+
+  MEM_freeN(out);
+  return bytes_written;
+}
+
+static size_t seq_disk_cache_lzo_decompress_from_file(
+    void *mem, size_t size, FILE *file, size_t offset, size_t size_compressed)
+{
+  unsigned char *in = MEM_mallocN(size_compressed, "seq_disk_cache_lzo_buffer");
+  lzo_uint out_len = size;
+  size_t bytes_read = 0;
+
+  if (seq_disk_cache_read_raw(in, size_compressed, file, offset) == size_compressed &&
+      lzo1x_decompress_safe(in, (lzo_uint)size_compressed, mem, &out_len, NULL) == LZO_E_OK) {
+    bytes_read = out_len;
+  }
+
+  MEM_freeN(in);
+  return bytes_read;
+}
+#endif
+
 static size_t deflate_imbuf_to_file(ImBuf *ibuf,
                                     FILE *file,
                                     int level,
                                     DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
-  }
-  else {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+  void *mem = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_NONE:
+      return seq_disk_cache_write_raw(mem, header_entry->size_raw, file, header_entry->offset);
+#ifdef WITH_LZO
+    case DCACHE_CODEC_LZO:
+      return seq_disk_cache_lzo_compress_to_file(
+          mem, header_entry->size_raw, file, header_entry->offset);
+#endif
+    default:
+      return BLI_gzip_mem_to_file_at_pos(
+          mem, header_entry->size_raw, file, header_entry->offset, level);
   }
 }
 
 static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
-  }
-  else {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
-  }
+  void *mem = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_NONE:
+      return seq_disk_cache_read_raw(mem, header_entry->size_raw, file, header_entry->offset);
+    case DCACHE_CODEC_ZLIB:
+      return BLI_ungzip_file_to_mem_at_pos(
+          mem, header_entry->size_raw, file, header_entry->offset);
+#ifdef WITH_LZO
+    case DCACHE_CODEC_LZO:
+      return seq_disk_cache_lzo_decompress_from_file(mem,
+                                                     header_entry->size_raw,
+                                                     file,
+                                                     header_entry->offset,
+                                                     header_entry->size_compressed);
+#endif
+  }
+
+  /* Codec is not supported by this build. */
+  return 0;
 }
 
 static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -522,7 +689,7 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(float nfra, ImBuf *ibuf, DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -554,8 +721,9 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     header->entry[i].encoding = 0;
   }
 
+  header->entry[i].codec = seq_disk_cache_codec();
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->nfra;
+  header->entry[i].frameno = nfra;
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
@@ -584,11 +752,11 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache,
+                                      char *path,
+                                      float nfra,
+                                      ImBuf *ibuf)
 {
-  char path[FILE_MAX];
-
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
   FILE *file = BLI_fopen(path, "rb+");
@@ -603,7 +771,7 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
   seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
+  int entry_index = seq_disk_cache_add_header_entry(nfra, ibuf, &header);
   size_t bytes_written = deflate_imbuf_to_file(
       ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
 
@@ -619,6 +787,7 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
     return true;
   }
 
+  fclose(file);
   return false;
 }
 
@@ -626,6 +795,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 {
   char path[FILE_MAX];
   DiskCacheHeader header;
+  const double start_time = PIL_check_seconds_timer();
 
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
@@ -676,6 +846,129 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   seq_disk_cache_update_file(disk_cache, path);
   fclose(file);
 
+  const double time = PIL_check_seconds_timer() - start_time;
+  disk_cache->read_time_total += time;
+  disk_cache->read_count++;
+  CLOG_INFO(&LOG,
+            1,
+            "Disk cache read frame %d in %.2f ms (average %.2f ms)",
+            (int)key->nfra,
+            time * 1000.0,
+            disk_cache->read_time_total * 1000.0 / disk_cache->read_count);
+
+  return ibuf;
+}
+
+static void *seq_disk_cache_write_thread(void *data)
+{
+  SeqDiskCache *disk_cache = data;
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  while (true) {
+    DiskCacheWriteItem *item = BLI_pophead(&disk_cache->write_queue);
+
+    if (item == NULL) {
+      /* Queue is always flushed before thread ends. */
+      if (disk_cache->write_thread_stop) {
+        break;
+      }
+      BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->write_queue_mutex);
+      continue;
+    }
+
+    disk_cache->write_queue_len--;
+    /* Lock files before item leaves queue, so readers can not miss the image. */
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    BLI_condition_notify_all(&disk_cache->write_queue_cond);
+    BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+    const double start_time = PIL_check_seconds_timer();
+    if (seq_disk_cache_write_file(disk_cache, item->path, item->nfra, item->ibuf)) {
+      const double time = PIL_check_seconds_timer() - start_time;
+      disk_cache->write_time_total += time;
+      disk_cache->write_count++;
+      CLOG_INFO(&LOG,
+                1,
+                "Disk cache wrote frame %d in %.2f ms (average %.2f ms)",
+                (int)item->nfra,
+                time * 1000.0,
+                disk_cache->write_time_total * 1000.0 / disk_cache->write_count);
+    }
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    seq_disk_cache_enforce_limits(disk_cache);
+
+    IMB_freeImBuf(item->ibuf);
+    MEM_freeN(item);
+
+    BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  }
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+  return NULL;
+}
+
+static void seq_disk_cache_write_thread_start(SeqDiskCache *disk_cache)
+{
+  BLI_mutex_init(&disk_cache->write_queue_mutex);
+  BLI_condition_init(&disk_cache->write_queue_cond);
+  BLI_threadpool_init(&disk_cache->write_thread, seq_disk_cache_write_thread, 1);
+  BLI_threadpool_insert(&disk_cache->write_thread, disk_cache);
+}
+
+/* Write all queued images and end write thread. */
+static void seq_disk_cache_write_thread_end(SeqDiskCache *disk_cache)
+{
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  disk_cache->write_thread_stop = true;
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+  BLI_threadpool_end(&disk_cache->write_thread);
+  BLI_mutex_end(&disk_cache->write_queue_mutex);
+  BLI_condition_end(&disk_cache->write_queue_cond);
+}
+
+static void seq_disk_cache_write_queue_push(SeqDiskCache *disk_cache,
+                                            SeqCacheKey *key,
+                                            ImBuf *ibuf)
+{
+  DiskCacheWriteItem *item = MEM_callocN(sizeof(DiskCacheWriteItem), "DiskCacheWriteItem");
+  seq_disk_cache_get_file_path(disk_cache, key, item->path, sizeof(item->path));
+  item->seq = key->seq;
+  item->cache_type = key->type;
+  item->nfra = key->nfra;
+  item->ibuf = ibuf;
+  IMB_refImBuf(ibuf);
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  /* Don't let images pile up in memory, when storage can't keep up with rendering. */
+  while (disk_cache->write_queue_len >= DCACHE_WRITE_QUEUE_MAX) {
+    BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->write_queue_mutex);
+  }
+  BLI_addtail(&disk_cache->write_queue, item);
+  disk_cache->write_queue_len++;
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+}
+
+/* Get image, that is not written yet. */
+static ImBuf *seq_disk_cache_write_queue_get(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  char path[FILE_MAX];
+  ImBuf *ibuf = NULL;
+
+  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  LISTBASE_FOREACH (DiskCacheWriteItem *, item, &disk_cache->write_queue) {
+    if (item->nfra == key->nfra && STREQ(item->path, path)) {
+      ibuf = item->ibuf;
+      IMB_refImBuf(ibuf);
+      break;
+    }
+  }
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
   return ibuf;
 }
 
@@ -683,6 +976,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_WRITE_QUEUE_MAX
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -798,7 +1092,7 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
-    cache->last_key = key;
+    cache->last_key[key->task_id] = key;
     cache->memory_used += IMB_get_size_in_memory(ibuf);
   }
 }
@@ -1037,17 +1331,15 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_lock(&cache_create_lock);
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
-  if (cache == NULL) {
-    return;
-  }
-
-  if (cache->disk_cache != NULL) {
+  if (cache == NULL || cache->disk_cache != NULL) {
+    BLI_mutex_unlock(&cache_create_lock);
     return;
   }
 
   cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
   cache->disk_cache->bmain = bmain;
   BLI_mutex_init(&cache->disk_cache->read_write_mutex);
+  seq_disk_cache_write_thread_start(cache->disk_cache);
   seq_disk_cache_handle_versioning(cache->disk_cache);
   seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
   cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
@@ -1062,7 +1354,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1112,6 +1403,7 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
+    seq_disk_cache_write_thread_end(cache->disk_cache);
     BLI_freelistN(&cache->disk_cache->files);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
@@ -1146,7 +1438,7 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1210,7 +1502,7 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1264,9 +1556,13 @@ struct ImBuf *BKE_sequencer_cache_get(
       seq_disk_cache_create(context->bmain, context->scene);
     }
 
-    BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-    ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
-    BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
+    ibuf = seq_disk_cache_write_queue_get(cache->disk_cache, &key);
+
+    if (ibuf == NULL) {
+      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
+      ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
+      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
+    }
     if (ibuf) {
       if (key.type == SEQ_CACHE_STORE_FINAL_OUT) {
         BKE_sequencer_cache_put_if_possible(context, seq, cfra, type, ibuf, 0.0f, true);
@@ -1305,8 +1601,9 @@ bool BKE_sequencer_cache_put_if_possible(const SeqRenderData *context,
     return true;
   }
   else {
-    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-    scene->ed->cache->last_key = NULL;
+    SeqCache *cache = scene->ed->cache;
+    seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+    cache->last_key[context->task_id] = NULL;
     return false;
   }
 }
@@ -1378,27 +1675,27 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   /* Item stored for later use */
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = cache->last_key[key->task_id];
   }
 
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = cache->last_key[key->task_id];
   seq_cache_put(cache, key, i);
 
   /* Restore pointer to previous item as this one will be freed when stack is rendered. */
   if (key->is_temp_cache) {
-    cache->last_key = temp_last_key;
+    cache->last_key[key->task_id] = temp_last_key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
    * Item is already put in cache, so cache->last_key points to current key.
    */
   if (flag & type && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = cache->last_key[key->task_id];
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    cache->last_key[key->task_id] = NULL;
   }
 
   seq_cache_unlock(scene);
@@ -1409,10 +1706,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_queue_push(cache->disk_cache, key, i);
     }
   }
 }
@@ -1441,7 +1735,7 @@ void BKE_sequencer_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->nfra, key->type, key->cost);
   }
 
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -489,6 +489,7 @@ Editing *BKE_sequencer_editing_ensure(Scene *scene)
     ed->cache_flag |= SEQ_CACHE_VIEW_FINAL_OUT;
     ed->cache_flag |= SEQ_CACHE_VIEW_ENABLE;
     ed->recycle_max_cost = 10.0f;
+    ed->prefetch_threads = 1;
   }
 
   return scene->ed;
@@ -1968,6 +1969,33 @@ static ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int c
   }
 }
 
+/* Scale with the filter chosen for final renders and proxies, returns false when none is chosen
+ * and the image isn't scaled. */
+static bool seq_imbuf_scale_filtered(const Editing *ed, ImBuf *ibuf, int rectx, int recty)
+{
+  eIMBScaleFilter filter;
+
+  switch ((eSeqScaleFilter)ed->scale_filter) {
+    case SEQ_SCALE_FILTER_BOX:
+      filter = IMB_SCALE_FILTER_BOX;
+      break;
+    case SEQ_SCALE_FILTER_BILINEAR:
+      filter = IMB_SCALE_FILTER_BILINEAR;
+      break;
+    case SEQ_SCALE_FILTER_MITCHELL:
+      filter = IMB_SCALE_FILTER_MITCHELL;
+      break;
+    case SEQ_SCALE_FILTER_LANCZOS:
+      filter = IMB_SCALE_FILTER_LANCZOS;
+      break;
+    case SEQ_SCALE_FILTER_DEFAULT:
+    default:
+      return false;
+  }
+
+  return IMB_scaleImBuf_filtered(ibuf, (unsigned int)rectx, (unsigned int)recty, filter);
+}
+
 static void seq_proxy_build_frame(const SeqRenderData *context,
                                   SeqRenderState *state,
                                   Sequence *seq,
@@ -1999,7 +2027,9 @@ static void seq_proxy_build_frame(const SeqRenderData *context,
     ibuf = IMB_dupImBuf(ibuf_tmp);
     IMB_metadata_copy(ibuf, ibuf_tmp);
     IMB_freeImBuf(ibuf_tmp);
-    IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+    if (!seq_imbuf_scale_filtered(ed, ibuf, rectx, recty)) {
+      IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+    }
   }
   else {
     ibuf = ibuf_tmp;
@@ -2809,7 +2839,9 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
 
   if (ibuf->x != context->rectx || ibuf->y != context->recty) {
     if (context->for_render) {
-      IMB_scaleImBuf(ibuf, (short)context->rectx, (short)context->recty);
+      if (!seq_imbuf_scale_filtered(scene->ed, ibuf, context->rectx, context->recty)) {
+        IMB_scaleImBuf(ibuf, (short)context->rectx, (short)context->recty);
+      }
     }
     else {
       IMB_scalefastImBuf(ibuf, (short)context->rectx, (short)context->recty);
@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "BKE_subdiv_adaptive.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_math.h"
+#include "BLI_rect.h"
+
+#include "BKE_camera.h"
+
+#include "MEM_guardedalloc.h"
+
+void BKE_subdiv_adaptive_view_init(SubdivAdaptiveView *view,
+                                   const Object *camera,
+                                   const RenderData *rd)
+{
+  const int winx = rd->xsch * rd->size / 100;
+  const int winy = rd->ysch * rd->size / 100;
+  CameraParams params;
+  BKE_camera_params_init(&params);
+  BKE_camera_params_from_object(&params, camera);
+  BKE_camera_params_compute_viewplane(&params, winx, winy, rd->xasp, rd->yasp);
+  BKE_camera_params_compute_matrix(&params);
+
+  float camera_mat[4][4], persmat[4][4];
+  normalize_m4_m4(camera_mat, camera->obmat);
+  invert_m4_m4(view->viewmat, camera_mat);
+  mul_m4_m4m4(persmat, params.winmat, view->viewmat);
+  planes_from_projmat(persmat,
+                      view->frustum_planes[0],
+                      view->frustum_planes[1],
+                      view->frustum_planes[2],
+                      view->frustum_planes[3],
+                      view->frustum_planes[4],
+                      view->frustum_planes[5]);
+  for (int i = 0; i < 6; i++) {
+    view->frustum_planes[i][3] /= normalize_v3(view->frustum_planes[i]);
+  }
+
+  /* For a perspective camera the view-plane is at the clipping start distance. */
+  view->pixels_per_unit = (float)winx / BLI_rctf_size_x(&params.viewplane);
+  if (!params.is_ortho) {
+    view->pixels_per_unit *= params.clip_start;
+  }
+  view->clip_start = params.clip_start;
+  view->is_ortho = params.is_ortho;
+}
+
+static bool subdiv_adaptive_sphere_in_view(const SubdivAdaptiveView *view,
+                                           const float center[3],
+                                           const float radius)
+{
+  for (int i = 0; i < 6; i++) {
+    if (plane_point_side_v3(view->frustum_planes[i], center) < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int subdiv_adaptive_face_level(const SubdivAdaptiveView *view,
+                                      const Mesh *mesh,
+                                      const MPoly *mpoly,
+                                      const float (*vert_cos)[3],
+                                      const float pixel_size,
+                                      const int max_level)
+{
+  const MLoop *mloop = &mesh->mloop[mpoly->loopstart];
+  float center[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < mpoly->totloop; i++) {
+    add_v3_v3(center, vert_cos[mloop[i].v]);
+  }
+  mul_v3_fl(center, 1.0f / (float)mpoly->totloop);
+
+  float radius_sq = 0.0f, edge_length_sq = 0.0f;
+  for (int i = 0; i < mpoly->totloop; i++) {
+    const float *co = vert_cos[mloop[i].v];
+    const float *co_next = vert_cos[mloop[(i + 1) % mpoly->totloop].v];
+    radius_sq = max_ff(radius_sq, len_squared_v3v3(co, center));
+    edge_length_sq = max_ff(edge_length_sq, len_squared_v3v3(co, co_next));
+  }
+  const float radius = sqrtf(radius_sq);
+  if (!subdiv_adaptive_sphere_in_view(view, center, radius)) {
+    return 0;
+  }
+
+  /* The longest edge of the face, at the closest distance any point of it can have. */
+  float edge_pixels = sqrtf(edge_length_sq) * view->pixels_per_unit;
+  if (!view->is_ortho) {
+    float center_view[3];
+    mul_v3_m4v3(center_view, view->viewmat, center);
+    edge_pixels /= max_ff(-center_view[2] - radius, view->clip_start);
+  }
+  /* Every level halves the edge length. */
+  if (edge_pixels <= pixel_size) {
+    return 0;
+  }
+  const int level = (int)ceilf(log2f(edge_pixels / pixel_size));
+  return min_ii(level, max_level);
+}
+
+int BKE_subdiv_adaptive_face_levels(const SubdivAdaptiveView *view,
+                                    const Mesh *mesh,
+                                    const float obmat[4][4],
+                                    const float pixel_size,
+                                    const int max_level,
+                                    int *r_face_levels)
+{
+  float(*vert_cos)[3] = MEM_malloc_arrayN(mesh->totvert, sizeof(*vert_cos), __func__);
+  for (int i = 0; i < mesh->totvert; i++) {
+    mul_v3_m4v3(vert_cos[i], obmat, mesh->mvert[i].co);
+  }
+
+  int level_max = 0;
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const int level = subdiv_adaptive_face_level(
+        view, mesh, &mesh->mpoly[i], (const float(*)[3])vert_cos, pixel_size, max_level);
+    if (r_face_levels != NULL) {
+      r_face_levels[i] = level;
+    }
+    level_max = max_ii(level_max, level);
+  }
+
+  MEM_freeN(vert_cos);
+  return level_max;
+}
@@ -35,6 +35,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
 #include "opensubdiv_evaluator_capi.h"
 #include "opensubdiv_topology_refiner_capi.h"
 
@@ -61,11 +62,32 @@ bool BKE_subdiv_eval_begin(Subdiv *subdiv)
   return true;
 }
 
+static void set_coarse_positions_range(Subdiv *subdiv,
+                                       const Mesh *mesh,
+                                       const float (*coarse_vertex_cos)[3],
+                                       const int vertex_index,
+                                       const int manifold_vertex_index,
+                                       const int num_vertices)
+{
+  OpenSubdiv_Evaluator *evaluator = subdiv->evaluator;
+  if (coarse_vertex_cos != NULL) {
+    evaluator->setCoarsePositions(
+        evaluator, coarse_vertex_cos[vertex_index], manifold_vertex_index, num_vertices);
+  }
+  else {
+    evaluator->setCoarsePositionsFromBuffer(evaluator,
+                                            &mesh->mvert[vertex_index],
+                                            offsetof(MVert, co),
+                                            sizeof(MVert),
+                                            manifold_vertex_index,
+                                            num_vertices);
+  }
+}
+
 static void set_coarse_positions(Subdiv *subdiv,
                                  const Mesh *mesh,
                                  const float (*coarse_vertex_cos)[3])
 {
-  const MVert *mvert = mesh->mvert;
   const MLoop *mloop = mesh->mloop;
   const MPoly *mpoly = mesh->mpoly;
   /* Mark vertices which needs new coordinates. */
@@ -80,21 +102,32 @@ static void set_coarse_positions(Subdiv *subdiv,
       BLI_BITMAP_ENABLE(vertex_used_map, loop->v);
     }
   }
-  for (int vertex_index = 0, manifold_vertex_index = 0; vertex_index < mesh->totvert;
-       vertex_index++) {
-    if (!BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+  /* Pass ranges of used vertices at once, which is a single range for meshes without loose
+   * vertices. */
+  int manifold_vertex_index = 0;
+  int range_start = -1;
+  for (int vertex_index = 0; vertex_index < mesh->totvert; vertex_index++) {
+    if (BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      if (range_start == -1) {
+        range_start = vertex_index;
+      }
       continue;
     }
-    const float *vertex_co;
-    if (coarse_vertex_cos != NULL) {
-      vertex_co = coarse_vertex_cos[vertex_index];
+    if (range_start != -1) {
+      const int num_vertices = vertex_index - range_start;
+      set_coarse_positions_range(
+          subdiv, mesh, coarse_vertex_cos, range_start, manifold_vertex_index, num_vertices);
+      manifold_vertex_index += num_vertices;
+      range_start = -1;
     }
-    else {
-      const MVert *vertex = &mvert[vertex_index];
-      vertex_co = vertex->co;
-    }
-    subdiv->evaluator->setCoarsePositions(subdiv->evaluator, vertex_co, manifold_vertex_index, 1);
-    manifold_vertex_index++;
+  }
+  if (range_start != -1) {
+    set_coarse_positions_range(subdiv,
+                               mesh,
+                               coarse_vertex_cos,
+                               range_start,
+                               manifold_vertex_index,
+                               mesh->totvert - range_start);
   }
   MEM_freeN(vertex_used_map);
 }
@@ -232,6 +265,38 @@ void BKE_subdiv_eval_limit_point_and_short_normal(Subdiv *subdiv,
   normal_float_to_short_v3(r_N, N_float);
 }
 
+/* ============================ Batched queries ============================= */
+
+void BKE_subdiv_eval_limit_points_and_derivatives(Subdiv *subdiv,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3])
+{
+  subdiv->evaluator->evaluatePatchesLimit(subdiv->evaluator,
+                                          patch_coords,
+                                          num_patch_coords,
+                                          (float *)r_P,
+                                          (float *)r_dPdu,
+                                          (float *)r_dPdv);
+  if (r_dPdu == NULL || r_dPdv == NULL) {
+    return;
+  }
+  /* Same as for the single point query, step inside of the face for degenerate derivatives. */
+  for (int i = 0; i < num_patch_coords; i++) {
+    if (is_zero_v3(r_dPdu[i]) || is_zero_v3(r_dPdv[i])) {
+      BKE_subdiv_eval_limit_point_and_derivatives(subdiv,
+                                                  patch_coords[i].ptex_face,
+                                                  patch_coords[i].u,
+                                                  patch_coords[i].v,
+                                                  r_P[i],
+                                                  r_dPdu[i],
+                                                  r_dPdv[i]);
+    }
+  }
+}
+
 void BKE_subdiv_eval_face_varying(Subdiv *subdiv,
                                   const int face_varying_channel,
                                   const int ptex_face_index,
@@ -31,6 +31,7 @@
 
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_key.h"
@@ -41,6 +42,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Subdivision Context
  * \{ */
@@ -76,6 +79,9 @@ typedef struct SubdivMeshContext {
    * when it's not possible is when displacement is used. */
   bool can_evaluate_normals;
   bool have_displacement;
+  /* Limit surface coordinates of the inner vertices, which are evaluated in batches once the
+   * traversal is done. Is -1 for the ptex face of all other vertices. */
+  OpenSubdiv_PatchCoord *inner_vertex_patch_coords;
 } SubdivMeshContext;
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -113,10 +119,21 @@ static void subdiv_mesh_prepare_accumulator(SubdivMeshContext *ctx, int num_vert
       sizeof(*ctx->accumulated_counters), num_vertices, "subdiv accumulated counters");
 }
 
+static void subdiv_mesh_prepare_inner_vertex_patch_coords(SubdivMeshContext *ctx,
+                                                          int num_vertices)
+{
+  ctx->inner_vertex_patch_coords = MEM_malloc_arrayN(
+      num_vertices, sizeof(*ctx->inner_vertex_patch_coords), "subdiv inner patch coords");
+  for (int i = 0; i < num_vertices; i++) {
+    ctx->inner_vertex_patch_coords[i].ptex_face = -1;
+  }
+}
+
 static void subdiv_mesh_context_free(SubdivMeshContext *ctx)
 {
   MEM_SAFE_FREE(ctx->accumulated_normals);
   MEM_SAFE_FREE(ctx->accumulated_counters);
+  MEM_SAFE_FREE(ctx->inner_vertex_patch_coords);
 }
 
 /** \} */
@@ -454,19 +471,73 @@ static void subdiv_mesh_tls_free(void *tls_v)
 /** \name Evaluation helper functions
  * \{ */
 
-static void eval_final_point_and_vertex_normal(Subdiv *subdiv,
-                                               const int ptex_face_index,
-                                               const float u,
-                                               const float v,
-                                               float r_P[3],
-                                               short r_N[3])
+/* Number of inner vertices evaluated by a single limit surface query. */
+#define INNER_VERTICES_EVAL_CHUNK_SIZE 512
+
+static void subdiv_mesh_eval_inner_vertices_chunk(void *__restrict userdata,
+                                                  const int chunk_index,
+                                                  const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  if (subdiv->displacement_evaluator == NULL) {
-    BKE_subdiv_eval_limit_point_and_short_normal(subdiv, ptex_face_index, u, v, r_P, r_N);
+  SubdivMeshContext *ctx = userdata;
+  Subdiv *subdiv = ctx->subdiv;
+  MVert *subdiv_mvert = ctx->subdiv_mesh->mvert;
+  const int start_vertex_index = chunk_index * INNER_VERTICES_EVAL_CHUNK_SIZE;
+  const int end_vertex_index = min_ii(start_vertex_index + INNER_VERTICES_EVAL_CHUNK_SIZE,
+                                      ctx->subdiv_mesh->totvert);
+  OpenSubdiv_PatchCoord patch_coords[INNER_VERTICES_EVAL_CHUNK_SIZE];
+  int vertex_indices[INNER_VERTICES_EVAL_CHUNK_SIZE];
+  int num_patch_coords = 0;
+  for (int i = start_vertex_index; i < end_vertex_index; i++) {
+    if (ctx->inner_vertex_patch_coords[i].ptex_face != -1) {
+      patch_coords[num_patch_coords] = ctx->inner_vertex_patch_coords[i];
+      vertex_indices[num_patch_coords] = i;
+      num_patch_coords++;
+    }
   }
-  else {
-    BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, r_P);
+  if (num_patch_coords == 0) {
+    return;
   }
+  float P[INNER_VERTICES_EVAL_CHUNK_SIZE][3];
+  float dPdu[INNER_VERTICES_EVAL_CHUNK_SIZE][3];
+  float dPdv[INNER_VERTICES_EVAL_CHUNK_SIZE][3];
+  BKE_subdiv_eval_limit_points_and_derivatives(
+      subdiv, patch_coords, num_patch_coords, P, dPdu, dPdv);
+  for (int i = 0; i < num_patch_coords; i++) {
+    MVert *subdiv_vert = &subdiv_mvert[vertex_indices[i]];
+    copy_v3_v3(subdiv_vert->co, P[i]);
+    if (ctx->have_displacement) {
+      /* Matches #BKE_subdiv_eval_final_point, normals are calculated from the final mesh. */
+      float D[3];
+      BKE_subdiv_eval_displacement(subdiv,
+                                   patch_coords[i].ptex_face,
+                                   patch_coords[i].u,
+                                   patch_coords[i].v,
+                                   dPdu[i],
+                                   dPdv[i],
+                                   D);
+      add_v3_v3(subdiv_vert->co, D);
+    }
+    else {
+      float N[3];
+      cross_v3_v3v3(N, dPdu[i], dPdv[i]);
+      normalize_v3(N);
+      normal_float_to_short_v3(subdiv_vert->no, N);
+    }
+  }
+}
+
+/* Evaluate limit surface for all inner vertices, in batches instead of a query per vertex. */
+static void subdiv_mesh_eval_inner_vertices(SubdivMeshContext *ctx)
+{
+  if (ctx->subdiv_mesh == NULL || ctx->subdiv->evaluator == NULL) {
+    return;
+  }
+  const int num_chunks = (ctx->subdiv_mesh->totvert + INNER_VERTICES_EVAL_CHUNK_SIZE - 1) /
+                         INNER_VERTICES_EVAL_CHUNK_SIZE;
+  TaskParallelSettings parallel_range_settings;
+  BLI_parallel_range_settings_defaults(&parallel_range_settings);
+  BLI_task_parallel_range(
+      0, num_chunks, ctx, subdiv_mesh_eval_inner_vertices_chunk, &parallel_range_settings);
 }
 
 /** \} */
@@ -524,6 +595,7 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
       subdiv_context->coarse_mesh, num_vertices, num_edges, 0, num_loops, num_polygons, mask);
   subdiv_mesh_ctx_cache_custom_data_layers(subdiv_context);
   subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  subdiv_mesh_prepare_inner_vertex_patch_coords(subdiv_context, num_vertices);
   return true;
 }
 
@@ -780,7 +852,6 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
 {
   SubdivMeshContext *ctx = foreach_context->user_data;
   SubdivMeshTLS *tls = tls_v;
-  Subdiv *subdiv = ctx->subdiv;
   const Mesh *coarse_mesh = ctx->coarse_mesh;
   const MPoly *coarse_mpoly = coarse_mesh->mpoly;
   const MPoly *coarse_poly = &coarse_mpoly[coarse_poly_index];
@@ -789,8 +860,11 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
-  eval_final_point_and_vertex_normal(
-      subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+  /* Position and normal are evaluated by #subdiv_mesh_eval_inner_vertices. */
+  OpenSubdiv_PatchCoord *patch_coord = &ctx->inner_vertex_patch_coords[subdiv_vertex_index];
+  patch_coord->ptex_face = ptex_face_index;
+  patch_coord->u = u;
+  patch_coord->v = v;
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
 }
 
@@ -1223,6 +1297,7 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
   BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, settings, coarse_mesh);
+  subdiv_mesh_eval_inner_vertices(&subdiv_context);
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   Mesh *result = subdiv_context.subdiv_mesh;
   // BKE_mesh_validate(result, true, true);
@@ -59,6 +59,8 @@ enum eNlaEvalStrip_StripMode {
   NES_TIME_TRANSITION_END,
 };
 
+struct AnimEvalPlan;
+struct MemArena;
 struct NlaEvalChannel;
 struct NlaEvalData;
 
@@ -77,6 +79,8 @@ typedef struct NlaValidMask {
 /* Set of property values for blending. */
 typedef struct NlaEvalChannelSnapshot {
   struct NlaEvalChannel *channel;
+  /* Next snapshot in the pool of unused snapshots of the channel. */
+  struct NlaEvalChannelSnapshot *next_free;
 
   int length;   /* Number of values in the property. */
   bool is_base; /* Base snapshot of the channel. */
@@ -111,6 +115,9 @@ typedef struct NlaEvalChannel {
   struct NlaEvalChannel *next_blend;
   NlaEvalChannelSnapshot *blend_snapshot;
 
+  /* Snapshots that were released, reused instead of allocating new ones. */
+  NlaEvalChannelSnapshot *free_snapshots;
+
   /* Mask of array items controlled by NLA. */
   NlaValidMask valid;
 
@@ -136,6 +143,16 @@ typedef struct NlaEvalData {
   GHash *path_hash;
   GHash *key_hash;
 
+  /* Copies of the paths used as keys of path_hash. */
+  struct MemArena *path_arena;
+
+  /* Mapping of actions to their NlaEvalAction. */
+  GHash *action_hash;
+
+  /* Some channels may not stay valid until the next evaluation of the same ID,
+   * e.g. because they are properties of another ID, so the data can't be reused. */
+  bool is_volatile;
+
   /* Base snapshot. */
   int num_channels;
   NlaEvalSnapshot base_snapshot;
@@ -144,6 +161,15 @@ typedef struct NlaEvalData {
   NlaEvalSnapshot eval_snapshot;
 } NlaEvalData;
 
+/* F-Curves of an action prepared for evaluation, with the channel each curve is blended into. */
+typedef struct NlaEvalAction {
+  struct AnimEvalPlan *plan;
+  /* Channels in the order of the curves, NULL if the path doesn't resolve. */
+  NlaEvalChannel **channels;
+  /* Checked against the curves of the action in this evaluation. */
+  bool is_checked;
+} NlaEvalAction;
+
 /* Information about the currently edited strip and ones below it for keyframing. */
 typedef struct NlaKeyframingContext {
   struct NlaKeyframingContext *next, *prev;
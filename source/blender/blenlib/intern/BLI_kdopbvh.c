@@ -117,6 +117,9 @@ typedef struct BVHOverlapData_Shared {
   /* use for callbacks */
   BVHTree_OverlapCallback callback;
   void *userdata;
+
+  /* #BLI_bvhtree_overlap_self only, the node pairs of each job (#BVHOverlapSelfJob). */
+  const struct BVHOverlapSelfJob *self_jobs;
 } BVHOverlapData_Shared;
 
 typedef struct BVHOverlapData_Thread {
@@ -1032,14 +1035,62 @@ bool BLI_bvhtree_update_node(
   return true;
 }
 
+/* Join all the branches below and including the node, children first. */
+static void node_join_recursive(BVHTree *tree, BVHNode *node)
+{
+  if (node->totnode == 0) {
+    return;
+  }
+  for (int i = 0; i < node->totnode; i++) {
+    node_join_recursive(tree, node->children[i]);
+  }
+  node_join(tree, node);
+}
+
+static void bvhtree_update_tree_task_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHTree *tree = userdata;
+  BVHNode *root = tree->nodes[tree->totleaf];
+  BVHNode *node = root->children[i / tree->tree_type];
+  const int child = i % tree->tree_type;
+
+  if (child < node->totnode) {
+    node_join_recursive(tree, node->children[child]);
+  }
+}
+
 /* call BLI_bvhtree_update_node() first for every node/point/triangle */
 void BLI_bvhtree_update_tree(BVHTree *tree)
 {
+  BVHNode **root = tree->nodes + tree->totleaf;
+
+  if (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD && tree->totbranch > 0) {
+    /* Refit the sub-trees two levels below the root in parallel,
+     * they don't share any node so the result is the same as the serial update. */
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0,
+                            (*root)->totnode * tree->tree_type,
+                            tree,
+                            bvhtree_update_tree_task_cb,
+                            &settings);
+
+    for (int i = 0; i < (*root)->totnode; i++) {
+      if ((*root)->children[i]->totnode) {
+        node_join(tree, (*root)->children[i]);
+      }
+    }
+    node_join(tree, *root);
+    return;
+  }
+
   /* Update bottom=>top
    * TRICKY: the way we build the tree all the childs have an index greater than the parent
    * This allows us todo a bottom up update by starting on the bigger numbered branch */
 
-  BVHNode **root = tree->nodes + tree->totleaf;
   BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
 
   for (; index >= root; index--) {
@@ -1390,6 +1441,247 @@ BVHTreeOverlap *BLI_bvhtree_overlap(
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_overlap_self
+ * \{ */
+
+/* Split the self overlap into at least this many jobs (when the tree is large enough). */
+#define KDOPBVH_OVERLAP_SELF_JOBS_MIN 64
+
+/* A pair of nodes to traverse, or a single node to traverse against itself. */
+typedef struct BVHOverlapSelfJob {
+  const BVHNode *node1, *node2;
+} BVHOverlapSelfJob;
+
+static void tree_overlap_self_push(BVHOverlapData_Thread *data_thread,
+                                   const BVHNode *node1,
+                                   const BVHNode *node2)
+{
+  BVHOverlapData_Shared *data = data_thread->shared;
+  int index_a = node1->index, index_b = node2->index;
+
+  if (index_a > index_b) {
+    SWAP(int, index_a, index_b);
+  }
+
+  if (!data->callback ||
+      data->callback(data->userdata, index_a, index_b, data_thread->thread)) {
+    BVHTreeOverlap *overlap = BLI_stack_push_r(data_thread->overlap);
+    overlap->indexA = index_a;
+    overlap->indexB = index_b;
+  }
+}
+
+/**
+ * Overlap of two disjoint sub-trees of the same tree,
+ * like #tree_overlap_traverse_cb with the pair indices sorted.
+ */
+static void tree_overlap_self_traverse_pair(BVHOverlapData_Thread *data_thread,
+                                            const BVHNode *node1,
+                                            const BVHNode *node2)
+{
+  BVHOverlapData_Shared *data = data_thread->shared;
+  int j;
+
+  if (tree_overlap_test(node1, node2, data->start_axis, data->stop_axis)) {
+    if (!node1->totnode) {
+      if (!node2->totnode) {
+        tree_overlap_self_push(data_thread, node1, node2);
+      }
+      else {
+        for (j = 0; j < node2->totnode; j++) {
+          tree_overlap_self_traverse_pair(data_thread, node1, node2->children[j]);
+        }
+      }
+    }
+    else {
+      for (j = 0; j < node1->totnode; j++) {
+        tree_overlap_self_traverse_pair(data_thread, node1->children[j], node2);
+      }
+    }
+  }
+}
+
+/**
+ * Overlap of a sub-tree with itself: each child against itself and against its siblings,
+ * so every pair of nodes is only visited once.
+ */
+static void tree_overlap_self_traverse(BVHOverlapData_Thread *data_thread, const BVHNode *node)
+{
+  int i, j;
+
+  for (i = 0; i < node->totnode; i++) {
+    tree_overlap_self_traverse(data_thread, node->children[i]);
+    for (j = i + 1; j < node->totnode; j++) {
+      tree_overlap_self_traverse_pair(data_thread, node->children[i], node->children[j]);
+    }
+  }
+}
+
+static void bvhtree_overlap_self_task_cb(void *__restrict userdata,
+                                         const int j,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHOverlapData_Thread *data = &((BVHOverlapData_Thread *)userdata)[j];
+  const BVHOverlapSelfJob *job = data->shared->self_jobs + j;
+
+  if (job->node1 == job->node2) {
+    tree_overlap_self_traverse(data, job->node1);
+  }
+  else {
+    tree_overlap_self_traverse_pair(data, job->node1, job->node2);
+  }
+}
+
+/**
+ * Expand the jobs one level down the tree,
+ * pairs of nodes that don't overlap or leaf nodes against themselves are skipped.
+ * \return the number of jobs written to \a r_jobs.
+ */
+static int bvhtree_overlap_self_jobs_expand(const BVHOverlapData_Shared *data,
+                                            const BVHOverlapSelfJob *jobs,
+                                            const int jobs_len,
+                                            BVHOverlapSelfJob *r_jobs)
+{
+  int jobs_new_len = 0;
+
+  for (int n = 0; n < jobs_len; n++) {
+    const BVHNode *node1 = jobs[n].node1, *node2 = jobs[n].node2;
+
+    if (node1 == node2) {
+      for (int i = 0; i < node1->totnode; i++) {
+        const BVHNode *child_i = node1->children[i];
+        if (child_i->totnode) {
+          r_jobs[jobs_new_len].node1 = r_jobs[jobs_new_len].node2 = child_i;
+          jobs_new_len++;
+        }
+        for (int j = i + 1; j < node1->totnode; j++) {
+          const BVHNode *child_j = node1->children[j];
+          if (tree_overlap_test(child_i, child_j, data->start_axis, data->stop_axis)) {
+            r_jobs[jobs_new_len].node1 = child_i;
+            r_jobs[jobs_new_len].node2 = child_j;
+            jobs_new_len++;
+          }
+        }
+      }
+    }
+    else if (node1->totnode) {
+      for (int i = 0; i < node1->totnode; i++) {
+        if (tree_overlap_test(node1->children[i], node2, data->start_axis, data->stop_axis)) {
+          r_jobs[jobs_new_len].node1 = node1->children[i];
+          r_jobs[jobs_new_len].node2 = node2;
+          jobs_new_len++;
+        }
+      }
+    }
+    else {
+      /* The pair can't be split on this side, keep it as it is. */
+      r_jobs[jobs_new_len++] = jobs[n];
+    }
+  }
+
+  return jobs_new_len;
+}
+
+/**
+ * Overlap of a tree with itself, like `BLI_bvhtree_overlap(tree, tree, ...)`
+ * but each pair of leaves is only reported once (with `indexA < indexB`)
+ * and leaves are never reported as overlapping with themselves.
+ *
+ * The traversal is split in many more jobs than #BLI_bvhtree_overlap_ex uses,
+ * the pairs are returned in the order of the jobs so it doesn't depend on the number of threads.
+ *
+ * \note The callback must be thread-safe, its `thread` argument is always zero.
+ */
+BVHTreeOverlap *BLI_bvhtree_overlap_self(const BVHTree *tree,
+                                         uint *r_overlap_tot,
+                                         /* optional callback to test the overlap before adding */
+                                         BVHTree_OverlapCallback callback,
+                                         void *userdata)
+{
+  const BVHNode *root = tree->nodes[tree->totleaf];
+  const bool use_threading = tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD;
+  const int jobs_expand_max = tree->tree_type * (tree->tree_type + 1) / 2;
+  BVHOverlapData_Shared data_shared;
+  BVHOverlapData_Thread *data;
+  BVHOverlapSelfJob *jobs, *jobs_next;
+  BVHTreeOverlap *overlap, *to;
+  int jobs_len = 1, j;
+  size_t total = 0;
+
+  *r_overlap_tot = 0;
+
+  if (tree->totleaf < 2) {
+    return NULL;
+  }
+
+  data_shared.tree1 = data_shared.tree2 = tree;
+  data_shared.start_axis = tree->start_axis;
+  data_shared.stop_axis = tree->stop_axis;
+  data_shared.callback = callback;
+  data_shared.userdata = userdata;
+
+  jobs = MEM_mallocN(sizeof(*jobs), __func__);
+  jobs[0].node1 = jobs[0].node2 = root;
+
+  if (use_threading) {
+    while (jobs_len > 0 && jobs_len < KDOPBVH_OVERLAP_SELF_JOBS_MIN) {
+      jobs_next = MEM_malloc_arrayN((size_t)(jobs_len * jobs_expand_max), sizeof(*jobs), __func__);
+      const int jobs_next_len = bvhtree_overlap_self_jobs_expand(
+          &data_shared, jobs, jobs_len, jobs_next);
+      MEM_freeN(jobs);
+      jobs = jobs_next;
+
+      if (jobs_next_len == jobs_len) {
+        /* Splitting doesn't add any job anymore. */
+        break;
+      }
+      jobs_len = jobs_next_len;
+    }
+  }
+
+  data = MEM_malloc_arrayN((size_t)MAX2(jobs_len, 1), sizeof(*data), __func__);
+  data_shared.self_jobs = jobs;
+
+  for (j = 0; j < jobs_len; j++) {
+    data[j].shared = &data_shared;
+    data[j].overlap = BLI_stack_new(sizeof(BVHTreeOverlap), __func__);
+    data[j].max_interactions = 0;
+    data[j].thread = 0;
+  }
+
+  if (use_threading) {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, jobs_len, data, bvhtree_overlap_self_task_cb, &settings);
+  }
+  else {
+    tree_overlap_self_traverse(data, root);
+  }
+
+  for (j = 0; j < jobs_len; j++) {
+    total += BLI_stack_count(data[j].overlap);
+  }
+
+  to = overlap = MEM_mallocN(sizeof(BVHTreeOverlap) * total, "BVHTreeOverlap");
+
+  for (j = 0; j < jobs_len; j++) {
+    uint count = (uint)BLI_stack_count(data[j].overlap);
+    BLI_stack_pop_n(data[j].overlap, to, count);
+    BLI_stack_free(data[j].overlap);
+    to += count;
+  }
+
+  MEM_freeN(data);
+  MEM_freeN(jobs);
+
+  *r_overlap_tot = (uint)total;
+  return overlap;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_find_nearest
  * \{ */
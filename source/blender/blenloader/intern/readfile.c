@@ -3529,6 +3529,8 @@ static void direct_link_animdata(FileData *fd, AnimData *adt)
   link_list(fd, &adt->drivers);
   direct_link_fcurves(fd, &adt->drivers);
   adt->driver_array = NULL;
+  adt->action_eval_plan = NULL;
+  adt->nla_eval_data = NULL;
 
   /* link overrides */
   // TODO...
@@ -4660,6 +4662,7 @@ static void direct_link_pointcache(FileData *fd, PointCache *cache)
   cache->free_edit = NULL;
   cache->cached_frames = NULL;
   cache->cached_frames_len = 0;
+  cache->archive = NULL;
 }
 
 static void direct_link_pointcache_list(FileData *fd,
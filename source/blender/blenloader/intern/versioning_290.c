@@ -28,7 +28,9 @@
 #include "DNA_gpencil_modifier_types.h"
 #include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
+#include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
+#include "DNA_sequence_types.h"
 
 #include "BKE_collection.h"
 #include "BKE_colortools.h"
@@ -266,5 +268,37 @@ void blo_do_versions_290(FileData *fd, Library *UNUSED(lib), Main *bmain)
    */
   {
     /* Keep this block, even when empty. */
+
+    if (!DNA_struct_elem_find(fd->filesdna, "Editing", "int", "prefetch_threads")) {
+      LISTBASE_FOREACH (Scene *, scene, &bmain->scenes) {
+        if (scene->ed != NULL) {
+          scene->ed->prefetch_threads = 1;
+        }
+      }
+    }
+
+    /* Boolean modifier operand type, existing modifiers always used a single object. */
+    if (!DNA_struct_elem_find(fd->filesdna, "BooleanModifierData", "Collection", "*collection")) {
+      LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+        LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+          if (md->type == eModifierType_Boolean) {
+            BooleanModifierData *bmd = (BooleanModifierData *)md;
+            bmd->flag = eBooleanModifierFlag_Object;
+          }
+        }
+      }
+    }
+
+    if (!DNA_struct_elem_find(
+            fd->filesdna, "SubsurfModifierData", "float", "adaptive_pixel_size")) {
+      LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+        LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+          if (md->type == eModifierType_Subsurf) {
+            SubsurfModifierData *smd = (SubsurfModifierData *)md;
+            smd->adaptive_pixel_size = 1.0f;
+          }
+        }
+      }
+    }
   }
 }
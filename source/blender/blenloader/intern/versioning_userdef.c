@@ -768,6 +768,10 @@ void BLO_version_defaults_userpref_blend(Main *bmain, UserDef *userdef)
     if (userdef->collection_instance_empty_size == 0) {
       userdef->collection_instance_empty_size = 1.0f;
     }
+
+    if (userdef->modifier_cache_limit == 0) {
+      userdef->modifier_cache_limit = 512;
+    }
   }
 
   if (userdef->pixelsize == 0.0f) {
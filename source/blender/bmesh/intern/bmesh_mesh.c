@@ -2697,6 +2697,38 @@ void BM_mesh_toolflags_set(BMesh *bm, bool use_toolflags)
   bm->use_toolflags = use_toolflags;
 }
 
+/**
+ * Re-allocates mesh data without the gaps left by removed elements,
+ * so elements added afterwards come last in the iteration order.
+ *
+ * \note Tool flags are cleared.
+ */
+void BM_mesh_pack(BMesh *bm)
+{
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_BM(bm);
+
+  BLI_mempool *vpool_dst = NULL;
+  BLI_mempool *epool_dst = NULL;
+  BLI_mempool *fpool_dst = NULL;
+
+  bm_mempool_init_ex(&allocsize, bm->use_toolflags, &vpool_dst, &epool_dst, NULL, &fpool_dst);
+
+  BM_mesh_elem_toolflags_clear(bm);
+
+  BM_mesh_rebuild(bm,
+                  &((struct BMeshCreateParams){
+                      .use_toolflags = bm->use_toolflags,
+                  }),
+                  vpool_dst,
+                  epool_dst,
+                  NULL,
+                  fpool_dst);
+
+  if (bm->use_toolflags) {
+    BM_mesh_elem_toolflags_ensure(bm);
+  }
+}
+
 /* -------------------------------------------------------------------- */
 /** \name BMesh Coordinate Access
  * \{ */
@@ -84,6 +84,7 @@ void BM_mesh_elem_index_validate(
     BMesh *bm, const char *location, const char *func, const char *msg_a, const char *msg_b);
 
 void BM_mesh_toolflags_set(BMesh *bm, bool use_toolflags);
+void BM_mesh_pack(BMesh *bm);
 
 #ifndef NDEBUG
 bool BM_mesh_elem_table_check(BMesh *bm);
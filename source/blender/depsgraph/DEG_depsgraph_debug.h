@@ -53,6 +53,10 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+void DEG_stats_drivers(const struct Depsgraph *graph,
+                       size_t *r_drivers,
+                       size_t *r_python_drivers);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
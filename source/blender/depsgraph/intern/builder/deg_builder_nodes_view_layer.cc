@@ -121,6 +121,12 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   if (scene->camera != nullptr) {
     build_object(-1, scene->camera, DEG_ID_LINKED_INDIRECTLY, true);
   }
+  /* Cameras the scene switches to with markers. */
+  LISTBASE_FOREACH (TimeMarker *, marker, &scene->markers) {
+    if (marker->camera != nullptr) {
+      build_object(-1, marker->camera, DEG_ID_LINKED_INDIRECTLY, true);
+    }
+  }
   /* Rigidbody. */
   if (scene->rigidbody_world != nullptr) {
     build_rigidbody(scene);
@@ -105,6 +105,11 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   if (scene->camera != nullptr) {
     build_object(nullptr, scene->camera);
   }
+  LISTBASE_FOREACH (TimeMarker *, marker, &scene->markers) {
+    if (marker->camera != nullptr) {
+      build_object(nullptr, marker->camera);
+    }
+  }
   /* Rigidbody. */
   if (scene->rigidbody_world != nullptr) {
     build_rigidbody(scene);
@@ -23,12 +23,17 @@
  * Implementation of tools for debugging the depsgraph
  */
 
+#include "BLI_listbase.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_scene_types.h"
 
+#include "DNA_anim_types.h"
 #include "DNA_object_types.h"
 
+#include "BKE_anim_data.h"
+#include "BKE_fcurve_driver.h"
+
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_debug.h"
@@ -243,6 +248,40 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+/* Count the drivers of the IDs in the graph, and those of them which can't be evaluated without
+ * Python, serializing the evaluation of all of them. */
+void DEG_stats_drivers(const Depsgraph *graph, size_t *r_drivers, size_t *r_python_drivers)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  size_t tot_drivers = 0;
+  size_t tot_python_drivers = 0;
+
+  for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+    AnimData *adt = BKE_animdata_from_id(id_node->id_orig);
+    if (adt == nullptr) {
+      continue;
+    }
+    LISTBASE_FOREACH (FCurve *, fcu, &adt->drivers) {
+      ChannelDriver *driver = fcu->driver;
+      if (driver == nullptr) {
+        continue;
+      }
+      tot_drivers++;
+      if (driver->type == DRIVER_TYPE_PYTHON && driver->expression[0] != '\0' &&
+          !BKE_driver_has_simple_expression(driver)) {
+        tot_python_drivers++;
+      }
+    }
+  }
+
+  if (r_drivers) {
+    *r_drivers = tot_drivers;
+  }
+  if (r_python_drivers) {
+    *r_python_drivers = tot_python_drivers;
+  }
+}
+
 static DEG::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
@@ -82,6 +82,7 @@
 #define MAXNUMSTREAMS 50
 
 struct IDProperty;
+struct MovieCache;
 struct _AviMovie;
 struct anim_index;
 
@@ -131,12 +132,23 @@ struct anim {
   AVFrame *pFrameRGB;
   AVFrame *pFrameDeinterlaced;
   struct SwsContext *img_convert_ctx;
+  /* Contexts converting horizontal slices of the frame in parallel, NULL when not used. */
+  struct SwsContext **img_convert_ctx_slices;
+  int img_convert_slices_num;
+  int img_convert_slice_height;
   int videoStream;
 
   struct ImBuf *last_frame;
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Frames decoded while seeking backwards, keyed by PTS. */
+  struct MovieCache *frame_cache;
+  /* PTS range each cached frame is displayed for, sorted, see #ffmpeg_frame_cache_get. */
+  int64_t (*frame_cache_ranges)[2];
+  int frame_cache_ranges_len;
+  int frame_cache_ranges_alloc;
 #endif
 
   char index_dir[768];
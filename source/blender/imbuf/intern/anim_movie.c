@@ -53,6 +53,7 @@
 #  include <io.h>
 #endif
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -76,8 +77,15 @@
 #ifdef WITH_FFMPEG
 #  include "BKE_global.h" /* ENDIAN_ORDER */
 
+#  include "BLI_ghash.h"
+#  include "BLI_task.h"
+#  include "BLI_threads.h"
+
+#  include "IMB_moviecache.h"
+
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
+#  include <libavutil/pixdesc.h>
 #  include <libavutil/rational.h>
 #  include <libswscale/swscale.h>
 
@@ -486,6 +494,192 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
   return (anim->x & 31) != 0;
 }
 
+static void ffmpeg_sws_colorspace_init(struct anim *anim, struct SwsContext *img_convert_ctx)
+{
+#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+  /* The following for color space determination */
+  int srcRange, dstRange, brightness, contrast, saturation;
+  int *table;
+  const int *inv_table;
+
+  /* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+  if (!sws_getColorspaceDetails(img_convert_ctx,
+                                (int **)&inv_table,
+                                &srcRange,
+                                &table,
+                                &dstRange,
+                                &brightness,
+                                &contrast,
+                                &saturation)) {
+    srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+    inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+    if (sws_setColorspaceDetails(img_convert_ctx,
+                                 (int *)inv_table,
+                                 srcRange,
+                                 table,
+                                 dstRange,
+                                 brightness,
+                                 contrast,
+                                 saturation)) {
+      fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+    }
+  }
+  else {
+    fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+  }
+#  else
+  UNUSED_VARS(anim, img_convert_ctx);
+#  endif
+}
+
+/* Minimal height of slice converted by its own thread. */
+#  define FFMPEG_SWS_SLICE_HEIGHT_MIN 64
+/* Maximal number of threads decoding one movie. */
+#  define FFMPEG_DECODE_THREADS_MAX 4
+
+static void ffmpeg_sws_slices_free(struct anim *anim)
+{
+  if (anim->img_convert_ctx_slices == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < anim->img_convert_slices_num; i++) {
+    sws_freeContext(anim->img_convert_ctx_slices[i]);
+  }
+  MEM_freeN(anim->img_convert_ctx_slices);
+  anim->img_convert_ctx_slices = NULL;
+  anim->img_convert_slices_num = 0;
+}
+
+/* Color conversion has no vertical scaling, so frame can be split to horizontal slices,
+ * that are converted as separate images. Each slice needs its own context, because
+ * libswscale requires slices of one context to be passed in order.
+ */
+static void ffmpeg_sws_slices_init(struct anim *anim)
+{
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+  int flags_unsupported = AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                          AV_PIX_FMT_FLAG_HWACCEL;
+#  ifdef AV_PIX_FMT_FLAG_PSEUDOPAL
+  flags_unsupported |= AV_PIX_FMT_FLAG_PSEUDOPAL;
+#  endif
+
+  anim->img_convert_ctx_slices = NULL;
+  anim->img_convert_slices_num = 0;
+
+  /* Big endian path flips image after conversion of whole frame. */
+  if (desc == NULL || (desc->flags & flags_unsupported) || ENDIAN_ORDER == B_ENDIAN) {
+    return;
+  }
+
+  const int num_slices = min_ii(BLI_system_thread_count(), anim->y / FFMPEG_SWS_SLICE_HEIGHT_MIN);
+  if (num_slices < 2) {
+    return;
+  }
+
+  /* Slices must start on rows with chroma samples. */
+  const int chroma_align = 1 << desc->log2_chroma_h;
+  const int slice_height = ((anim->y / num_slices + chroma_align - 1) / chroma_align) *
+                           chroma_align;
+
+  anim->img_convert_ctx_slices = MEM_callocN(sizeof(struct SwsContext *) * num_slices,
+                                             "ffmpeg sws slices");
+  anim->img_convert_slice_height = slice_height;
+
+  for (int i = 0; i < num_slices; i++) {
+    const int slice_start = i * slice_height;
+    if (slice_start >= anim->y) {
+      break;
+    }
+
+    const int height = min_ii(slice_height, anim->y - slice_start);
+    struct SwsContext *img_convert_ctx = sws_getContext(anim->x,
+                                                        height,
+                                                        anim->pCodecCtx->pix_fmt,
+                                                        anim->x,
+                                                        height,
+                                                        AV_PIX_FMT_RGBA,
+                                                        SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT,
+                                                        NULL,
+                                                        NULL,
+                                                        NULL);
+    if (img_convert_ctx == NULL) {
+      /* Fall back to conversion of whole frame. */
+      ffmpeg_sws_slices_free(anim);
+      return;
+    }
+
+    ffmpeg_sws_colorspace_init(anim, img_convert_ctx);
+    anim->img_convert_ctx_slices[i] = img_convert_ctx;
+    anim->img_convert_slices_num++;
+  }
+}
+
+typedef struct FFmpegSwsSliceData {
+  struct anim *anim;
+  AVFrame *input;
+  const AVPixFmtDescriptor *desc;
+  uint8_t *dst;
+  int dst_stride;
+} FFmpegSwsSliceData;
+
+static void ffmpeg_sws_slice_cb(void *__restrict userdata,
+                                const int slice,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  FFmpegSwsSliceData *data = userdata;
+  struct anim *anim = data->anim;
+  const AVPixFmtDescriptor *desc = data->desc;
+  AVFrame *input = data->input;
+  const int slice_start = slice * anim->img_convert_slice_height;
+  const int height = min_ii(anim->img_convert_slice_height, anim->y - slice_start);
+  uint8_t *src[4];
+
+  for (int plane = 0; plane < 4; plane++) {
+    src[plane] = input->data[plane];
+  }
+
+  for (int comp = 0; comp < desc->nb_components; comp++) {
+    const int plane = desc->comp[comp].plane;
+    /* Chroma components of YUV formats are sub-sampled vertically. */
+    const bool is_chroma = ELEM(comp, 1, 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+    const int plane_row = is_chroma ? (slice_start >> desc->log2_chroma_h) : slice_start;
+    src[plane] = input->data[plane] + plane_row * input->linesize[plane];
+  }
+
+  /* Image is flipped, first row of slice is written to last row of its destination. */
+  int dst_stride[4] = {-data->dst_stride, 0, 0, 0};
+  uint8_t *dst[4] = {data->dst + (anim->y - 1 - slice_start) * data->dst_stride, 0, 0, 0};
+
+  sws_scale(anim->img_convert_ctx_slices[slice],
+            (const uint8_t *const *)src,
+            input->linesize,
+            0,
+            height,
+            dst,
+            dst_stride);
+}
+
+static void ffmpeg_sws_scale_slices(struct anim *anim, AVFrame *input)
+{
+  FFmpegSwsSliceData data = {
+      .anim = anim,
+      .input = input,
+      .desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt),
+      .dst = anim->pFrameRGB->data[0],
+      .dst_stride = anim->pFrameRGB->linesize[0],
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, anim->img_convert_slices_num, &data, ffmpeg_sws_slice_cb, &settings);
+}
+
+#  undef FFMPEG_SWS_SLICE_HEIGHT_MIN
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -499,13 +693,6 @@ static int startffmpeg(struct anim *anim)
   double frs_den;
   int streamcount;
 
-#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-  /* The following for color space determination */
-  int srcRange, dstRange, brightness, contrast, saturation;
-  int *table;
-  const int *inv_table;
-#  endif
-
   if (anim == NULL) {
     return (-1);
   }
@@ -554,6 +741,11 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  /* Decode with frame and slice threads, anim keeps decoder open between fetches. Several movies
+   * may be decoded at once, e.g. by sequencer prefetching, so don't use all threads for one. */
+  pCodecCtx->thread_count = min_ii(BLI_system_thread_count(), FFMPEG_DECODE_THREADS_MAX);
+  pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -695,34 +887,8 @@ static int startffmpeg(struct anim *anim)
     return -1;
   }
 
-#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-  /* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-  if (!sws_getColorspaceDetails(anim->img_convert_ctx,
-                                (int **)&inv_table,
-                                &srcRange,
-                                &table,
-                                &dstRange,
-                                &brightness,
-                                &contrast,
-                                &saturation)) {
-    srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-    inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
-
-    if (sws_setColorspaceDetails(anim->img_convert_ctx,
-                                 (int *)inv_table,
-                                 srcRange,
-                                 table,
-                                 dstRange,
-                                 brightness,
-                                 contrast,
-                                 saturation)) {
-      fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-    }
-  }
-  else {
-    fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-  }
-#  endif
+  ffmpeg_sws_colorspace_init(anim, anim->img_convert_ctx);
+  ffmpeg_sws_slices_init(anim);
 
   return (0);
 }
@@ -730,13 +896,12 @@ static int startffmpeg(struct anim *anim)
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
   AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
   int filter_y = 0;
 
   if (!anim->pFrameComplete) {
@@ -827,6 +992,9 @@ static void ffmpeg_postprocess(struct anim *anim)
       top -= 8 * w;
     }
   }
+  else if (anim->img_convert_ctx_slices) {
+    ffmpeg_sws_scale_slices(anim, input);
+  }
   else {
     int *dstStride = anim->pFrameRGB->linesize;
     uint8_t **dst = anim->pFrameRGB->data;
@@ -949,7 +1117,141 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
   return (rval >= 0);
 }
 
-static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_search)
+/* Frames are cached by their own PTS. */
+static unsigned int anim_frame_cache_hash(const void *key_v)
+{
+  const uint64_t pts = *(const int64_t *)key_v;
+  return BLI_ghashutil_uinthash((unsigned int)(pts ^ (pts >> 32)));
+}
+
+static bool anim_frame_cache_cmp(const void *a_v, const void *b_v)
+{
+  return *(const int64_t *)a_v != *(const int64_t *)b_v;
+}
+
+/* Index of the last cached range starting at or before pts, -1 when there is none. */
+static int ffmpeg_frame_cache_range_find(struct anim *anim, int64_t pts)
+{
+  int low = 0, high = anim->frame_cache_ranges_len;
+
+  while (low < high) {
+    const int mid = (low + high) / 2;
+    if (anim->frame_cache_ranges[mid][0] <= pts) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return low - 1;
+}
+
+static void ffmpeg_frame_cache_range_remove(struct anim *anim, int index)
+{
+  anim->frame_cache_ranges_len--;
+  memmove(&anim->frame_cache_ranges[index],
+          &anim->frame_cache_ranges[index + 1],
+          sizeof(*anim->frame_cache_ranges) * (anim->frame_cache_ranges_len - index));
+}
+
+static void ffmpeg_frame_cache_range_add(struct anim *anim, int64_t pts, int64_t next_pts)
+{
+  int index = ffmpeg_frame_cache_range_find(anim, pts);
+
+  if (index == -1 || anim->frame_cache_ranges[index][0] != pts) {
+    if (anim->frame_cache_ranges_len == anim->frame_cache_ranges_alloc) {
+      anim->frame_cache_ranges_alloc = max_ii(64, anim->frame_cache_ranges_alloc * 2);
+      anim->frame_cache_ranges = MEM_reallocN(
+          anim->frame_cache_ranges,
+          sizeof(*anim->frame_cache_ranges) * anim->frame_cache_ranges_alloc);
+    }
+    index++;
+    memmove(&anim->frame_cache_ranges[index + 1],
+            &anim->frame_cache_ranges[index],
+            sizeof(*anim->frame_cache_ranges) * (anim->frame_cache_ranges_len - index));
+    anim->frame_cache_ranges_len++;
+  }
+
+  anim->frame_cache_ranges[index][0] = pts;
+  anim->frame_cache_ranges[index][1] = next_pts;
+}
+
+static void ffmpeg_frame_cache_free(struct anim *anim)
+{
+  if (anim->frame_cache) {
+    IMB_moviecache_free(anim->frame_cache);
+    anim->frame_cache = NULL;
+  }
+  MEM_SAFE_FREE(anim->frame_cache_ranges);
+  anim->frame_cache_ranges_len = 0;
+  anim->frame_cache_ranges_alloc = 0;
+}
+
+/* Frame in anim->pFrame to be cached, NULL when it's invalid or cached already. */
+static ImBuf *ffmpeg_frame_cache_ibuf_new(struct anim *anim)
+{
+  int64_t key = anim->next_pts;
+
+  if (!anim->pFrameComplete || anim->next_pts == -1) {
+    return NULL;
+  }
+  if (anim->frame_cache && IMB_moviecache_has_frame(anim->frame_cache, &key)) {
+    return NULL;
+  }
+
+  ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+  ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+  ffmpeg_postprocess(anim, ibuf);
+  return ibuf;
+}
+
+/* Keep frame displayed from pts until next_pts, so it doesn't have to be decoded again when
+ * playing backwards. Takes ownership of ibuf. */
+static void ffmpeg_frame_cache_put(struct anim *anim, ImBuf *ibuf, int64_t pts, int64_t next_pts)
+{
+  if (next_pts <= pts) {
+    IMB_freeImBuf(ibuf);
+    return;
+  }
+
+  if (anim->frame_cache == NULL) {
+    anim->frame_cache = IMB_moviecache_create(
+        "anim frame cache", sizeof(int64_t), anim_frame_cache_hash, anim_frame_cache_cmp);
+  }
+
+  IMB_moviecache_put(anim->frame_cache, &pts, ibuf);
+  IMB_freeImBuf(ibuf);
+  ffmpeg_frame_cache_range_add(anim, pts, next_pts);
+}
+
+/* Number of frames preceding seek target, that are cached when seeking backwards. */
+#  define FFMPEG_FRAME_CACHE_REVERSE_FRAMES 50
+
+/* Cached frame displayed at pts, like the frame repeat check of #ffmpeg_fetchibuf the PTS
+ * doesn't need to match the one of the frame exactly. */
+static ImBuf *ffmpeg_frame_cache_get(struct anim *anim, int64_t pts)
+{
+  if (anim->frame_cache == NULL) {
+    return NULL;
+  }
+
+  const int index = ffmpeg_frame_cache_range_find(anim, pts);
+  if (index == -1 || pts >= anim->frame_cache_ranges[index][1]) {
+    return NULL;
+  }
+
+  ImBuf *ibuf = IMB_moviecache_get(anim->frame_cache, &anim->frame_cache_ranges[index][0]);
+  if (ibuf == NULL) {
+    /* Freed by the cache limiter. */
+    ffmpeg_frame_cache_range_remove(anim, index);
+  }
+  return ibuf;
+}
+
+/* Frames with PTS greater or equal to pts_cache_start, passed while scanning, are cached. */
+static void ffmpeg_decode_video_frame_scan(struct anim *anim,
+                                           int64_t pts_to_search,
+                                           int64_t pts_cache_start)
 {
   /* there seem to exist *very* silly GOP lengths out in the wild... */
   int count = 1000;
@@ -966,9 +1268,16 @@ static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_sea
            "  WHILE: pts=%lld in search of %lld\n",
            (long long int)anim->next_pts,
            (long long int)pts_to_search);
+    /* The range of the frame is known once the next one is decoded. */
+    const int64_t pts = anim->next_pts;
+    ImBuf *cache_ibuf = (pts >= pts_cache_start) ? ffmpeg_frame_cache_ibuf_new(anim) : NULL;
     if (!ffmpeg_decode_video_frame(anim)) {
+      IMB_freeImBuf(cache_ibuf);
       break;
     }
+    if (cache_ibuf) {
+      ffmpeg_frame_cache_put(anim, cache_ibuf, pts, anim->next_pts);
+    }
     count--;
   }
   if (count == 0) {
@@ -1029,7 +1338,12 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
-static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+/* r_from_cache is set when the frame comes from the frame cache, the decoder then stays at
+ * anim->curposition. */
+static ImBuf *ffmpeg_fetchibuf(struct anim *anim,
+                               int position,
+                               IMB_Timecode_Type tc,
+                               bool *r_from_cache)
 {
   int64_t pts_to_search = 0;
   double frame_rate;
@@ -1040,6 +1354,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   int new_frame_index = 0; /* To quiet gcc barking... */
   int old_frame_index = 0; /* To quiet gcc barking... */
 
+  *r_from_cache = false;
+
   if (anim == NULL) {
     return (0);
   }
@@ -1090,11 +1406,19 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     return anim->last_frame;
   }
 
+  /* Decoder state is not changed, so curposition must be kept. */
+  ImBuf *cached_frame = ffmpeg_frame_cache_get(anim, pts_to_search);
+  if (cached_frame) {
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: frame cache hit\n");
+    *r_from_cache = true;
+    return cached_frame;
+  }
+
   if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
       position - (anim->curposition + 1) < anim->preseek) {
     av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval (no index)\n");
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search, INT64_MAX);
   }
   else if (tc_index && IMB_indexer_can_scan(tc_index, old_frame_index, new_frame_index)) {
     av_log(anim->pFormatCtx,
@@ -1102,7 +1426,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
            "FETCH: within preseek interval "
            "(index tells us)\n");
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search, INT64_MAX);
   }
   else if (position != anim->curposition + 1) {
     long long pos;
@@ -1174,7 +1498,13 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     /* memset(anim->pFrame, ...) ?? */
 
     if (ret >= 0) {
-      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+      /* When playing backwards, frames preceding the searched one will be needed next. */
+      int64_t pts_cache_start = INT64_MAX;
+      if (position < anim->curposition) {
+        pts_cache_start = pts_to_search - (int64_t)(FFMPEG_FRAME_CACHE_REVERSE_FRAMES /
+                                                    pts_time_base / frame_rate);
+      }
+      ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_cache_start);
     }
   }
   else if (position == 0 && anim->curposition == -1) {
@@ -1189,7 +1519,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
   anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-  ffmpeg_postprocess(anim);
+  ffmpeg_postprocess(anim, anim->last_frame);
 
   anim->last_pts = anim->next_pts;
 
@@ -1231,7 +1561,9 @@ static void free_anim_ffmpeg(struct anim *anim)
     av_frame_free(&anim->pFrameDeinterlaced);
 
     sws_freeContext(anim->img_convert_ctx);
+    ffmpeg_sws_slices_free(anim);
     IMB_freeImBuf(anim->last_frame);
+    ffmpeg_frame_cache_free(anim);
     if (anim->next_packet.stream_index != -1) {
       av_free_packet(&anim->next_packet);
     }
@@ -1387,13 +1719,15 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
       break;
 #endif
 #ifdef WITH_FFMPEG
-    case ANIM_FFMPEG:
-      ibuf = ffmpeg_fetchibuf(anim, position, tc);
-      if (ibuf) {
+    case ANIM_FFMPEG: {
+      bool from_cache;
+      ibuf = ffmpeg_fetchibuf(anim, position, tc, &from_cache);
+      if (ibuf && !from_cache) {
         anim->curposition = position;
       }
       filter_y = 0; /* done internally */
       break;
+    }
 #endif
   }
 
@@ -1401,7 +1735,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return (ibuf);
 }
@@ -45,6 +45,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
+#include "BLI_rand.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -60,6 +61,10 @@
 
 #include <ocio_capi.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /*********************** Global declarations *************************/
 
 #define DISPLAY_BUFFER_CHANNELS 4
@@ -97,10 +102,40 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* lock used by baked LUT cache, see colormanage_lut_acquire() */
+static pthread_mutex_t lut_cache_lock = BLI_MUTEX_INITIALIZER;
+
+/* Display transform from scene linear a baked LUT was created for. */
+typedef struct ColormanageLUTKey {
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+} ColormanageLUTKey;
+
+typedef struct ColormanageLUT {
+  struct ColormanageLUT *next, *prev;
+  ColormanageLUTKey key;
+  /* Number of processors using this LUT, only unused ones are removed from the cache. */
+  int users;
+  /* False when the baked table does not match the exact processor closely enough. */
+  bool is_valid;
+  /* COLORMANAGE_LUT_SIZE^3 RGB entries padded to four floats, red varies fastest. */
+  float *table;
+} ColormanageLUT;
+
+static ListBase global_lut_cache = {NULL, NULL};
+
 typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
   CurveMapping *curve_mapping;
   bool is_data_result;
+
+  /* Baked LUT which can be used instead of the processor for large buffers. */
+  bool use_lut;
+  ColormanageLUTKey lut_key;
+  ColormanageLUT *lut;
+  /* Exposure is not baked into the LUT, it is applied as a gain to the input. */
+  float lut_gain;
 } ColormanageProcessor;
 
 static struct global_glsl_state {
@@ -585,11 +620,16 @@ static void colormanage_load_config(OCIO_ConstConfigRcPtr *config)
   invert_m3_m3(imbuf_linear_srgb_to_xyz, imbuf_xyz_to_linear_srgb);
 }
 
+static void colormanage_lut_cache_free(void);
+
 static void colormanage_free_config(void)
 {
   ColorSpace *colorspace;
   ColorManagedDisplay *display;
 
+  /* free baked LUTs, they depend on the config */
+  colormanage_lut_cache_free();
+
   /* free color spaces */
   colorspace = global_colorspaces.first;
   while (colorspace) {
@@ -3747,6 +3787,365 @@ void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin,
   }
 }
 
+/*********************** Baked LUT processor functions *************************/
+
+/* Applying the full OCIO processor chain to every pixel is the main cost of color managing large
+ * float buffers. Instead, display transforms are baked into a 3D LUT indexed through a logarithmic
+ * shaper and evaluated with tetrahedral interpolation. A baked LUT is only used when it matches
+ * the exact processor within COLORMANAGE_LUT_TOLERANCE, and pixels outside of the shaper domain
+ * are still transformed by the processor.
+ *
+ * Color space transforms are not baked. Their float results are used for further processing
+ * rather than for display, so they keep the precision of the exact processor. */
+
+/* Shaper domain in stops. Inputs are offset by 2^COLORMANAGE_LUT_LOG_MIN so black maps to the
+ * first grid point. */
+#define COLORMANAGE_LUT_LOG_MIN -12
+#define COLORMANAGE_LUT_LOG_MAX 6
+#define COLORMANAGE_LUT_OFFSET (1.0f / 4096.0f)
+/* Grid points per stop. The shaper is piecewise linear between powers of two, so an integer
+ * number of steps keeps it linear inside of every LUT cell. */
+#define COLORMANAGE_LUT_STEPS 4
+#define COLORMANAGE_LUT_SIZE \
+  ((COLORMANAGE_LUT_LOG_MAX - COLORMANAGE_LUT_LOG_MIN) * COLORMANAGE_LUT_STEPS + 1)
+/* Maximum error relative to the exact result. Results darker than COLORMANAGE_LUT_TOLERANCE_MIN
+ * are compared as if they had that value, below it float rounding dominates the error. */
+#define COLORMANAGE_LUT_TOLERANCE 4e-3f
+#define COLORMANAGE_LUT_TOLERANCE_MIN 1e-4f
+#define COLORMANAGE_LUT_VERIFY_SAMPLES 4096
+#define COLORMANAGE_LUT_CACHE_MAX 4
+/* Baking a LUT does not pay off for smaller buffers. */
+#define COLORMANAGE_LUT_MIN_PIXELS 16384
+
+/* Piecewise linear approximation of log2(x + offset) which is exact at powers of two. Grid points
+ * are placed with the exact inverse, so the approximation costs no accuracy. */
+BLI_INLINE float colormanage_lut_shaper(float value)
+{
+  union {
+    float f;
+    int i;
+  } u;
+  u.f = value + COLORMANAGE_LUT_OFFSET;
+  return (float)u.i * (1.0f / 8388608.0f) - 127.0f;
+}
+
+static float colormanage_lut_shaper_inverse(float value)
+{
+  union {
+    float f;
+    int i;
+  } u;
+  u.i = (int)(((double)value + 127.0) * 8388608.0 + 0.5);
+  return max_ff(u.f - COLORMANAGE_LUT_OFFSET, 0.0f);
+}
+
+/* Transform a single RGB value, returns false if it lies outside of the LUT domain. */
+static bool colormanage_lut_eval(const float *table, const float rgb[3], float r_rgb[3])
+{
+  const int size = COLORMANAGE_LUT_SIZE;
+  const float grid_scale = (float)COLORMANAGE_LUT_STEPS;
+  const float domain_max = (float)(1 << COLORMANAGE_LUT_LOG_MAX) - COLORMANAGE_LUT_OFFSET;
+  int index[4];
+  float frac[4];
+
+#ifdef __SSE2__
+  const __m128 value = _mm_set_ps(0.0f, rgb[2], rgb[1], rgb[0]);
+  const __m128 inside = _mm_and_ps(_mm_cmpge_ps(value, _mm_setzero_ps()),
+                                   _mm_cmple_ps(value, _mm_set1_ps(domain_max)));
+  if ((_mm_movemask_ps(inside) & 7) != 7) {
+    return false;
+  }
+  /* Vectorized colormanage_lut_shaper(), scaled to grid coordinates. */
+  const __m128i bits = _mm_castps_si128(_mm_add_ps(value, _mm_set1_ps(COLORMANAGE_LUT_OFFSET)));
+  __m128 coord = _mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set1_ps(grid_scale / 8388608.0f));
+  coord = _mm_add_ps(coord, _mm_set1_ps(-(127.0f + COLORMANAGE_LUT_LOG_MIN) * grid_scale));
+  coord = _mm_max_ps(coord, _mm_setzero_ps());
+  const __m128 coord_floor = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(coord)),
+                                        _mm_set1_ps((float)(size - 2)));
+  _mm_storeu_si128((__m128i *)index, _mm_cvttps_epi32(coord_floor));
+  _mm_storeu_ps(frac, _mm_min_ps(_mm_sub_ps(coord, coord_floor), _mm_set1_ps(1.0f)));
+#else
+  for (int i = 0; i < 3; i++) {
+    if (!(rgb[i] >= 0.0f && rgb[i] <= domain_max)) {
+      return false;
+    }
+    const float coord = max_ff(
+        (colormanage_lut_shaper(rgb[i]) - (float)COLORMANAGE_LUT_LOG_MIN) * grid_scale, 0.0f);
+    index[i] = min_ii((int)coord, size - 2);
+    frac[i] = min_ff(coord - (float)index[i], 1.0f);
+  }
+#endif
+
+  /* Tetrahedral interpolation: walk from the base corner along the axes in order of decreasing
+   * fractional coordinate. */
+  const int stride[3] = {4, 4 * size, 4 * size * size};
+  int axis[3] = {0, 1, 2};
+  if (frac[axis[0]] < frac[axis[1]]) {
+    SWAP(int, axis[0], axis[1]);
+  }
+  if (frac[axis[1]] < frac[axis[2]]) {
+    SWAP(int, axis[1], axis[2]);
+  }
+  if (frac[axis[0]] < frac[axis[1]]) {
+    SWAP(int, axis[0], axis[1]);
+  }
+
+  const float *c0 = table + index[0] * stride[0] + index[1] * stride[1] + index[2] * stride[2];
+  const float *c1 = c0 + stride[axis[0]];
+  const float *c2 = c1 + stride[axis[1]];
+  const float *c3 = c2 + stride[axis[2]];
+  const float w0 = 1.0f - frac[axis[0]];
+  const float w1 = frac[axis[0]] - frac[axis[1]];
+  const float w2 = frac[axis[1]] - frac[axis[2]];
+  const float w3 = frac[axis[2]];
+
+#ifdef __SSE2__
+  __m128 result = _mm_mul_ps(_mm_set1_ps(w0), _mm_loadu_ps(c0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w1), _mm_loadu_ps(c1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w2), _mm_loadu_ps(c2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w3), _mm_loadu_ps(c3)));
+  float result_v4[4];
+  _mm_storeu_ps(result_v4, result);
+  copy_v3_v3(r_rgb, result_v4);
+#else
+  for (int i = 0; i < 3; i++) {
+    r_rgb[i] = w0 * c0[i] + w1 * c1[i] + w2 * c2[i] + w3 * c3[i];
+  }
+#endif
+
+  return true;
+}
+
+/* Compare the baked table against the exact processor on random inputs spread evenly over the
+ * shaper domain. */
+static bool colormanage_lut_verify(const float *table, OCIO_ConstProcessorRcPtr *processor)
+{
+  const int tot_sample = COLORMANAGE_LUT_VERIFY_SAMPLES;
+  float(*samples)[4] = MEM_mallocN(sizeof(*samples) * tot_sample, "colormanage LUT samples");
+  float(*exact)[4] = MEM_mallocN(sizeof(*exact) * tot_sample, "colormanage LUT exact");
+  RNG *rng = BLI_rng_new(0);
+  bool is_valid = true;
+
+  for (int i = 0; i < tot_sample; i++) {
+    for (int j = 0; j < 3; j++) {
+      const float t = BLI_rng_get_float(rng);
+      samples[i][j] = colormanage_lut_shaper_inverse(
+          (float)COLORMANAGE_LUT_LOG_MIN +
+          t * (float)(COLORMANAGE_LUT_LOG_MAX - COLORMANAGE_LUT_LOG_MIN));
+    }
+    samples[i][3] = 1.0f;
+  }
+  BLI_rng_free(rng);
+
+  memcpy(exact, samples, sizeof(*exact) * tot_sample);
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc((float *)exact,
+                                                              tot_sample,
+                                                              1,
+                                                              4,
+                                                              sizeof(float),
+                                                              4 * sizeof(float),
+                                                              4 * sizeof(float) * tot_sample);
+  OCIO_processorApply(processor, img);
+  OCIO_PackedImageDescRelease(img);
+
+  for (int i = 0; i < tot_sample && is_valid; i++) {
+    float result[3];
+    if (!colormanage_lut_eval(table, samples[i], result)) {
+      continue;
+    }
+    for (int j = 0; j < 3; j++) {
+      const float error = fabsf(result[j] - exact[i][j]) /
+                          max_ff(fabsf(exact[i][j]), COLORMANAGE_LUT_TOLERANCE_MIN);
+      if (!(error <= COLORMANAGE_LUT_TOLERANCE)) {
+        is_valid = false;
+        break;
+      }
+    }
+  }
+
+  MEM_freeN(samples);
+  MEM_freeN(exact);
+
+  return is_valid;
+}
+
+static void colormanage_lut_bake(ColormanageLUT *lut)
+{
+  const ColormanageLUTKey *key = &lut->key;
+  const int size = COLORMANAGE_LUT_SIZE;
+  OCIO_ConstProcessorRcPtr *processor;
+  float grid[COLORMANAGE_LUT_SIZE];
+
+  processor = create_display_buffer_processor(
+      key->look, key->view, key->display, 0.0f, 1.0f, global_role_scene_linear, false);
+
+  if (processor == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < size; i++) {
+    grid[i] = colormanage_lut_shaper_inverse((float)COLORMANAGE_LUT_LOG_MIN +
+                                             (float)i / (float)COLORMANAGE_LUT_STEPS);
+  }
+
+  lut->table = MEM_mallocN(sizeof(float[4]) * size * size * size, "colormanage LUT table");
+
+  float *entry = lut->table;
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, entry += 4) {
+        entry[0] = grid[r];
+        entry[1] = grid[g];
+        entry[2] = grid[b];
+        entry[3] = 1.0f;
+      }
+    }
+  }
+
+  /* Evaluate the whole grid as an image, one row per green and blue pair. */
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(lut->table,
+                                                              size,
+                                                              size * size,
+                                                              4,
+                                                              sizeof(float),
+                                                              4 * sizeof(float),
+                                                              4 * sizeof(float) * size);
+  OCIO_processorApply(processor, img);
+  OCIO_PackedImageDescRelease(img);
+
+  lut->is_valid = colormanage_lut_verify(lut->table, processor);
+
+  if (!lut->is_valid) {
+    MEM_freeN(lut->table);
+    lut->table = NULL;
+  }
+
+  OCIO_processorRelease(processor);
+}
+
+static void colormanage_lut_free(ColormanageLUT *lut)
+{
+  MEM_SAFE_FREE(lut->table);
+  MEM_freeN(lut);
+}
+
+static void colormanage_lut_cache_free(void)
+{
+  BLI_mutex_lock(&lut_cache_lock);
+
+  LISTBASE_FOREACH_MUTABLE (ColormanageLUT *, lut, &global_lut_cache) {
+    colormanage_lut_free(lut);
+  }
+  BLI_listbase_clear(&global_lut_cache);
+
+  BLI_mutex_unlock(&lut_cache_lock);
+}
+
+/* Get LUT for the given transform from the cache, baking it if needed.
+ * Must be called with lut_cache_lock held. */
+static ColormanageLUT *colormanage_lut_acquire(const ColormanageLUTKey *key)
+{
+  ColormanageLUT *lut;
+
+  for (lut = global_lut_cache.first; lut; lut = lut->next) {
+    if (memcmp(&lut->key, key, sizeof(*key)) == 0) {
+      break;
+    }
+  }
+
+  if (lut) {
+    /* keep recently used LUTs at the list head */
+    BLI_remlink(&global_lut_cache, lut);
+  }
+  else {
+    lut = MEM_callocN(sizeof(ColormanageLUT), "colormanage LUT");
+    lut->key = *key;
+    colormanage_lut_bake(lut);
+
+    /* remove least recently used LUTs which are not used by any processor */
+    int tot_lut = BLI_listbase_count(&global_lut_cache);
+    ColormanageLUT *lut_iter = global_lut_cache.last;
+    while (lut_iter && tot_lut >= COLORMANAGE_LUT_CACHE_MAX) {
+      ColormanageLUT *lut_prev = lut_iter->prev;
+      if (lut_iter->users == 0) {
+        BLI_remlink(&global_lut_cache, lut_iter);
+        colormanage_lut_free(lut_iter);
+        tot_lut--;
+      }
+      lut_iter = lut_prev;
+    }
+  }
+
+  BLI_addhead(&global_lut_cache, lut);
+  lut->users++;
+
+  return lut;
+}
+
+static const float *colormanage_processor_lut_ensure(ColormanageProcessor *cm_processor)
+{
+  if (!cm_processor->use_lut) {
+    return NULL;
+  }
+
+  /* processor is shared between threads applying it to different parts of the buffer */
+  BLI_mutex_lock(&lut_cache_lock);
+  if (cm_processor->lut == NULL) {
+    cm_processor->lut = colormanage_lut_acquire(&cm_processor->lut_key);
+  }
+  BLI_mutex_unlock(&lut_cache_lock);
+
+  return cm_processor->lut->table;
+}
+
+static void colormanage_processor_lut_apply(ColormanageProcessor *cm_processor,
+                                            const float *table,
+                                            float *buffer,
+                                            int width,
+                                            int height,
+                                            int channels,
+                                            bool predivide)
+{
+  const size_t tot_pixel = (size_t)width * height;
+  const float gain = cm_processor->lut_gain;
+  float *pixel = buffer;
+
+  predivide = predivide && (channels == 4);
+
+  for (size_t i = 0; i < tot_pixel; i++, pixel += channels) {
+    const float alpha = predivide ? pixel[3] : 1.0f;
+    float rgb[3];
+
+    if (alpha == 1.0f || alpha == 0.0f) {
+      mul_v3_v3fl(rgb, pixel, gain);
+    }
+    else {
+      mul_v3_v3fl(rgb, pixel, gain / alpha);
+    }
+
+    if (colormanage_lut_eval(table, rgb, rgb)) {
+      if (alpha == 1.0f || alpha == 0.0f) {
+        copy_v3_v3(pixel, rgb);
+      }
+      else {
+        mul_v3_v3fl(pixel, rgb, alpha);
+      }
+    }
+    else if (channels == 4) {
+      /* outside of the LUT domain, use the exact processor */
+      if (predivide) {
+        OCIO_processorApplyRGBA_predivide(cm_processor->processor, pixel);
+      }
+      else {
+        OCIO_processorApplyRGBA(cm_processor->processor, pixel);
+      }
+    }
+    else {
+      OCIO_processorApplyRGB(cm_processor->processor, pixel);
+    }
+  }
+}
+
 /*********************** Pixel processor functions *************************/
 
 ColormanageProcessor *IMB_colormanagement_display_processor_new(
@@ -3786,6 +4185,16 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
     BKE_curvemapping_premultiply(cm_processor->curve_mapping, false);
   }
 
+  /* Display gamma also affects alpha, which the LUT does not handle. */
+  if (cm_processor->processor && applied_view_settings->gamma == 1.0f) {
+    ColormanageLUTKey *key = &cm_processor->lut_key;
+    STRNCPY(key->look, applied_view_settings->look);
+    STRNCPY(key->view, applied_view_settings->view_transform);
+    STRNCPY(key->display, display_settings->display_device);
+    cm_processor->use_lut = true;
+    cm_processor->lut_gain = powf(2.0f, applied_view_settings->exposure);
+  }
+
   return cm_processor;
 }
 
@@ -3882,6 +4291,17 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
 
   if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
+    const float *lut_table = NULL;
+
+    if ((size_t)width * height >= COLORMANAGE_LUT_MIN_PIXELS) {
+      lut_table = colormanage_processor_lut_ensure(cm_processor);
+    }
+
+    if (lut_table) {
+      colormanage_processor_lut_apply(
+          cm_processor, lut_table, buffer, width, height, channels, predivide);
+      return;
+    }
 
     /* apply OCIO processor */
     img = OCIO_createOCIO_PackedImageDesc(buffer,
@@ -3929,6 +4349,11 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->lut) {
+    BLI_mutex_lock(&lut_cache_lock);
+    cm_processor->lut->users--;
+    BLI_mutex_unlock(&lut_cache_lock);
+  }
 
   MEM_freeN(cm_processor);
 }
@@ -22,8 +22,11 @@
  * \ingroup imbuf
  */
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -35,6 +38,12 @@
 
 #include "BLI_sys_types.h"  // for intptr_t support
 
+#include <string.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -1758,6 +1767,446 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
   return true;
 }
 
+/* ******** filtered scaling ******** */
+
+/* Separable resampler: a horizontal pass into an intermediate float buffer followed by a
+ * vertical pass, both threaded over rows. The contributing source samples and their normalized
+ * weights are computed once per axis. Byte buffers are filtered with premultiplied alpha. */
+
+/* Contributions of the source samples to every destination sample along one axis. */
+typedef struct ScaleFilterAxis {
+  int *start;
+  int *len;
+  float *weights;
+  /* Number of weights stored per destination sample. */
+  int stride;
+} ScaleFilterAxis;
+
+typedef struct ScaleFilterData {
+  const ScaleFilterAxis *axis_x;
+  const ScaleFilterAxis *axis_y;
+
+  int src_x;
+  int dst_x;
+  int channels;
+  bool premultiply;
+
+  const unsigned char *src_byte;
+  const float *src_float;
+
+  /* Horizontally filtered rows, `dst_x * src_y * channels` floats. */
+  float *tmp;
+
+  unsigned char *dst_byte;
+  float *dst_float;
+} ScaleFilterData;
+
+typedef struct ScaleFilterTLS {
+  /* Accumulation row used when writing to a byte buffer. */
+  float *accum;
+} ScaleFilterTLS;
+
+static float scale_filter_support(eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_MITCHELL:
+      return 2.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  return 1.0f;
+}
+
+static float scale_filter_eval(eIMBScaleFilter filter, float x)
+{
+  x = fabsf(x);
+
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return (x < 0.5f) ? 1.0f : 0.0f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_MITCHELL: {
+      /* Mitchell-Netravali with B = C = 1/3. */
+      const float b = 1.0f / 3.0f, c = 1.0f / 3.0f;
+      if (x < 1.0f) {
+        return ((12.0f - 9.0f * b - 6.0f * c) * x * x * x +
+                (-18.0f + 12.0f * b + 6.0f * c) * x * x + (6.0f - 2.0f * b)) /
+               6.0f;
+      }
+      if (x < 2.0f) {
+        return ((-b - 6.0f * c) * x * x * x + (6.0f * b + 30.0f * c) * x * x +
+                (-12.0f * b - 48.0f * c) * x + (8.0f * b + 24.0f * c)) /
+               6.0f;
+      }
+      return 0.0f;
+    }
+    case IMB_SCALE_FILTER_LANCZOS: {
+      /* Lanczos with three lobes. */
+      if (x < 1e-6f) {
+        return 1.0f;
+      }
+      if (x < 3.0f) {
+        const float px = (float)M_PI * x;
+        return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
+      }
+      return 0.0f;
+    }
+  }
+  return 0.0f;
+}
+
+static void scale_filter_axis_init(ScaleFilterAxis *axis,
+                                   int src_len,
+                                   int dst_len,
+                                   eIMBScaleFilter filter)
+{
+  const float scale = (float)dst_len / (float)src_len;
+  /* Widen the kernel when minifying, so every source sample contributes. */
+  const float filter_scale = (scale < 1.0f) ? 1.0f / scale : 1.0f;
+  const float support = scale_filter_support(filter) * filter_scale;
+
+  axis->stride = (int)ceilf(support) * 2 + 3;
+  axis->start = MEM_mallocN(sizeof(int) * dst_len, "scale filter start");
+  axis->len = MEM_mallocN(sizeof(int) * dst_len, "scale filter len");
+  axis->weights = MEM_mallocN(sizeof(float) * dst_len * axis->stride, "scale filter weights");
+
+  for (int i = 0; i < dst_len; i++) {
+    const float center = ((float)i + 0.5f) / scale;
+    const int left = max_ii((int)floorf(center - support), 0);
+    const int right = min_ii((int)ceilf(center + support), src_len - 1);
+    float *weights = &axis->weights[i * axis->stride];
+    float total = 0.0f;
+    int start = left;
+    int len = 0;
+
+    for (int j = left; j <= right && len < axis->stride; j++) {
+      const float weight = scale_filter_eval(filter, ((float)j + 0.5f - center) / filter_scale);
+      if (len == 0 && weight == 0.0f) {
+        start = j + 1;
+        continue;
+      }
+      weights[len++] = weight;
+      total += weight;
+    }
+    while (len > 0 && weights[len - 1] == 0.0f) {
+      len--;
+    }
+
+    if (len == 0 || total == 0.0f) {
+      /* Fall back to the nearest sample. */
+      start = min_ii(max_ii((int)center, 0), src_len - 1);
+      weights[0] = 1.0f;
+      len = 1;
+    }
+    else {
+      const float total_inv = 1.0f / total;
+      for (int k = 0; k < len; k++) {
+        weights[k] *= total_inv;
+      }
+    }
+
+    axis->start[i] = start;
+    axis->len[i] = len;
+  }
+}
+
+static void scale_filter_axis_free(ScaleFilterAxis *axis)
+{
+  MEM_freeN(axis->start);
+  MEM_freeN(axis->len);
+  MEM_freeN(axis->weights);
+}
+
+/* accum[i] += weight * row[i] */
+static void scale_filter_row_madd(float *accum, const float *row, const float weight, int len)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 weight4 = _mm_set1_ps(weight);
+  for (; i + 4 <= len; i += 4) {
+    __m128 value = _mm_mul_ps(weight4, _mm_loadu_ps(row + i));
+    _mm_storeu_ps(accum + i, _mm_add_ps(_mm_loadu_ps(accum + i), value));
+  }
+#endif
+  for (; i < len; i++) {
+    accum[i] += weight * row[i];
+  }
+}
+
+static void scale_filter_x_byte(const ScaleFilterData *data,
+                                const unsigned char *src,
+                                float *dst)
+{
+  const ScaleFilterAxis *axis = data->axis_x;
+
+  for (int x = 0; x < data->dst_x; x++) {
+    const unsigned char *pixel = src + 4 * axis->start[x];
+    const float *weights = &axis->weights[x * axis->stride];
+    const int len = axis->len[x];
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    __m128 accum = _mm_setzero_ps();
+    for (int k = 0; k < len; k++, pixel += 4) {
+      int packed;
+      memcpy(&packed, pixel, sizeof(packed));
+      __m128i value_i = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+      __m128 value = _mm_cvtepi32_ps(_mm_unpacklo_epi16(value_i, zero));
+      float weight = weights[k];
+      if (data->premultiply) {
+        const float alpha_weight = weight * (float)pixel[3] * (1.0f / 255.0f);
+        value = _mm_mul_ps(value, _mm_set_ps(weight, alpha_weight, alpha_weight, alpha_weight));
+      }
+      else {
+        value = _mm_mul_ps(value, _mm_set1_ps(weight));
+      }
+      accum = _mm_add_ps(accum, value);
+    }
+    _mm_storeu_ps(dst + 4 * x, accum);
+#else
+    float accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int k = 0; k < len; k++, pixel += 4) {
+      const float weight = weights[k];
+      const float color_weight = data->premultiply ? weight * (float)pixel[3] * (1.0f / 255.0f) :
+                                                     weight;
+      accum[0] += color_weight * (float)pixel[0];
+      accum[1] += color_weight * (float)pixel[1];
+      accum[2] += color_weight * (float)pixel[2];
+      accum[3] += weight * (float)pixel[3];
+    }
+    copy_v4_v4(dst + 4 * x, accum);
+#endif
+  }
+}
+
+static void scale_filter_x_float(const ScaleFilterData *data, const float *src, float *dst)
+{
+  const ScaleFilterAxis *axis = data->axis_x;
+  const int channels = data->channels;
+
+#ifdef __SSE2__
+  if (channels == 4) {
+    for (int x = 0; x < data->dst_x; x++) {
+      const float *pixel = src + 4 * axis->start[x];
+      const float *weights = &axis->weights[x * axis->stride];
+      const int len = axis->len[x];
+      __m128 accum = _mm_setzero_ps();
+      for (int k = 0; k < len; k++, pixel += 4) {
+        accum = _mm_add_ps(accum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(pixel)));
+      }
+      _mm_storeu_ps(dst + 4 * x, accum);
+    }
+    return;
+  }
+#endif
+
+  for (int x = 0; x < data->dst_x; x++) {
+    const float *pixel = src + channels * axis->start[x];
+    const float *weights = &axis->weights[x * axis->stride];
+    const int len = axis->len[x];
+    float *dst_pixel = dst + channels * x;
+    for (int c = 0; c < channels; c++) {
+      dst_pixel[c] = 0.0f;
+    }
+    for (int k = 0; k < len; k++, pixel += channels) {
+      for (int c = 0; c < channels; c++) {
+        dst_pixel[c] += weights[k] * pixel[c];
+      }
+    }
+  }
+}
+
+static void scale_filter_x_task(void *__restrict userdata,
+                                const int y,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFilterData *data = userdata;
+  const size_t src_row_len = (size_t)data->src_x * data->channels;
+  const size_t dst_row_len = (size_t)data->dst_x * data->channels;
+  float *dst = data->tmp + dst_row_len * y;
+
+  if (data->src_byte) {
+    scale_filter_x_byte(data, data->src_byte + src_row_len * y, dst);
+  }
+  else {
+    scale_filter_x_float(data, data->src_float + src_row_len * y, dst);
+  }
+}
+
+static unsigned char scale_filter_unit_to_uchar(float value)
+{
+  if (value <= 0.0f) {
+    return 0;
+  }
+  if (value >= 255.0f) {
+    return 255;
+  }
+  return (unsigned char)(value + 0.5f);
+}
+
+static void scale_filter_y_task(void *__restrict userdata,
+                                const int y,
+                                const TaskParallelTLS *__restrict tls)
+{
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterAxis *axis = data->axis_y;
+  const int row_len = data->dst_x * data->channels;
+  const float *src = data->tmp + (size_t)row_len * axis->start[y];
+  const float *weights = &axis->weights[y * axis->stride];
+  const int len = axis->len[y];
+  float *accum;
+
+  if (data->dst_byte) {
+    ScaleFilterTLS *tls_data = tls->userdata_chunk;
+    if (tls_data->accum == NULL) {
+      tls_data->accum = MEM_mallocN(sizeof(float) * row_len, "scale filter accum");
+    }
+    accum = tls_data->accum;
+  }
+  else {
+    accum = data->dst_float + (size_t)row_len * y;
+  }
+
+  memset(accum, 0, sizeof(float) * row_len);
+  for (int k = 0; k < len; k++, src += row_len) {
+    scale_filter_row_madd(accum, src, weights[k], row_len);
+  }
+
+  if (data->dst_byte) {
+    unsigned char *dst = data->dst_byte + (size_t)row_len * y;
+    for (int x = 0; x < data->dst_x; x++, accum += 4, dst += 4) {
+      float mul = 1.0f;
+      if (data->premultiply && accum[3] > 0.0f) {
+        mul = 255.0f / min_ff(accum[3], 255.0f);
+      }
+      dst[0] = scale_filter_unit_to_uchar(accum[0] * mul);
+      dst[1] = scale_filter_unit_to_uchar(accum[1] * mul);
+      dst[2] = scale_filter_unit_to_uchar(accum[2] * mul);
+      dst[3] = scale_filter_unit_to_uchar(accum[3]);
+    }
+  }
+}
+
+static void scale_filter_tls_free(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk)
+{
+  ScaleFilterTLS *tls_data = chunk;
+  MEM_SAFE_FREE(tls_data->accum);
+}
+
+static void scale_filter_buffer(ScaleFilterData *data, int src_y, int dst_y)
+{
+  TaskParallelSettings settings;
+  ScaleFilterTLS tls_data = {NULL};
+
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)data->dst_x * src_y > 64 * 64);
+  settings.min_iter_per_thread = 8;
+  BLI_task_parallel_range(0, src_y, data, scale_filter_x_task, &settings);
+
+  settings.use_threading = ((size_t)data->dst_x * dst_y > 64 * 64);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = scale_filter_tls_free;
+  BLI_task_parallel_range(0, dst_y, data, scale_filter_y_task, &settings);
+}
+
+/**
+ * Resample \a ibuf to \a newx by \a newy using a separable \a filter. Both the byte and float
+ * buffers are scaled, the work is spread over all threads.
+ *
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             eIMBScaleFilter filter)
+{
+  ScaleFilterAxis axis_x, axis_y;
+  ScaleFilterData data = {NULL};
+  unsigned char *new_rect = NULL;
+  float *new_rect_float = NULL;
+  int channels_max;
+
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+  if (newx == 0 || newy == 0) {
+    return false;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+
+  channels_max = (ibuf->rect_float) ? max_ii(ibuf->channels, 4) : 4;
+
+  if (ibuf->rect) {
+    new_rect = MEM_mallocN(sizeof(unsigned int) * newx * newy, "scale filter byte");
+  }
+  if (ibuf->rect_float) {
+    new_rect_float = MEM_mallocN(sizeof(float) * ibuf->channels * newx * newy,
+                                 "scale filter float");
+  }
+
+  scale_filter_axis_init(&axis_x, ibuf->x, newx, filter);
+  scale_filter_axis_init(&axis_y, ibuf->y, newy, filter);
+
+  data.axis_x = &axis_x;
+  data.axis_y = &axis_y;
+  data.src_x = ibuf->x;
+  data.dst_x = newx;
+  data.tmp = MEM_mallocN(sizeof(float) * channels_max * newx * ibuf->y, "scale filter tmp");
+
+  if (ibuf->rect) {
+    data.channels = 4;
+    data.premultiply = (ibuf->planes == 32);
+    data.src_byte = (unsigned char *)ibuf->rect;
+    data.src_float = NULL;
+    data.dst_byte = new_rect;
+    data.dst_float = NULL;
+    scale_filter_buffer(&data, ibuf->y, newy);
+  }
+
+  if (ibuf->rect_float) {
+    data.channels = ibuf->channels;
+    data.premultiply = false;
+    data.src_byte = NULL;
+    data.src_float = ibuf->rect_float;
+    data.dst_byte = NULL;
+    data.dst_float = new_rect_float;
+    scale_filter_buffer(&data, ibuf->y, newy);
+  }
+
+  MEM_freeN(data.tmp);
+  scale_filter_axis_free(&axis_x);
+  scale_filter_axis_free(&axis_y);
+
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  if (new_rect) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)new_rect;
+  }
+
+  if (new_rect_float) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = new_rect_float;
+  }
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+  return true;
+}
+
 /* ******** threaded scaling ******** */
 
 typedef struct ScaleTreadInitData {
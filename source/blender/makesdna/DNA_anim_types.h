@@ -1079,6 +1079,10 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, the active action prepared for evaluation, see anim_sys.c. */
+  struct AnimEvalPlan *action_eval_plan;
+  /** Runtime data, NLA channels kept between evaluations, see anim_sys.c. */
+  struct NlaEvalData *nla_eval_data;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -128,7 +128,7 @@ typedef struct ClothSimSettings {
   int preroll DNA_DEPRECATED;
   /** In percent!; if tearing enabled, a spring will get cut. */
   int maxspringlen;
-  /** Which solver should be used? txold. */
+  /** Linear solver for the implicit integration, see CLOTH_SOLVER_TYPE. */
   short solver_type;
   /** Vertex group for scaling bending stiffness. */
   short vgroup_bend;
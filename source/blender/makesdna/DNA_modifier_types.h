@@ -153,6 +153,7 @@ typedef enum {
   /* DEPRECATED, ONLY USED FOR DO-VERSIONS */
   eSubsurfModifierFlag_SubsurfUv_DEPRECATED = (1 << 3),
   eSubsurfModifierFlag_UseCrease = (1 << 4),
+  eSubsurfModifierFlag_UseAdaptive = (1 << 5),
 } SubsurfModifierFlag;
 
 typedef enum {
@@ -175,7 +176,8 @@ typedef struct SubsurfModifierData {
   short subdivType, levels, renderLevels, flags;
   short uv_smooth;
   short quality;
-  char _pad[4];
+  /** Target length of subdivided edges on the render camera, in pixels. */
+  float adaptive_pixel_size;
 
   /* TODO(sergey): Get rid of those with the old CCG subdivision code. */
   void *emCache, *mCache;
@@ -829,8 +831,10 @@ typedef struct BooleanModifierData {
   ModifierData modifier;
 
   struct Object *object;
+  struct Collection *collection;
   char operation;
-  char _pad[2];
+  char flag;
+  char _pad[1];
   char bm_flag;
   float double_threshold;
 } BooleanModifierData;
@@ -841,6 +845,12 @@ typedef enum {
   eBooleanModifierOp_Difference = 2,
 } BooleanModifierOp;
 
+/* flag */
+enum {
+  eBooleanModifierFlag_Object = (1 << 0),
+  eBooleanModifierFlag_Collection = (1 << 1),
+};
+
 /* bm_flag (only used when G_DEBUG) */
 enum {
   eBooleanModifierBMeshFlag_BMesh_Separate = (1 << 0),
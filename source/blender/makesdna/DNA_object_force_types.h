@@ -289,6 +289,9 @@ typedef struct PointCache {
   struct PTCacheEdit *edit;
   /** Free callback. */
   void (*free_edit)(struct PTCacheEdit *edit);
+
+  /** Index of the frames of the single file disk cache (runtime only). */
+  struct PTCacheArchive *archive;
 } PointCache;
 
 typedef struct SBVertex {
@@ -501,6 +504,8 @@ typedef struct SoftBody {
 #define PTCACHE_IGNORE_CLEAR (1 << 13)
 
 #define PTCACHE_FLAG_INFO_DIRTY (1 << 14)
+/* Store all the frames of the disk cache in one file. */
+#define PTCACHE_DISK_SINGLE_FILE (1 << 15)
 
 /* PTCACHE_OUTDATED + PTCACHE_FRAMES_SKIPPED */
 #define PTCACHE_REDO_NEEDED 258
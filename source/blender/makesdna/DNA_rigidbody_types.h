@@ -63,7 +63,8 @@ typedef struct RigidBodyWorld {
   /** Group containing objects to use for Rigid Body Constraint.s*/
   struct Collection *constraints;
 
-  char _pad[4];
+  /** Number of threads solving the simulation islands, 0 to use all system threads. */
+  int num_threads;
   /** Last frame world was evaluated for (internal). */
   float ltime;
 
@@ -279,6 +279,12 @@ typedef struct Editing {
 
   /* Must be initialized only by BKE_sequencer_cache_create() */
   int64_t disk_cache_timestamp;
+
+  /** Number of threads used to render frames ahead of playhead. */
+  int prefetch_threads;
+  /** Filter scaling strips in final renders and proxies, see #eSeqScaleFilter. */
+  char scale_filter;
+  char _pad0[3];
 } Editing;
 
 /* ************* Effect Variable Structs ********* */
@@ -689,6 +695,16 @@ enum {
   SEQ_CACHE_DISK_CACHE_ENABLE = (1 << 11),
 };
 
+/* Editing->scale_filter */
+typedef enum eSeqScaleFilter {
+  /* Box filter for final renders, nearest neighbor for proxies. */
+  SEQ_SCALE_FILTER_DEFAULT = 0,
+  SEQ_SCALE_FILTER_BOX = 1,
+  SEQ_SCALE_FILTER_BILINEAR = 2,
+  SEQ_SCALE_FILTER_MITCHELL = 3,
+  SEQ_SCALE_FILTER_LANCZOS = 4,
+} eSeqScaleFilter;
+
 #ifdef __cplusplus
 }
 #endif
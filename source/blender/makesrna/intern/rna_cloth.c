@@ -543,6 +543,34 @@ static void rna_def_cloth_solver_result(BlenderRNA *brna)
   RNA_def_property_clear_flag(prop, PROP_EDITABLE);
   RNA_def_property_ui_text(prop, "Average Iterations", "Average iterations during substeps");
 
+  prop = RNA_def_property(srna, "time_collision_bvh", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "time_collision_bvh");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision BVH Time",
+                           "Seconds spent updating the bounding volume hierarchies of the cloth");
+
+  prop = RNA_def_property(srna, "time_collision_overlap", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "time_collision_overlap");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision Overlap Time",
+                           "Seconds spent finding the overlapping bounding volumes");
+
+  prop = RNA_def_property(srna, "time_collision_narrow", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "time_collision_narrow");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision Narrow Phase Time",
+                           "Seconds spent testing the overlapping primitives for collisions");
+
+  prop = RNA_def_property(srna, "time_collision_response", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "time_collision_response");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision Response Time",
+                           "Seconds spent computing and applying the collision impulses");
+
   RNA_define_verify_sdna(1);
 }
 
@@ -561,6 +589,21 @@ static void rna_def_cloth_sim_settings(BlenderRNA *brna)
       {0, NULL, 0, NULL, NULL},
   };
 
+  static const EnumPropertyItem prop_solver_type_items[] = {
+      {CLOTH_SOLVER_CONJUGATE_GRADIENT,
+       "CONJUGATE_GRADIENT",
+       0,
+       "Conjugate Gradient",
+       "Single threaded conjugate gradient solver (legacy)"},
+      {CLOTH_SOLVER_BLOCK_JACOBI,
+       "BLOCK_JACOBI",
+       0,
+       "Block Jacobi",
+       "Multi-threaded conjugate gradient solver with a block Jacobi preconditioner, "
+       "converges in fewer iterations on stiff or dense cloth"},
+      {0, NULL, 0, NULL, NULL},
+  };
+
   srna = RNA_def_struct(brna, "ClothSettings", NULL);
   RNA_def_struct_ui_text(srna, "Cloth Settings", "Cloth simulation settings for an object");
   RNA_def_struct_sdna(srna, "ClothSimSettings");
@@ -875,6 +918,14 @@ static void rna_def_cloth_sim_settings(BlenderRNA *brna)
   RNA_def_property_update(prop, 0, "rna_cloth_update");
   RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
 
+  prop = RNA_def_property(srna, "solver_type", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "solver_type");
+  RNA_def_property_enum_items(prop, prop_solver_type_items);
+  RNA_def_property_ui_text(
+      prop, "Solver", "Linear solver used to compute the velocity changes of each step");
+  RNA_def_property_update(prop, 0, "rna_cloth_update");
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+
   prop = RNA_def_property(srna, "use_internal_springs", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flags", CLOTH_SIMSETTINGS_FLAG_INTERNAL_SPRINGS);
   RNA_def_property_ui_text(prop,
@@ -257,14 +257,18 @@ static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 
 static void rna_Depsgraph_debug_stats(Depsgraph *depsgraph, char *result)
 {
-  size_t outer, ops, rels;
+  size_t outer, ops, rels, drivers, python_drivers;
   DEG_stats_simple(depsgraph, &outer, &ops, &rels);
+  DEG_stats_drivers(depsgraph, &drivers, &python_drivers);
   BLI_snprintf(result,
                STATS_MAX_SIZE,
-               "Approx %zu Operations, %zu Relations, %zu Outer Nodes",
+               "Approx %zu Operations, %zu Relations, %zu Outer Nodes, "
+               "%zu Drivers (%zu using Python)",
                ops,
                rels,
-               outer);
+               outer,
+               drivers,
+               python_drivers);
 }
 
 static void rna_Depsgraph_update(Depsgraph *depsgraph, Main *bmain, ReportList *reports)
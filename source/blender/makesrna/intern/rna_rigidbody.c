@@ -33,6 +33,7 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_math.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "WM_types.h"
@@ -925,6 +926,17 @@ static void rna_def_rigidbody_world(BlenderRNA *brna)
       "stability a little so use only when necessary)");
   RNA_def_property_update(prop, NC_SCENE, "rna_RigidBodyWorld_reset");
 
+  /* threads */
+  prop = RNA_def_property(srna, "threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "num_threads");
+  RNA_def_property_range(prop, 0, BLENDER_MAX_THREADS);
+  RNA_def_property_ui_text(
+      prop,
+      "Threads",
+      "Number of threads solving groups of touching objects, the result is the same for any "
+      "number of threads (0 uses all system threads)");
+  RNA_def_property_update(prop, NC_SCENE, NULL);
+
   /* cache */
   prop = RNA_def_property(srna, "point_cache", PROP_POINTER, PROP_NONE);
   RNA_def_property_flag(prop, PROP_NEVER_NULL);
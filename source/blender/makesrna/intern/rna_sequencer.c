@@ -1891,6 +1891,26 @@ static void rna_def_editor(BlenderRNA *brna)
        "Store proxies using project directory"},
       {0, NULL, 0, NULL, NULL},
   };
+  static const EnumPropertyItem scale_filter_items[] = {
+      {SEQ_SCALE_FILTER_DEFAULT,
+       "DEFAULT",
+       0,
+       "Default",
+       "Box filter for final renders and nearest neighbor for proxies"},
+      {SEQ_SCALE_FILTER_BOX, "BOX", 0, "Box", "Average of the covered pixels"},
+      {SEQ_SCALE_FILTER_BILINEAR, "BILINEAR", 0, "Bilinear", "Tent filter, smooth but blurry"},
+      {SEQ_SCALE_FILTER_MITCHELL,
+       "MITCHELL",
+       0,
+       "Mitchell",
+       "Cubic filter, sharper with little ringing"},
+      {SEQ_SCALE_FILTER_LANCZOS,
+       "LANCZOS",
+       0,
+       "Lanczos",
+       "Windowed sinc filter, sharpest but may ring at edges"},
+      {0, NULL, 0, NULL, NULL},
+  };
   srna = RNA_def_struct(brna, "SequenceEditor", NULL);
   RNA_def_struct_ui_text(srna, "Sequence Editor", "Sequence editing data for a Scene data-block");
   RNA_def_struct_ui_icon(srna, ICON_SEQUENCE);
@@ -2019,6 +2039,25 @@ static void rna_def_editor(BlenderRNA *brna)
       "Render frames ahead of playhead in the background for faster playback");
   RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
 
+  prop = RNA_def_property(srna, "prefetch_threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "prefetch_threads");
+  RNA_def_property_range(prop, 1, SEQ_PREFETCH_THREADS_MAX);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Threads",
+                           "Number of frames rendered ahead of playhead in parallel, each thread "
+                           "uses its own copy of the scene");
+  RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
+
+  prop = RNA_def_property(srna, "scale_filter", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "scale_filter");
+  RNA_def_property_enum_items(prop, scale_filter_items);
+  RNA_def_property_ui_text(
+      prop,
+      "Scale Filter",
+      "Filter used when scaling strips to the render size in final renders, and when building "
+      "proxies");
+  RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, "rna_SequenceEditor_update_cache");
+
   prop = RNA_def_property(srna, "recycle_max_cost", PROP_FLOAT, PROP_NONE);
   RNA_def_property_range(prop, 0.0f, SEQ_CACHE_COST_MAX);
   RNA_def_property_ui_range(prop, 0.0f, SEQ_CACHE_COST_MAX, 0.1f, 1);
@@ -181,6 +181,7 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "BKE_idprop.h"
 #  include "BKE_main.h"
 #  include "BKE_mesh_runtime.h"
+#  include "BKE_modifier_stack_cache.h"
 #  include "BKE_paint.h"
 #  include "BKE_pbvh.h"
 #  include "BKE_screen.h"
@@ -551,6 +552,49 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_modifier_cache_update(Main *UNUSED(bmain),
+                                              Scene *UNUSED(scene),
+                                              PointerRNA *UNUSED(ptr))
+{
+  BKE_modifier_stack_cache_enforce_limit();
+  USERDEF_TAG_DIRTY;
+}
+
+static int rna_Userdef_modifier_cache_hits_get(PointerRNA *UNUSED(ptr))
+{
+  ModifierStackCacheStats stats;
+  BKE_modifier_stack_cache_stats_get(&stats);
+  return (int)MIN2(stats.hits, INT_MAX);
+}
+
+static int rna_Userdef_modifier_cache_misses_get(PointerRNA *UNUSED(ptr))
+{
+  ModifierStackCacheStats stats;
+  BKE_modifier_stack_cache_stats_get(&stats);
+  return (int)MIN2(stats.misses, INT_MAX);
+}
+
+static float rna_Userdef_modifier_cache_time_saved_get(PointerRNA *UNUSED(ptr))
+{
+  ModifierStackCacheStats stats;
+  BKE_modifier_stack_cache_stats_get(&stats);
+  return (float)stats.time_saved;
+}
+
+static float rna_Userdef_modifier_cache_time_overhead_get(PointerRNA *UNUSED(ptr))
+{
+  ModifierStackCacheStats stats;
+  BKE_modifier_stack_cache_stats_get(&stats);
+  return (float)stats.time_overhead;
+}
+
+static int rna_Userdef_modifier_cache_memory_get(PointerRNA *UNUSED(ptr))
+{
+  ModifierStackCacheStats stats;
+  BKE_modifier_stack_cache_stats_get(&stats);
+  return (int)(stats.mem_in_use / (1024 * 1024));
+}
+
 static void rna_Userdef_disk_cache_dir_update(Main *UNUSED(bmain),
                                               Scene *UNUSED(scene),
                                               PointerRNA *UNUSED(ptr))
@@ -5208,6 +5252,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Uses fast compression with little CPU overhead, suitable for real-time playback"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -5263,6 +5312,55 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  /* Modifier stack cache */
+
+  prop = RNA_def_property(srna, "modifier_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "modifier_cache_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(
+      prop,
+      "Modifier Cache Limit",
+      "Memory limit for intermediate modifier stack results, used to only re-evaluate "
+      "modifiers after the one that changed (in megabytes, 0 disables the cache)");
+  RNA_def_property_update(prop, 0, "rna_Userdef_modifier_cache_update");
+
+  prop = RNA_def_property(srna, "modifier_cache_hits", PROP_INT, PROP_NONE);
+  RNA_def_property_int_funcs(prop, "rna_Userdef_modifier_cache_hits_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Modifier Cache Hits",
+                           "Number of modifier stack evaluations that continued from a cached "
+                           "result");
+
+  prop = RNA_def_property(srna, "modifier_cache_misses", PROP_INT, PROP_NONE);
+  RNA_def_property_int_funcs(prop, "rna_Userdef_modifier_cache_misses_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Modifier Cache Misses",
+                           "Number of modifier stack evaluations that found no cached result");
+
+  prop = RNA_def_property(srna, "modifier_cache_time_saved", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_funcs(prop, "rna_Userdef_modifier_cache_time_saved_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Modifier Cache Time Saved",
+                           "Time it took to evaluate the modifiers of the cached results that "
+                           "were used (in seconds)");
+
+  prop = RNA_def_property(srna, "modifier_cache_time_overhead", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_funcs(prop, "rna_Userdef_modifier_cache_time_overhead_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Modifier Cache Overhead",
+                           "Time spent looking up, storing and copying modifier stack results "
+                           "(in seconds)");
+
+  prop = RNA_def_property(srna, "modifier_cache_memory", PROP_INT, PROP_NONE);
+  RNA_def_property_int_funcs(prop, "rna_Userdef_modifier_cache_memory_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop, "Modifier Cache Memory", "Memory used by the modifier stack cache (in megabytes)");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
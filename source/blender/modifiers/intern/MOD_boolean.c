@@ -28,13 +28,17 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_alloca.h"
+#include "BLI_listbase.h"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
 
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BKE_collection.h"
 #include "BKE_global.h" /* only to check G.debug */
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
@@ -63,6 +67,7 @@ static void initData(ModifierData *md)
 
   bmd->double_threshold = 1e-6f;
   bmd->operation = eBooleanModifierOp_Difference;
+  bmd->flag = eBooleanModifierFlag_Object;
 }
 
 static bool isDisabled(const struct Scene *UNUSED(scene),
@@ -71,6 +76,10 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
 {
   BooleanModifierData *bmd = (BooleanModifierData *)md;
 
+  if (bmd->flag & eBooleanModifierFlag_Collection) {
+    return bmd->collection == NULL;
+  }
+
   /* The object type check is only needed here in case we have a placeholder
    * object assigned (because the library containing the mesh is missing).
    *
@@ -86,13 +95,32 @@ static void foreachObjectLink(ModifierData *md, Object *ob, ObjectWalkFunc walk,
   walk(userData, ob, &bmd->object, IDWALK_CB_NOP);
 }
 
+static void foreachIDLink(ModifierData *md, Object *ob, IDWalkFunc walk, void *userData)
+{
+  BooleanModifierData *bmd = (BooleanModifierData *)md;
+
+  walk(userData, ob, (ID **)&bmd->collection, IDWALK_CB_NOP);
+
+  foreachObjectLink(md, ob, (ObjectWalkFunc)walk, userData);
+}
+
 static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphContext *ctx)
 {
   BooleanModifierData *bmd = (BooleanModifierData *)md;
-  if (bmd->object != NULL) {
+  if ((bmd->flag & eBooleanModifierFlag_Object) && bmd->object != NULL) {
     DEG_add_object_relation(ctx->node, bmd->object, DEG_OB_COMP_TRANSFORM, "Boolean Modifier");
     DEG_add_object_relation(ctx->node, bmd->object, DEG_OB_COMP_GEOMETRY, "Boolean Modifier");
   }
+  else if ((bmd->flag & eBooleanModifierFlag_Collection) && bmd->collection != NULL) {
+    FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (bmd->collection, operand_ob) {
+      if (operand_ob->type == OB_MESH && operand_ob != ctx->object) {
+        DEG_add_object_relation(
+            ctx->node, operand_ob, DEG_OB_COMP_TRANSFORM, "Boolean Modifier");
+        DEG_add_object_relation(ctx->node, operand_ob, DEG_OB_COMP_GEOMETRY, "Boolean Modifier");
+      }
+    }
+    FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
+  }
   /* We need own transformation as well. */
   DEG_add_modifier_to_transform_relation(ctx->node, "Boolean Modifier");
 }
@@ -153,185 +181,343 @@ static int bm_face_isect_pair(BMFace *f, void *UNUSED(user_data))
   return BM_elem_flag_test(f, BM_FACE_TAG) ? 1 : 0;
 }
 
-static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
+/**
+ * Add the geometry of \a mesh to \a bm, leaving #BM_ELEM_TAG set on the new vertices and faces
+ * only, so they can be told apart from the geometry already in the BMesh.
+ */
+static void bm_mesh_append_tagged(BMesh *bm, const Mesh *mesh, const bool is_flip)
 {
-  BooleanModifierData *bmd = (BooleanModifierData *)md;
-  Mesh *result = mesh;
+  BM_mesh_elem_hflag_enable_all(bm, BM_VERT | BM_FACE, BM_ELEM_TAG, false);
+
+  BM_mesh_bm_from_me(bm,
+                     mesh,
+                     &((struct BMeshFromMeshParams){
+                         .calc_face_normal = true,
+                     }));
+
+  const int cd_loop_mdisp_offset = CustomData_get_offset(&bm->ldata, CD_MDISPS);
+  BMIter iter;
+  BMVert *eve;
+  BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
+    BM_elem_flag_toggle(eve, BM_ELEM_TAG);
+  }
+  BMFace *efa;
+  BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+    BM_elem_flag_toggle(efa, BM_ELEM_TAG);
+    if (UNLIKELY(is_flip) && BM_elem_flag_test(efa, BM_ELEM_TAG)) {
+      BM_face_normal_flip_ex(bm, efa, cd_loop_mdisp_offset, true);
+    }
+  }
+}
 
-  Mesh *mesh_other;
+/**
+ * Move the tagged operand geometry in front of the rest of \a bm.
+ *
+ * The inside test of the intersection casts a ray from one face of every group of faces,
+ * which face is picked depends on the element order. With the operand first the result
+ * matches a separate boolean modifier for every operand.
+ */
+static void bm_mesh_order_tagged_first(BMesh *bm)
+{
+  uint *vert_idx = MEM_malloc_arrayN(bm->totvert, sizeof(*vert_idx), __func__);
+  uint *edge_idx = MEM_malloc_arrayN(bm->totedge, sizeof(*edge_idx), __func__);
+  uint *face_idx = MEM_malloc_arrayN(bm->totface, sizeof(*face_idx), __func__);
+  uint tagged_len[3] = {0, 0, 0};
+  BMIter iter;
+  BMVert *eve;
+  BMEdge *eed;
+  BMFace *efa;
+  int i;
+
+  /* Edges of the operand are the ones using its (tagged) vertices. */
+  BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
+    tagged_len[0] += BM_elem_flag_test(eve, BM_ELEM_TAG) ? 1 : 0;
+  }
+  BM_ITER_MESH (eed, &iter, bm, BM_EDGES_OF_MESH) {
+    tagged_len[1] += BM_elem_flag_test(eed->v1, BM_ELEM_TAG) ? 1 : 0;
+  }
+  BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+    tagged_len[2] += BM_elem_flag_test(efa, BM_ELEM_TAG) ? 1 : 0;
+  }
 
-  if (bmd->object == NULL) {
-    return result;
+  uint tagged_index[3] = {0, 0, 0};
+  uint untagged_index[3] = {tagged_len[0], tagged_len[1], tagged_len[2]};
+  BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
+    vert_idx[i] = BM_elem_flag_test(eve, BM_ELEM_TAG) ? tagged_index[0]++ : untagged_index[0]++;
+  }
+  BM_ITER_MESH_INDEX (eed, &iter, bm, BM_EDGES_OF_MESH, i) {
+    edge_idx[i] = BM_elem_flag_test(eed->v1, BM_ELEM_TAG) ? tagged_index[1]++ :
+                                                            untagged_index[1]++;
+  }
+  BM_ITER_MESH_INDEX (efa, &iter, bm, BM_FACES_OF_MESH, i) {
+    face_idx[i] = BM_elem_flag_test(efa, BM_ELEM_TAG) ? tagged_index[2]++ : untagged_index[2]++;
   }
 
-  Object *other = bmd->object;
-  mesh_other = BKE_modifier_get_evaluated_mesh_from_evaluated_object(other, false);
-  if (mesh_other) {
-    Object *object = ctx->object;
+  BM_mesh_remap(bm, vert_idx, edge_idx, face_idx);
 
-    /* when one of objects is empty (has got no faces) we could speed up
-     * calculation a bit returning one of objects' derived meshes (or empty one)
-     * Returning mesh is depended on modifiers operation (sergey) */
-    result = get_quick_mesh(object, mesh, other, mesh_other, bmd->operation);
+  MEM_freeN(vert_idx);
+  MEM_freeN(edge_idx);
+  MEM_freeN(face_idx);
+}
 
-    if (result == NULL) {
-      const bool is_flip = (is_negative_m4(object->obmat) != is_negative_m4(other->obmat));
+/**
+ * Intersect the tagged operand geometry (in the local space of \a operand)
+ * with the rest of \a bm, which is in the local space of \a object.
+ */
+static void bm_mesh_intersect_tagged(BMesh *bm,
+                                     BooleanModifierData *bmd,
+                                     Object *object,
+                                     Object *operand,
+                                     const bool is_flip,
+                                     const bool recalc_normals)
+{
+  BMIter iter;
+  BMVert *eve;
+  BMFace *efa;
+
+  /* Faces created by a previous intersection may have stale normals,
+   * these are needed for tessellating n-gons. */
+  if (recalc_normals) {
+    BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+      if (!BM_elem_flag_test(efa, BM_ELEM_TAG)) {
+        BM_face_normal_update(efa);
+      }
+    }
+  }
 
-      BMesh *bm;
-      const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(mesh, mesh_other);
+  /* create tessface & intersect */
+  const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+  int tottri;
+  BMLoop *(*looptris)[3];
 
-#ifdef DEBUG_TIME
-      TIMEIT_START(boolean_bmesh);
-#endif
-      bm = BM_mesh_create(&allocsize,
-                          &((struct BMeshCreateParams){
-                              .use_toolflags = false,
-                          }));
+  looptris = MEM_malloc_arrayN(looptris_tot, sizeof(*looptris), __func__);
 
-      BM_mesh_bm_from_me(bm,
-                         mesh_other,
-                         &((struct BMeshFromMeshParams){
-                             .calc_face_normal = true,
-                         }));
+  BM_mesh_calc_tessellation_beauty(bm, looptris, &tottri);
 
-      if (UNLIKELY(is_flip)) {
-        const int cd_loop_mdisp_offset = CustomData_get_offset(&bm->ldata, CD_MDISPS);
-        BMIter iter;
-        BMFace *efa;
-        BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
-          BM_face_normal_flip_ex(bm, efa, cd_loop_mdisp_offset, true);
-        }
+  /* postpone this until after tessellating
+   * so we can use the original normals before the vertex are moved */
+  {
+    float imat[4][4];
+    float omat[4][4];
+
+    invert_m4_m4(imat, object->obmat);
+    mul_m4_m4m4(omat, imat, operand->obmat);
+
+    BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
+      if (BM_elem_flag_test(eve, BM_ELEM_TAG)) {
+        mul_m4_v3(omat, eve->co);
+        BM_elem_flag_disable(eve, BM_ELEM_TAG);
+      }
+    }
+
+    /* we need face normals because of 'BM_face_split_edgenet'
+     * we could calculate on the fly too (before calling split). */
+    float nmat[3][3];
+    copy_m3_m4(nmat, omat);
+    invert_m3(nmat);
+
+    if (UNLIKELY(is_flip)) {
+      negate_m3(nmat);
+    }
+
+    const short ob_src_totcol = operand->totcol;
+    short *material_remap = BLI_array_alloca(material_remap, ob_src_totcol ? ob_src_totcol : 1);
+
+    /* Using original (not evaluated) object here since we are writing to it. */
+    /* XXX Pretty sure comment above is fully wrong now with CoW & co ? */
+    BKE_object_material_remap_calc(object, operand, material_remap);
+
+    BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+      if (!BM_elem_flag_test(efa, BM_ELEM_TAG)) {
+        BM_elem_flag_disable(efa, BM_FACE_TAG);
+        continue;
       }
 
+      mul_transposed_m3_v3(nmat, efa->no);
+      normalize_v3(efa->no);
+
+      /* Temp tag to test which side split faces are from. */
+      BM_elem_flag_enable(efa, BM_FACE_TAG);
+      BM_elem_flag_disable(efa, BM_ELEM_TAG);
+
+      /* remap material */
+      if (LIKELY(efa->mat_nr < ob_src_totcol)) {
+        efa->mat_nr = material_remap[efa->mat_nr];
+      }
+    }
+  }
+
+  /* not needed, but normals for 'dm' will be invalid,
+   * currently this is ok for 'BM_mesh_intersect' */
+  // BM_mesh_normals_update(bm);
+
+  bool use_separate = false;
+  bool use_dissolve = true;
+  bool use_island_connect = true;
+
+  /* change for testing */
+  if (G.debug & G_DEBUG) {
+    use_separate = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_Separate) != 0;
+    use_dissolve = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_NoDissolve) == 0;
+    use_island_connect = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_NoConnectRegions) == 0;
+  }
+
+  BM_mesh_intersect(bm,
+                    looptris,
+                    tottri,
+                    bm_face_isect_pair,
+                    NULL,
+                    false,
+                    use_separate,
+                    use_dissolve,
+                    use_island_connect,
+                    false,
+                    false,
+                    bmd->operation,
+                    bmd->double_threshold);
+
+  MEM_freeN(looptris);
+}
+
+/**
+ * Run the boolean against every operand in one BMesh,
+ * avoiding a mesh conversion round trip for each of them.
+ */
+static Mesh *boolean_bmesh_operands(BooleanModifierData *bmd,
+                                    Object *object,
+                                    Mesh *mesh,
+                                    Object **operands,
+                                    Mesh **operand_meshes,
+                                    const int operands_len)
+{
+  BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(mesh);
+  for (int i = 0; i < operands_len; i++) {
+    allocsize.totvert += operand_meshes[i]->totvert;
+    allocsize.totedge += operand_meshes[i]->totedge;
+    allocsize.totloop += operand_meshes[i]->totloop;
+    allocsize.totface += operand_meshes[i]->totpoly;
+  }
+
+#ifdef DEBUG_TIME
+  TIMEIT_START(boolean_bmesh);
+#endif
+  BMesh *bm = BM_mesh_create(&allocsize,
+                             &((struct BMeshCreateParams){
+                                 .use_toolflags = false,
+                             }));
+
+  for (int i = 0; i < operands_len; i++) {
+    Object *operand = operands[i];
+    const bool is_flip = (is_negative_m4(object->obmat) != is_negative_m4(operand->obmat));
+
+    if (i == 0) {
+      /* Keep the operand first, so the element order matches a single boolean. */
+      bm_mesh_append_tagged(bm, operand_meshes[i], is_flip);
       BM_mesh_bm_from_me(bm,
                          mesh,
                          &((struct BMeshFromMeshParams){
                              .calc_face_normal = true,
                          }));
+    }
+    else {
+      /* Without the gaps of removed elements the operand is appended in its own order. */
+      BM_mesh_pack(bm);
+      bm_mesh_append_tagged(bm, operand_meshes[i], is_flip);
+      bm_mesh_order_tagged_first(bm);
+    }
 
-      /* main bmesh intersection setup */
-      {
-        /* create tessface & intersect */
-        const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
-        int tottri;
-        BMLoop *(*looptris)[3];
-
-        looptris = MEM_malloc_arrayN(looptris_tot, sizeof(*looptris), __func__);
-
-        BM_mesh_calc_tessellation_beauty(bm, looptris, &tottri);
+    bm_mesh_intersect_tagged(bm, bmd, object, operand, is_flip, i != 0);
+  }
 
-        /* postpone this until after tessellating
-         * so we can use the original normals before the vertex are moved */
-        {
-          BMIter iter;
-          int i;
-          const int i_verts_end = mesh_other->totvert;
-          const int i_faces_end = mesh_other->totpoly;
+  Mesh *result = BKE_mesh_from_bmesh_for_eval_nomain(bm, NULL, mesh);
 
-          float imat[4][4];
-          float omat[4][4];
+  BM_mesh_free(bm);
 
-          invert_m4_m4(imat, object->obmat);
-          mul_m4_m4m4(omat, imat, other->obmat);
+  result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
 
-          BMVert *eve;
-          i = 0;
-          BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
-            mul_m4_v3(omat, eve->co);
-            if (++i == i_verts_end) {
-              break;
-            }
-          }
+#ifdef DEBUG_TIME
+  TIMEIT_END(boolean_bmesh);
+#endif
 
-          /* we need face normals because of 'BM_face_split_edgenet'
-           * we could calculate on the fly too (before calling split). */
-          {
-            float nmat[3][3];
-            copy_m3_m4(nmat, omat);
-            invert_m3(nmat);
-
-            if (UNLIKELY(is_flip)) {
-              negate_m3(nmat);
-            }
-
-            const short ob_src_totcol = other->totcol;
-            short *material_remap = BLI_array_alloca(material_remap,
-                                                     ob_src_totcol ? ob_src_totcol : 1);
-
-            /* Using original (not evaluated) object here since we are writing to it. */
-            /* XXX Pretty sure comment above is fully wrong now with CoW & co ? */
-            BKE_object_material_remap_calc(ctx->object, other, material_remap);
-
-            BMFace *efa;
-            i = 0;
-            BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
-              mul_transposed_m3_v3(nmat, efa->no);
-              normalize_v3(efa->no);
-
-              /* Temp tag to test which side split faces are from. */
-              BM_elem_flag_enable(efa, BM_FACE_TAG);
-
-              /* remap material */
-              if (LIKELY(efa->mat_nr < ob_src_totcol)) {
-                efa->mat_nr = material_remap[efa->mat_nr];
-              }
-
-              if (++i == i_faces_end) {
-                break;
-              }
-            }
-          }
-        }
+  return result;
+}
 
-        /* not needed, but normals for 'dm' will be invalid,
-         * currently this is ok for 'BM_mesh_intersect' */
-        // BM_mesh_normals_update(bm);
+static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
+{
+  BooleanModifierData *bmd = (BooleanModifierData *)md;
+  Object *object = ctx->object;
+  Mesh *result = mesh;
 
-        bool use_separate = false;
-        bool use_dissolve = true;
-        bool use_island_connect = true;
+  if (bmd->flag & eBooleanModifierFlag_Object) {
+    if (bmd->object == NULL) {
+      return result;
+    }
 
-        /* change for testing */
-        if (G.debug & G_DEBUG) {
-          use_separate = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_Separate) != 0;
-          use_dissolve = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_NoDissolve) == 0;
-          use_island_connect = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_NoConnectRegions) ==
-                               0;
-        }
+    Object *other = bmd->object;
+    Mesh *mesh_other = BKE_modifier_get_evaluated_mesh_from_evaluated_object(other, false);
+    if (mesh_other) {
+      /* when one of objects is empty (has got no faces) we could speed up
+       * calculation a bit returning one of objects' derived meshes (or empty one)
+       * Returning mesh is depended on modifiers operation (sergey) */
+      result = get_quick_mesh(object, mesh, other, mesh_other, bmd->operation);
 
-        BM_mesh_intersect(bm,
-                          looptris,
-                          tottri,
-                          bm_face_isect_pair,
-                          NULL,
-                          false,
-                          use_separate,
-                          use_dissolve,
-                          use_island_connect,
-                          false,
-                          false,
-                          bmd->operation,
-                          bmd->double_threshold);
-
-        MEM_freeN(looptris);
+      if (result == NULL) {
+        result = boolean_bmesh_operands(bmd, object, mesh, &other, &mesh_other, 1);
       }
 
-      result = BKE_mesh_from_bmesh_for_eval_nomain(bm, NULL, mesh);
-
-      BM_mesh_free(bm);
+      /* if new mesh returned, return it; otherwise there was
+       * an error, so delete the modifier object */
+      if (result == NULL) {
+        BKE_modifier_set_error(md, "Cannot execute boolean operation");
+      }
+    }
+  }
+  else if (bmd->flag & eBooleanModifierFlag_Collection) {
+    if (bmd->collection == NULL) {
+      return result;
+    }
 
-      result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+    ListBase operand_bases = BKE_collection_object_cache_get(bmd->collection);
+    const int operands_max = BLI_listbase_count(&operand_bases);
+    Object **operands = MEM_malloc_arrayN(operands_max, sizeof(*operands), __func__);
+    Mesh **operand_meshes = MEM_malloc_arrayN(operands_max, sizeof(*operand_meshes), __func__);
+    int operands_len = 0;
 
-#ifdef DEBUG_TIME
-      TIMEIT_END(boolean_bmesh);
-#endif
+    FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (bmd->collection, operand_ob) {
+      if (operand_ob->type != OB_MESH || operand_ob == object) {
+        continue;
+      }
+      Mesh *mesh_operand = BKE_modifier_get_evaluated_mesh_from_evaluated_object(operand_ob,
+                                                                                  false);
+      if (mesh_operand == NULL) {
+        continue;
+      }
+      if (mesh_operand->totpoly == 0) {
+        /* Empty operands leave union and difference unchanged. */
+        if (bmd->operation == eBooleanModifierOp_Intersect) {
+          operands_len = 0;
+          result = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+          break;
+        }
+        continue;
+      }
+      operands[operands_len] = operand_ob;
+      operand_meshes[operands_len] = mesh_operand;
+      operands_len++;
     }
+    FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
 
-    /* if new mesh returned, return it; otherwise there was
-     * an error, so delete the modifier object */
-    if (result == NULL) {
-      BKE_modifier_set_error(md, "Cannot execute boolean operation");
+    if (operands_len != 0) {
+      if (mesh->totpoly == 0 && bmd->operation != eBooleanModifierOp_Union) {
+        result = get_quick_mesh(object, mesh, operands[0], operand_meshes[0], bmd->operation);
+      }
+      else {
+        result = boolean_bmesh_operands(bmd, object, mesh, operands, operand_meshes, operands_len);
+      }
     }
+
+    MEM_freeN(operands);
+    MEM_freeN(operand_meshes);
   }
 
   return result;
@@ -372,7 +558,7 @@ ModifierTypeInfo modifierType_Boolean = {
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachObjectLink */ foreachObjectLink,
-    /* foreachIDLink */ NULL,
+    /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ NULL,
     /* freeRuntimeData */ NULL,
 };
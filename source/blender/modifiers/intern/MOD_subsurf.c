@@ -25,6 +25,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_listbase.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
@@ -33,18 +34,24 @@
 
 #include "BKE_scene.h"
 #include "BKE_subdiv.h"
+#include "BKE_subdiv_adaptive.h"
 #include "BKE_subdiv_ccg.h"
 #include "BKE_subdiv_deform.h"
 #include "BKE_subdiv_mesh.h"
 #include "BKE_subsurf.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
 #include "MOD_modifiertypes.h"
 
 #include "intern/CCGSubSurf.h"
 
+#include "CLG_log.h"
+
+static CLG_LogRef LOG = {"modifier.subsurf"};
+
 typedef struct SubsurfRuntimeData {
   /* Cached subdivision surface descriptor, with topology and settings. */
   struct Subdiv *subdiv;
@@ -59,6 +66,7 @@ static void initData(ModifierData *md)
   smd->uv_smooth = SUBSURF_UV_SMOOTH_PRESERVE_CORNERS;
   smd->quality = 3;
   smd->flags |= (eSubsurfModifierFlag_UseCrease | eSubsurfModifierFlag_ControlEdges);
+  smd->adaptive_pixel_size = 1.0f;
 }
 
 static void copyData(const ModifierData *md, ModifierData *target, const int flag)
@@ -108,13 +116,63 @@ static bool isDisabled(const Scene *scene, ModifierData *md, bool useRenderParam
   return get_render_subsurf_level(&scene->r, levels, useRenderParams != 0) == 0;
 }
 
+static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphContext *ctx)
+{
+  SubsurfModifierData *smd = (SubsurfModifierData *)md;
+  if ((smd->flags & eSubsurfModifierFlag_UseAdaptive) == 0) {
+    return;
+  }
+  /* Adaptive subdivision depends on the render camera and resolution. The camera is switched by
+   * markers, every camera it can become is built into the dependency graph. */
+  DEG_add_scene_relation(
+      ctx->node, ctx->scene, DEG_SCENE_COMP_PARAMETERS, "Subdivision Surface Modifier");
+  if (ctx->scene->camera != NULL) {
+    DEG_add_object_relation(
+        ctx->node, ctx->scene->camera, DEG_OB_COMP_TRANSFORM, "Subdivision Surface Modifier");
+    DEG_add_object_relation(
+        ctx->node, ctx->scene->camera, DEG_OB_COMP_PARAMETERS, "Subdivision Surface Modifier");
+  }
+  LISTBASE_FOREACH (TimeMarker *, marker, &ctx->scene->markers) {
+    if (marker->camera != NULL && marker->camera != ctx->scene->camera) {
+      DEG_add_object_relation(
+          ctx->node, marker->camera, DEG_OB_COMP_TRANSFORM, "Subdivision Surface Modifier");
+      DEG_add_object_relation(
+          ctx->node, marker->camera, DEG_OB_COMP_PARAMETERS, "Subdivision Surface Modifier");
+    }
+  }
+  DEG_add_modifier_to_transform_relation(ctx->node, "Subdivision Surface Modifier");
+}
+
+/* Render level for the adaptive subdivision: the level of the face which needs the most. The
+ * subdivided mesh has a single resolution, which keeps it free of cracks between faces. */
+static int subdiv_adaptive_level_get(const SubsurfModifierData *smd,
+                                     const ModifierEvalContext *ctx,
+                                     const Scene *scene,
+                                     const Mesh *mesh,
+                                     const int max_level)
+{
+  const Object *camera = scene->camera;
+  if (camera == NULL || camera->type != OB_CAMERA || max_level == 0) {
+    return max_level;
+  }
+  SubdivAdaptiveView view;
+  BKE_subdiv_adaptive_view_init(&view, camera, &scene->r);
+  return BKE_subdiv_adaptive_face_levels(
+      &view, mesh, ctx->object->obmat, smd->adaptive_pixel_size, max_level, NULL);
+}
+
 static int subdiv_levels_for_modifier_get(const SubsurfModifierData *smd,
-                                          const ModifierEvalContext *ctx)
+                                          const ModifierEvalContext *ctx,
+                                          const Mesh *mesh)
 {
   Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
   const bool use_render_params = (ctx->flag & MOD_APPLY_RENDER);
   const int requested_levels = (use_render_params) ? smd->renderLevels : smd->levels;
-  return get_render_subsurf_level(&scene->r, requested_levels, use_render_params);
+  const int levels = get_render_subsurf_level(&scene->r, requested_levels, use_render_params);
+  if (use_render_params && (smd->flags & eSubsurfModifierFlag_UseAdaptive)) {
+    return subdiv_adaptive_level_get(smd, ctx, scene, mesh, levels);
+  }
+  return levels;
 }
 
 static void subdiv_settings_init(SubdivSettings *settings, const SubsurfModifierData *smd)
@@ -144,9 +202,10 @@ static Subdiv *subdiv_descriptor_ensure(SubsurfModifierData *smd,
 
 static void subdiv_mesh_settings_init(SubdivToMeshSettings *settings,
                                       const SubsurfModifierData *smd,
-                                      const ModifierEvalContext *ctx)
+                                      const ModifierEvalContext *ctx,
+                                      const Mesh *mesh)
 {
-  const int level = subdiv_levels_for_modifier_get(smd, ctx);
+  const int level = subdiv_levels_for_modifier_get(smd, ctx, mesh);
   settings->resolution = (1 << level) + 1;
   settings->use_optimal_display = (smd->flags & eSubsurfModifierFlag_ControlEdges) &&
                                   !(ctx->flag & MOD_APPLY_TO_BASE_MESH);
@@ -159,11 +218,19 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
 {
   Mesh *result = mesh;
   SubdivToMeshSettings mesh_settings;
-  subdiv_mesh_settings_init(&mesh_settings, smd, ctx);
+  subdiv_mesh_settings_init(&mesh_settings, smd, ctx, mesh);
   if (mesh_settings.resolution < 3) {
     return result;
   }
   result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+  if ((smd->flags & eSubsurfModifierFlag_UseAdaptive) && (ctx->flag & MOD_APPLY_RENDER) &&
+      result != NULL) {
+    CLOG_INFO(&LOG,
+              1,
+              "adaptive subdivision of \"%s\" to %d faces",
+              ctx->object->id.name + 2,
+              result->totpoly);
+  }
   return result;
 }
 
@@ -171,9 +238,10 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
 
 static void subdiv_ccg_settings_init(SubdivToCCGSettings *settings,
                                      const SubsurfModifierData *smd,
-                                     const ModifierEvalContext *ctx)
+                                     const ModifierEvalContext *ctx,
+                                     const Mesh *mesh)
 {
-  const int level = subdiv_levels_for_modifier_get(smd, ctx);
+  const int level = subdiv_levels_for_modifier_get(smd, ctx, mesh);
   settings->resolution = (1 << level) + 1;
   settings->need_normal = true;
   settings->need_mask = false;
@@ -186,7 +254,7 @@ static Mesh *subdiv_as_ccg(SubsurfModifierData *smd,
 {
   Mesh *result = mesh;
   SubdivToCCGSettings ccg_settings;
-  subdiv_ccg_settings_init(&ccg_settings, smd, ctx);
+  subdiv_ccg_settings_init(&ccg_settings, smd, ctx, mesh);
   if (ccg_settings.resolution < 3) {
     return result;
   }
@@ -299,7 +367,7 @@ ModifierTypeInfo modifierType_Subsurf = {
     /* requiredDataMask */ NULL,
     /* freeData */ freeData,
     /* isDisabled */ isDisabled,
-    /* updateDepsgraph */ NULL,
+    /* updateDepsgraph */ updateDepsgraph,
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachObjectLink */ NULL,
@@ -32,15 +32,15 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_alloca.h"
-#include "BLI_kdopbvh.h"
+#include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 
-#include "BKE_bvhutils.h"
 #include "BKE_deform.h"
 #include "BKE_mesh.h"
 #include "BKE_modifier.h"
@@ -49,6 +49,8 @@
 
 #include "MOD_modifiertypes.h"
 
+#include "atomic_ops.h"
+
 //#define USE_WELD_DEBUG
 //#define USE_WELD_NORMALS
 
@@ -191,18 +193,14 @@ static bool weld_iter_loop_of_poly_begin(WeldLoopOfPolyIter *iter,
 
 static bool weld_iter_loop_of_poly_next(WeldLoopOfPolyIter *iter);
 
-static void weld_assert_vert_dest_map_setup(const BVHTreeOverlap *overlap,
-                                            const uint overlap_len,
-                                            const uint *vert_dest_map)
+static void weld_assert_vert_dest_map_setup(const uint mvert_len, const uint *vert_dest_map)
 {
-  const BVHTreeOverlap *overlap_iter = &overlap[0];
-  for (uint i = overlap_len; i--; overlap_iter++) {
-    uint indexA = overlap_iter->indexA;
-    uint indexB = overlap_iter->indexB;
-    uint va_dst = vert_dest_map[indexA];
-    uint vb_dst = vert_dest_map[indexB];
-
-    BLI_assert(va_dst == vb_dst);
+  for (uint i = 0; i < mvert_len; i++) {
+    uint v_dst = vert_dest_map[i];
+    if (v_dst != OUT_OF_CONTEXT) {
+      BLI_assert(v_dst <= i);
+      BLI_assert(vert_dest_map[v_dst] == v_dst);
+    }
   }
 }
 
@@ -371,70 +369,272 @@ static void weld_assert_poly_len(const WeldPoly *wp, const WeldLoop *wloop)
 /** \name Weld Vert API
  * \{ */
 
-static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
-                                          const BVHTreeOverlap *overlap,
-                                          const uint overlap_len,
-                                          uint *r_vert_dest_map,
-                                          WeldVert **r_wvert,
-                                          uint *r_wvert_len,
-                                          uint *r_vert_kill_len)
+/* Size of the spatial hash grid along each axis, limiting the number of cells when the merge
+ * distance is very small compared to the mesh. */
+#define WELD_CELL_LEN_MAX (1 << 20)
+
+typedef struct WeldVertClustersData {
+  const MVert *mvert;
+  /* Optional, only the enabled vertices are welded. */
+  const BLI_bitmap *v_mask;
+  float merge_dist_sq;
+  uint max_interactions;
+
+  float cell_min[3];
+  float cell_size_inv;
+  /* Cell of each vertex, the vertices of each hash bucket are stored in index order. */
+  int (*vert_cell)[3];
+  uint *bucket_offs;
+  uint *bucket_verts;
+  uint bucket_mask;
+
+  /* Atomics are only needed when actually using threads. */
+  bool use_threading;
+  uint *vert_dest_map;
+} WeldVertClustersData;
+
+BLI_INLINE uint weld_cell_hash(const int cell[3], const uint bucket_mask)
+{
+  return (((uint)cell[0] * 73856093u) ^ ((uint)cell[1] * 19349663u) ^
+          ((uint)cell[2] * 83492791u)) &
+         bucket_mask;
+}
+
+BLI_INLINE bool weld_vert_dest_cas(uint *v_dest, uint v_old, uint v_new, bool use_threading)
+{
+  if (use_threading) {
+    return atomic_cas_uint32(v_dest, v_old, v_new) == v_old;
+  }
+  if (*v_dest == v_old) {
+    *v_dest = v_new;
+    return true;
+  }
+  return false;
+}
+
+/* Find the vertex the cluster of \a v is merged into, halving the path on the way.
+ * Parents always have a lower index than their children, so the root is the lowest index of
+ * the cluster. */
+static uint weld_vert_cluster_root(uint *vert_dest_map, uint v)
+{
+  while (vert_dest_map[v] != v) {
+    vert_dest_map[v] = vert_dest_map[vert_dest_map[v]];
+    v = vert_dest_map[v];
+  }
+  return v;
+}
+
+/* Join the clusters of two vertices. The lower root wins, so the result doesn't depend on the
+ * order the pairs are found in. */
+static void weld_vert_clusters_join(uint *vert_dest_map,
+                                    const uint v_a,
+                                    const uint v_b,
+                                    const bool use_threading)
+{
+  weld_vert_dest_cas(&vert_dest_map[v_a], OUT_OF_CONTEXT, v_a, use_threading);
+  weld_vert_dest_cas(&vert_dest_map[v_b], OUT_OF_CONTEXT, v_b, use_threading);
+
+  while (true) {
+    uint va_dst = weld_vert_cluster_root(vert_dest_map, v_a);
+    uint vb_dst = weld_vert_cluster_root(vert_dest_map, v_b);
+    if (va_dst == vb_dst) {
+      return;
+    }
+    if (va_dst > vb_dst) {
+      SWAP(uint, va_dst, vb_dst);
+    }
+    /* Fails when another thread linked the root meanwhile, try again from the new roots. */
+    if (weld_vert_dest_cas(&vert_dest_map[vb_dst], vb_dst, va_dst, use_threading)) {
+      return;
+    }
+  }
+}
+
+static void weld_vert_cell_cb(void *__restrict userdata,
+                              const int i,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WeldVertClustersData *data = userdata;
+  if (data->v_mask && !BLI_BITMAP_TEST(data->v_mask, i)) {
+    return;
+  }
+  const float *co = data->mvert[i].co;
+  for (int j = 0; j < 3; j++) {
+    const float f = (co[j] - data->cell_min[j]) * data->cell_size_inv;
+    data->vert_cell[i][j] = (int)clamp_f(f, 0.0f, (float)WELD_CELL_LEN_MAX);
+  }
+}
+
+static void weld_vert_clusters_find_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WeldVertClustersData *data = userdata;
+  if (data->v_mask && !BLI_BITMAP_TEST(data->v_mask, i)) {
+    return;
+  }
+
+  const uint v_a = (uint)i;
+  const float *co = data->mvert[v_a].co;
+  const int *cell = data->vert_cell[v_a];
+  uint found_len = 0;
+
+  /* The cells are at least twice the merge distance, so the vertices within the distance are
+   * in the cell of the vertex or in the neighbors on the side of the half it is in.
+   * Only the pairs with a higher index are tested, the others are found from the lower one. */
+  int side[3];
+  for (int j = 0; j < 3; j++) {
+    const float f = (co[j] - data->cell_min[j]) * data->cell_size_inv;
+    side[j] = (f - (float)cell[j] < 0.5f) ? -1 : 1;
+  }
+
+  for (int z = 0; z < 2; z++) {
+    for (int y = 0; y < 2; y++) {
+      for (int x = 0; x < 2; x++) {
+        const int cell_b[3] = {
+            cell[0] + x * side[0], cell[1] + y * side[1], cell[2] + z * side[2]};
+        const uint bucket = weld_cell_hash(cell_b, data->bucket_mask);
+        const uint *bucket_verts_end = &data->bucket_verts[data->bucket_offs[bucket + 1]];
+        for (const uint *v_b_p = &data->bucket_verts[data->bucket_offs[bucket]];
+             v_b_p != bucket_verts_end;
+             v_b_p++) {
+          const uint v_b = *v_b_p;
+          if (v_b <= v_a) {
+            continue;
+          }
+          const int *cell_vb = data->vert_cell[v_b];
+          if ((cell_vb[0] != cell_b[0]) || (cell_vb[1] != cell_b[1]) ||
+              (cell_vb[2] != cell_b[2])) {
+            /* Other cell with the same hash. */
+            continue;
+          }
+          if (len_squared_v3v3(co, data->mvert[v_b].co) > data->merge_dist_sq) {
+            continue;
+          }
+          weld_vert_clusters_join(data->vert_dest_map, v_a, v_b, data->use_threading);
+          if (++found_len == data->max_interactions) {
+            return;
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Find the clusters of vertices closer than \a merge_dist to each other, using a spatial hash
+ * of cells twice the size of the distance.
+ *
+ * \param max_interactions: Limit of vertices found for each vertex, zero for no limit.
+ * \param r_vert_dest_map: For each vertex, the lowest index of its cluster, or #OUT_OF_CONTEXT
+ * when it isn't merged.
+ * \return The number of vertices merged into others.
+ */
+static uint weld_vert_clusters_find(const MVert *mvert,
+                                    const uint mvert_len,
+                                    const BLI_bitmap *v_mask,
+                                    const float merge_dist,
+                                    const uint max_interactions,
+                                    uint *r_vert_dest_map)
 {
   uint *v_dest_iter = &r_vert_dest_map[0];
   for (uint i = mvert_len; i--; v_dest_iter++) {
     *v_dest_iter = OUT_OF_CONTEXT;
   }
 
-  uint vert_kill_len = 0;
-  const BVHTreeOverlap *overlap_iter = &overlap[0];
-  for (uint i = 0; i < overlap_len; i++, overlap_iter++) {
-    uint indexA = overlap_iter->indexA;
-    uint indexB = overlap_iter->indexB;
-
-    BLI_assert(indexA < indexB);
-
-    uint va_dst = r_vert_dest_map[indexA];
-    uint vb_dst = r_vert_dest_map[indexB];
-    if (va_dst == OUT_OF_CONTEXT) {
-      if (vb_dst == OUT_OF_CONTEXT) {
-        vb_dst = indexA;
-        r_vert_dest_map[indexB] = vb_dst;
-      }
-      r_vert_dest_map[indexA] = vb_dst;
-      vert_kill_len++;
+  WeldVertClustersData data = {
+      .mvert = mvert,
+      .v_mask = v_mask,
+      .merge_dist_sq = square_f(merge_dist),
+      .max_interactions = max_interactions,
+      .vert_dest_map = r_vert_dest_map,
+  };
+
+  uint vert_len = 0;
+  float max[3];
+  INIT_MINMAX(data.cell_min, max);
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask == NULL || BLI_BITMAP_TEST(v_mask, i)) {
+      minmax_v3v3_v3(data.cell_min, max, mvert[i].co);
+      vert_len++;
     }
-    else if (vb_dst == OUT_OF_CONTEXT) {
-      r_vert_dest_map[indexB] = va_dst;
-      vert_kill_len++;
+  }
+  if (vert_len < 2) {
+    return 0;
+  }
+
+  float cell_size = max_fff(max[0] - data.cell_min[0],
+                            max[1] - data.cell_min[1],
+                            max[2] - data.cell_min[2]) /
+                    (float)WELD_CELL_LEN_MAX;
+  cell_size = max_ff(cell_size, merge_dist * 2.0f);
+  data.cell_size_inv = (cell_size > 0.0f) ? 1.0f / cell_size : 1.0f;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mvert_len > 10000);
+  settings.min_iter_per_thread = 1024;
+  data.use_threading = settings.use_threading && (BLI_task_scheduler_num_threads() > 1);
+
+  data.vert_cell = MEM_mallocN(sizeof(*data.vert_cell) * mvert_len, __func__);
+  BLI_task_parallel_range(0, (int)mvert_len, &data, weld_vert_cell_cb, &settings);
+
+  /* Sort the vertices by bucket, keeping them in index order so the vertices found first
+   * don't depend on threading. */
+  const uint bucket_len = power_of_2_max_u(vert_len);
+  data.bucket_mask = bucket_len - 1;
+  data.bucket_offs = MEM_callocN(sizeof(*data.bucket_offs) * (bucket_len + 1), __func__);
+  data.bucket_verts = MEM_mallocN(sizeof(*data.bucket_verts) * vert_len, __func__);
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask == NULL || BLI_BITMAP_TEST(v_mask, i)) {
+      data.bucket_offs[weld_cell_hash(data.vert_cell[i], data.bucket_mask) + 1]++;
     }
-    else if (va_dst != vb_dst) {
-      uint v_new, v_old;
-      if (va_dst < vb_dst) {
-        v_new = va_dst;
-        v_old = vb_dst;
-      }
-      else {
-        v_new = vb_dst;
-        v_old = va_dst;
-      }
-      BLI_assert(r_vert_dest_map[v_old] == v_old);
-      BLI_assert(r_vert_dest_map[v_new] == v_new);
-      vert_kill_len++;
-
-      const BVHTreeOverlap *overlap_iter_b = &overlap[0];
-      for (uint j = i + 1; j--; overlap_iter_b++) {
-        indexA = overlap_iter_b->indexA;
-        indexB = overlap_iter_b->indexB;
-        va_dst = r_vert_dest_map[indexA];
-        vb_dst = r_vert_dest_map[indexB];
-        if (ELEM(v_old, vb_dst, va_dst)) {
-          r_vert_dest_map[indexA] = v_new;
-          r_vert_dest_map[indexB] = v_new;
-        }
+  }
+  for (uint i = 0; i < bucket_len; i++) {
+    data.bucket_offs[i + 1] += data.bucket_offs[i];
+  }
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask == NULL || BLI_BITMAP_TEST(v_mask, i)) {
+      const uint bucket = weld_cell_hash(data.vert_cell[i], data.bucket_mask);
+      data.bucket_verts[data.bucket_offs[bucket]++] = i;
+    }
+  }
+  for (uint i = bucket_len; i > 0; i--) {
+    data.bucket_offs[i] = data.bucket_offs[i - 1];
+  }
+  data.bucket_offs[0] = 0;
+
+  BLI_task_parallel_range(0, (int)mvert_len, &data, weld_vert_clusters_find_cb, &settings);
+
+  MEM_freeN(data.vert_cell);
+  MEM_freeN(data.bucket_offs);
+  MEM_freeN(data.bucket_verts);
+
+  /* Point every vertex directly to the root of its cluster. The parents come first and are
+   * already resolved. */
+  uint vert_kill_len = 0;
+  v_dest_iter = &r_vert_dest_map[0];
+  for (uint i = 0; i < mvert_len; i++, v_dest_iter++) {
+    if (*v_dest_iter != OUT_OF_CONTEXT) {
+      *v_dest_iter = r_vert_dest_map[*v_dest_iter];
+      if (*v_dest_iter != i) {
+        vert_kill_len++;
       }
-      BLI_assert(r_vert_dest_map[v_old] == v_new);
     }
   }
 
+#ifdef USE_WELD_DEBUG
+  weld_assert_vert_dest_map_setup(mvert_len, r_vert_dest_map);
+#endif
+
+  return vert_kill_len;
+}
+
+static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
+                                          const uint *vert_dest_map,
+                                          WeldVert **r_wvert,
+                                          uint *r_wvert_len)
+{
   /* Vert Context. */
   uint wvert_len = 0;
 
@@ -442,7 +642,7 @@ static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
   wvert = MEM_mallocN(sizeof(*wvert) * mvert_len, __func__);
   wv = &wvert[0];
 
-  v_dest_iter = &r_vert_dest_map[0];
+  const uint *v_dest_iter = &vert_dest_map[0];
   for (uint i = 0; i < mvert_len; i++, v_dest_iter++) {
     if (*v_dest_iter != OUT_OF_CONTEXT) {
       wv->vert_dest = *v_dest_iter;
@@ -452,13 +652,8 @@ static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
     }
   }
 
-#ifdef USE_WELD_DEBUG
-  weld_assert_vert_dest_map_setup(overlap, overlap_len, r_vert_dest_map);
-#endif
-
   *r_wvert = MEM_reallocN(wvert, sizeof(*wvert) * wvert_len);
   *r_wvert_len = wvert_len;
-  *r_vert_kill_len = vert_kill_len;
 }
 
 static void weld_vert_groups_setup(const uint mvert_len,
@@ -1383,9 +1578,13 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
 /** \name Weld Mesh API
  * \{ */
 
+/**
+ * \param vert_dest_map: The clusters found by #weld_vert_clusters_find,
+ * owned by \a r_weld_mesh afterwards.
+ */
 static void weld_mesh_context_create(const Mesh *mesh,
-                                     BVHTreeOverlap *overlap,
-                                     const uint overlap_len,
+                                     uint *vert_dest_map,
+                                     const uint vert_kill_len,
                                      WeldMesh *r_weld_mesh)
 {
   const MEdge *medge = mesh->medge;
@@ -1396,19 +1595,13 @@ static void weld_mesh_context_create(const Mesh *mesh,
   const uint mloop_len = mesh->totloop;
   const uint mpoly_len = mesh->totpoly;
 
-  uint *vert_dest_map = MEM_mallocN(sizeof(*vert_dest_map) * mvert_len, __func__);
   uint *edge_dest_map = MEM_mallocN(sizeof(*edge_dest_map) * medge_len, __func__);
   struct WeldGroup *v_links = MEM_callocN(sizeof(*v_links) * mvert_len, __func__);
 
   WeldVert *wvert;
   uint wvert_len;
-  weld_vert_ctx_alloc_and_setup(mvert_len,
-                                overlap,
-                                overlap_len,
-                                vert_dest_map,
-                                &wvert,
-                                &wvert_len,
-                                &r_weld_mesh->vert_kill_len);
+  weld_vert_ctx_alloc_and_setup(mvert_len, vert_dest_map, &wvert, &wvert_len);
+  r_weld_mesh->vert_kill_len = vert_kill_len;
 
   uint *edge_ctx_map;
   WeldEdge *wedge;
@@ -1622,20 +1815,31 @@ static void customdata_weld(
 /** \name Weld Modifier Main
  * \{ */
 
-struct WeldOverlapData {
-  const MVert *mvert;
-  float merge_dist_sq;
-};
-static bool bvhtree_weld_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
+typedef struct WeldRemapData {
+  MEdge *medge;
+  MLoop *mloop;
+  const uint *vert_final;
+  const uint *edge_final;
+} WeldRemapData;
+
+static void weld_remap_edges_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  if (index_a < index_b) {
-    struct WeldOverlapData *data = userdata;
-    const MVert *mvert = data->mvert;
-    const float dist_sq = len_squared_v3v3(mvert[index_a].co, mvert[index_b].co);
-    BLI_assert(dist_sq <= ((data->merge_dist_sq + FLT_EPSILON) * 3));
-    return dist_sq <= data->merge_dist_sq;
-  }
-  return false;
+  const WeldRemapData *data = userdata;
+  MEdge *me = &data->medge[i];
+  me->v1 = data->vert_final[me->v1];
+  me->v2 = data->vert_final[me->v2];
+}
+
+static void weld_remap_loops_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const WeldRemapData *data = userdata;
+  MLoop *ml = &data->mloop[i];
+  ml->v = data->vert_final[ml->v];
+  ml->e = data->edge_final[ml->e];
 }
 
 static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContext *ctx, Mesh *mesh)
@@ -1644,7 +1848,6 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
 
   Object *ob = ctx->object;
   BLI_bitmap *v_mask = NULL;
-  int v_mask_act = 0;
 
   const MVert *mvert;
   const MLoop *mloop;
@@ -1668,44 +1871,23 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
         const bool found = BKE_defvert_find_weight(dv, defgrp_index) > 0.0f;
         if (found != invert_vgroup) {
           BLI_BITMAP_ENABLE(v_mask, i);
-          v_mask_act++;
         }
       }
     }
   }
 
-  /* Get overlap map. */
-  /* TODO: For a better performanse use KD-Tree. */
-  struct BVHTreeFromMesh treedata;
-  BVHTree *bvhtree = bvhtree_from_mesh_verts_ex(
-      &treedata, mvert, totvert, false, v_mask, v_mask_act, wmd->merge_dist / 2, 2, 6, 0, NULL);
+  /* Get the clusters of vertices to merge. */
+  uint *vert_dest_map = MEM_mallocN(sizeof(*vert_dest_map) * totvert, __func__);
+  const uint vert_kill_len = weld_vert_clusters_find(
+      mvert, totvert, v_mask, wmd->merge_dist, wmd->max_interactions, vert_dest_map);
 
   if (v_mask) {
     MEM_freeN(v_mask);
   }
 
-  if (bvhtree == NULL) {
-    return result;
-  }
-
-  struct WeldOverlapData data;
-  data.mvert = mvert;
-  data.merge_dist_sq = square_f(wmd->merge_dist);
-
-  uint overlap_len;
-  BVHTreeOverlap *overlap = BLI_bvhtree_overlap_ex(bvhtree,
-                                                   bvhtree,
-                                                   &overlap_len,
-                                                   bvhtree_weld_overlap_cb,
-                                                   &data,
-                                                   wmd->max_interactions,
-                                                   BVH_OVERLAP_RETURN_PAIRS);
-
-  free_bvhtree_from_mesh(&treedata);
-
-  if (overlap_len) {
+  if (vert_kill_len) {
     WeldMesh weld_mesh;
-    weld_mesh_context_create(mesh, overlap, overlap_len, &weld_mesh);
+    weld_mesh_context_create(mesh, vert_dest_map, vert_kill_len, &weld_mesh);
 
     mloop = mesh->mloop;
     mpoly = mesh->mpoly;
@@ -1773,12 +1955,7 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
       }
       if (count) {
         CustomData_copy_data(&mesh->edata, &result->edata, source_index, dest_index, count);
-        MEdge *me = &result->medge[dest_index];
         dest_index += count;
-        for (; count--; me++) {
-          me->v1 = vert_final[me->v1];
-          me->v2 = vert_final[me->v2];
-        }
       }
       if (i == totedge) {
         break;
@@ -1791,8 +1968,8 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
                         wegrp->group.len,
                         dest_index);
         MEdge *me = &result->medge[dest_index];
-        me->v1 = vert_final[wegrp->v1];
-        me->v2 = vert_final[wegrp->v2];
+        me->v1 = wegrp->v1;
+        me->v2 = wegrp->v2;
         me->flag |= ME_LOOSEEDGE;
 
         *index_iter = dest_index;
@@ -1802,6 +1979,20 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
 
     BLI_assert(dest_index == result_nedges);
 
+    /* The edges and loops keep the original vertex and edge indices until all of them are
+     * known, they are remapped in parallel afterwards. */
+    WeldRemapData remap_data = {
+        .medge = result->medge,
+        .mloop = result->mloop,
+        .vert_final = vert_final,
+        .edge_final = edge_final,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (result_nloops > 10000);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, result_nedges, &remap_data, weld_remap_edges_cb, &settings);
+
     /* Polys/Loops */
 
     mp = &mpoly[0];
@@ -1817,10 +2008,7 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
         uint mp_loop_len = mp->totloop;
         CustomData_copy_data(&mesh->ldata, &result->ldata, mp->loopstart, loop_cur, mp_loop_len);
         loop_cur += mp_loop_len;
-        for (; mp_loop_len--; r_ml++) {
-          r_ml->v = vert_final[r_ml->v];
-          r_ml->e = edge_final[r_ml->e];
-        }
+        r_ml += mp_loop_len;
       }
       else {
         WeldPoly *wp = &weld_mesh.wpoly[poly_ctx];
@@ -1835,10 +2023,9 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
           }
           while (weld_iter_loop_of_poly_next(&iter)) {
             customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
-            uint v = vert_final[iter.v];
             uint e = edge_final[iter.e];
-            r_ml->v = v;
-            r_ml->e = e;
+            r_ml->v = iter.v;
+            r_ml->e = iter.e;
             r_ml++;
             loop_cur++;
             if (iter.type) {
@@ -1870,10 +2057,9 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
         }
         while (weld_iter_loop_of_poly_next(&iter)) {
           customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
-          uint v = vert_final[iter.v];
           uint e = edge_final[iter.e];
-          r_ml->v = v;
-          r_ml->e = e;
+          r_ml->v = iter.v;
+          r_ml->e = iter.e;
           r_ml++;
           loop_cur++;
           if (iter.type) {
@@ -1891,14 +2077,18 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     BLI_assert((int)r_i == result_npolys);
     BLI_assert(loop_cur == result_nloops);
 
+    BLI_task_parallel_range(0, result_nloops, &remap_data, weld_remap_loops_cb, &settings);
+
     /* is this needed? */
     /* recalculate normals */
     result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
 
     weld_mesh_context_free(&weld_mesh);
   }
+  else {
+    MEM_freeN(vert_dest_map);
+  }
 
-  MEM_freeN(overlap);
   return result;
 }
 
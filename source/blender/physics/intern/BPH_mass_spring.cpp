@@ -1086,6 +1086,8 @@ static void cloth_clear_result(ClothModifierData *clmd)
   sres->max_error = sres->min_error = sres->avg_error = 0.0f;
   sres->max_iterations = sres->min_iterations = 0;
   sres->avg_iterations = 0.0f;
+  sres->time_collision_bvh = sres->time_collision_overlap = 0.0f;
+  sres->time_collision_narrow = sres->time_collision_response = 0.0f;
 }
 
 static void cloth_record_result(ClothModifierData *clmd, ImplicitSolverResult *result, float dt)
@@ -1144,6 +1146,8 @@ int BPH_cloth_solve(
   }
   cloth_clear_result(clmd);
 
+  BPH_mass_spring_set_solver_type(id, clmd->sim_parms->solver_type);
+
   if (clmd->sim_parms->vgroup_mass > 0) { /* Do goal stuff. */
     for (i = 0; i < mvert_num; i++) {
       // update velocities with constrained velocities from pinned verts
@@ -100,6 +100,8 @@ void BPH_mass_spring_add_constraint_ndof2(struct Implicit_Data *data,
                                           const float c1[3],
                                           const float dV[3]);
 
+/* Linear solver for the velocities, see CLOTH_SOLVER_TYPE */
+void BPH_mass_spring_set_solver_type(struct Implicit_Data *data, int solver_type);
 bool BPH_mass_spring_solve_velocities(struct Implicit_Data *data,
                                       float dt,
                                       struct ImplicitSolverResult *result);
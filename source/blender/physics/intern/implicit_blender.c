@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -656,6 +657,14 @@ DO_INLINE void subadd_bfmatrixS_bfmatrixS(
 // simulator start
 ///////////////////////////////////////////////////////////////////
 
+/* Entry of a vertex row of the sparse matrices, used by the block Jacobi solver.
+ * Off-diagonal blocks are only stored for the lower triangle, so each of them is in two rows. */
+typedef struct ImplicitRowBlock {
+  unsigned int index; /* block in the big matrix */
+  unsigned int col;   /* vertex the block is multiplied with */
+  bool transposed;    /* block is used for the upper triangle */
+} ImplicitRowBlock;
+
 typedef struct Implicit_Data {
   /* inputs */
   fmatrix3x3 *bigI;        /* identity (constant) */
@@ -677,6 +686,15 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+
+  /* block Jacobi solver, allocated on first use (see CLOTH_SOLVER_TYPE) */
+  int solver_type;
+  unsigned int *row_offset;       /* first entry of each vertex row, numverts + 1 */
+  ImplicitRowBlock *row_blocks;   /* diagonal block first, then the off-diagonal blocks */
+  unsigned int (*row_pattern)[2]; /* vertices of the off-diagonal blocks the rows are built for */
+  int row_num_blocks;             /* number of off-diagonal blocks in the rows */
+  lfVector *r, *c, *q, *s;        /* conjugate gradient vectors */
+  float (*chunk_dot)[3];          /* partial dot products, per chunk of vertices */
 } Implicit_Data;
 
 Implicit_Data *BPH_mass_spring_solver_create(int numverts, int numsprings)
@@ -728,6 +746,15 @@ void BPH_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  MEM_SAFE_FREE(id->row_offset);
+  MEM_SAFE_FREE(id->row_blocks);
+  MEM_SAFE_FREE(id->row_pattern);
+  del_lfvector(id->r);
+  del_lfvector(id->c);
+  del_lfvector(id->q);
+  del_lfvector(id->s);
+  MEM_SAFE_FREE(id->chunk_dot);
+
   MEM_freeN(id);
 }
 
@@ -1139,8 +1166,366 @@ static int cg_filtered_pre(lfVector *dv,
 }
 #  endif
 
+/* ================================ */
+
+/* Block Jacobi preconditioned conjugate gradient, multi-threaded per chunk of vertices.
+ *
+ * The matrices are multiplied per vertex row, so threads never write to the same vertex.
+ * Dot products are summed per chunk first and then in chunk order, which keeps the result the
+ * same regardless of the number of threads. */
+
+#  define IMPLICIT_CHUNK_SIZE 256
+/* Below this number of vertices threading costs more than it gains. */
+#  define IMPLICIT_PARALLEL_LIMIT 1024
+
+void BPH_mass_spring_set_solver_type(Implicit_Data *data, int solver_type)
+{
+  data->solver_type = solver_type;
+}
+
+BLI_INLINE unsigned int implicit_num_chunks(unsigned int numverts)
+{
+  return (numverts + IMPLICIT_CHUNK_SIZE - 1) / IMPLICIT_CHUNK_SIZE;
+}
+
+/* Build the vertex rows from the blocks added by the forces. Springs usually add the same
+ * blocks in every step, the rows are only rebuilt when that's not the case. */
+static void implicit_rows_ensure(Implicit_Data *data)
+{
+  const unsigned int numverts = data->A[0].vcount;
+  const unsigned int num_blocks = (unsigned int)data->num_blocks;
+  const fmatrix3x3 *blocks = data->A + numverts;
+  unsigned int *offset;
+  unsigned int i;
+
+  if (data->row_offset == NULL) {
+    const unsigned int numsprings = data->A[0].scount;
+
+    data->row_offset = MEM_malloc_arrayN(numverts + 1, sizeof(*data->row_offset), __func__);
+    data->row_blocks = MEM_malloc_arrayN(
+        numverts + 2 * numsprings, sizeof(*data->row_blocks), __func__);
+    data->row_pattern = MEM_malloc_arrayN(
+        max_ii(numsprings, 1), sizeof(*data->row_pattern), __func__);
+    data->row_num_blocks = -1;
+
+    data->r = create_lfvector(numverts);
+    data->c = create_lfvector(numverts);
+    data->q = create_lfvector(numverts);
+    data->s = create_lfvector(numverts);
+    data->chunk_dot = MEM_malloc_arrayN(
+        implicit_num_chunks(numverts), sizeof(*data->chunk_dot), __func__);
+  }
+
+  if (data->row_num_blocks == data->num_blocks) {
+    for (i = 0; i < num_blocks; i++) {
+      if (blocks[i].r != data->row_pattern[i][0] || blocks[i].c != data->row_pattern[i][1]) {
+        break;
+      }
+    }
+    if (i == num_blocks) {
+      return;
+    }
+  }
+
+  /* Count the entries of each row two places ahead, so that after the prefix sum
+   * offset[row + 1] is the start of the row. It's used as the insertion point while filling,
+   * which leaves it at the end of the row. */
+  offset = data->row_offset;
+  memset(offset, 0, sizeof(*offset) * (numverts + 1));
+  for (i = 0; i + 2 <= numverts; i++) {
+    offset[i + 2]++;
+  }
+  for (i = 0; i < num_blocks; i++) {
+    if (blocks[i].r + 2 <= numverts) {
+      offset[blocks[i].r + 2]++;
+    }
+    if (blocks[i].c + 2 <= numverts) {
+      offset[blocks[i].c + 2]++;
+    }
+  }
+  for (i = 2; i <= numverts; i++) {
+    offset[i] += offset[i - 1];
+  }
+
+  for (i = 0; i < numverts; i++) {
+    ImplicitRowBlock *entry = &data->row_blocks[offset[i + 1]++];
+    entry->index = i;
+    entry->col = i;
+    entry->transposed = false;
+  }
+  for (i = 0; i < num_blocks; i++) {
+    const unsigned int r = blocks[i].r, c = blocks[i].c;
+    ImplicitRowBlock *entry;
+
+    entry = &data->row_blocks[offset[r + 1]++];
+    entry->index = numverts + i;
+    entry->col = c;
+    entry->transposed = false;
+
+    entry = &data->row_blocks[offset[c + 1]++];
+    entry->index = numverts + i;
+    entry->col = r;
+    entry->transposed = true;
+
+    data->row_pattern[i][0] = r;
+    data->row_pattern[i][1] = c;
+  }
+  data->row_num_blocks = data->num_blocks;
+}
+
+/* Row of the sparse symmetric matrix multiplied with the long vector. */
+BLI_INLINE void implicit_row_mul(float to[3],
+                                 const Implicit_Data *data,
+                                 fmatrix3x3 *matrix,
+                                 lfVector *from,
+                                 unsigned int row)
+{
+  zero_v3(to);
+  for (unsigned int j = data->row_offset[row]; j < data->row_offset[row + 1]; j++) {
+    const ImplicitRowBlock *entry = &data->row_blocks[j];
+    if (entry->transposed) {
+      muladd_fmatrixT_fvector(to, matrix[entry->index].m, from[entry->col]);
+    }
+    else {
+      muladd_fmatrix_fvector(to, matrix[entry->index].m, from[entry->col]);
+    }
+  }
+}
+
+typedef struct ImplicitSolverTaskData {
+  Implicit_Data *data;
+  unsigned int numverts;
+  float dt;
+  float alpha, beta;
+} ImplicitSolverTaskData;
+
+static void implicit_run_chunks(ImplicitSolverTaskData *task_data, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (task_data->numverts > IMPLICIT_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, (int)implicit_num_chunks(task_data->numverts), task_data, func, &settings);
+}
+
+/* Sum of the partial dot products, in a fixed order. */
+static float implicit_chunk_dot_sum(const ImplicitSolverTaskData *task_data, int index)
+{
+  const unsigned int num_chunks = implicit_num_chunks(task_data->numverts);
+  float sum = 0.0f;
+  for (unsigned int chunk = 0; chunk < num_chunks; chunk++) {
+    sum += task_data->data->chunk_dot[chunk][index];
+  }
+  return sum;
+}
+
+/* Inverse of a diagonal block of A. The preconditioner has to stay positive definite, which
+ * the block isn't when springs are strongly compressed; only its diagonal is used then. */
+BLI_INLINE void implicit_preconditioner_block(float r[3][3], float m[3][3])
+{
+  if (m[0][0] > 0.0f && m[0][0] * m[1][1] - m[0][1] * m[1][0] > 0.0f &&
+      determinant_m3_array(m) > 0.0f && invert_m3_m3(r, m)) {
+    return;
+  }
+
+  zero_m3(r);
+  for (int i = 0; i < 3; i++) {
+    r[i][i] = (m[i][i] != 0.0f) ? 1.0f / fabsf(m[i][i]) : 1.0f;
+  }
+}
+
+/* A = M - dt * dFdV - dt^2 * dFdX, and the inverse of the diagonal blocks of A. */
+static void implicit_assemble_cb(void *__restrict userdata,
+                                 const int index,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ImplicitSolverTaskData *task_data = userdata;
+  Implicit_Data *data = task_data->data;
+  const float dt = task_data->dt;
+
+  copy_m3_m3(data->A[index].m, data->M[index].m);
+  subadd_fmatrixS_fmatrixS(
+      data->A[index].m, data->dFdV[index].m, dt, data->dFdX[index].m, dt * dt);
+
+  if ((unsigned int)index < task_data->numverts) {
+    implicit_preconditioner_block(data->Pinv[index].m, data->A[index].m);
+  }
+}
+
+/* B = dt * F + dt^2 * dFdX * V, dV = z, r = filter(B - A * dV) and c = filter(P^-1 * r).
+ * Sums r^T * r, r^T * c and filter(B)^T * filter(B). */
+static void implicit_init_cb(void *__restrict userdata,
+                             const int chunk,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ImplicitSolverTaskData *task_data = userdata;
+  Implicit_Data *data = task_data->data;
+  const float dt = task_data->dt;
+  float rnorm2 = 0.0f, delta = 0.0f, bnorm2 = 0.0f;
+
+  const unsigned int start = (unsigned int)chunk * IMPLICIT_CHUNK_SIZE;
+  const unsigned int end = min_ii(start + IMPLICIT_CHUNK_SIZE, task_data->numverts);
+
+  for (unsigned int i = start; i < end; i++) {
+    float dFdXmV[3], AdV[3], fB[3];
+
+    implicit_row_mul(dFdXmV, data, data->dFdX, data->V, i);
+    mul_v3_fl(dFdXmV, dt * dt);
+    mul_v3_v3fl(data->B[i], data->F[i], dt);
+    add_v3_v3(data->B[i], dFdXmV);
+
+    copy_v3_v3(data->dV[i], data->z[i]);
+
+    mul_v3_m3v3(fB, data->S[i].m, data->B[i]);
+    bnorm2 += dot_v3v3(fB, fB);
+
+    implicit_row_mul(AdV, data, data->A, data->z, i);
+    sub_v3_v3v3(data->r[i], data->B[i], AdV);
+    mul_m3_v3(data->S[i].m, data->r[i]);
+    mul_v3_m3v3(data->c[i], data->Pinv[i].m, data->r[i]);
+    mul_m3_v3(data->S[i].m, data->c[i]);
+    rnorm2 += dot_v3v3(data->r[i], data->r[i]);
+    delta += dot_v3v3(data->r[i], data->c[i]);
+  }
+
+  data->chunk_dot[chunk][0] = rnorm2;
+  data->chunk_dot[chunk][1] = delta;
+  data->chunk_dot[chunk][2] = bnorm2;
+}
+
+/* q = filter(A * c) */
+static void implicit_cg_mul_cb(void *__restrict userdata,
+                               const int chunk,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ImplicitSolverTaskData *task_data = userdata;
+  Implicit_Data *data = task_data->data;
+  float dot = 0.0f;
+
+  const unsigned int start = (unsigned int)chunk * IMPLICIT_CHUNK_SIZE;
+  const unsigned int end = min_ii(start + IMPLICIT_CHUNK_SIZE, task_data->numverts);
+
+  for (unsigned int i = start; i < end; i++) {
+    implicit_row_mul(data->q[i], data, data->A, data->c, i);
+    mul_m3_v3(data->S[i].m, data->q[i]);
+    dot += dot_v3v3(data->c[i], data->q[i]);
+  }
+
+  data->chunk_dot[chunk][0] = dot;
+}
+
+/* dV += alpha * c, r -= alpha * q and s = P^-1 * r. Sums r^T * r and r^T * s. */
+static void implicit_cg_update_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ImplicitSolverTaskData *task_data = userdata;
+  Implicit_Data *data = task_data->data;
+  const float alpha = task_data->alpha;
+  float rnorm2 = 0.0f, delta = 0.0f;
+
+  const unsigned int start = (unsigned int)chunk * IMPLICIT_CHUNK_SIZE;
+  const unsigned int end = min_ii(start + IMPLICIT_CHUNK_SIZE, task_data->numverts);
+
+  for (unsigned int i = start; i < end; i++) {
+    madd_v3_v3fl(data->dV[i], data->c[i], alpha);
+    madd_v3_v3fl(data->r[i], data->q[i], -alpha);
+    mul_v3_m3v3(data->s[i], data->Pinv[i].m, data->r[i]);
+    rnorm2 += dot_v3v3(data->r[i], data->r[i]);
+    delta += dot_v3v3(data->r[i], data->s[i]);
+  }
+
+  data->chunk_dot[chunk][0] = rnorm2;
+  data->chunk_dot[chunk][1] = delta;
+}
+
+/* c = filter(s + beta * c) */
+static void implicit_cg_direction_cb(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ImplicitSolverTaskData *task_data = userdata;
+  Implicit_Data *data = task_data->data;
+  const float beta = task_data->beta;
+
+  const unsigned int start = (unsigned int)chunk * IMPLICIT_CHUNK_SIZE;
+  const unsigned int end = min_ii(start + IMPLICIT_CHUNK_SIZE, task_data->numverts);
+
+  for (unsigned int i = start; i < end; i++) {
+    madd_v3_v3v3fl(data->c[i], data->s[i], data->c[i], beta);
+    mul_m3_v3(data->S[i].m, data->c[i]);
+  }
+}
+
+static bool implicit_solve_velocities_block_jacobi(Implicit_Data *data,
+                                                   float dt,
+                                                   ImplicitSolverResult *result)
+{
+  const unsigned int conjgrad_looplimit = 100;
+  const float conjgrad_epsilon = 0.01f;
+  unsigned int conjgrad_loopcount = 0;
+  float bnorm2, rnorm2, delta_new, delta_old, rnorm2_target;
+  ImplicitSolverTaskData task_data = {
+      .data = data,
+      .numverts = data->M[0].vcount,
+      .dt = dt,
+  };
+
+  implicit_rows_ensure(data);
+
+  {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (task_data.numverts > IMPLICIT_PARALLEL_LIMIT);
+    settings.min_iter_per_thread = IMPLICIT_CHUNK_SIZE;
+    BLI_task_parallel_range(0,
+                            (int)task_data.numverts + data->num_blocks,
+                            &task_data,
+                            implicit_assemble_cb,
+                            &settings);
+  }
+
+  /* Same stopping criterion as cg_filtered(), on the residual itself. The preconditioned
+   * residual doesn't measure the same error as the legacy solver does. */
+  implicit_run_chunks(&task_data, implicit_init_cb);
+  rnorm2 = implicit_chunk_dot_sum(&task_data, 0);
+  delta_new = implicit_chunk_dot_sum(&task_data, 1);
+  bnorm2 = implicit_chunk_dot_sum(&task_data, 2);
+  rnorm2_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
+
+  while (rnorm2 > rnorm2_target && delta_new > 0.0f &&
+         conjgrad_loopcount < conjgrad_looplimit) {
+    implicit_run_chunks(&task_data, implicit_cg_mul_cb);
+    task_data.alpha = delta_new / implicit_chunk_dot_sum(&task_data, 0);
+
+    implicit_run_chunks(&task_data, implicit_cg_update_cb);
+    rnorm2 = implicit_chunk_dot_sum(&task_data, 0);
+    delta_old = delta_new;
+    delta_new = implicit_chunk_dot_sum(&task_data, 1);
+
+    task_data.beta = delta_new / delta_old;
+    implicit_run_chunks(&task_data, implicit_cg_direction_cb);
+
+    conjgrad_loopcount++;
+  }
+
+  add_lfvector_lfvector(data->Vnew, data->V, data->dV, task_data.numverts);
+
+  /* The iterations also stop when the preconditioned residual breaks down. */
+  result->status = rnorm2 <= rnorm2_target ? BPH_SOLVER_SUCCESS : BPH_SOLVER_NO_CONVERGENCE;
+  result->iterations = conjgrad_loopcount;
+  result->error = bnorm2 > 0.0f ? sqrtf(rnorm2 / bnorm2) : 0.0f;
+
+  return result->status == BPH_SOLVER_SUCCESS;
+}
+
 bool BPH_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSolverResult *result)
 {
+  if (data->solver_type == CLOTH_SOLVER_BLOCK_JACOBI) {
+    return implicit_solve_velocities_block_jacobi(data, dt, result);
+  }
+
   unsigned int numverts = data->dFdV[0].vcount;
 
   lfVector *dFdXmV = create_lfvector(numverts);
@@ -1345,8 +1730,12 @@ void BPH_mass_spring_clear_forces(Implicit_Data *data)
 {
   int numverts = data->M[0].vcount;
   zero_lfvector(data->F, numverts);
-  init_bfmatrix(data->dFdX, ZERO);
-  init_bfmatrix(data->dFdV, ZERO);
+
+  /* Blocks after the ones used in the previous step are still zero. */
+  for (int i = 0; i < numverts + data->num_blocks; i++) {
+    zero_m3(data->dFdX[i].m);
+    zero_m3(data->dFdV[i].m);
+  }
 
   data->num_blocks = 0;
 }
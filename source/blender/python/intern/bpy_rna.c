@@ -26,7 +26,8 @@
 
 #include <Python.h>
 
-#include <float.h> /* FLT_MIN/MAX */
+#include <float.h>  /* FLT_MIN/MAX */
+#include <limits.h> /* CHAR_MIN */
 #include <stddef.h>
 
 #include "RNA_types.h"
@@ -5160,7 +5161,7 @@ static int foreach_parse_args(BPy_PropertyRNA *self,
   if (*r_tot > 0) {
     if (!foreach_attr_type(self, *r_attr, r_raw_type, r_attr_tot, r_attr_signed)) {
       PyErr_Format(PyExc_AttributeError,
-                   "foreach_get/set '%.200s.%200s[...]' elements have no attribute '%.200s'",
+                   "foreach_get/set '%.200s.%.200s[...]' elements have no attribute '%.200s'",
                    RNA_struct_identifier(self->ptr.type),
                    RNA_property_identifier(self->prop),
                    *r_attr);
@@ -5427,6 +5428,334 @@ static PyObject *pyrna_prop_collection_foreach_set(BPy_PropertyRNA *self, PyObje
   return foreach_getset(self, args, 1);
 }
 
+/* --- collection buffer: start --- */
+/* Expose the attribute of the items of a collection stored in a raw array through the buffer
+ * protocol, e.g. for NumPy. The buffer holds a copy of the values, the data may be reallocated
+ * or freed (by operators, undo, edit-mode...) while views of the buffer are still in use. */
+
+/* The C types `rna_raw_access` uses for the raw types as well, DNA doesn't keep track of
+ * unsigned types. */
+static const char *foreach_buffer_format(RawPropertyType raw_type)
+{
+  switch (raw_type) {
+    case PROP_RAW_CHAR:
+      return (CHAR_MIN < 0) ? "b" : "B";
+    case PROP_RAW_SHORT:
+      return "h";
+    case PROP_RAW_INT:
+      return "i";
+    case PROP_RAW_BOOLEAN:
+      return "?";
+    case PROP_RAW_FLOAT:
+      return "f";
+    case PROP_RAW_DOUBLE:
+      return "d";
+    case PROP_RAW_UNSET:
+      break;
+  }
+  return NULL;
+}
+
+static int pyrna_prop_collection_buffer_getbuffer(BPy_PropertyCollectionBufferRNA *self,
+                                                  Py_buffer *view,
+                                                  int flags)
+{
+  view->obj = NULL;
+
+  if (!self->is_valid) {
+    PyErr_SetString(PyExc_ReferenceError,
+                    "bpy_prop_collection_buffer can't be used after leaving its context");
+    return -1;
+  }
+
+  const int itemsize = RNA_raw_type_sizeof(self->raw_type);
+  const int attr_tot = MAX2(self->attr_tot, 1);
+
+  view->buf = self->array;
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->len = self->shape[0] * attr_tot * itemsize;
+  view->readonly = 0;
+  view->itemsize = itemsize;
+  /* The buffer protocol doesn't modify the format string. */
+  view->format = (flags & PyBUF_FORMAT) ? (char *)foreach_buffer_format(self->raw_type) : NULL;
+  view->ndim = (self->attr_tot != 0) ? 2 : 1;
+  view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  return 0;
+}
+
+static PyBufferProcs pyrna_prop_collection_buffer_as_buffer = {
+    (getbufferproc)pyrna_prop_collection_buffer_getbuffer,
+    NULL,
+};
+
+PyDoc_STRVAR(pyrna_prop_collection_buffer_update_doc,
+             ".. method:: update()\n"
+             "\n"
+             "   Write the values of the buffer back to the data and tag it as changed.\n");
+static PyObject *pyrna_prop_collection_buffer_update(BPy_PropertyCollectionBufferRNA *self)
+{
+  BPy_PropertyRNA *py_collection = self->py_collection;
+  PointerRNA itemptr;
+
+  PYRNA_PROP_CHECK_OBJ(py_collection);
+
+  const int items_len = RNA_property_collection_length(&py_collection->ptr, py_collection->prop);
+  if (items_len != (int)self->shape[0]) {
+    PyErr_Format(PyExc_BufferError,
+                 "bpy_prop_collection_buffer '%.200s' doesn't match the data anymore, "
+                 "%d items were copied but there are %d now",
+                 RNA_property_identifier(self->itemprop),
+                 (int)self->shape[0],
+                 items_len);
+    return NULL;
+  }
+
+  if (!RNA_property_collection_raw_set(NULL,
+                                       &py_collection->ptr,
+                                       py_collection->prop,
+                                       RNA_property_identifier(self->itemprop),
+                                       self->array,
+                                       self->raw_type,
+                                       (int)(self->shape[0] * self->shape[1]))) {
+    PyErr_SetString(PyExc_RuntimeError, "internal error setting the array");
+    return NULL;
+  }
+
+  /* Update callbacks only use the owner ID of the items, any item will do. */
+  if (RNA_property_collection_lookup_int(&py_collection->ptr, py_collection->prop, 0, &itemptr)) {
+    RNA_property_update(BPy_GetContext(), &itemptr, self->itemprop);
+  }
+
+  Py_RETURN_NONE;
+}
+
+static PyObject *pyrna_prop_collection_buffer_enter(BPy_PropertyCollectionBufferRNA *self)
+{
+  Py_INCREF(self);
+  return (PyObject *)self;
+}
+
+static PyObject *pyrna_prop_collection_buffer_exit(BPy_PropertyCollectionBufferRNA *self,
+                                                   PyObject *UNUSED(args))
+{
+  if (!self->is_valid) {
+    Py_RETURN_NONE;
+  }
+  self->is_valid = false;
+
+  /* Tag the data even when leaving on an error, part of it may have been written already. */
+  if (PYRNA_PROP_IS_VALID(self->py_collection)) {
+    PyObject *ret = pyrna_prop_collection_buffer_update(self);
+    if (ret == NULL) {
+      return NULL;
+    }
+    Py_DECREF(ret);
+  }
+
+  Py_RETURN_NONE;
+}
+
+static struct PyMethodDef pyrna_prop_collection_buffer_methods[] = {
+    {"update",
+     (PyCFunction)pyrna_prop_collection_buffer_update,
+     METH_NOARGS,
+     pyrna_prop_collection_buffer_update_doc},
+    {"__enter__", (PyCFunction)pyrna_prop_collection_buffer_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)pyrna_prop_collection_buffer_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL},
+};
+
+static void pyrna_prop_collection_buffer_dealloc(BPy_PropertyCollectionBufferRNA *self)
+{
+#ifdef USE_WEAKREFS
+  if (self->in_weakreflist != NULL) {
+    PyObject_ClearWeakRefs((PyObject *)self);
+  }
+#endif
+
+  Py_DECREF(self->py_collection);
+  MEM_SAFE_FREE(self->array);
+
+  PyObject_DEL(self);
+}
+
+static PyTypeObject pyrna_prop_collection_buffer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "bpy_prop_collection_buffer", /* tp_name */
+    sizeof(BPy_PropertyCollectionBufferRNA),                     /* tp_basicsize */
+    0,                                                           /* tp_itemsize */
+    /* methods */
+    (destructor)pyrna_prop_collection_buffer_dealloc, /* tp_dealloc */
+    (printfunc)NULL,                                  /* printfunc tp_print; */
+    NULL,                                             /* getattrfunc tp_getattr; */
+    NULL,                                             /* setattrfunc tp_setattr; */
+    NULL,
+    /* tp_compare */ /* DEPRECATED in Python 3.0! */
+    NULL,            /* tp_repr */
+
+    /* Method suites for standard classes */
+
+    NULL, /* PyNumberMethods *tp_as_number; */
+    NULL, /* PySequenceMethods *tp_as_sequence; */
+    NULL, /* PyMappingMethods *tp_as_mapping; */
+
+    /* More standard operations (here for binary compatibility) */
+
+    NULL, /* hashfunc tp_hash; */
+    NULL, /* ternaryfunc tp_call; */
+    NULL, /* reprfunc tp_str; */
+
+    /* will only use these if this is a subtype of a py class */
+    NULL, /* getattrofunc tp_getattro; */
+    NULL, /* setattrofunc tp_setattro; */
+
+    /* Functions to access object as input/output buffer */
+    &pyrna_prop_collection_buffer_as_buffer, /* PyBufferProcs *tp_as_buffer; */
+
+    /*** Flags to define presence of optional/expanded features ***/
+    Py_TPFLAGS_DEFAULT, /* long tp_flags; */
+
+    NULL, /*  char *tp_doc;  Documentation string */
+    /*** Assigned meaning in release 2.0 ***/
+    /* call function for all accessible objects */
+    NULL, /* traverseproc tp_traverse; */
+
+    /* delete references to contained objects */
+    NULL, /* inquiry tp_clear; */
+
+    /***  Assigned meaning in release 2.1 ***/
+    /*** rich comparisons (subclassed) ***/
+    NULL, /* richcmpfunc tp_richcompare; */
+
+/***  weak reference enabler ***/
+#ifdef USE_WEAKREFS
+    offsetof(BPy_PropertyCollectionBufferRNA, in_weakreflist), /* long tp_weaklistoffset; */
+#else
+    0,
+#endif
+    /*** Added in release 2.2 ***/
+    /*   Iterators */
+    NULL, /* getiterfunc tp_iter; */
+    NULL, /* iternextfunc tp_iternext; */
+
+    /*** Attribute descriptor and subclassing stuff ***/
+    pyrna_prop_collection_buffer_methods, /* struct PyMethodDef *tp_methods; */
+    NULL,                                 /* struct PyMemberDef *tp_members; */
+    NULL,                                 /* struct PyGetSetDef *tp_getset; */
+    NULL,                                 /* struct _typeobject *tp_base; */
+    NULL,                                 /* PyObject *tp_dict; */
+    NULL,                                 /* descrgetfunc tp_descr_get; */
+    NULL,                                 /* descrsetfunc tp_descr_set; */
+    0,                                    /* long tp_dictoffset; */
+    NULL,                                 /* initproc tp_init; */
+    NULL,                                 /* allocfunc tp_alloc; */
+    NULL,                                 /* newfunc tp_new; */
+    /*  Low-level free-memory routine */
+    NULL, /* freefunc tp_free;  */
+    /* For PyObject_IS_GC */
+    NULL, /* inquiry tp_is_gc;  */
+    NULL, /* PyObject *tp_bases; */
+    /* method resolution order */
+    NULL, /* PyObject *tp_mro;  */
+    NULL, /* PyObject *tp_cache; */
+    NULL, /* PyObject *tp_subclasses; */
+    NULL, /* PyObject *tp_weaklist; */
+    NULL,
+};
+
+PyDoc_STRVAR(
+    pyrna_prop_collection_as_buffer_doc,
+    ".. method:: as_buffer(attr)\n"
+    "\n"
+    "   Copy an attribute of all items into a buffer, to read and write it at once.\n"
+    "   The returned object supports the buffer protocol, for use with ``memoryview``\n"
+    "   or ``numpy.asarray``, it may also be used as a context manager which writes\n"
+    "   the values back to the data on exit.\n"
+    "\n"
+    "   :arg attr: Name of the attribute of the items,\n"
+    "      which must be stored in a contiguous array of the items.\n"
+    "   :type attr: string\n"
+    "\n"
+    "   .. note::\n"
+    "\n"
+    "      The values are copied when the buffer is created, changes to them are only\n"
+    "      written back to the data by :meth:`update`, which fails when the number of items\n"
+    "      changed in the meantime.\n");
+static PyObject *pyrna_prop_collection_as_buffer(BPy_PropertyRNA *self, PyObject *value)
+{
+  BPy_PropertyCollectionBufferRNA *ret;
+  PointerRNA itemptr_base;
+  PropertyRNA *itemprop;
+  RawArray raw;
+
+  PYRNA_PROP_CHECK_OBJ(self);
+
+  const char *attr = _PyUnicode_AsString(value);
+  if (attr == NULL) {
+    PyErr_Format(PyExc_TypeError,
+                 "as_buffer(attr): expected a string, not %.200s",
+                 Py_TYPE(value)->tp_name);
+    return NULL;
+  }
+
+  RNA_pointer_create(NULL, RNA_property_pointer_type(&self->ptr, self->prop), NULL, &itemptr_base);
+  itemprop = RNA_struct_find_property(&itemptr_base, attr);
+  if (itemprop == NULL) {
+    PyErr_Format(PyExc_AttributeError,
+                 "as_buffer '%.200s.%.200s[...]' elements have no attribute '%.200s'",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  if (!ELEM(RNA_property_type(itemprop), PROP_BOOLEAN, PROP_INT, PROP_FLOAT) ||
+      (RNA_property_flag(itemprop) & PROP_DYNAMIC) ||
+      !RNA_property_collection_raw_array(&self->ptr, self->prop, itemprop, &raw)) {
+    PyErr_Format(PyExc_TypeError,
+                 "as_buffer '%.200s.%.200s[...].%.200s' is not stored as an editable array, "
+                 "use foreach_get/set instead",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  ret = PyObject_New(BPy_PropertyCollectionBufferRNA, &pyrna_prop_collection_buffer_Type);
+#ifdef USE_WEAKREFS
+  ret->in_weakreflist = NULL;
+#endif
+  Py_INCREF(self);
+  ret->py_collection = self;
+  ret->itemprop = itemprop;
+  ret->raw_type = RNA_property_raw_type(itemprop);
+  ret->attr_tot = RNA_property_array_length(&itemptr_base, itemprop);
+  ret->is_valid = true;
+
+  const int itemsize = RNA_raw_type_sizeof(ret->raw_type);
+  const int attr_tot = MAX2(ret->attr_tot, 1);
+  ret->shape[0] = raw.len;
+  ret->shape[1] = attr_tot;
+  ret->strides[0] = (Py_ssize_t)itemsize * attr_tot;
+  ret->strides[1] = itemsize;
+  ret->array = MEM_malloc_arrayN((size_t)raw.len * attr_tot, (size_t)itemsize, __func__);
+
+  if (!RNA_property_collection_raw_get(
+          NULL, &self->ptr, self->prop, attr, ret->array, ret->raw_type, raw.len * attr_tot)) {
+    Py_DECREF(ret);
+    PyErr_SetString(PyExc_RuntimeError, "internal error getting the array");
+    return NULL;
+  }
+
+  return (PyObject *)ret;
+}
+
+/* --- collection buffer: end --- */
+
 static PyObject *pyprop_array_foreach_getset(BPy_PropertyArrayRNA *self,
                                              PyObject *args,
                                              const bool do_set)
@@ -5764,6 +6093,10 @@ static struct PyMethodDef pyrna_prop_collection_methods[] = {
      (PyCFunction)pyrna_prop_collection_foreach_set,
      METH_VARARGS,
      pyrna_prop_collection_foreach_set_doc},
+    {"as_buffer",
+     (PyCFunction)pyrna_prop_collection_as_buffer,
+     METH_O,
+     pyrna_prop_collection_as_buffer_doc},
 
     {"keys", (PyCFunction)pyrna_prop_collection_keys, METH_NOARGS, pyrna_prop_collection_keys_doc},
     {"items",
@@ -7631,6 +7964,10 @@ void BPY_rna_init(void)
     return;
   }
 #endif
+
+  if (PyType_Ready(&pyrna_prop_collection_buffer_Type) < 0) {
+    return;
+  }
 }
 
 /* 'bpy.data' from Python. */
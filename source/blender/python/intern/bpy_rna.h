@@ -165,6 +165,28 @@ typedef struct {
   CollectionPropertyIterator iter;
 } BPy_PropertyCollectionIterRNA;
 
+typedef struct {
+  PyObject_HEAD /* required python macro   */
+#ifdef USE_WEAKREFS
+      PyObject *in_weakreflist;
+#endif
+
+  /* The collection the items are in, the values are written back to it on update. */
+  BPy_PropertyRNA *py_collection;
+  /* The attribute of the items, stored in the raw array of the collection. */
+  PropertyRNA *itemprop;
+  RawPropertyType raw_type;
+  /* Array length of the attribute, zero when it isn't an array. */
+  int attr_tot;
+  /* Cleared when leaving the context manager, no new buffers can be exported then. */
+  bool is_valid;
+  /* Copy of the values of all items, owned by the buffer, so exported views never point to
+   * freed data. */
+  void *array;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+} BPy_PropertyCollectionBufferRNA;
+
 typedef struct {
   PyObject_HEAD /* required python macro   */
 #ifdef USE_WEAKREFS
@@ -0,0 +1,186 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_animsys.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_nla.h"
+#include "BKE_object.h"
+
+#include "ED_keyframing.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_RUN_AVERAGED 3
+#define NUM_FRAMES 250
+#define NUM_KEYS 40
+
+/* Evaluate the animation of the object for all frames, as an evaluated copy or not. */
+static void animsys_evaluate_perf(Object *ob, const char *name, const bool is_evaluated_copy)
+{
+  SET_FLAG_FROM_TEST(ob->id.tag, is_evaluated_copy, LIB_TAG_COPIED_ON_WRITE);
+  double timing = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    const double init_time = PIL_check_seconds_timer();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      BKE_animsys_evaluate_animdata(&ob->id, ob->adt, (float)frame, ADT_RECALC_ANIM, false);
+    }
+    timing += PIL_check_seconds_timer() - init_time;
+  }
+  ob->id.tag &= ~LIB_TAG_COPIED_ON_WRITE;
+  printf("\t%s: done in %fs on average over %d runs\n",
+         name,
+         timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+}
+
+/* Playback of an action with location, quaternion rotation and scale keyed on every bone. */
+static void animsys_action_perf_do(const char *id, const int num_bones)
+{
+  Main *bmain = BKE_main_new();
+  Object *ob = BKE_object_add_only_object(bmain, OB_ARMATURE, "Armature");
+  ob->pose = (bPose *)MEM_callocN(sizeof(bPose), __func__);
+  bAction *action = BKE_action_add(bmain, "Action");
+
+  const struct {
+    const char *name;
+    int array_len;
+  } props[] = {{"location", 3}, {"rotation_quaternion", 4}, {"scale", 3}};
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  int num_fcurves = 0;
+  for (int i = 0; i < num_bones; i++) {
+    char name[MAXBONENAME];
+    BLI_snprintf(name, sizeof(name), "Bone.%d", i);
+    BKE_pose_channel_verify(ob->pose, name);
+
+    for (int p = 0; p < (int)ARRAY_SIZE(props); p++) {
+      for (int index = 0; index < props[p].array_len; index++) {
+        FCurve *fcu = (FCurve *)MEM_callocN(sizeof(FCurve), __func__);
+        fcu->rna_path = BLI_sprintfN("pose.bones[\"%s\"].%s", name, props[p].name);
+        fcu->array_index = index;
+        for (int key = 0; key < NUM_KEYS; key++) {
+          const float value = (float)((key * 13 + num_fcurves * 7) % 11) * 0.1f;
+          insert_vert_fcurve(fcu,
+                             (float)(key * 6 + num_fcurves % 4),
+                             value,
+                             BEZT_KEYTYPE_KEYFRAME,
+                             INSERTKEY_NO_USERPREF);
+        }
+        BLI_addtail(&action->curves, fcu);
+        num_fcurves++;
+      }
+    }
+  }
+  BKE_pose_channels_hash_make(ob->pose);
+
+  AnimData *adt = BKE_animdata_add_id(&ob->id);
+  adt->action = action;
+  id_us_plus(&action->id);
+
+  printf("\t%d F-Curves, %d frames\n", num_fcurves, NUM_FRAMES);
+
+  /* Evaluation of the curves only. */
+  FCurve **fcurves = (FCurve **)MEM_malloc_arrayN(num_fcurves, sizeof(*fcurves), __func__);
+  int *segment_cache = (int *)MEM_calloc_arrayN(num_fcurves, sizeof(*segment_cache), __func__);
+  float *values = (float *)MEM_malloc_arrayN(num_fcurves, sizeof(*values), __func__);
+  int i = 0;
+  LISTBASE_FOREACH (FCurve *, fcu, &action->curves) {
+    fcurves[i++] = fcu;
+  }
+
+  double timing_single = 0.0, timing_batch = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    double init_time = PIL_check_seconds_timer();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      for (i = 0; i < num_fcurves; i++) {
+        values[i] = evaluate_fcurve(fcurves[i], (float)frame);
+      }
+    }
+    timing_single += PIL_check_seconds_timer() - init_time;
+
+    init_time = PIL_check_seconds_timer();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      evaluate_fcurves(fcurves, segment_cache, values, num_fcurves, (float)frame);
+    }
+    timing_batch += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\tevaluate_fcurve: done in %fs on average over %d runs\n",
+         timing_single / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tevaluate_fcurves: done in %fs on average over %d runs\n",
+         timing_batch / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  /* Evaluation of the animation data, including writing the values to the pose. */
+  animsys_evaluate_perf(ob, "Action per F-Curve", false);
+  animsys_evaluate_perf(ob, "Action evaluation plan", true);
+
+  /* The action in an NLA strip, with the active action combined on top of it. */
+  NlaTrack *nlt = BKE_nlatrack_add(adt, NULL);
+  NlaStrip *strip = BKE_nlastrip_new(action);
+  strip->blendmode = NLASTRIP_MODE_REPLACE;
+  BKE_nlatrack_add_strip(nlt, strip);
+  adt->act_blendmode = NLASTRIP_MODE_COMBINE;
+  adt->act_influence = 0.5f;
+
+  animsys_evaluate_perf(ob, "NLA evaluated from scratch", false);
+  animsys_evaluate_perf(ob, "NLA reusing evaluation data", true);
+
+  MEM_freeN(fcurves);
+  MEM_freeN(segment_cache);
+  MEM_freeN(values);
+  BKE_main_free(bmain);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class AnimsysPerformanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(AnimsysPerformanceTest, ActionSmall)
+{
+  animsys_action_perf_do("50 bones", 50);
+}
+
+TEST_F(AnimsysPerformanceTest, ActionLarge)
+{
+  animsys_action_perf_do("500 bones", 500);
+}
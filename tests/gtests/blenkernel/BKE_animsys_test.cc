@@ -0,0 +1,222 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_animsys.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_nla.h"
+#include "BKE_object.h"
+
+#include "ED_keyframing.h"
+}
+
+#define NUM_BONES 20
+
+static FCurve *animsys_test_fcurve_add(bAction *action, const char *rna_path, int array_index)
+{
+  FCurve *fcu = static_cast<FCurve *>(MEM_callocN(sizeof(FCurve), "FCurve"));
+  fcu->rna_path = BLI_strdup(rna_path);
+  fcu->array_index = array_index;
+  BLI_addtail(&action->curves, fcu);
+
+  const int seed = BLI_listbase_count(&action->curves);
+  for (int key = 0; key < 8; key++) {
+    const float value = (float)((key * 13 + seed * 7) % 11) * 0.25f - 1.0f;
+    insert_vert_fcurve(
+        fcu, (float)(key * 8 + seed % 5), value, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  }
+  return fcu;
+}
+
+class AnimsysActionTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    ob = BKE_object_add_only_object(bmain, OB_ARMATURE, "Armature");
+    ob->pose = static_cast<bPose *>(MEM_callocN(sizeof(bPose), "bPose"));
+    action = BKE_action_add(bmain, "Action");
+
+    for (int i = 0; i < NUM_BONES; i++) {
+      char name[MAXBONENAME], rna_path[128];
+      BLI_snprintf(name, sizeof(name), "Bone.%d", i);
+      BKE_pose_channel_verify(ob->pose, name);
+
+      for (int axis = 0; axis < 3; axis++) {
+        BLI_snprintf(rna_path, sizeof(rna_path), "pose.bones[\"%s\"].location", name);
+        animsys_test_fcurve_add(action, rna_path, axis);
+        BLI_snprintf(rna_path, sizeof(rna_path), "pose.bones[\"%s\"].scale", name);
+        animsys_test_fcurve_add(action, rna_path, axis);
+      }
+    }
+    BKE_pose_channels_hash_make(ob->pose);
+
+    /* A property of the object itself, and a path that doesn't resolve. */
+    animsys_test_fcurve_add(action, "location", 1);
+    animsys_test_fcurve_add(action, "pose.bones[\"Missing\"].location", 0);
+
+    AnimData *adt = BKE_animdata_add_id(&ob->id);
+    adt->action = action;
+    id_us_plus(&action->id);
+  }
+
+  void TearDown() override
+  {
+    ob->id.tag &= ~LIB_TAG_COPIED_ON_WRITE;
+    BKE_main_free(bmain);
+  }
+
+  /* Evaluate from scratch, or with the data kept between evaluations of evaluated IDs. */
+  void evaluate(const float frame, const bool use_plan)
+  {
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob->pose->chanbase) {
+      zero_v3(pchan->loc);
+      zero_v3(pchan->size);
+    }
+    zero_v3(ob->loc);
+
+    SET_FLAG_FROM_TEST(ob->id.tag, use_plan, LIB_TAG_COPIED_ON_WRITE);
+    BKE_animsys_evaluate_animdata(&ob->id, ob->adt, frame, ADT_RECALC_ANIM, false);
+  }
+
+  void expect_same_as_per_fcurve(const float frame)
+  {
+    evaluate(frame, false);
+    float expected[NUM_BONES][2][3], expected_ob_loc[3];
+    int i = 0;
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob->pose->chanbase) {
+      copy_v3_v3(expected[i][0], pchan->loc);
+      copy_v3_v3(expected[i][1], pchan->size);
+      i++;
+    }
+    copy_v3_v3(expected_ob_loc, ob->loc);
+    EXPECT_NE(expected_ob_loc[1], 0.0f);
+
+    evaluate(frame, true);
+    if (BLI_listbase_is_empty(&ob->adt->nla_tracks)) {
+      EXPECT_NE(ob->adt->action_eval_plan, nullptr);
+    }
+    else {
+      EXPECT_NE(ob->adt->nla_eval_data, nullptr);
+    }
+    i = 0;
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob->pose->chanbase) {
+      EXPECT_V3_NEAR(pchan->loc, expected[i][0], 1e-5f);
+      EXPECT_V3_NEAR(pchan->size, expected[i][1], 1e-5f);
+      i++;
+    }
+    EXPECT_V3_NEAR(ob->loc, expected_ob_loc, 1e-5f);
+  }
+
+  Main *bmain;
+  Object *ob;
+  bAction *action;
+};
+
+TEST_F(AnimsysActionTest, Playback)
+{
+  for (int frame = -5; frame < 80; frame++) {
+    expect_same_as_per_fcurve((float)frame * 0.9f);
+  }
+}
+
+TEST_F(AnimsysActionTest, ActionChanged)
+{
+  expect_same_as_per_fcurve(10.0f);
+
+  /* Remove a curve, point another one to a different property and add one. */
+  FCurve *fcu = static_cast<FCurve *>(action->curves.first);
+  BLI_remlink(&action->curves, fcu);
+  free_fcurve(fcu);
+
+  fcu = static_cast<FCurve *>(BLI_findlink(&action->curves, 12));
+  MEM_freeN(fcu->rna_path);
+  fcu->rna_path = BLI_strdup("location");
+  fcu->array_index = 2;
+
+  animsys_test_fcurve_add(action, "location", 0);
+
+  expect_same_as_per_fcurve(12.5f);
+  expect_same_as_per_fcurve(13.5f);
+}
+
+TEST_F(AnimsysActionTest, NlaPlayback)
+{
+  /* Strips of the action and of another action affecting some of the same properties. */
+  bAction *action_other = BKE_action_add(bmain, "ActionOther");
+  for (int i = 0; i < NUM_BONES; i += 2) {
+    char rna_path[128];
+    BLI_snprintf(rna_path, sizeof(rna_path), "pose.bones[\"Bone.%d\"].location", i);
+    animsys_test_fcurve_add(action_other, rna_path, 1);
+  }
+  animsys_test_fcurve_add(action_other, "location", 1);
+
+  NlaTrack *nlt = BKE_nlatrack_add(ob->adt, NULL);
+  NlaStrip *strip = BKE_nlastrip_new(action);
+  strip->end = 30.0f;
+  BKE_nlatrack_add_strip(nlt, strip);
+
+  nlt = BKE_nlatrack_add(ob->adt, nlt);
+  strip = BKE_nlastrip_new(action_other);
+  strip->start = 20.0f;
+  strip->end = 60.0f;
+  strip->blendmode = NLASTRIP_MODE_COMBINE;
+  strip->blendin = 10.0f;
+  BKE_nlatrack_add_strip(nlt, strip);
+
+  /* The active action on top, scale is keyed negative so it's not combined. */
+  ob->adt->act_blendmode = NLASTRIP_MODE_ADD;
+  ob->adt->act_influence = 0.5f;
+
+  for (int frame = -5; frame < 80; frame++) {
+    expect_same_as_per_fcurve((float)frame * 0.9f);
+  }
+
+  /* Only the other action is evaluated, the properties of the first one get the defaults. */
+  ob->adt->action = NULL;
+  id_us_min(&action->id);
+  expect_same_as_per_fcurve(45.0f);
+
+  /* The strip's action is edited. */
+  FCurve *fcu = static_cast<FCurve *>(action_other->curves.first);
+  MEM_freeN(fcu->rna_path);
+  fcu->rna_path = BLI_strdup("pose.bones[\"Bone.3\"].scale");
+  expect_same_as_per_fcurve(46.0f);
+  expect_same_as_per_fcurve(47.0f);
+}
@@ -0,0 +1,158 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lattice.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_RUN_AVERAGED 5
+#define NUM_BONES 64
+#define NUM_INFLUENCES 4
+
+static void armature_deform_perf_do(const char *id, const int num_verts)
+{
+  bArmature arm = {{NULL}};
+  bPose pose = {{NULL}};
+  Object arm_ob, target_ob;
+  Bone *bones = (Bone *)MEM_callocN(sizeof(*bones) * NUM_BONES, __func__);
+  bPoseChannel *pchans = (bPoseChannel *)MEM_callocN(sizeof(*pchans) * NUM_BONES, __func__);
+  bDeformGroup *groups = (bDeformGroup *)MEM_callocN(sizeof(*groups) * NUM_BONES, __func__);
+  memset(&arm_ob, 0, sizeof(arm_ob));
+  memset(&target_ob, 0, sizeof(target_ob));
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  for (int i = 0; i < NUM_BONES; i++) {
+    const float axis[3] = {0.0f, 0.0f, 1.0f};
+    BLI_snprintf(pchans[i].name, sizeof(pchans[i].name), "Bone.%d", i);
+    BLI_strncpy(groups[i].name, pchans[i].name, sizeof(groups[i].name));
+    pchans[i].bone = &bones[i];
+    bones[i].segments = 1;
+    unit_m4(bones[i].arm_mat);
+    axis_angle_to_mat4(pchans[i].chan_mat, axis, 0.01f * (float)i);
+    pchans[i].chan_mat[3][0] = 0.1f;
+    mat4_to_dquat(&pchans[i].runtime.deform_dual_quat, bones[i].arm_mat, pchans[i].chan_mat);
+    BLI_addtail(&pose.chanbase, &pchans[i]);
+    BLI_addtail(&target_ob.defbase, &groups[i]);
+  }
+
+  Mesh *mesh = BKE_mesh_new_nomain(num_verts, 0, 0, 0, 0);
+  mesh->dvert = (MDeformVert *)CustomData_add_layer(
+      &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, NULL, mesh->totvert);
+  for (int i = 0; i < num_verts; i++) {
+    mesh->mvert[i].co[0] = (float)(i % 1000) * 0.01f;
+    mesh->mvert[i].co[1] = (float)(i / 1000) * 0.01f;
+    for (int j = 0; j < NUM_INFLUENCES; j++) {
+      BKE_defvert_add_index_notest(
+          &mesh->dvert[i], (i / 100 + j * 5) % NUM_BONES, 1.0f / (float)(j + 1));
+    }
+  }
+
+  arm_ob.type = OB_ARMATURE;
+  arm_ob.data = &arm;
+  arm_ob.pose = &pose;
+  unit_m4(arm_ob.obmat);
+  target_ob.type = OB_MESH;
+  target_ob.data = mesh;
+  unit_m4(target_ob.obmat);
+
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+  float(*defmats)[3][3] = (float(*)[3][3])MEM_mallocN(sizeof(*defmats) * num_verts, __func__);
+
+  const struct {
+    const char *name;
+    int deformflag;
+    bool use_defmats;
+  } variants[] = {
+      {"Linear", ARM_DEF_VGROUP, false},
+      {"Linear with matrices", ARM_DEF_VGROUP, true},
+      {"Dual quaternion", ARM_DEF_VGROUP | ARM_DEF_QUATERNION, false},
+  };
+
+  for (int v = 0; v < (int)ARRAY_SIZE(variants); v++) {
+    double timing = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      BKE_mesh_vert_coords_get(mesh, vert_coords);
+      for (int j = 0; j < num_verts; j++) {
+        unit_m3(defmats[j]);
+      }
+      const double init_time = PIL_check_seconds_timer();
+      armature_deform_verts(&arm_ob,
+                            &target_ob,
+                            mesh,
+                            vert_coords,
+                            variants[v].use_defmats ? defmats : NULL,
+                            num_verts,
+                            variants[v].deformflag,
+                            NULL,
+                            NULL,
+                            NULL);
+      timing += PIL_check_seconds_timer() - init_time;
+    }
+    printf("\t%s: done in %fs on average over %d runs\n",
+           variants[v].name,
+           timing / NUM_RUN_AVERAGED,
+           NUM_RUN_AVERAGED);
+  }
+
+  MEM_freeN(vert_coords);
+  MEM_freeN(defmats);
+  BKE_id_free(NULL, mesh);
+  MEM_freeN(bones);
+  MEM_freeN(pchans);
+  MEM_freeN(groups);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class ArmatureDeformPerformanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(ArmatureDeformPerformanceTest, VertsSmall)
+{
+  armature_deform_perf_do("100000 vertices", 100000);
+}
+
+TEST_F(ArmatureDeformPerformanceTest, VertsLarge)
+{
+  armature_deform_perf_do("2000000 vertices", 2000000);
+}
@@ -0,0 +1,254 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lattice.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+}
+
+#define NUM_BONES 6
+#define NUM_VERTS 500
+
+/* Pose the bones with a rotation around a different axis each, with some scale on the last. */
+static void armature_deform_test_pose(Bone *bone, bPoseChannel *pchan, const int index)
+{
+  const float axis[3] = {(float)(index % 3), 1.0f, (float)(index % 2)};
+  float axis_n[3];
+  normalize_v3_v3(axis_n, axis);
+
+  unit_m4(bone->arm_mat);
+  bone->arm_mat[3][1] = (float)index;
+
+  axis_angle_to_mat4(pchan->chan_mat, axis_n, 0.2f * (float)(index + 1));
+  pchan->chan_mat[3][0] = 0.1f * (float)index;
+  pchan->chan_mat[3][2] = -0.3f;
+  if (index == NUM_BONES - 1) {
+    mul_m4_fl(pchan->chan_mat, 1.5f);
+    pchan->chan_mat[3][3] = 1.0f;
+  }
+  mat4_to_dquat(&pchan->runtime.deform_dual_quat, bone->arm_mat, pchan->chan_mat);
+}
+
+class ArmatureDeformTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    memset(&arm, 0, sizeof(arm));
+    memset(&pose, 0, sizeof(pose));
+    memset(&arm_ob, 0, sizeof(arm_ob));
+    memset(&target_ob, 0, sizeof(target_ob));
+    memset(bones, 0, sizeof(bones));
+    memset(pchans, 0, sizeof(pchans));
+    memset(groups, 0, sizeof(groups));
+
+    for (int i = 0; i < NUM_BONES; i++) {
+      BLI_snprintf(pchans[i].name, sizeof(pchans[i].name), "Bone.%d", i);
+      BLI_strncpy(groups[i].name, pchans[i].name, sizeof(groups[i].name));
+      pchans[i].bone = &bones[i];
+      bones[i].segments = 1;
+      armature_deform_test_pose(&bones[i], &pchans[i], i);
+      BLI_addtail(&pose.chanbase, &pchans[i]);
+      BLI_addtail(&target_ob.defbase, &groups[i]);
+    }
+    /* A group without bone, like the ones used by other modifiers. */
+    BLI_strncpy(groups[NUM_BONES].name, "Other", sizeof(groups[NUM_BONES].name));
+    BLI_addtail(&target_ob.defbase, &groups[NUM_BONES]);
+
+    mesh = BKE_mesh_new_nomain(NUM_VERTS, 0, 0, 0, 0);
+    mesh->dvert = (MDeformVert *)CustomData_add_layer(
+        &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, NULL, mesh->totvert);
+    for (int i = 0; i < NUM_VERTS; i++) {
+      mesh->mvert[i].co[0] = (float)(i % 10) * 0.5f;
+      mesh->mvert[i].co[1] = (float)((i / 10) % 10) * 0.5f;
+      mesh->mvert[i].co[2] = (float)(i / 100) * 0.5f;
+
+      /* Up to four influences, some of them zero, and some vertices only using the group that
+       * is not a bone. */
+      const int totweight = i % 5;
+      for (int j = 0; j < totweight; j++) {
+        const int def_nr = (i * 7 + j * 3) % (NUM_BONES + 1);
+        BKE_defvert_ensure_index(&mesh->dvert[i], def_nr)->weight = (float)((i + j) % 4) * 0.3f;
+      }
+    }
+
+    arm_ob.type = OB_ARMATURE;
+    arm_ob.data = &arm;
+    arm_ob.pose = &pose;
+    unit_m4(arm_ob.obmat);
+    target_ob.type = OB_MESH;
+    target_ob.data = mesh;
+    unit_m4(target_ob.obmat);
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(NULL, mesh);
+  }
+
+  /* The deformation computed bone by bone, as the sum of the weighted offsets for the linear
+   * blending, or from the blended dual quaternion. */
+  void expected_deform(const int i,
+                       const bool use_quaternion,
+                       float r_co[3],
+                       float r_defmat[3][3]) const
+  {
+    const MDeformVert *dvert = &mesh->dvert[i];
+    float co[3], vec[3] = {0.0f}, mat[3][3], contrib = 0.0f;
+    DualQuat dq;
+    memset(&dq, 0, sizeof(dq));
+    zero_m3(mat);
+    copy_v3_v3(co, mesh->mvert[i].co);
+
+    for (int j = 0; j < dvert->totweight; j++) {
+      const MDeformWeight *dw = &dvert->dw[j];
+      if (dw->def_nr >= NUM_BONES || dw->weight == 0.0f) {
+        continue;
+      }
+      const bPoseChannel *pchan = &pchans[dw->def_nr];
+      if (use_quaternion) {
+        add_weighted_dq_dq(&dq, &pchan->runtime.deform_dual_quat, dw->weight);
+      }
+      else {
+        float tmp[3], tmpmat[3][3];
+        mul_v3_m4v3(tmp, pchan->chan_mat, co);
+        sub_v3_v3(tmp, co);
+        madd_v3_v3fl(vec, tmp, dw->weight);
+        copy_m3_m4(tmpmat, pchan->chan_mat);
+        madd_m3_m3m3fl(mat, mat, tmpmat, dw->weight);
+      }
+      contrib += dw->weight;
+    }
+
+    copy_v3_v3(r_co, co);
+    unit_m3(r_defmat);
+    if (contrib > 0.0001f) {
+      if (use_quaternion) {
+        normalize_dq(&dq, contrib);
+        mul_v3m3_dq(r_co, mat, &dq);
+      }
+      else {
+        madd_v3_v3fl(r_co, vec, 1.0f / contrib);
+        mul_m3_fl(mat, 1.0f / contrib);
+      }
+      copy_m3_m3(r_defmat, mat);
+    }
+  }
+
+  void expect_deform(const int deformflag)
+  {
+    float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+    float(*defmats)[3][3] = (float(*)[3][3])MEM_mallocN(sizeof(*defmats) * NUM_VERTS, __func__);
+    for (int i = 0; i < NUM_VERTS; i++) {
+      unit_m3(defmats[i]);
+    }
+
+    armature_deform_verts(
+        &arm_ob, &target_ob, mesh, vert_coords, defmats, NUM_VERTS, deformflag, NULL, NULL, NULL);
+
+    const bool use_quaternion = (deformflag & ARM_DEF_QUATERNION) != 0;
+    for (int i = 0; i < NUM_VERTS; i++) {
+      float co[3], defmat[3][3];
+      expected_deform(i, use_quaternion, co, defmat);
+      EXPECT_V3_NEAR(vert_coords[i], co, 1e-5f);
+      for (int j = 0; j < 3; j++) {
+        EXPECT_V3_NEAR(defmats[i][j], defmat[j], 1e-5f);
+      }
+    }
+
+    MEM_freeN(vert_coords);
+    MEM_freeN(defmats);
+  }
+
+  bArmature arm;
+  bPose pose;
+  Object arm_ob;
+  Object target_ob;
+  Bone bones[NUM_BONES];
+  bPoseChannel pchans[NUM_BONES];
+  bDeformGroup groups[NUM_BONES + 1];
+  Mesh *mesh;
+};
+
+TEST_F(ArmatureDeformTest, Linear)
+{
+  expect_deform(ARM_DEF_VGROUP);
+}
+
+TEST_F(ArmatureDeformTest, DualQuaternion)
+{
+  expect_deform(ARM_DEF_VGROUP | ARM_DEF_QUATERNION);
+}
+
+TEST_F(ArmatureDeformTest, VertexGroupFactor)
+{
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+  float(*vert_coords_full)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+
+  /* The group that is not a bone controls the influence of the whole armature. */
+  armature_deform_verts(&arm_ob,
+                        &target_ob,
+                        mesh,
+                        vert_coords,
+                        NULL,
+                        NUM_VERTS,
+                        ARM_DEF_VGROUP,
+                        NULL,
+                        "Other",
+                        NULL);
+  armature_deform_verts(&arm_ob,
+                        &target_ob,
+                        mesh,
+                        vert_coords_full,
+                        NULL,
+                        NUM_VERTS,
+                        ARM_DEF_VGROUP,
+                        NULL,
+                        NULL,
+                        NULL);
+
+  for (int i = 0; i < NUM_VERTS; i++) {
+    const float factor = BKE_defvert_find_weight(&mesh->dvert[i], NUM_BONES);
+    float co[3];
+    interp_v3_v3v3(co, mesh->mvert[i].co, vert_coords_full[i], factor);
+    EXPECT_V3_NEAR(vert_coords[i], co, 1e-5f);
+  }
+
+  MEM_freeN(vert_coords);
+  MEM_freeN(vert_coords_full);
+}
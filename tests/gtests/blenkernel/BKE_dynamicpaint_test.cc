@@ -0,0 +1,206 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "CLG_log.h"
+
+#include "DNA_dynamicpaint_types.h"
+#include "DNA_genfile.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_dynamicpaint.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph.h"
+}
+
+#include "BKE_mesh_test_util.h"
+
+#define GRID_SIZE 128
+#define IMAGE_RESOLUTION 256
+#define NUM_FRAMES 30
+
+/* A vertical grid with UVs, so paint drips down along it. */
+static Mesh *dynamicpaint_test_canvas_new(void)
+{
+  Mesh *mesh = mesh_test_grid_new(GRID_SIZE);
+
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = co[1];
+    co[1] = 0.0f;
+    mul_v3_fl(co, 1.0f / GRID_SIZE);
+  }
+
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, NULL, mesh->totloop);
+  for (int i = 0; i < mesh->totloop; i++) {
+    const float *co = mesh->mvert[mesh->mloop[i].v].co;
+    mloopuv[i].uv[0] = co[0];
+    mloopuv[i].uv[1] = co[2];
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+class DynamicPaintTest : public ::testing::Test {
+ protected:
+  Main *bmain;
+  Scene *scene;
+  Depsgraph *depsgraph;
+
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    BKE_modifier_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    DNA_sdna_current_free();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = (Scene *)MEM_callocN(sizeof(Scene), __func__);
+    scene->r.sfra = 1;
+    scene->r.efra = NUM_FRAMES;
+    scene->r.frs_sec = 24;
+    scene->r.frs_sec_base = 1.0f;
+    scene->physics_settings.flag = PHYS_GLOBAL_GRAVITY;
+    copy_v3_fl3(scene->physics_settings.gravity, 0.0f, 0.0f, -9.81f);
+    depsgraph = DEG_graph_new(bmain, scene, NULL, DAG_EVAL_VIEWPORT);
+  }
+
+  void TearDown() override
+  {
+    DEG_graph_free(depsgraph);
+    MEM_freeN(scene);
+    BKE_main_free(bmain);
+  }
+
+  /* Bake a surface with all paint effects and return a copy of its paint. */
+  PaintPoint *bake(const short format, const bool use_tiles, int *r_total_points)
+  {
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, "Canvas");
+    DynamicPaintModifierData *pmd = (DynamicPaintModifierData *)BKE_modifier_new(
+        eModifierType_DynamicPaint);
+    BLI_addtail(&ob->modifiers, pmd);
+    dynamicPaint_createType(pmd, MOD_DYNAMICPAINT_TYPE_CANVAS, scene);
+
+    DynamicPaintRuntime *runtime = (DynamicPaintRuntime *)MEM_callocN(sizeof(*runtime),
+                                                                      __func__);
+    runtime->canvas_mesh = dynamicpaint_test_canvas_new();
+    pmd->modifier.runtime = runtime;
+
+    DynamicPaintSurface *surface = (DynamicPaintSurface *)pmd->canvas->surfaces.first;
+    surface->effect = MOD_DPAINT_EFFECT_DO_SPREAD | MOD_DPAINT_EFFECT_DO_SHRINK |
+                      MOD_DPAINT_EFFECT_DO_DRIP;
+    surface->flags |= MOD_DPAINT_USE_DRYING | MOD_DPAINT_DISSOLVE;
+    surface->diss_speed = NUM_FRAMES;
+    surface->format = format;
+    if (format == MOD_DPAINT_SURFACE_F_IMAGESEQ) {
+      float progress;
+      short do_update;
+      surface->image_resolution = IMAGE_RESOLUTION;
+      EXPECT_TRUE(dynamicPaint_createUVSurface(scene, surface, &progress, &do_update));
+    }
+    else {
+      EXPECT_TRUE(dynamicPaint_resetSurface(scene, surface));
+    }
+
+    /* A wet spot and a dry one, leaving most of the surface unpainted. Consecutive points
+     * are close to each other, for image sequences too. */
+    PaintSurfaceData *sData = surface->data;
+    PaintPoint *pPoint = (PaintPoint *)sData->type_data;
+    const int spot_size = sData->total_points / 32;
+    for (int i = 0; i < spot_size; i++) {
+      PaintPoint *wet = &pPoint[sData->total_points / 4 + i];
+      PaintPoint *dry = &pPoint[sData->total_points * 3 / 4 + i];
+      wet->wetness = 1.0f;
+      wet->state = DPAINT_PAINT_WET;
+      copy_v4_fl4(wet->e_color, 1.0f, 0.0f, 0.0f, 1.0f);
+      copy_v4_fl4(dry->color, 0.0f, 1.0f, 0.0f, 0.8f);
+    }
+
+    dynamicPaint_setUseTiles(use_tiles);
+    for (int frame = 2; frame <= NUM_FRAMES; frame++) {
+      EXPECT_TRUE(dynamicPaint_calculateFrame(surface, depsgraph, scene, ob, frame));
+    }
+    dynamicPaint_setUseTiles(true);
+
+    *r_total_points = sData->total_points;
+    PaintPoint *result = (PaintPoint *)MEM_dupallocN(sData->type_data);
+
+    BKE_modifier_free((ModifierData *)pmd);
+    BLI_listbase_clear(&ob->modifiers);
+    return result;
+  }
+
+  /* Processing only the painted tiles must give the same paint as processing all points. */
+  void test_tiles(const short format)
+  {
+    int total_points, total_points_ref;
+    PaintPoint *pPoint = bake(format, true, &total_points);
+    PaintPoint *pPoint_ref = bake(format, false, &total_points_ref);
+
+    ASSERT_EQ(total_points, total_points_ref);
+    int num_painted = 0;
+    for (int i = 0; i < total_points; i++) {
+      EXPECT_EQ(pPoint[i].state, pPoint_ref[i].state);
+      EXPECT_EQ(pPoint[i].wetness, pPoint_ref[i].wetness);
+      EXPECT_V4_NEAR(pPoint[i].color, pPoint_ref[i].color, 0.0f);
+      EXPECT_V4_NEAR(pPoint[i].e_color, pPoint_ref[i].e_color, 0.0f);
+      num_painted += (pPoint[i].color[3] != 0.0f);
+    }
+    /* The effects did run, but didn't spread the paint over the whole surface. */
+    EXPECT_GT(num_painted, 0);
+    EXPECT_LT(num_painted, total_points);
+
+    MEM_freeN(pPoint);
+    MEM_freeN(pPoint_ref);
+  }
+};
+
+TEST_F(DynamicPaintTest, TilesVertex)
+{
+  test_tiles(MOD_DPAINT_SURFACE_F_VERTEX);
+}
+
+TEST_F(DynamicPaintTest, TilesImageSequence)
+{
+  test_tiles(MOD_DPAINT_SURFACE_F_IMAGESEQ);
+}
@@ -20,6 +20,9 @@
 #include "MEM_guardedalloc.h"
 
 extern "C" {
+#include "BLI_math_vector.h"
+#include "BLI_utildefines.h"
+
 #include "BKE_fcurve.h"
 
 #include "ED_keyframing.h"
@@ -209,3 +212,88 @@ TEST(evaluate_fcurve, ExtrapolationBezierKeys)
 
   free_fcurve(fcu);
 }
+
+TEST(evaluate_fcurves, MatchesEvaluateFCurve)
+{
+  /* More curves than fit in one batch of Bezier segments. */
+  const int fcurves_num = 150;
+  FCurve **fcurves = static_cast<FCurve **>(
+      MEM_calloc_arrayN(fcurves_num, sizeof(FCurve *), "FCurves"));
+
+  for (int i = 0; i < fcurves_num; i++) {
+    /* Leave some curves out. */
+    if (i % 7 == 6) {
+      continue;
+    }
+    FCurve *fcu = static_cast<FCurve *>(MEM_callocN(sizeof(FCurve), "FCurve"));
+    for (int key = 0; key < 12; key++) {
+      const float frame = (float)(key * (1 + i % 5)) + (float)(i % 3) * 0.5f;
+      const float value = (float)((key * 37 + i * 11) % 23) - 10.0f;
+      insert_vert_fcurve(fcu, frame, value, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    }
+
+    switch (i % 9) {
+      case 1:
+        fcu->bezt[3].ipo = BEZT_IPO_LIN;
+        fcu->bezt[5].ipo = BEZT_IPO_CONST;
+        break;
+      case 2:
+        fcu->bezt[4].ipo = BEZT_IPO_BOUNCE;
+        fcu->extend = FCURVE_EXTRAPOLATE_LINEAR;
+        break;
+      case 3:
+        /* Handles without length, so the root is found slowly at the start of the segment. */
+        copy_v2_v2(fcu->bezt[2].vec[2], fcu->bezt[2].vec[1]);
+        copy_v2_v2(fcu->bezt[3].vec[0], fcu->bezt[3].vec[1]);
+        break;
+      case 4:
+        fcu->flag |= FCURVE_INT_VALUES;
+        break;
+      case 5:
+        add_fmodifier(&fcu->modifiers, FMODIFIER_TYPE_CYCLES, fcu);
+        break;
+      case 6:
+        /* Handles overlapping the next keyframe, corrected before evaluation. */
+        fcu->bezt[6].vec[2][0] += 10.0f;
+        fcu->bezt[7].vec[0][1] -= 20.0f;
+        break;
+    }
+    fcurves[i] = fcu;
+  }
+
+  int *segment_cache = static_cast<int *>(
+      MEM_calloc_arrayN(fcurves_num, sizeof(int), "segment_cache"));
+  float *values = static_cast<float *>(MEM_calloc_arrayN(fcurves_num, sizeof(float), "values"));
+
+  /* Playback, then playing backwards and jumping around. */
+  float frames[400];
+  for (int i = 0; i < 200; i++) {
+    frames[i] = -2.0f + (float)i * 0.3f;
+    frames[200 + i] = (i < 100) ? (60.0f - (float)i * 0.6f) : (float)((i * 17) % 61) - 0.5f;
+  }
+
+  for (int f = 0; f < (int)ARRAY_SIZE(frames); f++) {
+    for (int i = 0; i < fcurves_num; i++) {
+      values[i] = -1000.0f;
+    }
+    evaluate_fcurves(fcurves, segment_cache, values, fcurves_num, frames[f]);
+
+    for (int i = 0; i < fcurves_num; i++) {
+      if (fcurves[i] == NULL) {
+        EXPECT_EQ(values[i], -1000.0f);
+        continue;
+      }
+      const float expected = evaluate_fcurve(fcurves[i], frames[f]);
+      EXPECT_NEAR(values[i], expected, 1e-5f) << "curve " << i << " at frame " << frames[f];
+    }
+  }
+
+  for (int i = 0; i < fcurves_num; i++) {
+    if (fcurves[i] != NULL) {
+      free_fcurve(fcurves[i]);
+    }
+  }
+  MEM_freeN(fcurves);
+  MEM_freeN(segment_cache);
+  MEM_freeN(values);
+}
@@ -0,0 +1,218 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+}
+
+#include "BKE_mesh_test_util.h"
+
+#define NUM_RUN_AVERAGED 10
+
+static Mesh *mesh_perf_grid_new(const int size)
+{
+  Mesh *mesh = mesh_test_grid_new(size);
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = sinf((co[0] + co[1]) * 0.01f);
+  }
+  return mesh;
+}
+
+/* Simulates a deform modifier followed by a normals update, as in the modifier stack:
+ * either writing the deformed coordinates back to the vertices to calculate the normals from
+ * them, or calculating the normals from the deformed coordinates directly. */
+static void mesh_perf_calc_normals_do(const char *id, const int size)
+{
+  double vert_timing = 0.0, coords_timing = 0.0;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *mesh = mesh_perf_grid_new(size);
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+  float(*poly_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*poly_nors) * mesh->totpoly, __func__);
+  float(*vert_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*vert_nors) * mesh->totvert, __func__);
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    double init_time = PIL_check_seconds_timer();
+    BKE_mesh_vert_coords_apply(mesh, vert_coords);
+    BKE_mesh_calc_normals_poly(mesh->mvert,
+                               vert_nors,
+                               mesh->totvert,
+                               mesh->mloop,
+                               mesh->mpoly,
+                               mesh->totloop,
+                               mesh->totpoly,
+                               poly_nors,
+                               false);
+    vert_timing += PIL_check_seconds_timer() - init_time;
+
+    init_time = PIL_check_seconds_timer();
+    BKE_mesh_calc_normals_poly_coords(vert_coords,
+                                      mesh->totvert,
+                                      mesh->mloop,
+                                      mesh->mpoly,
+                                      mesh->totloop,
+                                      mesh->totpoly,
+                                      poly_nors,
+                                      vert_nors);
+    coords_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  printf("\t%d vertices, %d polygons\n", mesh->totvert, mesh->totpoly);
+
+  MEM_freeN(poly_nors);
+  MEM_freeN(vert_nors);
+  MEM_freeN(vert_coords);
+  BKE_id_free(NULL, mesh);
+
+  printf("\tBKE_mesh_calc_normals_poly: done in %fs on average over %d runs\n",
+         vert_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tBKE_mesh_calc_normals_poly_coords: done in %fs on average over %d runs\n",
+         coords_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+static void mesh_perf_normals_loop_split_do(const char *id, const int size)
+{
+  double timing = 0.0, spacearr_timing = 0.0;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *mesh = mesh_perf_grid_new(size);
+  /* Some flat faces and a fold, for a mix of sharp and smooth edges. */
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag = (i % 7 == 0) ? 0 : ME_SMOOTH;
+  }
+  for (int i = 0; i < mesh->totvert; i++) {
+    if (mesh->mvert[i].co[0] > (float)(size / 2)) {
+      mesh->mvert[i].co[2] += mesh->mvert[i].co[0] - (float)(size / 2);
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  float(*poly_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*poly_nors) * mesh->totpoly, __func__);
+  float(*loop_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*loop_nors) * mesh->totloop, __func__);
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             NULL,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             poly_nors,
+                             true);
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    double init_time = PIL_check_seconds_timer();
+    BKE_mesh_normals_loop_split(mesh->mvert,
+                                mesh->totvert,
+                                mesh->medge,
+                                mesh->totedge,
+                                mesh->mloop,
+                                loop_nors,
+                                mesh->totloop,
+                                mesh->mpoly,
+                                poly_nors,
+                                mesh->totpoly,
+                                true,
+                                DEG2RADF(30.0f),
+                                NULL,
+                                NULL,
+                                NULL);
+    timing += PIL_check_seconds_timer() - init_time;
+
+    MLoopNorSpaceArray lnors_spacearr = {NULL};
+    init_time = PIL_check_seconds_timer();
+    BKE_mesh_normals_loop_split(mesh->mvert,
+                                mesh->totvert,
+                                mesh->medge,
+                                mesh->totedge,
+                                mesh->mloop,
+                                loop_nors,
+                                mesh->totloop,
+                                mesh->mpoly,
+                                poly_nors,
+                                mesh->totpoly,
+                                true,
+                                DEG2RADF(30.0f),
+                                &lnors_spacearr,
+                                NULL,
+                                NULL);
+    spacearr_timing += PIL_check_seconds_timer() - init_time;
+    BKE_lnor_spacearr_free(&lnors_spacearr);
+  }
+
+  printf("\t%d vertices, %d polygons\n", mesh->totvert, mesh->totpoly);
+
+  MEM_freeN(poly_nors);
+  MEM_freeN(loop_nors);
+  BKE_id_free(NULL, mesh);
+
+  printf("\tBKE_mesh_normals_loop_split: done in %fs on average over %d runs\n",
+         timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tBKE_mesh_normals_loop_split (spaces): done in %fs on average over %d runs\n",
+         spacearr_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class MeshPerformanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(MeshPerformanceTest, CalcNormalsGridSmall)
+{
+  mesh_perf_calc_normals_do("Normals Grid 500x500", 500);
+}
+
+TEST_F(MeshPerformanceTest, CalcNormalsGridLarge)
+{
+  mesh_perf_calc_normals_do("Normals Grid 2000x2000", 2000);
+}
+
+TEST_F(MeshPerformanceTest, NormalsLoopSplitGridSmall)
+{
+  mesh_perf_normals_loop_split_do("Loop Normals Grid 500x500", 500);
+}
+
+TEST_F(MeshPerformanceTest, NormalsLoopSplitGridLarge)
+{
+  mesh_perf_normals_loop_split_do("Loop Normals Grid 2000x2000", 2000);
+}
@@ -0,0 +1,516 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+}
+
+#include "BKE_mesh_test_util.h"
+
+#define GRID_SIZE 64
+#define FOLD_GRID_SIZE 48
+#define DISK_SEGMENTS 256
+
+/* A wavy grid of quads, with an n-gon and a triangle so all the code paths of the poly normal
+ * calculation are used. */
+static Mesh *mesh_test_grid_ngon_new(const int size)
+{
+  const int totpoly_grid = (size - 1) * (size - 1);
+  Mesh *mesh = BKE_mesh_new_nomain(
+      size * size + 1, 0, 0, totpoly_grid * 4 + 5 + 3, totpoly_grid + 2);
+  mesh_test_grid_fill(mesh, size);
+
+  for (int i = 0; i < size * size; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = sinf(co[0] * 0.3f) * cosf(co[1] * 0.2f);
+  }
+  /* Isolated vertex, its normal falls back to the normalized coordinate. */
+  copy_v3_fl3(mesh->mvert[size * size].co, 3.0f, -4.0f, 0.0f);
+
+  /* An n-gon and a triangle along the bottom border. */
+  int l = totpoly_grid * 4;
+  const int ngon_verts[5] = {0, 1, 2, 3, 4};
+  mesh->mpoly[totpoly_grid].loopstart = l;
+  mesh->mpoly[totpoly_grid].totloop = 5;
+  for (int i = 0; i < 5; i++) {
+    mesh->mloop[l++].v = ngon_verts[4 - i];
+  }
+  mesh->mpoly[totpoly_grid + 1].loopstart = l;
+  mesh->mpoly[totpoly_grid + 1].totloop = 3;
+  for (int i = 0; i < 3; i++) {
+    mesh->mloop[l++].v = i;
+  }
+
+  return mesh;
+}
+
+class MeshTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(MeshTest, CalcNormalsPolyCoords)
+{
+  Mesh *mesh = mesh_test_grid_ngon_new(GRID_SIZE);
+
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+  /* Deform the coordinates only, the way a deform modifier does. */
+  for (int i = 0; i < mesh->totvert; i++) {
+    vert_coords[i][2] += vert_coords[i][0] * 0.1f;
+  }
+
+  float(*poly_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*poly_nors) * mesh->totpoly, __func__);
+  float(*vert_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*vert_nors) * mesh->totvert, __func__);
+  BKE_mesh_calc_normals_poly_coords(vert_coords,
+                                    mesh->totvert,
+                                    mesh->mloop,
+                                    mesh->mpoly,
+                                    mesh->totloop,
+                                    mesh->totpoly,
+                                    poly_nors,
+                                    vert_nors);
+
+  /* The vertex normals must not be touched. */
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_EQ(mesh->mvert[i].no[0], 0);
+    EXPECT_EQ(mesh->mvert[i].no[1], 0);
+    EXPECT_EQ(mesh->mvert[i].no[2], 0);
+  }
+
+  /* Same results as for the vertices. */
+  BKE_mesh_vert_coords_apply(mesh, vert_coords);
+  float(*poly_nors_ref)[3] = (float(*)[3])MEM_mallocN(sizeof(*poly_nors) * mesh->totpoly,
+                                                      __func__);
+  float(*vert_nors_ref)[3] = (float(*)[3])MEM_mallocN(sizeof(*vert_nors) * mesh->totvert,
+                                                      __func__);
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             vert_nors_ref,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             poly_nors_ref,
+                             false);
+
+  for (int i = 0; i < mesh->totpoly; i++) {
+    EXPECT_V3_NEAR(poly_nors[i], poly_nors_ref[i], 0.0f);
+  }
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_V3_NEAR(vert_nors[i], vert_nors_ref[i], 0.0f);
+  }
+  float isolated_nor[3];
+  normalize_v3_v3(isolated_nor, vert_coords[mesh->totvert - 1]);
+  EXPECT_V3_NEAR(vert_nors[mesh->totvert - 1], isolated_nor, 1e-6f);
+
+  /* Poly normals only, slightly different since quads don't use Newell's method there. */
+  memset(poly_nors, 0, sizeof(*poly_nors) * mesh->totpoly);
+  BKE_mesh_calc_normals_poly_coords(vert_coords,
+                                    mesh->totvert,
+                                    mesh->mloop,
+                                    mesh->mpoly,
+                                    mesh->totloop,
+                                    mesh->totpoly,
+                                    poly_nors,
+                                    NULL);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    EXPECT_V3_NEAR(poly_nors[i], poly_nors_ref[i], 1e-5f);
+  }
+
+  MEM_freeN(poly_nors);
+  MEM_freeN(vert_nors);
+  MEM_freeN(poly_nors_ref);
+  MEM_freeN(vert_nors_ref);
+  MEM_freeN(vert_coords);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, VertCoordsApplyWithNormals)
+{
+  Mesh *mesh = mesh_test_grid_ngon_new(GRID_SIZE);
+  Mesh *mesh_ref = BKE_mesh_copy_for_eval(mesh, false);
+
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, NULL);
+  for (int i = 0; i < mesh->totvert; i++) {
+    vert_coords[i][2] += vert_coords[i][0] * 0.1f;
+  }
+
+  BKE_mesh_vert_coords_apply_with_normals(mesh, vert_coords);
+  BKE_mesh_vert_coords_apply(mesh_ref, vert_coords);
+  BKE_mesh_ensure_normals_for_display(mesh_ref);
+
+  EXPECT_EQ(mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL, 0);
+  EXPECT_EQ(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL, 0);
+
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_V3_NEAR(mesh->mvert[i].co, mesh_ref->mvert[i].co, 0.0f);
+    EXPECT_EQ(mesh->mvert[i].no[0], mesh_ref->mvert[i].no[0]);
+    EXPECT_EQ(mesh->mvert[i].no[1], mesh_ref->mvert[i].no[1]);
+    EXPECT_EQ(mesh->mvert[i].no[2], mesh_ref->mvert[i].no[2]);
+  }
+
+  const float(*poly_nors)[3] = (const float(*)[3])CustomData_get_layer(&mesh->pdata, CD_NORMAL);
+  const float(*poly_nors_ref)[3] = (const float(*)[3])CustomData_get_layer(&mesh_ref->pdata,
+                                                                           CD_NORMAL);
+  ASSERT_NE(poly_nors, nullptr);
+  ASSERT_NE(poly_nors_ref, nullptr);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    EXPECT_V3_NEAR(poly_nors[i], poly_nors_ref[i], 0.0f);
+  }
+
+  MEM_freeN(vert_coords);
+  BKE_id_free(NULL, mesh_ref);
+  BKE_id_free(NULL, mesh);
+}
+
+/* A grid folded along its middle column, with some flat faces and a line of sharp edges. */
+static Mesh *mesh_test_fold_grid_new(const int size)
+{
+  Mesh *mesh = mesh_test_grid_new(size);
+
+  for (int y = 0, i = 0; y < size; y++) {
+    for (int x = 0; x < size; x++, i++) {
+      mesh->mvert[i].co[2] = sinf((float)y * 0.4f) * 0.3f +
+                             (x > size / 2 ? (float)(x - size / 2) : 0.0f);
+    }
+  }
+
+  for (int y = 0, i = 0; y < size - 1; y++) {
+    for (int x = 0; x < size - 1; x++, i++) {
+      mesh->mpoly[i].flag = ((x + y * 3) % 11 == 0) ? 0 : ME_SMOOTH;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  for (int i = 0; i < mesh->totedge; i++) {
+    MEdge *me = &mesh->medge[i];
+    if ((me->v1 % size) == size / 4 && (me->v2 % size) == size / 4) {
+      me->flag |= ME_SHARP;
+    }
+  }
+
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+/* A wavy disk of triangles around a single vertex, so it has a cyclic fan of high valence.
+ * The triangles are in reverse order of the fan. */
+static Mesh *mesh_test_disk_new(const int segments)
+{
+  Mesh *mesh = BKE_mesh_new_nomain(segments + 1, 0, 0, segments * 3, segments);
+
+  zero_v3(mesh->mvert[0].co);
+  for (int i = 0; i < segments; i++) {
+    const float angle = (float)(2.0 * M_PI) * (float)i / (float)segments;
+    copy_v3_fl3(mesh->mvert[i + 1].co, cosf(angle), sinf(angle), 0.1f * sinf(angle * 3.0f));
+  }
+
+  for (int i = 0; i < segments; i++) {
+    const int p = segments - 1 - i;
+    MLoop *ml = &mesh->mloop[p * 3];
+    mesh->mpoly[p].loopstart = p * 3;
+    mesh->mpoly[p].totloop = 3;
+    mesh->mpoly[p].flag = ME_SMOOTH;
+    ml[0].v = 0;
+    ml[1].v = i + 1;
+    ml[2].v = (i + 1) % segments + 1;
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+/* Reference loop normals, from the smooth fans found with a brute force search of all the loops
+ * using each vertex. Also returns the fan of each loop, as the smallest loop index in it. */
+static void mesh_test_loop_normals_calc(const Mesh *mesh,
+                                        const float (*poly_nors)[3],
+                                        const float split_angle,
+                                        float (*r_loop_nors)[3],
+                                        int *r_loop_fan)
+{
+  const float split_angle_cos = cosf(split_angle);
+  int *loop_to_poly = (int *)MEM_mallocN(sizeof(int) * mesh->totloop, __func__);
+  int *edge_users = (int *)MEM_callocN(sizeof(int) * mesh->totedge, __func__);
+  int *edge_poly = (int *)MEM_mallocN(sizeof(int) * mesh->totedge, __func__);
+  bool *edge_smooth = (bool *)MEM_mallocN(sizeof(bool) * mesh->totedge, __func__);
+
+  for (int p = 0; p < mesh->totpoly; p++) {
+    const MPoly *mp = &mesh->mpoly[p];
+    for (int l = mp->loopstart; l < mp->loopstart + mp->totloop; l++) {
+      const int e = (int)mesh->mloop[l].e;
+      loop_to_poly[l] = p;
+      edge_smooth[e] = (edge_users[e] == 0) ?
+                           true :
+                           (dot_v3v3(poly_nors[edge_poly[e]], poly_nors[p]) >= split_angle_cos);
+      edge_poly[e] = p;
+      edge_users[e]++;
+    }
+  }
+  for (int e = 0; e < mesh->totedge; e++) {
+    edge_smooth[e] = edge_smooth[e] && edge_users[e] == 2 &&
+                     (mesh->medge[e].flag & ME_SHARP) == 0;
+  }
+
+  /* Loops using each vertex. */
+  int *vert_loops_offset = (int *)MEM_callocN(sizeof(int) * (mesh->totvert + 1), __func__);
+  int *vert_loops_len = (int *)MEM_callocN(sizeof(int) * mesh->totvert, __func__);
+  int *vert_loops = (int *)MEM_mallocN(sizeof(int) * mesh->totloop, __func__);
+  for (int l = 0; l < mesh->totloop; l++) {
+    vert_loops_offset[mesh->mloop[l].v + 1]++;
+  }
+  for (int v = 0; v < mesh->totvert; v++) {
+    vert_loops_offset[v + 1] += vert_loops_offset[v];
+  }
+  for (int l = 0; l < mesh->totloop; l++) {
+    const uint v = mesh->mloop[l].v;
+    vert_loops[vert_loops_offset[v] + vert_loops_len[v]++] = l;
+  }
+
+  /* Loops are in the same fan when their polys share a smooth edge using the vertex. */
+  for (int l = 0; l < mesh->totloop; l++) {
+    r_loop_fan[l] = l;
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int l_a = 0; l_a < mesh->totloop; l_a++) {
+      const MPoly *mp_a = &mesh->mpoly[loop_to_poly[l_a]];
+      const int l_a_prev = (l_a == mp_a->loopstart) ? mp_a->loopstart + mp_a->totloop - 1 :
+                                                      l_a - 1;
+      const uint edges_a[2] = {mesh->mloop[l_a].e, mesh->mloop[l_a_prev].e};
+      if (!(mp_a->flag & ME_SMOOTH)) {
+        continue;
+      }
+      for (int i = 0; i < 2; i++) {
+        if (!edge_smooth[edges_a[i]]) {
+          continue;
+        }
+        /* Find the other loop using this vertex in the poly on the other side of the edge. */
+        const uint v = mesh->mloop[l_a].v;
+        for (int j = vert_loops_offset[v]; j < vert_loops_offset[v + 1]; j++) {
+          const int l_b = vert_loops[j];
+          if (l_b == l_a) {
+            continue;
+          }
+          const MPoly *mp_b = &mesh->mpoly[loop_to_poly[l_b]];
+          const int l_b_prev = (l_b == mp_b->loopstart) ? mp_b->loopstart + mp_b->totloop - 1 :
+                                                          l_b - 1;
+          if (!(mp_b->flag & ME_SMOOTH) ||
+              !ELEM(edges_a[i], mesh->mloop[l_b].e, mesh->mloop[l_b_prev].e)) {
+            continue;
+          }
+          const int fan = min_ii(r_loop_fan[l_a], r_loop_fan[l_b]);
+          if (r_loop_fan[l_a] != fan || r_loop_fan[l_b] != fan) {
+            r_loop_fan[l_a] = r_loop_fan[l_b] = fan;
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+
+  /* Angle weighted sum of the poly normals of each fan. */
+  memset(r_loop_nors, 0, sizeof(*r_loop_nors) * mesh->totloop);
+  for (int l = 0; l < mesh->totloop; l++) {
+    const MPoly *mp = &mesh->mpoly[loop_to_poly[l]];
+    const int l_prev = (l == mp->loopstart) ? mp->loopstart + mp->totloop - 1 : l - 1;
+    const int l_next = (l == mp->loopstart + mp->totloop - 1) ? mp->loopstart : l + 1;
+    const float *co = mesh->mvert[mesh->mloop[l].v].co;
+    float vec_prev[3], vec_next[3];
+    sub_v3_v3v3(vec_prev, mesh->mvert[mesh->mloop[l_prev].v].co, co);
+    sub_v3_v3v3(vec_next, mesh->mvert[mesh->mloop[l_next].v].co, co);
+    madd_v3_v3fl(r_loop_nors[r_loop_fan[l]],
+                 poly_nors[loop_to_poly[l]],
+                 angle_v3v3(vec_prev, vec_next));
+  }
+  for (int l = 0; l < mesh->totloop; l++) {
+    normalize_v3_v3(r_loop_nors[l], r_loop_nors[r_loop_fan[l]]);
+  }
+
+  MEM_freeN(vert_loops_offset);
+  MEM_freeN(vert_loops_len);
+  MEM_freeN(vert_loops);
+  MEM_freeN(loop_to_poly);
+  MEM_freeN(edge_users);
+  MEM_freeN(edge_poly);
+  MEM_freeN(edge_smooth);
+}
+
+class MeshNormalsLoopSplitTest : public MeshTest {
+ protected:
+  void SetUp() override
+  {
+    set_mesh(mesh_test_fold_grid_new(FOLD_GRID_SIZE));
+  }
+
+  void TearDown() override
+  {
+    free_mesh();
+  }
+
+  void free_mesh()
+  {
+    MEM_freeN(poly_nors);
+    MEM_freeN(loop_nors);
+    BKE_id_free(NULL, mesh);
+  }
+
+  void set_mesh(Mesh *new_mesh)
+  {
+    if (mesh) {
+      free_mesh();
+    }
+    mesh = new_mesh;
+    poly_nors = (float(*)[3])MEM_mallocN(sizeof(*poly_nors) * mesh->totpoly, __func__);
+    BKE_mesh_calc_normals_poly(mesh->mvert,
+                               NULL,
+                               mesh->totvert,
+                               mesh->mloop,
+                               mesh->mpoly,
+                               mesh->totloop,
+                               mesh->totpoly,
+                               poly_nors,
+                               true);
+    loop_nors = (float(*)[3])MEM_mallocN(sizeof(*loop_nors) * mesh->totloop, __func__);
+  }
+
+  void normals_loop_split(const float split_angle,
+                          MLoopNorSpaceArray *r_lnors_spacearr,
+                          short (*clnors_data)[2])
+  {
+    BKE_mesh_normals_loop_split(mesh->mvert,
+                                mesh->totvert,
+                                mesh->medge,
+                                mesh->totedge,
+                                mesh->mloop,
+                                loop_nors,
+                                mesh->totloop,
+                                mesh->mpoly,
+                                poly_nors,
+                                mesh->totpoly,
+                                true,
+                                split_angle,
+                                r_lnors_spacearr,
+                                clnors_data,
+                                NULL);
+  }
+
+  void expect_loop_normals(const float split_angle, const MLoopNorSpaceArray *lnors_spacearr)
+  {
+    float(*loop_nors_ref)[3] = (float(*)[3])MEM_mallocN(sizeof(*loop_nors_ref) * mesh->totloop,
+                                                        __func__);
+    int *loop_fan = (int *)MEM_mallocN(sizeof(int) * mesh->totloop, __func__);
+    mesh_test_loop_normals_calc(mesh, poly_nors, split_angle, loop_nors_ref, loop_fan);
+
+    int num_fans = 0;
+    for (int l = 0; l < mesh->totloop; l++) {
+      EXPECT_V3_NEAR(loop_nors[l], loop_nors_ref[l], 1e-5f);
+      num_fans += (loop_fan[l] == l);
+      if (lnors_spacearr) {
+        /* Loops of a fan share its space. */
+        ASSERT_NE(lnors_spacearr->lspacearr[l], nullptr);
+        EXPECT_EQ(lnors_spacearr->lspacearr[l], lnors_spacearr->lspacearr[loop_fan[l]]);
+      }
+    }
+    if (lnors_spacearr) {
+      EXPECT_EQ(lnors_spacearr->num_spaces, num_fans);
+    }
+
+    MEM_freeN(loop_nors_ref);
+    MEM_freeN(loop_fan);
+  }
+
+  Mesh *mesh = NULL;
+  float (*poly_nors)[3];
+  float (*loop_nors)[3];
+};
+
+TEST_F(MeshNormalsLoopSplitTest, Smooth)
+{
+  normals_loop_split((float)M_PI, NULL, NULL);
+  expect_loop_normals((float)M_PI, NULL);
+}
+
+TEST_F(MeshNormalsLoopSplitTest, SplitAngle)
+{
+  const float split_angle = DEG2RADF(30.0f);
+  normals_loop_split(split_angle, NULL, NULL);
+  expect_loop_normals(split_angle, NULL);
+
+  MLoopNorSpaceArray lnors_spacearr = {NULL};
+  normals_loop_split(split_angle, &lnors_spacearr, NULL);
+  expect_loop_normals(split_angle, &lnors_spacearr);
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+}
+
+TEST_F(MeshNormalsLoopSplitTest, HighValence)
+{
+  set_mesh(mesh_test_disk_new(DISK_SEGMENTS));
+  normals_loop_split((float)M_PI, NULL, NULL);
+  expect_loop_normals((float)M_PI, NULL);
+
+  MLoopNorSpaceArray lnors_spacearr = {NULL};
+  normals_loop_split((float)M_PI, &lnors_spacearr, NULL);
+  expect_loop_normals((float)M_PI, &lnors_spacearr);
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+}
+
+TEST_F(MeshNormalsLoopSplitTest, CustomNormals)
+{
+  float(*custom_nors)[3] = (float(*)[3])MEM_mallocN(sizeof(*custom_nors) * mesh->totloop,
+                                                    __func__);
+  short(*clnors)[2] = (short(*)[2])MEM_callocN(sizeof(*clnors) * mesh->totloop, __func__);
+  for (int l = 0; l < mesh->totloop; l++) {
+    copy_v3_fl3(custom_nors[l], 0.1f, 0.2f, 1.0f);
+    normalize_v3(custom_nors[l]);
+  }
+  BKE_mesh_normals_loop_custom_set(mesh->mvert,
+                                   mesh->totvert,
+                                   mesh->medge,
+                                   mesh->totedge,
+                                   mesh->mloop,
+                                   custom_nors,
+                                   mesh->totloop,
+                                   mesh->mpoly,
+                                   poly_nors,
+                                   mesh->totpoly,
+                                   clnors);
+
+  /* Custom normals disable the split angle. */
+  normals_loop_split(DEG2RADF(30.0f), NULL, clnors);
+  for (int l = 0; l < mesh->totloop; l++) {
+    EXPECT_V3_NEAR(loop_nors[l], custom_nors[l], 1e-3f);
+  }
+
+  MEM_freeN(custom_nors);
+  MEM_freeN(clnors);
+}
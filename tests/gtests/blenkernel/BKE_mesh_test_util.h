@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __BLENDER_TESTING_BKE_MESH_TEST_UTIL_H__
+#define __BLENDER_TESTING_BKE_MESH_TEST_UTIL_H__
+
+/* Grid meshes shared by the mesh, PBVH, BMesh and modifier tests. */
+
+#include <math.h>
+
+extern "C" {
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_mesh.h"
+}
+
+/**
+ * Fill the first `size * size` vertices of the mesh with a grid in the XY plane, one unit
+ * apart, and the first `(size - 1) * (size - 1)` polygons and their loops with its quads.
+ * Other elements are left to the caller, the height of the grid is zero.
+ */
+inline void mesh_test_grid_fill(Mesh *mesh, const int size)
+{
+  for (int y = 0, i = 0; y < size; y++) {
+    for (int x = 0; x < size; x++, i++) {
+      mesh->mvert[i].co[0] = (float)x;
+      mesh->mvert[i].co[1] = (float)y;
+      mesh->mvert[i].co[2] = 0.0f;
+    }
+  }
+
+  for (int y = 0, i = 0; y < size - 1; y++) {
+    for (int x = 0; x < size - 1; x++, i++) {
+      MLoop *ml = &mesh->mloop[i * 4];
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      ml[0].v = y * size + x;
+      ml[1].v = y * size + x + 1;
+      ml[2].v = (y + 1) * size + x + 1;
+      ml[3].v = (y + 1) * size + x;
+    }
+  }
+}
+
+/**
+ * New mesh outside of main database with a grid of `size * size` vertices and no edges,
+ * see #mesh_test_grid_fill.
+ */
+inline Mesh *mesh_test_grid_new(const int size)
+{
+  const int totpoly = (size - 1) * (size - 1);
+  Mesh *mesh = BKE_mesh_new_nomain(size * size, 0, 0, totpoly * 4, totpoly);
+  mesh_test_grid_fill(mesh, size);
+  return mesh;
+}
+
+/**
+ * New mesh outside of main database with a triangulated grid of `size * size` points, where
+ * every triangle has its own vertices, like the meshes exported by scanning software. Vertices
+ * are moved by up to `jitter` times the `spacing` of the grid, the grid is a wave along X.
+ */
+inline Mesh *mesh_test_split_grid_new(const int size, const float spacing, const float jitter)
+{
+  const int tottri = (size - 1) * (size - 1) * 2;
+  Mesh *mesh = BKE_mesh_new_nomain(tottri * 3, 0, 0, tottri * 3, tottri);
+
+  for (int y = 0, i = 0; y < size - 1; y++) {
+    for (int x = 0; x < size - 1; x++) {
+      const int tris[2][3][2] = {
+          {{x, y}, {x + 1, y}, {x + 1, y + 1}},
+          {{x, y}, {x + 1, y + 1}, {x, y + 1}},
+      };
+      for (int t = 0; t < 2; t++, i++) {
+        mesh->mpoly[i].loopstart = i * 3;
+        mesh->mpoly[i].totloop = 3;
+        for (int j = 0; j < 3; j++) {
+          const int v = i * 3 + j;
+          const int hash = (v * 7919) % 13;
+          float *co = mesh->mvert[v].co;
+          co[0] = spacing * ((float)tris[t][j][0] + jitter * (float)(hash - 6) / 6.0f);
+          co[1] = spacing * ((float)tris[t][j][1] - jitter * (float)(hash % 5) / 4.0f);
+          co[2] = spacing * sinf((float)tris[t][j][0] * 0.3f);
+          mesh->mloop[v].v = v;
+        }
+      }
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  return mesh;
+}
+
+#endif /* __BLENDER_TESTING_BKE_MESH_TEST_UTIL_H__ */
@@ -0,0 +1,293 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_modifier_stack_cache.h"
+}
+
+class ModifierStackCacheTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    BKE_modifier_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_modifier_stack_cache_free_all();
+    DNA_sdna_current_free();
+  }
+
+  void SetUp() override
+  {
+    U.modifier_cache_limit = 64;
+    memset(&scene, 0, sizeof(scene));
+    memset(&ob, 0, sizeof(ob));
+    ob.id.session_uuid = 1;
+    mesh = BKE_mesh_new_nomain(8, 0, 0, 0, 0);
+  }
+
+  void TearDown() override
+  {
+    for (ModifierStackCacheKeyState &state : states) {
+      BKE_modifier_stack_cache_key_state_free(&state);
+    }
+    BKE_id_free(NULL, mesh);
+    BKE_modifier_stack_cache_free_all();
+    U.modifier_cache_limit = 0;
+  }
+
+  void key_get(ModifierData *md, ModifierStackCacheKey *r_key)
+  {
+    const CustomData_MeshMasks mask = {0};
+    ModifierStackCacheKeyState state;
+    ASSERT_TRUE(BKE_modifier_stack_cache_key_init(
+        &state, &scene, &ob, mesh, &mask, eModifierMode_Realtime, 0));
+    BKE_modifier_stack_cache_key_add_modifier(&state, md, &mask);
+    BKE_modifier_stack_cache_key_get(&state, r_key);
+    states.push_back(state);
+  }
+
+  static bool key_hashes_equal(const ModifierStackCacheKey &a, const ModifierStackCacheKey &b)
+  {
+    return a.object_uuid == b.object_uuid && a.input_hash == b.input_hash &&
+           a.stack_hash == b.stack_hash && a.stack_len == b.stack_len;
+  }
+
+  Scene scene;
+  Object ob;
+  Mesh *mesh;
+  /* Keys are valid until their state is freed. */
+  std::vector<ModifierStackCacheKeyState> states;
+};
+
+TEST_F(ModifierStackCacheTest, KeySettings)
+{
+  ModifierData *md_a = BKE_modifier_new(eModifierType_Bevel);
+  ModifierData *md_b = BKE_modifier_new(eModifierType_Bevel);
+  /* Copies have their own profile, which must not change the key. */
+  BKE_modifier_copydata(md_a, md_b);
+  EXPECT_NE(((BevelModifierData *)md_a)->custom_profile,
+            ((BevelModifierData *)md_b)->custom_profile);
+
+  ModifierStackCacheKey key_a, key_b;
+  key_get(md_a, &key_a);
+  key_get(md_b, &key_b);
+  EXPECT_TRUE(key_hashes_equal(key_a, key_b));
+
+  ((BevelModifierData *)md_b)->value *= 2.0f;
+  key_get(md_b, &key_b);
+  EXPECT_FALSE(key_hashes_equal(key_a, key_b));
+
+  BKE_modifier_free(md_a);
+  BKE_modifier_free(md_b);
+}
+
+TEST_F(ModifierStackCacheTest, KeyInput)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Subsurf);
+
+  ModifierStackCacheKey key_a, key_b;
+  key_get(md, &key_a);
+  mesh->mvert[3].co[1] = 1.0f;
+  key_get(md, &key_b);
+  EXPECT_NE(key_a.input_hash, key_b.input_hash);
+
+  BKE_modifier_free(md);
+}
+
+TEST_F(ModifierStackCacheTest, KeyDisabled)
+{
+  const CustomData_MeshMasks mask = {0};
+  ModifierStackCacheKeyState state;
+
+  U.modifier_cache_limit = 0;
+  EXPECT_FALSE(BKE_modifier_stack_cache_key_init(
+      &state, &scene, &ob, mesh, &mask, eModifierMode_Realtime, 0));
+}
+
+TEST_F(ModifierStackCacheTest, SupportsModifier)
+{
+  ModifierData *md_subsurf = BKE_modifier_new(eModifierType_Subsurf);
+  ModifierData *md_boolean = BKE_modifier_new(eModifierType_Boolean);
+  ModifierData *md_wave = BKE_modifier_new(eModifierType_Wave);
+
+  EXPECT_TRUE(BKE_modifier_stack_cache_supports_modifier(&ob, md_subsurf));
+  /* Without operand there is no dependency on other objects. */
+  EXPECT_TRUE(BKE_modifier_stack_cache_supports_modifier(&ob, md_boolean));
+  ((BooleanModifierData *)md_boolean)->object = &ob;
+  EXPECT_FALSE(BKE_modifier_stack_cache_supports_modifier(&ob, md_boolean));
+  ((BooleanModifierData *)md_boolean)->object = NULL;
+  /* Animated over time. */
+  EXPECT_FALSE(BKE_modifier_stack_cache_supports_modifier(&ob, md_wave));
+
+  BKE_modifier_free(md_subsurf);
+  BKE_modifier_free(md_boolean);
+  BKE_modifier_free(md_wave);
+}
+
+TEST_F(ModifierStackCacheTest, StoreFind)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Subsurf);
+  ModifierStackCacheKey keys[2];
+  ModifierStackCacheStats stats_prev, stats;
+  Mesh *mesh_found = NULL, *mesh_deform_found = NULL;
+  double eval_time = 0.0;
+
+  BKE_modifier_stack_cache_stats_get(&stats_prev);
+
+  key_get(md, &keys[0]);
+  ((SubsurfModifierData *)md)->levels++;
+  key_get(md, &keys[1]);
+
+  EXPECT_EQ(BKE_modifier_stack_cache_find(
+                keys, 2, NULL, &mesh_found, &mesh_deform_found, &eval_time),
+            -1);
+
+  BKE_modifier_stack_cache_store(&keys[0], mesh, 1.0);
+  EXPECT_EQ(BKE_modifier_stack_cache_find(
+                keys, 2, NULL, &mesh_found, &mesh_deform_found, &eval_time),
+            0);
+  ASSERT_NE(mesh_found, nullptr);
+  EXPECT_NE(mesh_found, mesh);
+  EXPECT_EQ(mesh_found->totvert, mesh->totvert);
+  EXPECT_EQ(eval_time, 1.0);
+  BKE_id_free(NULL, mesh_found);
+
+  /* The result furthest along the stack is used. */
+  BKE_modifier_stack_cache_store(&keys[1], mesh, 2.0);
+  EXPECT_EQ(BKE_modifier_stack_cache_find(
+                keys, 2, NULL, &mesh_found, &mesh_deform_found, &eval_time),
+            1);
+  EXPECT_EQ(eval_time, 2.0);
+  BKE_id_free(NULL, mesh_found);
+
+  /* A missing result of the leading deform modifiers makes the others unusable. */
+  ModifierStackCacheKey deform_key = keys[0];
+  deform_key.stack_hash++;
+  EXPECT_EQ(BKE_modifier_stack_cache_find(
+                keys, 2, &deform_key, &mesh_found, &mesh_deform_found, &eval_time),
+            -1);
+
+  BKE_modifier_stack_cache_stats_get(&stats);
+  EXPECT_EQ(stats.hits - stats_prev.hits, 2);
+  EXPECT_EQ(stats.misses - stats_prev.misses, 2);
+  EXPECT_EQ(stats.entries_len, 2);
+  EXPECT_GT(stats.mem_in_use, 0);
+  EXPECT_EQ(stats.time_saved - stats_prev.time_saved, 3.0);
+  EXPECT_GT(stats.time_overhead, stats_prev.time_overhead);
+
+  BKE_modifier_free(md);
+}
+
+/* Keys with equal hashes only match when their data does. */
+TEST_F(ModifierStackCacheTest, HashCollision)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Subsurf);
+  ModifierStackCacheKey key_a, key_b;
+  ModifierStackCacheStats stats;
+  Mesh *mesh_found = NULL;
+  double eval_time;
+
+  key_get(md, &key_a);
+  mesh->mvert[3].co[1] = 1.0f;
+  key_get(md, &key_b);
+  key_b.input_hash = key_a.input_hash;
+  key_b.stack_hash = key_a.stack_hash;
+
+  BKE_modifier_stack_cache_store(&key_a, mesh, 1.0);
+  EXPECT_EQ(BKE_modifier_stack_cache_find(&key_b, 1, NULL, &mesh_found, NULL, &eval_time), -1);
+
+  BKE_modifier_stack_cache_store(&key_b, mesh, 1.0);
+  BKE_modifier_stack_cache_stats_get(&stats);
+  EXPECT_EQ(stats.entries_len, 2);
+
+  /* Equal data in another key matches. */
+  mesh->mvert[3].co[1] = 0.0f;
+  ModifierStackCacheKey key_c;
+  key_get(md, &key_c);
+  EXPECT_NE(key_c.data, key_a.data);
+  EXPECT_EQ(BKE_modifier_stack_cache_find(&key_c, 1, NULL, &mesh_found, NULL, &eval_time), 0);
+  BKE_id_free(NULL, mesh_found);
+
+  BKE_modifier_free(md);
+}
+
+/* Results which are fast to evaluate are not worth the copy. */
+TEST_F(ModifierStackCacheTest, MinEvalTime)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Subsurf);
+  ModifierStackCacheKey key;
+  ModifierStackCacheStats stats;
+
+  key_get(md, &key);
+  BKE_modifier_stack_cache_store(&key, mesh, 0.0);
+  BKE_modifier_stack_cache_stats_get(&stats);
+  EXPECT_EQ(stats.entries_len, 0);
+
+  BKE_modifier_free(md);
+}
+
+TEST_F(ModifierStackCacheTest, Limit)
+{
+  Mesh *mesh_large = BKE_mesh_new_nomain(1024 * 1024, 0, 0, 0, 0);
+  ModifierData *md = BKE_modifier_new(eModifierType_Subsurf);
+  ModifierStackCacheKey keys[8];
+  ModifierStackCacheStats stats;
+  double eval_time;
+
+  /* Every result takes 20MB, so only three of them fit. */
+  for (int i = 0; i < 8; i++) {
+    ((SubsurfModifierData *)md)->levels = i;
+    key_get(md, &keys[i]);
+    BKE_modifier_stack_cache_store(&keys[i], mesh_large, 1.0);
+  }
+  BKE_modifier_stack_cache_stats_get(&stats);
+  EXPECT_EQ(stats.entries_len, 3);
+  EXPECT_LE(stats.mem_in_use, 64 * 1024 * 1024);
+
+  /* The least recently used are freed first. */
+  Mesh *mesh_found = NULL;
+  EXPECT_EQ(BKE_modifier_stack_cache_find(&keys[7], 1, NULL, &mesh_found, NULL, &eval_time), 0);
+  BKE_id_free(NULL, mesh_found);
+  EXPECT_EQ(BKE_modifier_stack_cache_find(&keys[4], 1, NULL, &mesh_found, NULL, &eval_time),
+            -1);
+
+  BKE_modifier_free(md);
+  BKE_id_free(NULL, mesh_large);
+}
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+#include "PIL_time.h"
+}
+
+#include "BKE_mesh_test_util.h"
+
+#define NUM_RUN_AVERAGED 5
+
+static Mesh *pbvh_perf_grid_new(const int size)
+{
+  Mesh *mesh = mesh_test_grid_new(size);
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = sinf((co[0] + co[1]) * 0.01f);
+  }
+  return mesh;
+}
+
+static PBVH *pbvh_perf_build(Mesh *mesh)
+{
+  const int looptri_num = poly_to_tri_count(mesh->totpoly, mesh->totloop);
+  MLoopTri *looptri = (MLoopTri *)MEM_mallocN(sizeof(*looptri) * looptri_num, __func__);
+  BKE_mesh_recalc_looptri(
+      mesh->mloop, mesh->mpoly, mesh->mvert, mesh->totloop, mesh->totpoly, looptri);
+
+  PBVH *bvh = BKE_pbvh_new();
+  BKE_pbvh_build_mesh(bvh,
+                      mesh,
+                      mesh->mpoly,
+                      mesh->mloop,
+                      mesh->mvert,
+                      mesh->totvert,
+                      &mesh->vdata,
+                      &mesh->ldata,
+                      &mesh->pdata,
+                      looptri,
+                      looptri_num);
+  return bvh;
+}
+
+/* Tag the vertices within the radius around the center and the nodes using them,
+ * like a brush stroke step does. */
+static void pbvh_perf_tag_update(PBVH *bvh, const float center[3], const float radius)
+{
+  PBVHNode **nodes;
+  int totnode;
+  BKE_pbvh_search_gather(bvh, NULL, NULL, &nodes, &totnode);
+  for (int n = 0; n < totnode; n++) {
+    float bb_min[3], bb_max[3], co[3];
+    BKE_pbvh_node_get_BB(nodes[n], bb_min, bb_max);
+    copy_v3_v3(co, center);
+    CLAMP(co[0], bb_min[0], bb_max[0]);
+    CLAMP(co[1], bb_min[1], bb_max[1]);
+    CLAMP(co[2], bb_min[2], bb_max[2]);
+    if (len_v3v3(co, center) > radius) {
+      continue;
+    }
+    const int *vert_indices;
+    MVert *mvert;
+    int uniq_verts, totvert;
+    BKE_pbvh_node_num_verts(bvh, nodes[n], &uniq_verts, &totvert);
+    BKE_pbvh_node_get_verts(bvh, nodes[n], &vert_indices, &mvert);
+    for (int i = 0; i < totvert; i++) {
+      if (len_v3v3(mvert[vert_indices[i]].co, center) <= radius) {
+        mvert[vert_indices[i]].flag |= ME_VERT_PBVH_UPDATE;
+      }
+    }
+    BKE_pbvh_node_mark_update(nodes[n]);
+  }
+  MEM_SAFE_FREE(nodes);
+}
+
+static void pbvh_perf_do(const char *id, const int size)
+{
+  double build_timing = 0.0, update_all_timing = 0.0, update_brush_timing = 0.0;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *mesh = pbvh_perf_grid_new(size);
+  const float center[3] = {size * 0.5f, size * 0.5f, 0.0f};
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    double init_time = PIL_check_seconds_timer();
+    PBVH *bvh = pbvh_perf_build(mesh);
+    build_timing += PIL_check_seconds_timer() - init_time;
+
+    pbvh_perf_tag_update(bvh, center, (float)size * 2.0f);
+    init_time = PIL_check_seconds_timer();
+    BKE_pbvh_update_normals(bvh, NULL);
+    BKE_pbvh_update_bounds(bvh, PBVH_UpdateBB | PBVH_UpdateOriginalBB | PBVH_UpdateRedraw);
+    update_all_timing += PIL_check_seconds_timer() - init_time;
+
+    pbvh_perf_tag_update(bvh, center, 20.0f);
+    init_time = PIL_check_seconds_timer();
+    BKE_pbvh_update_normals(bvh, NULL);
+    BKE_pbvh_update_bounds(bvh, PBVH_UpdateBB | PBVH_UpdateOriginalBB | PBVH_UpdateRedraw);
+    update_brush_timing += PIL_check_seconds_timer() - init_time;
+
+    BKE_pbvh_free(bvh);
+  }
+
+  printf("\t%d vertices, %d polygons\n", mesh->totvert, mesh->totpoly);
+  BKE_id_free(NULL, mesh);
+
+  printf("\tBKE_pbvh_build_mesh: done in %fs on average over %d runs\n",
+         build_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tUpdate of all nodes: done in %fs on average over %d runs\n",
+         update_all_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tUpdate of a brush step: done in %fs on average over %d runs\n",
+         update_brush_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class PBVHPerformanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(PBVHPerformanceTest, GridSmall)
+{
+  pbvh_perf_do("Grid 500x500", 500);
+}
+
+TEST_F(PBVHPerformanceTest, GridMedium)
+{
+  pbvh_perf_do("Grid 2000x2000", 2000);
+}
+
+TEST_F(PBVHPerformanceTest, GridLarge)
+{
+  pbvh_perf_do("Grid 5000x5000", 5000);
+}
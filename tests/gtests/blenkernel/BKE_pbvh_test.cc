@@ -0,0 +1,219 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_pbvh.h"
+}
+
+#include "BKE_mesh_test_util.h"
+
+/* Large enough for several levels of nodes. */
+#define GRID_SIZE 200
+
+static float pbvh_test_height(const int x, const int y, const float offset)
+{
+  return sinf((float)x * 0.1f + offset) * cosf((float)y * 0.13f);
+}
+
+static Mesh *pbvh_test_grid_new(const int size)
+{
+  Mesh *mesh = mesh_test_grid_new(size);
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = pbvh_test_height((int)co[0], (int)co[1], 0.0f);
+  }
+  return mesh;
+}
+
+/* Normals as the PBVH computes them: the sum of the normals of the faces of all triangles
+ * using the vertex. */
+static void pbvh_test_normals_calc(const Mesh *mesh,
+                                   const MLoopTri *looptri,
+                                   const int looptri_num,
+                                   float (*r_normals)[3])
+{
+  memset(r_normals, 0, sizeof(*r_normals) * mesh->totvert);
+  for (int i = 0; i < looptri_num; i++) {
+    const MPoly *mp = &mesh->mpoly[looptri[i].poly];
+    float no[3];
+    BKE_mesh_calc_poly_normal(mp, &mesh->mloop[mp->loopstart], mesh->mvert, no);
+    for (int j = 0; j < 3; j++) {
+      add_v3_v3(r_normals[mesh->mloop[looptri[i].tri[j]].v], no);
+    }
+  }
+  for (int i = 0; i < mesh->totvert; i++) {
+    normalize_v3(r_normals[i]);
+  }
+}
+
+class PBVHTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    mesh = pbvh_test_grid_new(GRID_SIZE);
+    looptri_num = poly_to_tri_count(mesh->totpoly, mesh->totloop);
+    /* Owned by the PBVH. */
+    looptri = (MLoopTri *)MEM_mallocN(sizeof(*looptri) * looptri_num, __func__);
+    BKE_mesh_recalc_looptri(
+        mesh->mloop, mesh->mpoly, mesh->mvert, mesh->totloop, mesh->totpoly, looptri);
+
+    bvh = BKE_pbvh_new();
+    BKE_pbvh_build_mesh(bvh,
+                        mesh,
+                        mesh->mpoly,
+                        mesh->mloop,
+                        mesh->mvert,
+                        mesh->totvert,
+                        &mesh->vdata,
+                        &mesh->ldata,
+                        &mesh->pdata,
+                        looptri,
+                        looptri_num);
+  }
+
+  void TearDown() override
+  {
+    BKE_pbvh_free(bvh);
+    BKE_id_free(NULL, mesh);
+  }
+
+  /* Move the vertices with x below x_max and tag them and all leaves using them for update.
+   * The neighbors of the moved vertices get new normals too. */
+  void deform(const int x_max, const float offset)
+  {
+    for (int y = 0, i = 0; y < GRID_SIZE; y++) {
+      for (int x = 0; x < GRID_SIZE; x++, i++) {
+        if (x < x_max) {
+          mesh->mvert[i].co[2] = pbvh_test_height(x, y, offset);
+        }
+        if (x <= x_max) {
+          mesh->mvert[i].flag |= ME_VERT_PBVH_UPDATE;
+        }
+      }
+    }
+
+    PBVHNode **nodes;
+    int totnode;
+    BKE_pbvh_search_gather(bvh, NULL, NULL, &nodes, &totnode);
+    for (int n = 0; n < totnode; n++) {
+      const int *vert_indices;
+      MVert *mvert;
+      int uniq_verts, totvert;
+      BKE_pbvh_node_num_verts(bvh, nodes[n], &uniq_verts, &totvert);
+      BKE_pbvh_node_get_verts(bvh, nodes[n], &vert_indices, &mvert);
+      for (int i = 0; i < totvert; i++) {
+        if (mvert[vert_indices[i]].flag & ME_VERT_PBVH_UPDATE) {
+          BKE_pbvh_node_mark_update(nodes[n]);
+          break;
+        }
+      }
+    }
+    MEM_SAFE_FREE(nodes);
+  }
+
+  void expect_normals()
+  {
+    float(*normals)[3] = (float(*)[3])MEM_mallocN(sizeof(*normals) * mesh->totvert, __func__);
+    pbvh_test_normals_calc(mesh, looptri, looptri_num, normals);
+    for (int i = 0; i < mesh->totvert; i++) {
+      float no[3];
+      normal_short_to_float_v3(no, mesh->mvert[i].no);
+      EXPECT_V3_NEAR(no, normals[i], 1e-4f);
+      EXPECT_EQ(mesh->mvert[i].flag & ME_VERT_PBVH_UPDATE, 0);
+    }
+    MEM_freeN(normals);
+  }
+
+  Mesh *mesh;
+  MLoopTri *looptri;
+  int looptri_num;
+  PBVH *bvh;
+};
+
+TEST_F(PBVHTest, BuildMesh)
+{
+  PBVHNode **nodes;
+  int totnode;
+  BKE_pbvh_search_gather(bvh, NULL, NULL, &nodes, &totnode);
+  EXPECT_GT(totnode, 4);
+
+  /* Every vertex is unique to exactly one leaf, and within its bounds. */
+  int *vert_owner_count = (int *)MEM_callocN(sizeof(int) * mesh->totvert, __func__);
+  for (int n = 0; n < totnode; n++) {
+    const int *vert_indices;
+    MVert *mvert;
+    int uniq_verts, totvert;
+    float bb_min[3], bb_max[3];
+    BKE_pbvh_node_num_verts(bvh, nodes[n], &uniq_verts, &totvert);
+    BKE_pbvh_node_get_verts(bvh, nodes[n], &vert_indices, &mvert);
+    BKE_pbvh_node_get_BB(nodes[n], bb_min, bb_max);
+    EXPECT_GT(uniq_verts, 0);
+    for (int i = 0; i < totvert; i++) {
+      const float *co = mvert[vert_indices[i]].co;
+      EXPECT_TRUE(co[0] >= bb_min[0] && co[1] >= bb_min[1] && co[2] >= bb_min[2]);
+      EXPECT_TRUE(co[0] <= bb_max[0] && co[1] <= bb_max[1] && co[2] <= bb_max[2]);
+      if (i < uniq_verts) {
+        vert_owner_count[vert_indices[i]]++;
+      }
+    }
+  }
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_EQ(vert_owner_count[i], 1);
+  }
+  MEM_freeN(vert_owner_count);
+  MEM_SAFE_FREE(nodes);
+
+  float bb_min[3], bb_max[3];
+  BKE_pbvh_bounding_box(bvh, bb_min, bb_max);
+  EXPECT_FLOAT_EQ(bb_min[0], 0.0f);
+  EXPECT_FLOAT_EQ(bb_max[1], (float)(GRID_SIZE - 1));
+}
+
+TEST_F(PBVHTest, UpdateNormals)
+{
+  /* Start with all normals up to date. */
+  deform(GRID_SIZE, 0.0f);
+  BKE_pbvh_update_normals(bvh, NULL);
+  expect_normals();
+
+  /* Partial updates only touch the tagged nodes, and must not be affected by the results
+   * accumulated in earlier updates. */
+  deform(GRID_SIZE / 3, 1.0f);
+  BKE_pbvh_update_normals(bvh, NULL);
+  expect_normals();
+
+  deform(GRID_SIZE / 2, 2.0f);
+  BKE_pbvh_update_normals(bvh, NULL);
+  expect_normals();
+}
@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_pointcache.h"
+#include "BKE_softbody.h"
+}
+
+#define NUM_POINTS 500
+
+class PointCacheTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(NULL);
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    BLI_join_dirfile(
+        bmain->name, sizeof(bmain->name), BKE_tempdir_session(), "pointcache_test.blend");
+    main_prev = G_MAIN;
+    relbase_valid_prev = G.relbase_valid;
+    G_MAIN = bmain;
+    G.relbase_valid = 1;
+
+    ob = BKE_object_add_only_object(bmain, OB_MESH, "SoftBody");
+    ob->soft = sbNew(NULL);
+    ob->soft->totpoint = NUM_POINTS;
+    ob->soft->bpoint = static_cast<BodyPoint *>(
+        MEM_calloc_arrayN(NUM_POINTS, sizeof(BodyPoint), "BodyPoint"));
+
+    BKE_ptcache_id_from_softbody(&pid, ob, ob->soft);
+    pid.cache->flag |= PTCACHE_DISK_CACHE | PTCACHE_DISK_SINGLE_FILE;
+    pid.cache->compression = PTCACHE_COMPRESS_LZO;
+    pid.cache->startframe = 1;
+    pid.cache->endframe = 50;
+  }
+
+  void TearDown() override
+  {
+    pid.cache->flag &= ~PTCACHE_BAKED;
+    BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_ALL, 0);
+    pid.cache->flag ^= PTCACHE_DISK_SINGLE_FILE;
+    BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_ALL, 0);
+
+    BKE_main_free(bmain);
+    G_MAIN = main_prev;
+    G.relbase_valid = relbase_valid_prev;
+  }
+
+  static float point_value(const int cfra, const int index, const int axis)
+  {
+    return (float)cfra * 0.5f + (float)index * 0.01f + (float)axis * 3.0f;
+  }
+
+  void write_frames(const int sfra, const int efra)
+  {
+    for (int cfra = sfra; cfra <= efra; cfra++) {
+      for (int i = 0; i < NUM_POINTS; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+          ob->soft->bpoint[i].pos[axis] = point_value(cfra, i, axis);
+          ob->soft->bpoint[i].vec[axis] = -point_value(cfra, i, axis);
+        }
+      }
+      EXPECT_TRUE(BKE_ptcache_write(&pid, cfra));
+    }
+  }
+
+  void expect_frame(const int cfra)
+  {
+    memset(ob->soft->bpoint, 0, sizeof(BodyPoint) * NUM_POINTS);
+    EXPECT_EQ(BKE_ptcache_read(&pid, (float)cfra, true), PTCACHE_READ_EXACT);
+
+    for (int i = 0; i < NUM_POINTS; i++) {
+      for (int axis = 0; axis < 3; axis++) {
+        EXPECT_EQ(ob->soft->bpoint[i].pos[axis], point_value(cfra, i, axis));
+        EXPECT_EQ(ob->soft->bpoint[i].vec[axis], -point_value(cfra, i, axis));
+      }
+    }
+  }
+
+  bool frame_file_exists(const int cfra)
+  {
+    char filename[FILE_MAX];
+    BLI_snprintf(filename,
+                 sizeof(filename),
+                 "%sblendcache_pointcache_test/%s_%06d_%02u" PTCACHE_EXT,
+                 BKE_tempdir_session(),
+                 pid.cache->name[0] ? pid.cache->name : "536F6674426F6479",
+                 cfra,
+                 pid.stack_index);
+    return BLI_exists(filename);
+  }
+
+  Main *bmain, *main_prev;
+  int relbase_valid_prev;
+  Object *ob;
+  PTCacheID pid;
+};
+
+TEST_F(PointCacheTest, SingleFile)
+{
+  write_frames(1, 20);
+
+  EXPECT_FALSE(frame_file_exists(1));
+  EXPECT_TRUE(BKE_ptcache_id_exist(&pid, 1));
+  EXPECT_TRUE(BKE_ptcache_id_exist(&pid, 20));
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid, 21));
+
+  /* Frames are read in any order. */
+  expect_frame(17);
+  expect_frame(3);
+  expect_frame(20);
+
+  /* Write the frames again after removing some. */
+  BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_AFTER, 10);
+  EXPECT_TRUE(BKE_ptcache_id_exist(&pid, 10));
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid, 11));
+
+  write_frames(11, 30);
+  expect_frame(30);
+  expect_frame(12);
+  expect_frame(5);
+
+  BKE_ptcache_id_clear(&pid, PTCACHE_CLEAR_ALL, 0);
+  EXPECT_FALSE(BKE_ptcache_id_exist(&pid, 5));
+}
+
+TEST_F(PointCacheTest, ToggleSingleFile)
+{
+  write_frames(1, 10);
+
+  /* Convert to a file per frame and back. */
+  pid.cache->flag &= ~PTCACHE_DISK_SINGLE_FILE;
+  BKE_ptcache_toggle_disk_single_file(&pid);
+  EXPECT_TRUE(frame_file_exists(4));
+  expect_frame(4);
+
+  pid.cache->flag |= PTCACHE_DISK_SINGLE_FILE;
+  BKE_ptcache_toggle_disk_single_file(&pid);
+  EXPECT_FALSE(frame_file_exists(4));
+  expect_frame(4);
+  expect_frame(10);
+  EXPECT_TRUE(pid.cache->cached_frames[9]);
+}
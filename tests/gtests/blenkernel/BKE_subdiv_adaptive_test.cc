@@ -0,0 +1,191 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <vector>
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_camera_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv_adaptive.h"
+}
+
+#include "BKE_mesh_test_util.h"
+
+#define GRID_SIZE 9
+#define MAX_LEVEL 10
+
+/* A 50mm lens on a 36mm sensor at 1920 pixels covers this many pixels per unit at unit
+ * distance. */
+#define PIXELS_PER_UNIT (1920.0f * 50.0f / 36.0f)
+
+/* Camera at the origin looking down the -Z axis, rendering full HD. */
+class SubdivAdaptiveTest : public ::testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    camera_data.type = CAM_PERSP;
+    camera_data.lens = 50.0f;
+    camera_data.ortho_scale = 10.0f;
+    camera_data.sensor_x = 36.0f;
+    camera_data.sensor_y = 24.0f;
+    camera_data.sensor_fit = CAMERA_SENSOR_FIT_AUTO;
+    camera_data.clip_start = 0.1f;
+    camera_data.clip_end = 1000.0f;
+
+    camera.type = OB_CAMERA;
+    camera.data = &camera_data;
+    unit_m4(camera.obmat);
+
+    rd.xsch = 1920;
+    rd.ysch = 1080;
+    rd.size = 100;
+    rd.xasp = 1.0f;
+    rd.yasp = 1.0f;
+  }
+
+  void TearDown() override
+  {
+    if (mesh != NULL) {
+      BKE_id_free(NULL, mesh);
+    }
+  }
+
+  /* Levels of the faces of a grid of unit quads, centered at `location`. */
+  std::vector<int> face_levels(const float location[3],
+                               const float pixel_size,
+                               const float rotation_x = 0.0f,
+                               int *r_level_max = NULL)
+  {
+    if (mesh == NULL) {
+      mesh = mesh_test_grid_new(GRID_SIZE);
+    }
+    const float offset = -0.5f * (float)(GRID_SIZE - 1);
+    float obmat[4][4], offset_mat[4][4];
+    unit_m4(offset_mat);
+    copy_v3_fl3(offset_mat[3], offset, offset, 0.0f);
+    axis_angle_to_mat4_single(obmat, 'X', rotation_x);
+    mul_m4_m4m4(obmat, obmat, offset_mat);
+    add_v3_v3(obmat[3], location);
+
+    SubdivAdaptiveView view;
+    BKE_subdiv_adaptive_view_init(&view, &camera, &rd);
+    std::vector<int> levels(mesh->totpoly, -1);
+    const int level_max = BKE_subdiv_adaptive_face_levels(
+        &view, mesh, obmat, pixel_size, MAX_LEVEL, levels.data());
+    if (r_level_max != NULL) {
+      *r_level_max = level_max;
+    }
+    return levels;
+  }
+
+  Camera camera_data = {};
+  Object camera = {};
+  RenderData rd = {};
+  Mesh *mesh = NULL;
+};
+
+/* Faces facing the camera at one distance all get the level of their screen size. */
+TEST_F(SubdivAdaptiveTest, PixelSize)
+{
+  /* The closest points of the faces are at the distance where an edge covers 100 pixels. */
+  const float radius = sqrtf(0.5f);
+  const float location[3] = {0.0f, 0.0f, -(PIXELS_PER_UNIT / 100.0f + radius)};
+
+  for (const int level : face_levels(location, 1.0f)) {
+    EXPECT_EQ(level, 7);
+  }
+  for (const int level : face_levels(location, 4.0f)) {
+    EXPECT_EQ(level, 5);
+  }
+  for (const int level : face_levels(location, 200.0f)) {
+    EXPECT_EQ(level, 0);
+  }
+}
+
+TEST_F(SubdivAdaptiveTest, MaxLevel)
+{
+  const float location[3] = {0.0f, 0.0f, -30.0f};
+  int level_max;
+  for (const int level : face_levels(location, 0.01f, 0.0f, &level_max)) {
+    EXPECT_EQ(level, MAX_LEVEL);
+  }
+  EXPECT_EQ(level_max, MAX_LEVEL);
+}
+
+/* A grid going away from the camera, the far faces need fewer levels than the near ones. */
+TEST_F(SubdivAdaptiveTest, Distance)
+{
+  const float location[3] = {0.0f, 0.0f, -20.0f};
+  int level_max;
+  const std::vector<int> levels = face_levels(location, 1.0f, -(float)M_PI * 0.4f, &level_max);
+
+  const int row_len = GRID_SIZE - 1;
+  for (int y = 1; y < row_len; y++) {
+    for (int x = 0; x < row_len; x++) {
+      EXPECT_LE(levels[y * row_len + x], levels[(y - 1) * row_len + x]);
+    }
+  }
+  EXPECT_LT(levels.back(), levels.front());
+  EXPECT_EQ(level_max, levels.front());
+}
+
+TEST_F(SubdivAdaptiveTest, OutsideView)
+{
+  /* Behind the camera. */
+  const float location_behind[3] = {0.0f, 0.0f, 20.0f};
+  int level_max;
+  for (const int level : face_levels(location_behind, 1.0f, 0.0f, &level_max)) {
+    EXPECT_EQ(level, 0);
+  }
+  EXPECT_EQ(level_max, 0);
+
+  /* Next to the view, only the faces inside of the view are subdivided. */
+  const float location_side[3] = {0.5f * 20.0f * 1920.0f / PIXELS_PER_UNIT, 0.0f, -20.0f};
+  const std::vector<int> levels = face_levels(location_side, 1.0f);
+  const int row_len = GRID_SIZE - 1;
+  EXPECT_GT(levels[0], 0);
+  EXPECT_EQ(levels[row_len - 1], 0);
+}
+
+/* The distance doesn't matter to an orthographic camera. */
+TEST_F(SubdivAdaptiveTest, Ortho)
+{
+  camera_data.type = CAM_ORTHO;
+  /* 1920 pixels over 10 units. */
+  const float location_near[3] = {0.0f, 0.0f, -5.0f};
+  const float location_far[3] = {0.0f, 0.0f, -500.0f};
+  for (const int level : face_levels(location_near, 1.0f, -(float)M_PI * 0.4f)) {
+    EXPECT_EQ(level, 8);
+  }
+  for (const int level : face_levels(location_far, 1.0f)) {
+    EXPECT_EQ(level, 8);
+  }
+}
@@ -15,6 +15,9 @@ extern "C" {
 
 #include "stubs/bf_intern_eigen_stubs.h"
 
+#include <algorithm>
+#include <vector>
+
 /* -------------------------------------------------------------------- */
 /* Helper Functions */
 
@@ -136,3 +139,66 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* Sorted pairs of overlapping leaves, only the ones with `indexA < indexB` if requested. */
+static std::vector<std::pair<int, int>> overlap_pairs_sorted(BVHTreeOverlap *overlap,
+                                                             uint overlap_len,
+                                                             bool only_ordered)
+{
+  std::vector<std::pair<int, int>> pairs;
+  for (uint i = 0; i < overlap_len; i++) {
+    if (!only_ordered || overlap[i].indexA < overlap[i].indexB) {
+      pairs.push_back(std::make_pair(overlap[i].indexA, overlap[i].indexB));
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  if (overlap) {
+    MEM_freeN(overlap);
+  }
+  return pairs;
+}
+
+static void overlap_self_test(int points_len, float scale, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 4, 26);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, scale);
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Move the points and refit, so the updated tree is compared with a new one. */
+  BVHTree *tree_moved = BLI_bvhtree_new(points_len, 0.01f, 4, 26);
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, scale);
+    BLI_bvhtree_update_node(tree, i, co, NULL, 1);
+    BLI_bvhtree_insert(tree_moved, i, co, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  BLI_bvhtree_balance(tree_moved);
+
+  uint overlap_len;
+  BVHTreeOverlap *overlap = BLI_bvhtree_overlap(tree_moved, tree_moved, &overlap_len, NULL, NULL);
+  std::vector<std::pair<int, int>> expected = overlap_pairs_sorted(overlap, overlap_len, true);
+  EXPECT_FALSE(expected.empty());
+
+  overlap = BLI_bvhtree_overlap_self(tree, &overlap_len, NULL, NULL);
+  EXPECT_EQ(overlap_pairs_sorted(overlap, overlap_len, false), expected);
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_moved);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, OverlapSelf_100)
+{
+  overlap_self_test(100, 0.1f, 12);
+}
+TEST(kdopbvh, OverlapSelf_5000)
+{
+  overlap_self_test(5000, 1.0f, 123);
+}
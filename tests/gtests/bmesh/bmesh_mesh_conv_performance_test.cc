@@ -0,0 +1,107 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+}
+
+#include "blenkernel/BKE_mesh_test_util.h"
+
+#include "bmesh.h"
+
+#define NUM_RUN_AVERAGED 10
+
+static Mesh *mesh_conv_perf_grid_new(const int size)
+{
+  Mesh *mesh = mesh_test_grid_new(size);
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  /* Some typical layers, so the custom-data copying is part of the timings. */
+  CustomData_add_layer(&mesh->vdata, CD_PROP_FLT, CD_CALLOC, NULL, mesh->totvert);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOPUV, CD_CALLOC, NULL, mesh->totloop);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOPCOL, CD_CALLOC, NULL, mesh->totloop);
+
+  return mesh;
+}
+
+static void mesh_conv_perf_do(const char *id, const int size)
+{
+  double from_mesh_timing = 0.0, to_mesh_timing = 0.0, to_mesh_eval_timing = 0.0;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *mesh = mesh_conv_perf_grid_new(size);
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    BMeshCreateParams create_params = {0};
+    BMeshFromMeshParams convert_params = {0};
+    convert_params.calc_face_normal = true;
+
+    double init_time = PIL_check_seconds_timer();
+    BMesh *bm = BKE_mesh_to_bmesh_ex(mesh, &create_params, &convert_params);
+    from_mesh_timing += PIL_check_seconds_timer() - init_time;
+
+    BMeshToMeshParams params = {0};
+    init_time = PIL_check_seconds_timer();
+    Mesh *mesh_result = BKE_mesh_from_bmesh_nomain(bm, &params, mesh);
+    to_mesh_timing += PIL_check_seconds_timer() - init_time;
+    BKE_id_free(NULL, mesh_result);
+
+    init_time = PIL_check_seconds_timer();
+    mesh_result = BKE_mesh_from_bmesh_for_eval_nomain(bm, NULL, mesh);
+    to_mesh_eval_timing += PIL_check_seconds_timer() - init_time;
+    BKE_id_free(NULL, mesh_result);
+
+    BM_mesh_free(bm);
+  }
+
+  BKE_id_free(NULL, mesh);
+
+  printf("\tBM_mesh_bm_from_me: done in %fs on average over %d runs\n",
+         from_mesh_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tBM_mesh_bm_to_me: done in %fs on average over %d runs\n",
+         to_mesh_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tBM_mesh_bm_to_me_for_eval: done in %fs on average over %d runs\n",
+         to_mesh_eval_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class BMeshMeshConvPerformanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(BMeshMeshConvPerformanceTest, GridSmall)
+{
+  mesh_conv_perf_do("Grid 100x100", 100);
+}
+
+TEST_F(BMeshMeshConvPerformanceTest, GridMedium)
+{
+  mesh_conv_perf_do("Grid 500x500", 500);
+}
+
+TEST_F(BMeshMeshConvPerformanceTest, GridLarge)
+{
+  mesh_conv_perf_do("Grid 1000x1000", 1000);
+}
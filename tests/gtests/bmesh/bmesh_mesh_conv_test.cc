@@ -0,0 +1,178 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+}
+
+#include "blenkernel/BKE_mesh_test_util.h"
+
+#include "bmesh.h"
+
+/* Large enough for the conversion to use threads. */
+#define GRID_SIZE 120
+
+static Mesh *mesh_conv_grid_new(const int size)
+{
+  Mesh *mesh = mesh_test_grid_new(size);
+
+  for (int i = 0; i < mesh->totvert; i++) {
+    MVert *mv = &mesh->mvert[i];
+    mv->co[2] = (float)(((int)mv->co[0] * (int)mv->co[1]) % 7);
+    mv->bweight = (char)(i % 255);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].mat_nr = (short)(i % 3);
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  mesh->cd_flag |= ME_CDFLAG_VERT_BWEIGHT | ME_CDFLAG_EDGE_CREASE;
+
+  for (int i = 0; i < mesh->totedge; i++) {
+    mesh->medge[i].crease = (char)(i % 255);
+  }
+
+  float *vert_float = (float *)CustomData_add_layer(
+      &mesh->vdata, CD_PROP_FLT, CD_CALLOC, NULL, mesh->totvert);
+  for (int i = 0; i < mesh->totvert; i++) {
+    vert_float[i] = (float)i * 0.5f;
+  }
+
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, NULL, mesh->totloop);
+  for (int i = 0; i < mesh->totloop; i++) {
+    mloopuv[i].uv[0] = (float)i;
+    mloopuv[i].uv[1] = -(float)i;
+  }
+
+  return mesh;
+}
+
+static void mesh_conv_expect_equal(const Mesh *me_a, const Mesh *me_b)
+{
+  ASSERT_EQ(me_a->totvert, me_b->totvert);
+  ASSERT_EQ(me_a->totedge, me_b->totedge);
+  ASSERT_EQ(me_a->totloop, me_b->totloop);
+  ASSERT_EQ(me_a->totpoly, me_b->totpoly);
+
+  for (int i = 0; i < me_a->totvert; i++) {
+    EXPECT_V3_NEAR(me_a->mvert[i].co, me_b->mvert[i].co, 0.0f);
+    EXPECT_EQ(me_a->mvert[i].bweight, me_b->mvert[i].bweight);
+  }
+  for (int i = 0; i < me_a->totedge; i++) {
+    EXPECT_EQ(me_a->medge[i].v1, me_b->medge[i].v1);
+    EXPECT_EQ(me_a->medge[i].v2, me_b->medge[i].v2);
+    EXPECT_EQ(me_a->medge[i].crease, me_b->medge[i].crease);
+  }
+  for (int i = 0; i < me_a->totloop; i++) {
+    EXPECT_EQ(me_a->mloop[i].v, me_b->mloop[i].v);
+    EXPECT_EQ(me_a->mloop[i].e, me_b->mloop[i].e);
+  }
+  for (int i = 0; i < me_a->totpoly; i++) {
+    EXPECT_EQ(me_a->mpoly[i].loopstart, me_b->mpoly[i].loopstart);
+    EXPECT_EQ(me_a->mpoly[i].totloop, me_b->mpoly[i].totloop);
+    EXPECT_EQ(me_a->mpoly[i].mat_nr, me_b->mpoly[i].mat_nr);
+  }
+
+  const float *vert_float_a = (const float *)CustomData_get_layer(&me_a->vdata, CD_PROP_FLT);
+  const float *vert_float_b = (const float *)CustomData_get_layer(&me_b->vdata, CD_PROP_FLT);
+  ASSERT_NE(vert_float_b, nullptr);
+  EXPECT_EQ(memcmp(vert_float_a, vert_float_b, sizeof(float) * me_a->totvert), 0);
+
+  const MLoopUV *mloopuv_a = (const MLoopUV *)CustomData_get_layer(&me_a->ldata, CD_MLOOPUV);
+  const MLoopUV *mloopuv_b = (const MLoopUV *)CustomData_get_layer(&me_b->ldata, CD_MLOOPUV);
+  ASSERT_NE(mloopuv_b, nullptr);
+  for (int i = 0; i < me_a->totloop; i++) {
+    EXPECT_EQ(mloopuv_a[i].uv[0], mloopuv_b[i].uv[0]);
+    EXPECT_EQ(mloopuv_a[i].uv[1], mloopuv_b[i].uv[1]);
+  }
+}
+
+class BMeshMeshConvTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    mesh = mesh_conv_grid_new(GRID_SIZE);
+
+    BMeshCreateParams create_params = {0};
+    BMeshFromMeshParams convert_params = {0};
+    convert_params.calc_face_normal = true;
+    bm = BKE_mesh_to_bmesh_ex(mesh, &create_params, &convert_params);
+  }
+
+  void TearDown() override
+  {
+    BM_mesh_free(bm);
+    BKE_id_free(NULL, mesh);
+  }
+
+  Mesh *mesh;
+  BMesh *bm;
+};
+
+TEST_F(BMeshMeshConvTest, FromMesh)
+{
+  EXPECT_EQ(bm->totvert, mesh->totvert);
+  EXPECT_EQ(bm->totedge, mesh->totedge);
+  EXPECT_EQ(bm->totloop, mesh->totloop);
+  EXPECT_EQ(bm->totface, mesh->totpoly);
+
+  const int cd_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+  ASSERT_NE(cd_bweight_offset, -1);
+
+  BMIter iter;
+  BMVert *v;
+  int i;
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+    EXPECT_EQ(BM_elem_index_get(v), i);
+    EXPECT_EQ(BM_elem_float_data_get(&bm->vdata, v, CD_PROP_FLT), (float)i * 0.5f);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_bweight_offset), mesh->mvert[i].bweight);
+  }
+
+  BMFace *f;
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
+    float no[3];
+    BM_face_calc_normal(f, no);
+    EXPECT_EQ(f->mat_nr, mesh->mpoly[i].mat_nr);
+    EXPECT_V3_NEAR(f->no, no, 0.0f);
+  }
+}
+
+TEST_F(BMeshMeshConvTest, ToMesh)
+{
+  BMeshToMeshParams params = {0};
+  Mesh *mesh_result = BKE_mesh_from_bmesh_nomain(bm, &params, mesh);
+  mesh_conv_expect_equal(mesh, mesh_result);
+  BKE_id_free(NULL, mesh_result);
+}
+
+TEST_F(BMeshMeshConvTest, ToMeshForEval)
+{
+  Mesh *mesh_result = BKE_mesh_from_bmesh_for_eval_nomain(bm, NULL, mesh);
+  mesh_conv_expect_equal(mesh, mesh_result);
+
+  const int *index = (const int *)CustomData_get_layer(&mesh_result->pdata, CD_ORIGINDEX);
+  ASSERT_NE(index, nullptr);
+  for (int i = 0; i < mesh_result->totpoly; i++) {
+    EXPECT_EQ(index[i], i);
+  }
+  EXPECT_EQ(bm->elem_index_dirty, 0);
+
+  BKE_id_free(NULL, mesh_result);
+}
@@ -0,0 +1,105 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+}
+
+DEFINE_string(test_ocio_config, "", "The OpenColorIO configuration shipped with Blender.");
+
+class ImbufColormanagementTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    /* Without OpenColorIO the fallback configuration is used instead. */
+    if (!FLAGS_test_ocio_config.empty()) {
+      BLI_setenv("OCIO", FLAGS_test_ocio_config.c_str());
+    }
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_threadapi_exit();
+  }
+};
+
+/* Large buffers go through a baked LUT, compare them against the exact per-pixel transform. */
+static void test_display_processor_lut(const char *view, const char *look, const float exposure)
+{
+  const int width = 256, height = 256, channels = 4;
+  const size_t tot = (size_t)width * height * channels;
+  float *buffer = (float *)MEM_mallocN(sizeof(float) * tot, __func__);
+  float *expected = (float *)MEM_mallocN(sizeof(float) * tot, __func__);
+
+  for (int i = 0; i < width * height; i++) {
+    float *pixel = &buffer[i * channels];
+    /* Ramp over the range used for display, with some negative and very bright values. */
+    pixel[0] = (float)(i % width) / (width - 1) * 2.0f - 0.1f;
+    pixel[1] = (float)(i / width) / (height - 1) * 80.0f;
+    /* Dark values, down to the precision of half floats. */
+    pixel[2] = powf(2.0f, -14.0f * (float)((i * 7) % 1024) / 1023.0f);
+    pixel[3] = (i % 3 == 0) ? 0.5f : 1.0f;
+  }
+
+  ColorManagedDisplaySettings display_settings;
+  ColorManagedViewSettings view_settings;
+  STRNCPY(display_settings.display_device, "sRGB");
+  IMB_colormanagement_init_default_view_settings(&view_settings, &display_settings);
+  STRNCPY(view_settings.view_transform, view);
+  STRNCPY(view_settings.look, look);
+  view_settings.exposure = exposure;
+
+  ColormanageProcessor *cm_processor = IMB_colormanagement_display_processor_new(
+      &view_settings, &display_settings);
+  for (int i = 0; i < width * height; i++) {
+    float *pixel = &expected[i * channels];
+    copy_v4_v4(pixel, &buffer[i * channels]);
+    IMB_colormanagement_processor_apply_v4_predivide(cm_processor, pixel);
+  }
+  IMB_colormanagement_processor_apply(cm_processor, buffer, width, height, channels, true);
+  IMB_colormanagement_processor_free(cm_processor);
+
+  /* The LUT is only used when it matches within a relative error bound, see
+   * COLORMANAGE_LUT_TOLERANCE. */
+  for (size_t i = 0; i < tot; i++) {
+    EXPECT_NEAR(buffer[i], expected[i], 4e-3f * max_ff(1e-4f, fabsf(expected[i])))
+        << "view " << view << ", look " << look << ", index " << i;
+  }
+
+  MEM_freeN(buffer);
+  MEM_freeN(expected);
+}
+
+TEST_F(ImbufColormanagementTest, ProcessorLUTAccuracy)
+{
+  test_display_processor_lut("Standard", "None", 0.0f);
+}
+
+/* Filmic view with a look and exposure, a transform which is not a simple curve. */
+TEST_F(ImbufColormanagementTest, ProcessorLUTAccuracyFilmic)
+{
+  if (IMB_colormanagement_view_get_named_index("Filmic") == 0) {
+#ifdef WITH_OCIO
+    FAIL() << "Filmic view not found, pass the --test-ocio-config flag";
+#else
+    /* The fallback configuration only has the standard view. */
+    return;
+#endif
+  }
+  test_display_processor_lut("Filmic", "High Contrast", 1.5f);
+}
@@ -0,0 +1,114 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_RUN_AVERAGED 10
+
+static ImBuf *scaling_perf_ibuf_new(int x, int y, int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, flags);
+  if (ibuf->rect) {
+    unsigned char *rect = (unsigned char *)ibuf->rect;
+    for (int i = 0; i < x * y * 4; i++) {
+      rect[i] = (unsigned char)((i * 7) & 255);
+    }
+  }
+  if (ibuf->rect_float) {
+    for (int i = 0; i < x * y * 4; i++) {
+      ibuf->rect_float[i] = (float)((i * 7) & 255) / 255.0f;
+    }
+  }
+  return ibuf;
+}
+
+enum {
+  SCALE_PERF_IMBUF = -1,
+  SCALE_PERF_IMBUF_FAST = -2,
+};
+
+static void scaling_perf_do(const char *id, int method, int flags, int newx, int newy)
+{
+  double averaged_timing = 0.0;
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    ImBuf *ibuf = scaling_perf_ibuf_new(1920, 1080, flags);
+
+    const double init_time = PIL_check_seconds_timer();
+    switch (method) {
+      case SCALE_PERF_IMBUF:
+        IMB_scaleImBuf(ibuf, newx, newy);
+        break;
+      case SCALE_PERF_IMBUF_FAST:
+        IMB_scalefastImBuf(ibuf, newx, newy);
+        break;
+      default:
+        IMB_scaleImBuf_filtered(ibuf, newx, newy, (eIMBScaleFilter)method);
+        break;
+    }
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+
+    IMB_freeImBuf(ibuf);
+  }
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+}
+
+static void scaling_perf_test(const char *id, int flags, int newx, int newy)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  scaling_perf_do("IMB_scaleImBuf", SCALE_PERF_IMBUF, flags, newx, newy);
+  scaling_perf_do("IMB_scalefastImBuf", SCALE_PERF_IMBUF_FAST, flags, newx, newy);
+  scaling_perf_do("Filtered box", IMB_SCALE_FILTER_BOX, flags, newx, newy);
+  scaling_perf_do("Filtered bilinear", IMB_SCALE_FILTER_BILINEAR, flags, newx, newy);
+  scaling_perf_do("Filtered mitchell", IMB_SCALE_FILTER_MITCHELL, flags, newx, newy);
+  scaling_perf_do("Filtered lanczos", IMB_SCALE_FILTER_LANCZOS, flags, newx, newy);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class ImbufScalingTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+  }
+};
+
+TEST_F(ImbufScalingTest, ByteDownscale)
+{
+  scaling_perf_test("Byte 1920x1080 -> 480x270", IB_rect, 480, 270);
+}
+
+TEST_F(ImbufScalingTest, ByteUpscale)
+{
+  scaling_perf_test("Byte 1920x1080 -> 3840x2160", IB_rect, 3840, 2160);
+}
+
+TEST_F(ImbufScalingTest, FloatDownscale)
+{
+  scaling_perf_test("Float 1920x1080 -> 480x270", IB_rectfloat, 480, 270);
+}
+
+TEST_F(ImbufScalingTest, FloatUpscale)
+{
+  scaling_perf_test("Float 1920x1080 -> 3840x2160", IB_rectfloat, 3840, 2160);
+}
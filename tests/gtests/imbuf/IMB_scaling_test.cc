@@ -0,0 +1,141 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+static ImBuf *scaling_test_ibuf_new(int x, int y, int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, flags);
+  if (ibuf->rect) {
+    unsigned char *rect = (unsigned char *)ibuf->rect;
+    for (int i = 0; i < x * y; i++) {
+      rect[i * 4 + 0] = 200;
+      rect[i * 4 + 1] = 100;
+      rect[i * 4 + 2] = 50;
+      rect[i * 4 + 3] = 255;
+    }
+  }
+  if (ibuf->rect_float) {
+    for (int i = 0; i < x * y; i++) {
+      ibuf->rect_float[i * 4 + 0] = 0.75f;
+      ibuf->rect_float[i * 4 + 1] = 0.5f;
+      ibuf->rect_float[i * 4 + 2] = 0.25f;
+      ibuf->rect_float[i * 4 + 3] = 1.0f;
+    }
+  }
+  return ibuf;
+}
+
+static void scaling_test_constant(eIMBScaleFilter filter, int x, int y, int newx, int newy)
+{
+  ImBuf *ibuf = scaling_test_ibuf_new(x, y, IB_rect | IB_rectfloat);
+
+  EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, newx, newy, filter));
+  EXPECT_EQ(ibuf->x, newx);
+  EXPECT_EQ(ibuf->y, newy);
+
+  /* Normalized weights must reproduce a constant image exactly. */
+  const unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (int i = 0; i < newx * newy; i++) {
+    EXPECT_EQ(rect[i * 4 + 0], 200);
+    EXPECT_EQ(rect[i * 4 + 1], 100);
+    EXPECT_EQ(rect[i * 4 + 2], 50);
+    EXPECT_EQ(rect[i * 4 + 3], 255);
+    EXPECT_NEAR(ibuf->rect_float[i * 4 + 0], 0.75f, 1e-5f);
+    EXPECT_NEAR(ibuf->rect_float[i * 4 + 1], 0.5f, 1e-5f);
+    EXPECT_NEAR(ibuf->rect_float[i * 4 + 2], 0.25f, 1e-5f);
+    EXPECT_NEAR(ibuf->rect_float[i * 4 + 3], 1.0f, 1e-5f);
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+class ImbufScalingTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+  }
+};
+
+TEST_F(ImbufScalingTest, FilteredConstant)
+{
+  const eIMBScaleFilter filters[] = {IMB_SCALE_FILTER_BOX,
+                                     IMB_SCALE_FILTER_BILINEAR,
+                                     IMB_SCALE_FILTER_MITCHELL,
+                                     IMB_SCALE_FILTER_LANCZOS};
+  for (int i = 0; i < ARRAY_SIZE(filters); i++) {
+    scaling_test_constant(filters[i], 97, 61, 40, 25);
+    scaling_test_constant(filters[i], 97, 61, 211, 130);
+    scaling_test_constant(filters[i], 97, 61, 300, 17);
+    scaling_test_constant(filters[i], 1, 1, 8, 8);
+  }
+}
+
+TEST_F(ImbufScalingTest, FilteredBoxHalf)
+{
+  ImBuf *ibuf = IMB_allocImBuf(4, 2, 32, IB_rectfloat);
+  const float values[4] = {0.0f, 1.0f, 0.25f, 0.75f};
+
+  for (int y = 0; y < 2; y++) {
+    for (int x = 0; x < 4; x++) {
+      float *pixel = &ibuf->rect_float[(y * 4 + x) * 4];
+      pixel[0] = pixel[1] = pixel[2] = values[x];
+      pixel[3] = 1.0f;
+    }
+  }
+
+  /* Halving with a box filter averages pairs of pixels. */
+  EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, 2, 1, IMB_SCALE_FILTER_BOX));
+  EXPECT_FLOAT_EQ(ibuf->rect_float[0], 0.5f);
+  EXPECT_FLOAT_EQ(ibuf->rect_float[4], 0.5f);
+  EXPECT_FLOAT_EQ(ibuf->rect_float[3], 1.0f);
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImbufScalingTest, FilteredPremultipliedByte)
+{
+  ImBuf *ibuf = IMB_allocImBuf(2, 1, 32, IB_rect);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+
+  /* Opaque red next to a fully transparent green pixel. */
+  rect[0] = 255;
+  rect[1] = 0;
+  rect[2] = 0;
+  rect[3] = 255;
+  rect[4] = 0;
+  rect[5] = 255;
+  rect[6] = 0;
+  rect[7] = 0;
+
+  /* The transparent pixel must not bleed its color into the result. */
+  EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, 1, 1, IMB_SCALE_FILTER_BOX));
+  rect = (unsigned char *)ibuf->rect;
+  EXPECT_EQ(rect[0], 255);
+  EXPECT_EQ(rect[1], 0);
+  EXPECT_EQ(rect[2], 0);
+  EXPECT_EQ(rect[3], 128);
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImbufScalingTest, FilteredSameSize)
+{
+  ImBuf *ibuf = scaling_test_ibuf_new(16, 16, IB_rect);
+  EXPECT_FALSE(IMB_scaleImBuf_filtered(ibuf, 16, 16, IMB_SCALE_FILTER_LANCZOS));
+  EXPECT_FALSE(IMB_scaleImBuf_filtered(ibuf, 0, 16, IMB_SCALE_FILTER_LANCZOS));
+  IMB_freeImBuf(ibuf);
+}
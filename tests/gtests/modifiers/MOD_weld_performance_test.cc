@@ -0,0 +1,86 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+
+#include "PIL_time.h"
+}
+
+#include "blenkernel/BKE_mesh_test_util.h"
+
+#define NUM_RUN_AVERAGED 3
+
+static void weld_perf_do(const char *id, const int size)
+{
+  double timing = 0.0;
+  int result_totvert = 0;
+
+  printf("\n========== STARTING %s ==========\n", id);
+
+  /* Scanned terrain with points a centimeter apart. */
+  Mesh *mesh = mesh_test_split_grid_new(size, 0.01f, 1e-4f);
+  Object ob;
+  memset(&ob, 0, sizeof(ob));
+  ob.type = OB_MESH;
+
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(eModifierType_Weld);
+  ModifierData *md = BKE_modifier_new(eModifierType_Weld);
+  ModifierEvalContext ctx = {NULL, &ob, (ModifierApplyFlag)0};
+
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    Mesh *result = mti->modifyMesh(md, &ctx, mesh);
+    timing += PIL_check_seconds_timer() - init_time;
+    result_totvert = result->totvert;
+    BKE_id_free(NULL, result);
+  }
+
+  printf("\t%d vertices welded to %d\n", mesh->totvert, result_totvert);
+  printf("\tWeld modifier: done in %fs on average over %d runs\n",
+         timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  BKE_modifier_free(md);
+  BKE_id_free(NULL, mesh);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+class WeldModifierPerformanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_modifier_init();
+  }
+};
+
+TEST_F(WeldModifierPerformanceTest, ScanSmall)
+{
+  weld_perf_do("Scan 100x100", 100);
+}
+
+TEST_F(WeldModifierPerformanceTest, ScanMedium)
+{
+  weld_perf_do("Scan 300x300", 300);
+}
+
+TEST_F(WeldModifierPerformanceTest, ScanLarge)
+{
+  weld_perf_do("Scan 1000x1000", 1000);
+}
@@ -0,0 +1,116 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+}
+
+#include "blenkernel/BKE_mesh_test_util.h"
+
+#define GRID_SIZE 60
+
+class WeldModifierTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_modifier_init();
+  }
+
+  void SetUp() override
+  {
+    memset(&ob, 0, sizeof(ob));
+    ob.type = OB_MESH;
+    md = BKE_modifier_new(eModifierType_Weld);
+  }
+
+  void TearDown() override
+  {
+    BKE_modifier_free(md);
+  }
+
+  Mesh *weld(Mesh *mesh, const float merge_dist)
+  {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(eModifierType_Weld);
+    ModifierEvalContext ctx = {NULL, &ob, (ModifierApplyFlag)0};
+    ((WeldModifierData *)md)->merge_dist = merge_dist;
+    return mti->modifyMesh(md, &ctx, mesh);
+  }
+
+  Object ob;
+  ModifierData *md;
+};
+
+TEST_F(WeldModifierTest, SplitGrid)
+{
+  Mesh *mesh = mesh_test_split_grid_new(GRID_SIZE, 1.0f, 0.001f);
+  Mesh *result = weld(mesh, 0.01f);
+  ASSERT_NE(result, mesh);
+
+  EXPECT_EQ(result->totvert, GRID_SIZE * GRID_SIZE);
+  EXPECT_EQ(result->totedge, (GRID_SIZE - 1) * (3 * GRID_SIZE - 1));
+  EXPECT_EQ(result->totpoly, mesh->totpoly);
+  EXPECT_EQ(result->totloop, mesh->totloop);
+
+  /* Every vertex is a merged grid point, kept at the position of one of its sources. */
+  for (int i = 0; i < result->totvert; i++) {
+    const float *co = result->mvert[i].co;
+    EXPECT_NEAR(co[0], roundf(co[0]), 0.002f);
+    EXPECT_NEAR(co[1], roundf(co[1]), 0.002f);
+  }
+
+  /* The topology is consistent and the polygons use the vertices they were made of. */
+  for (int i = 0; i < result->totpoly; i++) {
+    const MPoly *mp = &result->mpoly[i];
+    const MPoly *mp_orig = &mesh->mpoly[i];
+    ASSERT_EQ(mp->totloop, 3);
+    for (int j = 0; j < 3; j++) {
+      const MLoop *ml = &result->mloop[mp->loopstart + j];
+      const MLoop *ml_next = &result->mloop[mp->loopstart + (j + 1) % 3];
+      const MEdge *me = &result->medge[ml->e];
+      EXPECT_TRUE((me->v1 == ml->v && me->v2 == ml_next->v) ||
+                  (me->v2 == ml->v && me->v1 == ml_next->v));
+      EXPECT_LT(len_v3v3(result->mvert[ml->v].co,
+                         mesh->mvert[mesh->mloop[mp_orig->loopstart + j].v].co),
+                0.01f);
+    }
+  }
+
+  BKE_id_free(NULL, result);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(WeldModifierTest, MergeDistance)
+{
+  /* Only the split vertices displaced the same way are within the distance. */
+  Mesh *mesh = mesh_test_split_grid_new(8, 1.0f, 0.1f);
+  Mesh *result = weld(mesh, 0.001f);
+
+  int unique_len = 0;
+  for (int i = 0; i < mesh->totvert; i++) {
+    bool is_unique = true;
+    for (int j = 0; j < i && is_unique; j++) {
+      is_unique = len_v3v3(mesh->mvert[i].co, mesh->mvert[j].co) > 0.001f;
+    }
+    unique_len += is_unique;
+  }
+  EXPECT_LT(unique_len, mesh->totvert);
+  EXPECT_EQ(result->totvert, unique_len);
+
+  BKE_id_free(NULL, result);
+  BKE_id_free(NULL, mesh);
+}
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <vector>
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_cloth.h"
+
+#include "BPH_mass_spring.h"
+#include "implicit.h"
+}
+
+/* More vertices than the threading limit of the block Jacobi solver. */
+#define GRID_SIZE 40
+#define GRID_SPACING 0.05f
+#define NUM_STEPS 60
+#define STEP_TIME (1.0f / 120.0f)
+
+/* Cloth grid in the XY plane hanging from its last row, with structural, shear and bending
+ * springs. Masses and stiffness vary over the grid, as with weight painted cloth. */
+class ImplicitClothTest {
+ public:
+  ImplicitClothTest(const int solver_type)
+  {
+    const float ZERO[3] = {0.0f, 0.0f, 0.0f};
+    float I3[3][3];
+    unit_m3(I3);
+
+    for (int y = 0; y < GRID_SIZE; y++) {
+      for (int x = 0; x < GRID_SIZE; x++) {
+        if (x + 1 < GRID_SIZE) {
+          add_spring(x, y, x + 1, y, false);
+        }
+        if (y + 1 < GRID_SIZE) {
+          add_spring(x, y, x, y + 1, false);
+        }
+        if (x + 1 < GRID_SIZE && y + 1 < GRID_SIZE) {
+          add_spring(x, y, x + 1, y + 1, false);
+          add_spring(x + 1, y, x, y + 1, false);
+        }
+        if (x + 2 < GRID_SIZE) {
+          add_spring(x, y, x + 2, y, true);
+        }
+        if (y + 2 < GRID_SIZE) {
+          add_spring(x, y, x, y + 2, true);
+        }
+      }
+    }
+
+    data = BPH_mass_spring_solver_create(GRID_SIZE * GRID_SIZE, (int)springs.size());
+    BPH_mass_spring_set_solver_type(data, solver_type);
+
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+      const float co[3] = {(float)(i % GRID_SIZE) * GRID_SPACING,
+                           (float)(i / GRID_SIZE) * GRID_SPACING,
+                           0.0f};
+      masses.push_back(0.1f + 0.4f * (float)((i * 7) % 11) / 10.0f);
+      BPH_mass_spring_set_vertex_mass(data, i, masses[i]);
+      BPH_mass_spring_set_rest_transform(data, i, I3);
+      BPH_mass_spring_set_motion_state(data, i, co, ZERO);
+    }
+  }
+
+  ~ImplicitClothTest()
+  {
+    BPH_mass_spring_solver_free(data);
+  }
+
+  /* Simulate and return the positions of all vertices after every step. */
+  std::vector<float> simulate()
+  {
+    std::vector<float> result;
+    const float ZERO[3] = {0.0f, 0.0f, 0.0f};
+    const float gravity[3] = {0.0f, 0.0f, -9.81f};
+
+    for (int step = 0; step < NUM_STEPS; step++) {
+      ImplicitSolverResult solver_result;
+
+      BPH_mass_spring_clear_constraints(data);
+      for (int x = 0; x < GRID_SIZE; x++) {
+        BPH_mass_spring_add_constraint_ndof0(data, (GRID_SIZE - 1) * GRID_SIZE + x, ZERO);
+      }
+
+      BPH_mass_spring_clear_forces(data);
+      for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        BPH_mass_spring_force_gravity(data, i, masses[i], gravity);
+      }
+      for (const Spring &s : springs) {
+        BPH_mass_spring_force_spring_linear(data,
+                                            s.i,
+                                            s.j,
+                                            s.restlen,
+                                            s.stiffness,
+                                            5.0f,
+                                            s.stiffness,
+                                            0.0f,
+                                            false,
+                                            s.is_bending,
+                                            0.0f);
+      }
+
+      EXPECT_TRUE(BPH_mass_spring_solve_velocities(data, STEP_TIME, &solver_result))
+          << "step " << step;
+      BPH_mass_spring_solve_positions(data, STEP_TIME);
+      BPH_mass_spring_apply_result(data);
+
+      for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        float co[3];
+        BPH_mass_spring_get_position(data, i, co);
+        result.insert(result.end(), co, co + 3);
+      }
+    }
+    return result;
+  }
+
+ private:
+  struct Spring {
+    int i, j;
+    float restlen;
+    float stiffness;
+    bool is_bending;
+  };
+
+  void add_spring(const int x1, const int y1, const int x2, const int y2, const bool is_bending)
+  {
+    Spring s;
+    s.i = y1 * GRID_SIZE + x1;
+    s.j = y2 * GRID_SIZE + x2;
+    s.restlen = GRID_SPACING * sqrtf((float)((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)));
+    /* Compressed structural and shear springs add no blocks, bending springs resist. */
+    s.stiffness = (is_bending ? 0.5f : 15.0f) * (1.0f + (float)((s.i * 5) % 9)) / GRID_SPACING;
+    s.is_bending = is_bending;
+    springs.push_back(s);
+  }
+
+  Implicit_Data *data;
+  std::vector<float> masses;
+  std::vector<Spring> springs;
+};
+
+/* Both solvers stop at the same relative residual, so they agree up to that tolerance. */
+TEST(implicit, BlockJacobiMatchesConjugateGradient)
+{
+  std::vector<float> result_ref =
+      ImplicitClothTest(CLOTH_SOLVER_CONJUGATE_GRADIENT).simulate();
+  std::vector<float> result = ImplicitClothTest(CLOTH_SOLVER_BLOCK_JACOBI).simulate();
+  ASSERT_EQ(result.size(), result_ref.size());
+
+  /* The cloth fell, so the comparison isn't trivial. */
+  const int num_coords = GRID_SIZE * GRID_SIZE * 3;
+  float max_fall = 0.0f;
+  for (int i = 2; i < num_coords; i += 3) {
+    max_fall = max_ff(max_fall, -result_ref[result_ref.size() - num_coords + i]);
+  }
+  EXPECT_GT(max_fall, 10.0f * GRID_SPACING);
+
+  float max_error = 0.0f;
+  for (size_t i = 0; i < result.size(); i++) {
+    max_error = max_ff(max_error, fabsf(result[i] - result_ref[i]));
+  }
+  EXPECT_LT(max_error, 0.05f * max_fall);
+}
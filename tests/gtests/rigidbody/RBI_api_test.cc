@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "RBI_api.h"
+
+/* Chains are longer than the minimum solver batch size of Bullet (128 constraints and contacts),
+ * so each is solved as a separate batch. */
+#define NUM_CHAINS 6
+#define CHAIN_LENGTH 140
+#define NUM_FRAMES 30
+
+/* Chains of boxes linked by point constraints falling on a ground plane, each chain is a separate
+ * simulation island. An animated passive box sweeps through all chains and is linked to one of
+ * them, so kinematic bodies are shared by several islands. */
+class RigidBodyIslandsTest {
+ public:
+  RigidBodyIslandsTest(const int num_threads, const bool use_split_impulse)
+  {
+    const float gravity[3] = {0.0f, 0.0f, -9.81f};
+    const float rot[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    world = RB_dworld_new(gravity);
+    RB_dworld_set_solver_iterations(world, 10);
+    RB_dworld_set_split_impulse(world, use_split_impulse);
+    RB_dworld_set_num_threads(world, num_threads);
+
+    ground_shape = RB_shape_new_box(50.0f, 50.0f, 1.0f);
+    box_shape = RB_shape_new_box(0.1f, 0.1f, 0.1f);
+    kinematic_shape = RB_shape_new_box(0.5f, 20.0f, 0.5f);
+
+    const float ground_loc[3] = {0.0f, 0.0f, -1.0f};
+    add_body(ground_shape, ground_loc, rot, 0.0f);
+
+    for (int chain = 0; chain < NUM_CHAINS; chain++) {
+      for (int i = 0; i < CHAIN_LENGTH; i++) {
+        /* Wavy chains, so they don't fall flat. */
+        const float loc[3] = {(float)chain * 2.0f + 0.3f * sinf((float)i * 0.2f),
+                              ((float)i - CHAIN_LENGTH / 2) * 0.21f,
+                              0.5f + 0.2f * (float)chain + 0.3f * cosf((float)i * 0.3f)};
+        rbRigidBody *box = add_body(box_shape, loc, rot, 1.0f);
+
+        if (i > 0) {
+          float pivot[3] = {loc[0], loc[1] - 0.105f, loc[2]};
+          add_constraint(RB_constraint_new_point(pivot, bodies[bodies.size() - 2], box));
+        }
+      }
+    }
+
+    kinematic = add_body(kinematic_shape, kinematic_loc(0), rot, 0.0f);
+    RB_body_set_kinematic_state(kinematic, true);
+    float pivot[3] = {kinematic_loc(0)[0], 0.0f, kinematic_loc(0)[2]};
+    add_constraint(RB_constraint_new_point(pivot, kinematic, bodies[1 + CHAIN_LENGTH / 2]));
+  }
+
+  ~RigidBodyIslandsTest()
+  {
+    for (rbConstraint *con : constraints) {
+      RB_dworld_remove_constraint(world, con);
+      RB_constraint_delete(con);
+    }
+    for (rbRigidBody *body : bodies) {
+      RB_dworld_remove_body(world, body);
+      RB_body_delete(body);
+    }
+    RB_shape_delete(ground_shape);
+    RB_shape_delete(box_shape);
+    RB_shape_delete(kinematic_shape);
+    RB_dworld_delete(world);
+  }
+
+  /* Simulate and return the transforms of all bodies of every frame. */
+  std::vector<float> simulate()
+  {
+    std::vector<float> result;
+    const float rot[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+
+    for (int frame = 1; frame <= NUM_FRAMES; frame++) {
+      RB_body_activate(kinematic);
+      RB_body_set_loc_rot(kinematic, kinematic_loc(frame), rot);
+
+      RB_dworld_step_simulation(world, 1.0f / 24.0f, 10, 1.0f / 60.0f);
+
+      for (rbRigidBody *body : bodies) {
+        float mat[4][4];
+        RB_body_get_transform_matrix(body, mat);
+        result.insert(result.end(), &mat[0][0], &mat[0][0] + 16);
+      }
+    }
+    return result;
+  }
+
+ private:
+  /* The animated box moves across all chains. */
+  static const float *kinematic_loc(const int frame)
+  {
+    static float loc[3];
+    loc[0] = -1.0f + (float)frame * (2.0f * NUM_CHAINS / NUM_FRAMES);
+    loc[1] = 0.0f;
+    loc[2] = 0.5f;
+    return loc;
+  }
+
+  rbRigidBody *add_body(rbCollisionShape *shape,
+                        const float loc[3],
+                        const float rot[4],
+                        const float mass)
+  {
+    rbRigidBody *body = RB_body_new(shape, loc, rot);
+    RB_body_set_mass(body, mass);
+    RB_body_set_activation_state(body, false);
+    RB_dworld_add_body(world, body, 1);
+    bodies.push_back(body);
+    return body;
+  }
+
+  void add_constraint(rbConstraint *con)
+  {
+    RB_dworld_add_constraint(world, con, true);
+    constraints.push_back(con);
+  }
+
+  rbDynamicsWorld *world;
+  rbCollisionShape *ground_shape;
+  rbCollisionShape *box_shape;
+  rbCollisionShape *kinematic_shape;
+  rbRigidBody *kinematic;
+  std::vector<rbRigidBody *> bodies;
+  std::vector<rbConstraint *> constraints;
+};
+
+static void test_islands_threads(const bool use_split_impulse)
+{
+  std::vector<float> result_ref = RigidBodyIslandsTest(1, use_split_impulse).simulate();
+
+  /* The boxes moved. */
+  float moved = 0.0f;
+  for (int i = 0; i < (int)result_ref.size() / NUM_FRAMES; i++) {
+    moved += fabsf(result_ref[result_ref.size() - result_ref.size() / NUM_FRAMES + i] -
+                   result_ref[i]);
+  }
+  EXPECT_GT(moved, 1.0f);
+
+  /* Islands are solved separately whatever the number of threads, the result is identical. */
+  for (int num_threads = 2; num_threads <= 8; num_threads *= 2) {
+    std::vector<float> result = RigidBodyIslandsTest(num_threads, use_split_impulse).simulate();
+    ASSERT_EQ(result.size(), result_ref.size());
+    EXPECT_EQ(memcmp(result.data(), result_ref.data(), sizeof(float) * result.size()), 0)
+        << "with " << num_threads << " threads";
+  }
+}
+
+TEST(rigidbody, IslandsThreads)
+{
+  test_islands_threads(false);
+}
+
+TEST(rigidbody, IslandsThreadsSplitImpulse)
+{
+  test_islands_threads(true);
+}
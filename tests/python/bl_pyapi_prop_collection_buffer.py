@@ -0,0 +1,119 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_pyapi_prop_collection_buffer.py -- --verbose
+import bmesh
+import bpy
+import unittest
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+
+class TestPropCollectionBuffer(unittest.TestCase):
+    def setUp(self):
+        self.mesh = bpy.data.meshes.new("TestBuffer")
+        co = range(12)
+        self.mesh.from_pydata(list(zip(co[0::3], co[1::3], co[2::3])), [], [(0, 1, 2, 3)])
+        self.mesh.uv_layers.new()
+
+    def tearDown(self):
+        if self.mesh is not None:
+            bpy.data.meshes.remove(self.mesh)
+
+    def test_memoryview(self):
+        view = memoryview(self.mesh.vertices.as_buffer("co"))
+        self.assertEqual(view.format, "f")
+        self.assertEqual(view.shape, (4, 3))
+        self.assertFalse(view.readonly)
+        self.assertEqual(view.tolist()[1], [3.0, 4.0, 5.0])
+
+        # Written to the data on update only.
+        view[2, 1] = -1.0
+        self.assertEqual(self.mesh.vertices[2].co[1], 7.0)
+        view.obj.update()
+        self.assertEqual(self.mesh.vertices[2].co[1], -1.0)
+        view.release()
+
+        view = memoryview(self.mesh.loops.as_buffer("vertex_index"))
+        # Same type as the raw array, unsigned in the RNA only.
+        self.assertEqual(view.format, "i")
+        self.assertEqual(view.shape, (4,))
+        self.assertEqual(view.tolist(), [0, 1, 2, 3])
+        view.release()
+
+    @unittest.skipIf(np is None, "NumPy is not available")
+    def test_numpy(self):
+        buffer = self.mesh.vertices.as_buffer("co")
+        co = np.asarray(buffer)
+        self.assertEqual(co.dtype, np.float32)
+        self.assertEqual(co.shape, (4, 3))
+        co += 1.0
+        buffer.update()
+        del co
+
+        co_check = np.empty(12, dtype=np.float32)
+        self.mesh.vertices.foreach_get("co", co_check)
+        self.assertTrue(np.array_equal(co_check, np.arange(1, 13, dtype=np.float32)))
+
+        with self.mesh.uv_layers[0].data.as_buffer("uv") as buffer:
+            uv = np.asarray(buffer)
+            self.assertEqual(uv.shape, (4, 2))
+            uv[:] = ((0.0, 0.0), (1.0, 0.0), (1.0, 1.0), (0.0, 1.0))
+            del uv
+        self.assertEqual(tuple(self.mesh.uv_layers[0].data[2].uv), (1.0, 1.0))
+
+    def test_resize(self):
+        buffer = self.mesh.vertices.as_buffer("co")
+        view = memoryview(buffer)
+        self.mesh.vertices.add(2)
+        # The buffer keeps the values it copied, but can't write them back anymore.
+        self.assertEqual(view.shape, (4, 3))
+        self.assertEqual(memoryview(buffer).shape, (4, 3))
+        with self.assertRaises(BufferError):
+            buffer.update()
+        view.release()
+        self.assertEqual(memoryview(self.mesh.vertices.as_buffer("co")).shape, (6, 3))
+
+    def test_reallocate(self):
+        view = memoryview(self.mesh.vertices.as_buffer("co"))
+        # Replaces all arrays of the mesh, as leaving edit-mode does.
+        bm = bmesh.new()
+        bm.from_mesh(self.mesh)
+        bm.verts.new((0.0, 0.0, 0.0))
+        bm.to_mesh(self.mesh)
+        bm.free()
+        self.assertEqual(view.tolist()[3], [9.0, 10.0, 11.0])
+        view.release()
+
+    def test_remove(self):
+        view = memoryview(self.mesh.loops.as_buffer("vertex_index"))
+        bpy.data.meshes.remove(self.mesh)
+        self.mesh = None
+        self.assertEqual(view.tolist(), [0, 1, 2, 3])
+        view.release()
+
+    def test_context(self):
+        with self.mesh.vertices.as_buffer("co") as buffer:
+            view = memoryview(buffer)
+            view[0, 0] = -1.0
+            view.release()
+        self.assertEqual(self.mesh.vertices[0].co[0], -1.0)
+        with self.assertRaises(ReferenceError):
+            memoryview(buffer)
+
+    def test_unsupported(self):
+        with self.assertRaises(AttributeError):
+            self.mesh.vertices.as_buffer("not_an_attribute")
+        # Stored as a flag.
+        with self.assertRaises(TypeError):
+            self.mesh.vertices.as_buffer("select")
+        with self.assertRaises(TypeError):
+            self.mesh.vertices.as_buffer(0)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
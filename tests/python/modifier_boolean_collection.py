@@ -0,0 +1,166 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Boolean modifier with a collection operand, compared to one boolean modifier per operand:
+./blender.bin --background -noaudio --factory-startup --python tests/python/modifier_boolean_collection.py
+"""
+
+import sys
+import unittest
+
+import bmesh
+import bpy
+
+
+def cube_object(name, location, size):
+    mesh = bpy.data.meshes.new(name)
+    bm = bmesh.new()
+    bmesh.ops.create_cube(bm, size=size)
+    bm.to_mesh(mesh)
+    bm.free()
+
+    ob = bpy.data.objects.new(name, mesh)
+    ob.location = location
+    bpy.context.scene.collection.objects.link(ob)
+    return ob
+
+
+class BooleanCollectionTest(unittest.TestCase):
+    # Overlap of every cutter with the target.
+    CUTTER_OVERLAP = 0.25 * 0.5 * 0.5
+
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        scene = bpy.context.scene
+
+        self.target = cube_object("Target", (0.0, 0.0, 0.0), 2.0)
+        # Cutters sticking out of the middle of three faces of the target. The faces of the
+        # cutters along X are in the same planes, which the inside test of the boolean only gets
+        # right with the same element order as a boolean modifier per cutter.
+        self.cutters = [
+            cube_object("CutterX", (1.0, 0.0, 0.0), 0.5),
+            cube_object("CutterNegX", (-1.0, 0.0, 0.0), 0.5),
+            cube_object("CutterZ", (0.0, 0.0, 1.0), 0.5),
+        ]
+
+        self.collection = bpy.data.collections.new("Cutters")
+        scene.collection.children.link(self.collection)
+        for ob in self.cutters[:2]:
+            self.collection.objects.link(ob)
+        # Objects of child collections are operands too.
+        self.child = bpy.data.collections.new("CuttersChild")
+        self.collection.children.link(self.child)
+        self.child.objects.link(self.cutters[2])
+
+        # Members which are skipped: the target itself and objects without a mesh.
+        self.collection.objects.link(self.target)
+        empty = bpy.data.objects.new("Empty", None)
+        self.collection.objects.link(empty)
+        camera = bpy.data.objects.new("Camera", bpy.data.cameras.new("Camera"))
+        self.collection.objects.link(camera)
+
+    def add_boolean_collection(self, operation):
+        modifier = self.target.modifiers.new("Boolean", 'BOOLEAN')
+        modifier.operand_type = 'COLLECTION'
+        modifier.collection = self.collection
+        modifier.operation = operation
+
+    def add_boolean_objects(self, operation, cutters):
+        for ob in cutters:
+            modifier = self.target.modifiers.new("Boolean", 'BOOLEAN')
+            modifier.operand_type = 'OBJECT'
+            modifier.object = ob
+            modifier.operation = operation
+
+    def evaluate_target(self):
+        """Vertex count and volume of the evaluated target."""
+        depsgraph = bpy.context.evaluated_depsgraph_get()
+        ob_eval = self.target.evaluated_get(depsgraph)
+        mesh = ob_eval.to_mesh()
+        bm = bmesh.new()
+        bm.from_mesh(mesh)
+        result = (len(bm.verts), bm.calc_volume())
+        bm.free()
+        ob_eval.to_mesh_clear()
+        return result
+
+    def evaluate_reference(self, operation, cutters):
+        """Evaluate with one modifier per cutter, then remove them again."""
+        self.target.modifiers.clear()
+        self.add_boolean_objects(operation, cutters)
+        result = self.evaluate_target()
+        self.target.modifiers.clear()
+        return result
+
+    def test_difference(self):
+        self.add_boolean_collection('DIFFERENCE')
+        verts_len, volume = self.evaluate_target()
+        self.assertAlmostEqual(volume, 8.0 - 3 * self.CUTTER_OVERLAP, places=5)
+
+        verts_len_ref, volume_ref = self.evaluate_reference('DIFFERENCE', self.cutters)
+        self.assertEqual(verts_len, verts_len_ref)
+        self.assertAlmostEqual(volume, volume_ref, places=5)
+
+    def test_union(self):
+        self.add_boolean_collection('UNION')
+        verts_len, volume = self.evaluate_target()
+        self.assertAlmostEqual(volume, 8.0 + 3 * self.CUTTER_OVERLAP, places=5)
+
+        verts_len_ref, volume_ref = self.evaluate_reference('UNION', self.cutters)
+        self.assertEqual(verts_len, verts_len_ref)
+        self.assertAlmostEqual(volume, volume_ref, places=5)
+
+    def test_intersect(self):
+        # The cutters don't overlap each other, keep one of them.
+        self.collection.objects.unlink(self.cutters[1])
+        self.child.objects.unlink(self.cutters[2])
+        self.add_boolean_collection('INTERSECT')
+        verts_len, volume = self.evaluate_target()
+        self.assertEqual(verts_len, 8)
+        self.assertAlmostEqual(volume, self.CUTTER_OVERLAP, places=5)
+
+    def test_empty_operand(self):
+        empty_mesh = bpy.data.objects.new("EmptyMesh", bpy.data.meshes.new("EmptyMesh"))
+        self.collection.objects.link(empty_mesh)
+
+        # Leaves union and difference as they are.
+        self.add_boolean_collection('DIFFERENCE')
+        verts_len, volume = self.evaluate_target()
+        verts_len_ref, volume_ref = self.evaluate_reference('DIFFERENCE', self.cutters)
+        self.assertEqual(verts_len, verts_len_ref)
+        self.assertAlmostEqual(volume, volume_ref, places=5)
+
+        # Nothing is inside of an empty operand.
+        self.add_boolean_collection('INTERSECT')
+        self.assertEqual(self.evaluate_target(), (0, 0.0))
+
+    def test_no_operands(self):
+        for ob in self.cutters:
+            ob.data = bpy.data.meshes.new("Empty")
+        self.add_boolean_collection('DIFFERENCE')
+        verts_len, volume = self.evaluate_target()
+        self.assertEqual(verts_len, 8)
+        self.assertAlmostEqual(volume, 8.0, places=5)
+
+
+if __name__ == '__main__':
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
@@ -0,0 +1,97 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Benchmark of emitter and hair particle systems on generated objects, without a test file:
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/physics_particle_benchmark.py
+
+import time
+
+import bmesh
+import bpy
+
+
+def benchmark_particle_object(name, resolution=32):
+    """Grid emitting the particles, with a particle system modifier."""
+    mesh = bpy.data.meshes.new(name)
+    bm = bmesh.new()
+    bmesh.ops.create_grid(bm, x_segments=resolution, y_segments=resolution, size=1.0)
+    bm.to_mesh(mesh)
+    bm.free()
+
+    ob = bpy.data.objects.new(name, mesh)
+    bpy.context.scene.collection.objects.link(ob)
+    ob.modifiers.new("ParticleSystem", 'PARTICLE_SYSTEM')
+    return ob, ob.particle_systems[0]
+
+
+def benchmark_emitter(count, frames=50):
+    scene = bpy.context.scene
+    ob, psys = benchmark_particle_object("BenchmarkEmitter")
+    part = psys.settings
+    part.count = count
+    part.frame_start = 1.0
+    part.frame_end = frames / 2
+    part.lifetime = frames
+    part.brownian_factor = 0.1
+    psys.point_cache.frame_end = frames
+    scene.frame_set(1)
+
+    start = time.perf_counter()
+    for frame in range(2, frames + 1):
+        scene.frame_set(frame)
+    elapsed = time.perf_counter() - start
+
+    print("{:d} emitted particles: {:.3f}s for {:d} frames".format(count, elapsed, frames - 1))
+    bpy.data.objects.remove(ob)
+
+
+def benchmark_hair(count, children, redraws=10):
+    ob, psys = benchmark_particle_object("BenchmarkHair")
+    part = psys.settings
+    part.type = 'HAIR'
+    part.count = count
+    part.hair_step = 8
+    part.child_type = 'INTERPOLATED'
+    part.child_nbr = children
+    part.rendered_child_count = children
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    depsgraph.update()
+
+    # Changing the display steps recomputes the parent and child paths only.
+    start = time.perf_counter()
+    for i in range(redraws):
+        part.display_step = 3 + i % 2
+        depsgraph.update()
+    elapsed = time.perf_counter() - start
+
+    print("{:d} hairs with {:d} children: {:.3f}s per path update".format(
+        count, count * children, elapsed / redraws))
+    bpy.data.objects.remove(ob)
+
+
+def main():
+    for count in (10000, 100000):
+        benchmark_emitter(count)
+    for count, children in ((1000, 100), (5000, 100)):
+        benchmark_hair(count, children)
+
+
+if __name__ == "__main__":
+    main()
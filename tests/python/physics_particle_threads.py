@@ -0,0 +1,166 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Particle simulation and hair paths must not depend on the number of threads. Blender runs this
+# script again with different thread counts and compares the results:
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/physics_particle_threads.py
+
+import array
+import hashlib
+import subprocess
+import sys
+
+import bmesh
+import bpy
+
+
+THREADS = (1, 2, 4, 8)
+FRAMES = 20
+
+
+def particle_object(name, resolution=16):
+    """Grid emitting the particles, with a particle system modifier."""
+    mesh = bpy.data.meshes.new(name)
+    bm = bmesh.new()
+    bmesh.ops.create_grid(bm, x_segments=resolution, y_segments=resolution, size=1.0)
+    bm.to_mesh(mesh)
+    bm.free()
+
+    ob = bpy.data.objects.new(name, mesh)
+    bpy.context.scene.collection.objects.link(ob)
+    ob.modifiers.new("ParticleSystem", 'PARTICLE_SYSTEM')
+    return ob, ob.particle_systems[0]
+
+
+def noisy_wind():
+    """Wind field with noise, using the random number generator of the field."""
+    ob = bpy.data.objects.new("Wind", None)
+    bpy.context.scene.collection.objects.link(ob)
+    ob.rotation_euler = (0.5, 0.5, 0.0)
+    ob.field.type = 'WIND'
+    ob.field.strength = 2.0
+    ob.field.noise = 5.0
+    # The default seed comes from the clock.
+    ob.field.seed = 1
+
+
+def emitter_setup(part):
+    part.count = 1000
+    part.frame_start = 1.0
+    part.frame_end = FRAMES / 2
+    part.lifetime = FRAMES
+    part.brownian_factor = 0.1
+
+
+def emitter_locations(ob):
+    scene = bpy.context.scene
+    ob.particle_systems[0].point_cache.frame_end = FRAMES
+    for frame in range(1, FRAMES + 1):
+        scene.frame_set(frame)
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    particles = ob.evaluated_get(depsgraph).particle_systems[0].particles
+    locations = array.array('f', [0.0]) * (len(particles) * 3)
+    particles.foreach_get("location", locations)
+    return locations
+
+
+def case_emitter_noise():
+    ob, psys = particle_object("Emitter")
+    emitter_setup(psys.settings)
+    noisy_wind()
+    return emitter_locations(ob)
+
+
+def case_emitter_self_effect():
+    ob, psys = particle_object("Emitter")
+    part = psys.settings
+    emitter_setup(part)
+    part.use_self_effect = True
+    part.force_field_1.type = 'FORCE'
+    part.force_field_1.strength = -0.5
+    return emitter_locations(ob)
+
+
+def case_hair_noise():
+    ob, psys = particle_object("Hair")
+    part = psys.settings
+    part.type = 'HAIR'
+    part.count = 500
+    part.hair_step = 8
+    part.effect_hair = 0.5
+    noisy_wind()
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    depsgraph.update()
+    ob_eval = ob.evaluated_get(depsgraph)
+    psys_eval = ob_eval.particle_systems[0]
+    steps = 2 ** part.display_step
+    locations = array.array('f')
+    for i in range(part.count):
+        for step in range(steps + 1):
+            locations.extend(psys_eval.co_hair(object=ob_eval, particle_no=i, step=step))
+    return locations
+
+
+CASES = (case_emitter_noise, case_emitter_self_effect, case_hair_noise)
+
+
+def dump():
+    """Print a hash of the result of every case."""
+    for case in CASES:
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+        locations = case()
+        print("{:s} {:s}".format(case.__name__, hashlib.md5(locations.tobytes()).hexdigest()))
+
+
+def run_threads(threads):
+    output = subprocess.check_output([
+        bpy.app.binary_path,
+        "--background",
+        "-noaudio",
+        "--factory-startup",
+        "--python-exit-code", "1",
+        "--threads", str(threads),
+        "--python", __file__,
+        "--",
+        "--dump",
+    ], universal_newlines=True)
+    return [line for line in output.splitlines() if line.startswith("case_")]
+
+
+def main():
+    if "--dump" in sys.argv:
+        dump()
+        return
+
+    result_ref = run_threads(THREADS[0])
+    assert len(result_ref) == len(CASES)
+    for threads in THREADS[1:]:
+        result = run_threads(threads)
+        if result != result_ref:
+            print("Result with {:d} threads differs from {:d} thread".format(threads, THREADS[0]))
+            print("\n".join(result_ref))
+            print("\n".join(result))
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
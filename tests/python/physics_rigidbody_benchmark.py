@@ -0,0 +1,93 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Benchmark of the rigid body simulation on generated piles of cubes, without a test file:
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/physics_rigidbody_benchmark.py
+
+import time
+
+import bmesh
+import bpy
+
+
+def benchmark_cube_mesh(size):
+    mesh = bpy.data.meshes.new("BenchmarkCube")
+    bm = bmesh.new()
+    bmesh.ops.create_cube(bm, size=size)
+    bm.to_mesh(mesh)
+    bm.free()
+    return mesh
+
+
+def benchmark_scene(num_piles, cubes_per_pile):
+    """Piles of cubes falling on a passive ground, each pile a separate simulation island."""
+    scene = bpy.context.scene
+    view_layer = bpy.context.view_layer
+
+    ground = bpy.data.objects.new("BenchmarkGround", benchmark_cube_mesh(1.0))
+    ground.scale = (num_piles * 2.0, num_piles * 2.0, 0.5)
+    ground.location.z = -0.5
+    scene.collection.objects.link(ground)
+    view_layer.objects.active = ground
+    bpy.ops.rigidbody.object_add(type='PASSIVE')
+
+    mesh = benchmark_cube_mesh(0.5)
+    rows = int(num_piles ** 0.5) + 1
+    for ob in scene.objects:
+        ob.select_set(False)
+    for pile in range(num_piles):
+        for i in range(cubes_per_pile):
+            ob = bpy.data.objects.new("BenchmarkCube", mesh)
+            ob.location = ((pile % rows) * 4.0 + (i % 2) * 0.1, (pile // rows) * 4.0, 0.3 + i * 0.55)
+            scene.collection.objects.link(ob)
+            ob.select_set(True)
+    bpy.ops.rigidbody.objects_add(type='ACTIVE')
+
+    return scene.rigidbody_world
+
+
+def benchmark(frames=100):
+    scene = bpy.context.scene
+    for num_piles, cubes_per_pile in ((16, 20), (64, 40)):
+        rbw = benchmark_scene(num_piles, cubes_per_pile)
+        rbw.point_cache.frame_end = frames
+
+        for threads in (1, 0):
+            rbw.threads = threads
+            # Changing the world settings frees the cache.
+            rbw.time_scale = 1.0
+            scene.frame_set(1)
+
+            start = time.perf_counter()
+            for frame in range(2, frames + 1):
+                scene.frame_set(frame)
+            elapsed = time.perf_counter() - start
+
+            steps = (frames - 1) * rbw.steps_per_second / scene.render.fps
+            print("{:d} cubes, {:s}: {:.1f} steps per second".format(
+                num_piles * cubes_per_pile, "1 thread" if threads else "all threads", steps / elapsed))
+
+        for ob in list(scene.objects):
+            bpy.data.objects.remove(ob)
+        bpy.ops.rigidbody.world_remove()
+
+
+if __name__ == "__main__":
+    benchmark()